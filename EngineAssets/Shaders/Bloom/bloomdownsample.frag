@@ -0,0 +1,36 @@
+#include "../globals.glsl"
+
+// Halves the resolution with 13 bilinear taps, 4 overlapping 2x2 boxes around the center and one at it. Wider than a box filter
+// so small bright spots do not flicker when they move between the texels of the smaller level
+
+layout(binding = BLUR_TEXTURE_BINDING_POINT) uniform sampler2D u_sourceTex;
+
+uniform vec2 u_sourceTexelSize;
+
+in vec2 v_texcoord;
+
+layout(location = 0) out vec3 out_color;
+
+vec3 sampleSource(float a_x, float a_y)
+{
+	return texture(u_sourceTex, v_texcoord + vec2(a_x, a_y) * u_sourceTexelSize).rgb;
+}
+
+void main()
+{
+	vec3 a = sampleSource(-2.0,  2.0);
+	vec3 b = sampleSource( 0.0,  2.0);
+	vec3 c = sampleSource( 2.0,  2.0);
+	vec3 d = sampleSource(-2.0,  0.0);
+	vec3 e = sampleSource( 0.0,  0.0);
+	vec3 f = sampleSource( 2.0,  0.0);
+	vec3 g = sampleSource(-2.0, -2.0);
+	vec3 h = sampleSource( 0.0, -2.0);
+	vec3 i = sampleSource( 2.0, -2.0);
+	vec3 j = sampleSource(-1.0,  1.0);
+	vec3 k = sampleSource( 1.0,  1.0);
+	vec3 l = sampleSource(-1.0, -1.0);
+	vec3 m = sampleSource( 1.0, -1.0);
+
+	out_color = e * 0.125 + (a + c + g + i) * 0.03125 + (b + d + f + h) * 0.0625 + (j + k + l + m) * 0.125;
+}
@@ -0,0 +1,27 @@
+#include "../globals.glsl"
+
+// Adds the level below, upsampled with a 3x3 tent, to the downsampled level of this resolution
+
+layout(binding = BLUR_TEXTURE_BINDING_POINT) uniform sampler2D u_sourceTex;
+layout(binding = COLOR_TEXTURE_BINDING_POINT) uniform sampler2D u_levelTex;
+
+uniform vec2 u_sourceTexelSize;
+uniform float u_scale;
+
+in vec2 v_texcoord;
+
+layout(location = 0) out vec3 out_color;
+
+vec3 sampleSource(float a_x, float a_y)
+{
+	return texture(u_sourceTex, v_texcoord + vec2(a_x, a_y) * u_sourceTexelSize).rgb;
+}
+
+void main()
+{
+	vec3 upsampled = sampleSource(0.0, 0.0) * 4.0;
+	upsampled += (sampleSource(-1.0, 0.0) + sampleSource(1.0, 0.0) + sampleSource(0.0, -1.0) + sampleSource(0.0, 1.0)) * 2.0;
+	upsampled += sampleSource(-1.0, -1.0) + sampleSource(1.0, -1.0) + sampleSource(-1.0, 1.0) + sampleSource(1.0, 1.0);
+
+	out_color = (texture(u_levelTex, v_texcoord).rgb + upsampled * (1.0 / 16.0)) * u_scale;
+}
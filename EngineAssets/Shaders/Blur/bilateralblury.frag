@@ -9,7 +9,7 @@ VALACCESSOR  (e.g: rg)
 
 in vec2 v_texcoord;
 
-layout(binding = BLUR_TEXTURE_BINDING_POINT) uniform FBOSampler u_blurTex;
+layout(binding = BLUR_TEXTURE_BINDING_POINT) uniform sampler2D u_blurTex;
 layout(binding = DEPTH_TEXTURE_BINDING_POINT) uniform FBOSampler u_depthTex;
 
 layout(location = 0) out float out_val;
@@ -28,7 +28,7 @@ float sampleDepth(vec2 a_texcoord)
 
 VALTYPE sampleVal(vec2 a_texcoord)
 {
-	return singleSampleFBO(u_blurTex, a_texcoord).VALACCESSOR;
+	return texture(u_blurTex, a_texcoord).VALACCESSOR;
 }
 
 float crossBilateralWeight(float a_r, float a_z, float a_z0)
@@ -7,7 +7,7 @@ VALACCESSOR  (e.g: rg)
 
 in vec2 v_texcoord;
 
-layout(binding = BLUR_TEXTURE_BINDING_POINT) uniform FBOSampler u_blurTex;
+layout(binding = BLUR_TEXTURE_BINDING_POINT) uniform sampler2D u_blurTex;
 
 uniform vec2 u_pixelOffset;
 
@@ -49,7 +49,7 @@ void main()
     for( int i = 0; i < stepCount; i++ )                                                                            
     {                                                                                                               
         vec2 texCoordOffset = offsets[i] * u_pixelOffset;                                                            
-        VALTYPE val = singleSampleFBO(u_blurTex, v_texcoord + texCoordOffset).VALACCESSOR + singleSampleFBO(u_blurTex, v_texcoord - texCoordOffset).VALACCESSOR; 
+        VALTYPE val = texture(u_blurTex, v_texcoord + texCoordOffset).VALACCESSOR + texture(u_blurTex, v_texcoord - texCoordOffset).VALACCESSOR; 
         blurredVal += weights[i] * val;                                                                                
     }
     out_val = blurredVal;
@@ -3,14 +3,31 @@
 
 #include "../globals.glsl"
 
+#ifdef DEINTERLEAVED
+// The depth is split in 4x4 layers, the layer (x, y) holds the pixels (4i + x, 4j + y). The pixels of a layer sample only their own
+// layer, every 4th pixel, with the same direction and jitter so neighbouring pixels sample neighbouring texels
+layout (binding = DEPTH_TEXTURE_BINDING_POINT) uniform sampler2D u_linearDepthTex;
+#define SAMPLE_SPACING 4.0
+#else
 layout (binding = DEPTH_TEXTURE_BINDING_POINT) uniform FBOSampler u_linearDepthTex;
+#define SAMPLE_SPACING 1.0
+#endif
 layout (binding = HBAO_NOISE_TEXTURE_BINDING_POINT) uniform sampler2D u_noiseTex;
 
+// Change every frame when the frames add up, so the frames sample different directions and steps
+uniform float u_directionOffset;
+uniform float u_stepJitter;
+
 in vec2 v_position;
 in vec2 v_texcoord;
 
 layout(location = 0) out float out_ao;
 
+#ifdef DEINTERLEAVED
+ivec2 g_layer;
+ivec2 g_layerRes;
+#endif
+
 float viewSpaceZFromDepth(float a_d)
 {
 	a_d = a_d * 2.0 - 1.0;
@@ -43,9 +60,19 @@ vec3 uvToEye(vec2 a_uv, float a_eyeZ)
 	return vec3(uv * a_eyeZ, a_eyeZ);
 }
 
+float fetchDepth(vec2 a_uv)
+{
+#ifdef DEINTERLEAVED
+	ivec2 layerTexel = clamp(ivec2(floor(a_uv * u_aoResolution / SAMPLE_SPACING)), ivec2(0), g_layerRes - 1);
+	return texelFetch(u_linearDepthTex, g_layer * g_layerRes + layerTexel, 0).r;
+#else
+	return singleSampleFBO(u_linearDepthTex, a_uv).r;
+#endif
+}
+
 vec3 fetchEyePos(vec2 a_uv)
 {
-	float depth = singleSampleFBO(u_linearDepthTex, a_uv).r;
+	float depth = fetchDepth(a_uv);
 	float z = viewSpaceZFromDepth(depth);
 	return uvToEye(a_uv, z);
 }
@@ -69,7 +96,7 @@ float falloff(float a_d2)
 
 vec2 snapUVOffset(vec2 a_uv)
 {
-	return round(a_uv * u_aoResolution) * u_invAOResolution;
+	return round(a_uv * u_aoResolution / SAMPLE_SPACING) * SAMPLE_SPACING * u_invAOResolution;
 }
 
 float tanToSin(float a_x)
@@ -90,7 +117,7 @@ vec2 rotateDirections(vec2 a_dir, vec2 a_cosSin)
 
 void computeSteps(inout vec2 a_stepSizeUV, inout float a_numSteps, float a_rayRadiusPx, float a_rand)
 {
-	a_numSteps = min(NUM_STEPS, a_rayRadiusPx);
+	a_numSteps = min(NUM_STEPS, a_rayRadiusPx / SAMPLE_SPACING);
 	float stepSizePx = a_rayRadiusPx / (a_numSteps + 1);
 	float maxNumSteps = u_maxRadiusPixels / stepSizePx;
 
@@ -104,12 +131,12 @@ void computeSteps(inout vec2 a_stepSizeUV, inout float a_numSteps, float a_rayRa
 	a_stepSizeUV = stepSizePx * u_invAOResolution;
 }
 
-float horizonOcclusion(vec2 a_deltaUV, vec3 a_p, float a_numSteps, 
+float horizonOcclusion(vec2 a_texcoord, vec2 a_deltaUV, vec3 a_p, float a_numSteps, 
                        float a_randstep, vec3 a_dPdu, vec3 a_dPdv)
 {
 	float ao = 0.0;
 
-	vec2 uv = v_texcoord + snapUVOffset(a_randstep * a_deltaUV);
+	vec2 uv = a_texcoord + snapUVOffset(a_randstep * a_deltaUV);
 	vec2 deltaUV = snapUVOffset(a_deltaUV);
 	vec3 t = deltaUV.x * a_dPdu + deltaUV.y * a_dPdv;
 	float tanH = biasedTangent(t);
@@ -139,10 +166,15 @@ float hbao(vec2 a_texcoord)
 	float ao = 1.0;
 
 	vec3 p = fetchEyePos(a_texcoord);
+#ifdef DEINTERLEAVED
+	vec3 rand = texelFetch(u_noiseTex, g_layer, 0).rgb;
+#else
 	vec3 rand = texture(u_noiseTex, a_texcoord.xy * u_noiseTexScale).rgb;
+#endif
+	rand.z = fract(rand.z + u_stepJitter);
 	vec2 rayRadiusUV = (0.5 * u_r * u_focalLen) / -p.z;
 	float rayRadiusPx = rayRadiusUV.x * u_aoResolution.x;
-	if (rayRadiusPx > 1.0)
+	if (rayRadiusPx > SAMPLE_SPACING)
 	{
 		ao = 0.0;
 		float numSteps;
@@ -150,10 +182,10 @@ float hbao(vec2 a_texcoord)
 		computeSteps(stepSize, numSteps, rayRadiusPx, rand.z);
 
 		vec3 pr, pl, pt, pb;
-		pr = fetchEyePos(a_texcoord + vec2(u_invAOResolution.x, 0));
-		pl = fetchEyePos(a_texcoord + vec2(-u_invAOResolution.x, 0));
-		pt = fetchEyePos(a_texcoord + vec2(0, u_invAOResolution.y));
-		pb = fetchEyePos(a_texcoord + vec2(0, -u_invAOResolution.y));
+		pr = fetchEyePos(a_texcoord + vec2(u_invAOResolution.x * SAMPLE_SPACING, 0));
+		pl = fetchEyePos(a_texcoord + vec2(-u_invAOResolution.x * SAMPLE_SPACING, 0));
+		pt = fetchEyePos(a_texcoord + vec2(0, u_invAOResolution.y * SAMPLE_SPACING));
+		pb = fetchEyePos(a_texcoord + vec2(0, -u_invAOResolution.y * SAMPLE_SPACING));
 
 		vec3 dPdu = minDiff(p, pr, pl);
 		vec3 dPdv = minDiff(p, pt, pb) * (u_aoResolution.y * u_invAOResolution.x);
@@ -162,10 +194,10 @@ float hbao(vec2 a_texcoord)
 
 		for (float d = 0.0; d < NUM_DIRECTIONS; ++d)
 		{
-			float angle = alpha * d;
+			float angle = alpha * d + u_directionOffset;
 			vec2 dir = rotateDirections(vec2(cos(angle), sin(angle)), rand.xy);
 			vec2 deltaUV = dir * stepSize;
-			ao += horizonOcclusion(deltaUV, p, numSteps, rand.z, dPdu, dPdv);
+			ao += horizonOcclusion(a_texcoord, deltaUV, p, numSteps, rand.z, dPdu, dPdv);
 		}
 		ao = 1.0 - ao / NUM_DIRECTIONS * u_strength;
 	}
@@ -174,5 +206,14 @@ float hbao(vec2 a_texcoord)
 
 void main()
 {
+#ifdef DEINTERLEAVED
+	// The texcoord of the pixel this texel of its layer holds
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	g_layerRes = ivec2(ceil(u_aoResolution / SAMPLE_SPACING));
+	g_layer = texel / g_layerRes;
+	vec2 pixel = vec2((texel - g_layer * g_layerRes) * int(SAMPLE_SPACING) + g_layer);
+	out_ao = hbao((pixel + 0.5) * u_invAOResolution);
+#else
 	out_ao = hbao(v_texcoord);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "../globals.glsl"
+
+// Splits the depth at the ambient occlusion resolution into 4x4 layers, the layer (x, y) holds the pixels (4i + x, 4j + y)
+
+layout (binding = DEPTH_TEXTURE_BINDING_POINT) uniform FBOSampler u_depthTex;
+
+layout (location = 0) out float out_depth;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	ivec2 layerRes = ivec2(ceil(u_aoResolution / 4.0));
+	ivec2 layer = texel / layerRes;
+	vec2 pixel = vec2((texel - layer * layerRes) * 4 + layer);
+	out_depth = singleSampleFBO(u_depthTex, min(pixel + 0.5, u_aoResolution - 0.5) * u_invAOResolution).r;
+}
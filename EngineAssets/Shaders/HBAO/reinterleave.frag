@@ -0,0 +1,14 @@
+#include "../globals.glsl"
+
+// Puts the pixels of the 4x4 layers of the ambient occlusion back in place
+
+layout (binding = BLUR_TEXTURE_BINDING_POINT) uniform sampler2D u_aoTex;
+
+layout (location = 0) out float out_ao;
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	ivec2 layerRes = ivec2(ceil(u_aoResolution / 4.0));
+	out_ao = texelFetch(u_aoTex, (pixel % 4) * layerRes + pixel / 4, 0).r;
+}
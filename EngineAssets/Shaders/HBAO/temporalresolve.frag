@@ -0,0 +1,47 @@
+#include "../globals.glsl"
+
+// Blends the ambient occlusion of this frame into the result of the frames before, reprojected with the view projection of the
+// frame before. The history is dropped where the depth the frame before stored does not match the reprojected depth, which is
+// something that was hidden or off screen the frame before
+
+layout (binding = BLUR_TEXTURE_BINDING_POINT) uniform sampler2D u_aoTex;
+layout (binding = DEPTH_TEXTURE_BINDING_POINT) uniform FBOSampler u_depthTex;
+layout (binding = HBAO_HISTORY_TEXTURE_BINDING_POINT) uniform sampler2D u_historyTex;
+layout (binding = HBAO_HISTORY_DEPTH_TEXTURE_BINDING_POINT) uniform sampler2D u_historyDepthTex;
+
+uniform mat4 u_reprojectionMatrix; // From the clip space of this frame to the one of the frame before
+uniform float u_historyWeight;     // 0 without a history
+uniform float u_depthTolerance;    // Relative difference of the view depths
+
+in vec2 v_texcoord;
+
+layout (location = 0) out float out_ao;
+layout (location = 1) out float out_depth;
+
+float viewDepth(float a_d)
+{
+	return 1.0 / (u_ndcDepthConv.x * (a_d * 2.0 - 1.0) + u_ndcDepthConv.y);
+}
+
+void main()
+{
+	float ao = texture(u_aoTex, v_texcoord).r;
+	float depth = singleSampleFBO(u_depthTex, v_texcoord).r;
+
+	vec4 prevClip = u_reprojectionMatrix * vec4(vec3(v_texcoord, depth) * 2.0 - 1.0, 1.0);
+	vec3 prevPos = (prevClip.xyz / prevClip.w) * 0.5 + 0.5;
+
+	float weight = u_historyWeight;
+	if (any(lessThan(prevPos.xy, vec2(0.0))) || any(greaterThan(prevPos.xy, vec2(1.0))))
+		weight = 0.0;
+
+	// Not filtered, depths across an edge average to a depth of neither side
+	ivec2 historyTexel = ivec2(prevPos.xy * vec2(textureSize(u_historyDepthTex, 0)));
+	float historyDepth = viewDepth(texelFetch(u_historyDepthTex, historyTexel, 0).r);
+	float expectedDepth = viewDepth(prevPos.z);
+	if (abs(historyDepth - expectedDepth) > u_depthTolerance * expectedDepth)
+		weight = 0.0;
+
+	out_ao = mix(ao, texture(u_historyTex, prevPos.xy).r, weight);
+	out_depth = depth;
+}
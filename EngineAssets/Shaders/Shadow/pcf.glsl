@@ -24,18 +24,33 @@ const vec2 poissonDisk[16] = vec2[](
 	vec2(0.14383161, -0.14100790)
 );
 
-float pcf(vec4 shadowCoord)
+#define PCF_RADIUS_TEXELS 2.5
+
+// atlasRect is the tile of the cascade in the shadow atlas, min xy max zw
+float pcf(vec4 shadowCoord, vec4 atlasRect)
 {
 	float totalShadow = 0.0;
 	float bias = 0.0006;
+	vec2 texelSize = 1.0 / vec2(textureSize(u_shadowTex, 0));
 	for (int i = 0; i < PCF_NUM_SAMPLES; ++i)
 	{
-		vec2 offset = poissonDisk[i] * 0.0003;
-		vec2 texcoord = (shadowCoord.xy + offset) / shadowCoord.w;
+		vec2 offset = poissonDisk[i] * PCF_RADIUS_TEXELS * texelSize;
+		vec2 texcoord = clamp((shadowCoord.xy + offset) / shadowCoord.w, atlasRect.xy, atlasRect.zw);
 		float depth = (shadowCoord.z - bias) / shadowCoord.w;
 		totalShadow += texture(u_shadowTex, vec3(texcoord, depth));
 	}
 	return totalShadow / PCF_NUM_SAMPLES;
 }
 
+// Uses the first cascade that reaches the view depth of the fragment, beyond the last one everything is lit
+float cascadedPCF(vec3 worldPosition, float viewDepth)
+{
+	for (int i = 0; i < u_numShadowCascades; ++i)
+	{
+		if (viewDepth <= u_shadowCascadeSplits[i])
+			return pcf(u_shadowMats[i] * vec4(worldPosition, 1.0), u_shadowAtlasRects[i]);
+	}
+	return 1.0;
+}
+
 #endif // PCF_GLSL
\ No newline at end of file
@@ -4,7 +4,7 @@
 /* USAGE /*
 Use the FOR_LIGHT_ITERATOR(LIGHT, VSDEPTH) macro like a regular for loop, LIGHT being the the name of the iterated light, VSDEPTH being the depth of the current fragment. e.g:
 FOR_LIGHT_ITERATOR(light, v_position.z)
-{ // operate with light.positionRange (vec4) and light.colorIntensity (vec4)
+{ // operate with light.positionRange (vec4), light.colorIntensity (vec4) and light.directionAngle (vec4), attenuated by getSpotAttenuation
 }
 */
 
@@ -12,6 +12,23 @@ struct Light
 {
 	vec4 positionRange;
 	vec4 colorIntensity;
+	vec4 directionAngle; // View space direction and cosine of the cone angle, -1 for point lights
+};
+
+#define SPOT_EDGE_SOFTNESS 0.1 // Of the cosine range of the cone that fades out towards its side
+
+// As many lights as the LightManager has, view space positions
+layout (std430, binding = LIGHT_POSITION_RANGES_BINDING_POINT) readonly buffer LightPositionRanges
+{
+	vec4 u_lightPositionRanges[];
+};
+layout (std430, binding = LIGHT_COLOR_INTENSITIES_BINDING_POINT) readonly buffer LightColorsIntensities
+{
+	vec4 u_lightColorIntensities[];
+};
+layout (std430, binding = LIGHT_DIRECTION_ANGLES_BINDING_POINT) readonly buffer LightDirectionAngles
+{
+	vec4 u_lightDirectionAngles[];
 };
 
 layout (binding = LIGHT_INDICE_TEXTURE_BINDING_POINT) uniform isamplerBuffer u_lightIndices;
@@ -23,7 +40,7 @@ layout (binding = LIGHT_GRID_TEXTURE_BINDING_POINT)   uniform isamplerBuffer u_l
 
 ivec2 _getLightListBeginEnd(float viewspaceDepth)
 {
-	ivec2 tileXY = ivec2(int(gl_FragCoord.x) / u_tileWidth, int(gl_FragCoord.y) / u_tileHeight);
+	ivec2 tileXY = ivec2(gl_FragCoord.xy * u_invRenderScale) / ivec2(u_tileWidth, u_tileHeight);
 	float tileZ = log(-viewspaceDepth * u_recNear) * u_recLogSD1;
 	int offset = (tileXY.x * u_gridHeight + tileXY.y) * u_gridDepth + int(tileZ);
 	return texelFetch(u_lightGrid, offset).xy;
@@ -31,9 +48,22 @@ ivec2 _getLightListBeginEnd(float viewspaceDepth)
 
 bool _lightIteratorCheck(ivec2 iterator, out Light light)
 {
+	// The storage buffers are only as large as the lights, the end of the list must not be read
+	if (iterator.x >= iterator.y)
+		return false;
 	int lightIndex = texelFetch(u_lightIndices, iterator.x).r;
 	light.positionRange = u_lightPositionRanges[lightIndex];
 	light.colorIntensity = u_lightColorIntensities[lightIndex];
-	return iterator.x < iterator.y;
+	light.directionAngle = u_lightDirectionAngles[lightIndex];
+	return true;
+}
+
+// L points from the fragment towards the light, nothing outside of the cone the lights are assigned to the clusters with is lit
+float getSpotAttenuation(Light light, vec3 L)
+{
+	float cosAngle = light.directionAngle.w;
+	if (cosAngle <= -1.0)
+		return 1.0;
+	return smoothstep(cosAngle, mix(cosAngle, 1.0, SPOT_EDGE_SOFTNESS), dot(-L, light.directionAngle.xyz));
 }
 #endif // CLUSTERED_SHADING
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "globals.glsl"
 
 layout(binding = COLOR_TEXTURE_BINDING_POINT) uniform FBOSampler u_colorTex;
-layout(binding = AO_RESULT_TEXTURE_BINDING_POINT) uniform FBOSampler u_aoTex;
-layout(binding = BLOOM_RESULT_TEXTURE_BINDING_POINT) uniform FBOSampler u_bloomTex;
+layout(binding = AO_RESULT_TEXTURE_BINDING_POINT) uniform sampler2D u_aoTex;
+layout(binding = BLOOM_RESULT_TEXTURE_BINDING_POINT) uniform sampler2D u_bloomTex; // Lower resolution, filtered while upscaled
 
 in vec2 v_texcoord;
 
@@ -11,8 +11,8 @@ layout(location = 0) out vec3 out_color;
 void main()
 {
 	vec3 color = sampleFBO(u_colorTex, v_texcoord).rgb;
-	float ao = singleSampleFBO(u_aoTex, v_texcoord).r;
-	vec3 bloom = singleSampleFBO(u_bloomTex, v_texcoord).rgb;
+	float ao = texture(u_aoTex, v_texcoord).r;
+	vec3 bloom = texture(u_bloomTex, v_texcoord).rgb;
 
 	if (u_hbaoEnabled != 0)
 		color *= ao;
@@ -33,6 +33,22 @@
 	#define sampleFBO texture
 	#define singleSampleFBO texture
 #endif
+#ifdef DRAW_INDIRECT
+struct DrawTransform
+{
+	mat4 modelMatrix;
+	mat4 normalMatrix;
+};
+layout (std430, binding = DRAW_TRANSFORMS_BINDING_POINT) readonly buffer DrawTransforms
+{
+	DrawTransform u_drawTransforms[];
+};
+	#if VERTEX_SHADER
+		layout(location = 5) in uint in_drawID; // Instanced attribute, equals the baseInstance of the draw command
+		#define u_modelMatrix u_drawTransforms[in_drawID].modelMatrix
+		#define u_normalMatrix u_drawTransforms[in_drawID].normalMatrix
+	#endif // VERTEX_SHADER
+#else // ! DRAW_INDIRECT
 layout (std140, binding = MODEL_DATA_BINDING_POINT) uniform ModelData
 {
 	mat4 u_modelMatrix;
@@ -42,6 +58,7 @@ layout (std140, binding = MODEL_DATA_BINDING_POINT) uniform ModelData
 	vec3 u_boundsMax;
 	float padding2_ModelData;
 };
+#endif
 layout (std140, binding = CAMERA_VARS_BINDING_POINT) uniform CameraVars
 {
 	mat4 u_vpMatrix;
@@ -60,7 +77,10 @@ layout (std140, binding = LIGHTING_GLOBALS_BINDING_POINT) uniform LightingGlobal
 	vec3 u_cubemapPos;
 	float padding3_LightingGlobals;
 	vec4 u_sunColorIntensity;
-	mat4 u_shadowMat;
+	mat4 u_shadowMats[MAX_SHADOW_CASCADES];
+	vec4 u_shadowCascadeSplits;
+	vec4 u_shadowAtlasRects[MAX_SHADOW_CASCADES];
+	int u_numShadowCascades;
 };
 struct MaterialProperty
 {
@@ -80,18 +100,17 @@ struct MaterialProperty
 	int padding1;
 	int padding2;
 };
-layout (std140, binding = MATERIAL_PROPERTIES_BINDING_POINT) uniform MaterialProperties
+#ifdef DRAW_INDIRECT
+layout (std430, binding = MATERIAL_PROPERTIES_SSBO_BINDING_POINT) readonly buffer MaterialProperties
 {
-	MaterialProperty u_materialProperties[MAX_MATERIALS];
+	MaterialProperty u_materialProperties[];
 };
-layout (std140, binding = LIGHT_POSITION_RANGES_BINDING_POINT) uniform LightPositionRanges
-{
-	vec4 u_lightPositionRanges[MAX_LIGHTS];
-};
-layout (std140, binding = LIGHT_COLOR_INTENSITIES_BINDING_POINT) uniform LightColorsIntensities
+#else
+layout (std140, binding = MATERIAL_PROPERTIES_BINDING_POINT) uniform MaterialProperties
 {
-	vec4 u_lightColorIntensities[MAX_LIGHTS];
+	MaterialProperty u_materialProperties[MAX_MATERIALS];
 };
+#endif
 layout (std140, binding = SETTINGS_GLOBALS_BINDING_POINT) uniform SettingsGlobals
 {
 	int u_hbaoEnabled;
@@ -108,6 +127,8 @@ layout (std140, binding = CLUSTERED_SHADING_GLOBALS_BINDING_POINT) uniform Clust
 
 	int u_gridHeight;
 	int u_gridDepth;
+
+	float u_invRenderScale; // The tiles are in pixels of the screen, the scene can be rendered at a lower resolution
 };
 layout (std140, binding = HBAO_GLOBALS_BINDING_POINT) uniform HBAOGlobals
 {
@@ -8,7 +8,7 @@ in vec2 v_texcoord;
 in vec3 v_normal;
 in vec4 v_tangent;
 flat in uint v_materialID;
-in vec4 v_shadowCoord;
+in vec3 v_wsPosition;
 
 layout (binding = DFV_TEXTURE_BINDING_POINT) uniform sampler2D u_dfvTexture;
 
@@ -102,20 +102,20 @@ void main()
 	vec3 V       = normalize(u_eyePos - v_position);
 	float NdotV  = clamp(dot(N, V), 0.0, 1.0);
 	
-	// Apply point lights
+	// Apply point and spot lights
 	vec3 lightAccum = vec3(0.0);
 	FOR_LIGHT_ITERATOR(light, v_position.z)
 	{
 		vec3 L = (light.positionRange.xyz - v_position);
 		float lightDistance = length(L);
 		L /= lightDistance;
-		float attenuation = inverseSquareFalloff(lightDistance, light.positionRange.w);
+		float attenuation = inverseSquareFalloff(lightDistance, light.positionRange.w) * getSpotAttenuation(light, L);
 		vec3 lightContrib = light.colorIntensity.rgb * light.colorIntensity.a * PI * attenuation;
 		lightAccum += doLight(lightContrib, L, N, V, NdotV, F0, diffuse, smoothness, metalness);
 	}
 	
 	// Apply sun + shadow
-	float visibility = (u_shadowsEnabled == 0) ? 1.0 : pcf(v_shadowCoord);
+	float visibility = (u_shadowsEnabled == 0) ? 1.0 : cascadedPCF(v_wsPosition, -v_position.z);
 	if (visibility > 0.0)
 	{
 		vec3 sunContrib = u_sunColorIntensity.rgb * u_sunColorIntensity.a * PI * visibility;
@@ -12,7 +12,7 @@ out vec3 v_normal;
 out vec4 v_tangent;
 flat out uint v_materialID;
 
-out vec4 v_shadowCoord;
+out vec3 v_wsPosition;
 
 void main()
 {
@@ -27,5 +27,5 @@ void main()
 	v_tangent    = vec4(normalize(normalMatrix * in_tangent.xyz), in_tangent.w);
 	v_materialID = in_materialID;
 
-	v_shadowCoord = u_shadowMat * pos;
+	v_wsPosition = pos.xyz;
 }
\ No newline at end of file
@@ -9,6 +9,13 @@ void GameObject::render(GLRenderer& a_renderer, bool a_depthOnly)
 	m_scene->render(a_renderer, m_transform, a_depthOnly);
 }
 
+void GameObject::addOccluders(OcclusionBuffer& a_occlusionBuffer, const PerspectiveCamera& a_camera)
+{
+	if (m_dirty)
+		updateTransform();
+	m_scene->addOccluders(a_occlusionBuffer, a_camera, m_transform);
+}
+
 void GameObject::setPosition(const glm::vec3 & a_position) 
 { 
 	m_position = a_position; 
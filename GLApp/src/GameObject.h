@@ -13,6 +13,7 @@ public:
 	void initialize(GLScene* a_scene) { m_scene = a_scene; }
 
 	virtual void render(GLRenderer& renderer, bool depthOnly) override;
+	virtual void addOccluders(OcclusionBuffer& occlusionBuffer, const PerspectiveCamera& camera) override;
 
 	void setPosition(const glm::vec3& a_position);
 	void setScale(float a_scale);
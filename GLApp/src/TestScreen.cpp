@@ -15,7 +15,15 @@
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <direct.h>
-TestScreen::TestScreen() : m_lightManager(GLConfig::getMaxLights())
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const float DB_REFRESH_INTERVAL_SEC = 0.5f;
+const char* const GPU_PASS_TIMINGS_FILE_PATH = "gpu-pass-timings.json";
+
+END_UNNAMED_NAMESPACE()
+
+TestScreen::TestScreen()
 {
 	char cCurrentPath[FILENAME_MAX];
 	_getcwd(cCurrentPath, sizeof(cCurrentPath));
@@ -32,6 +40,7 @@ TestScreen::TestScreen() : m_lightManager(GLConfig::getMaxLights())
 
 	if (m_objDB.openExisting("assets/OBJ-DB.da"))
 	{
+		m_objDB.startLoadTrace("assets/OBJ-DB.trace"); // Used by the resource builder to lay out the database in load order
 		m_sponzaScene.initialize("sponza.obj", m_objDB);
 		m_skysphereScene.initialize("skysphere.obj", m_objDB);
 		m_skysphereScene.setAsSkybox(true);
@@ -39,7 +48,7 @@ TestScreen::TestScreen() : m_lightManager(GLConfig::getMaxLights())
 		m_sunScene.setAsSkybox(true);
 
 		m_sponza.initialize(&m_sponzaScene);
-		m_renderer.addRenderObject(&m_sponza);
+		m_renderer.addRenderObject(&m_sponza, true);
 
 		m_skysphere.initialize(&m_skysphereScene);
 		m_renderer.addSkybox(&m_skysphere);
@@ -74,10 +83,24 @@ void TestScreen::render(float a_deltaSec)
 	}
 	m_sun.setPosition(m_camera.getPosition() + m_sunDir * 900.0f);
 
+	// Pick up assets rebuilt by a resource builder running with -daemon
+	m_dbRefreshTimeAccum += a_deltaSec;
+	if (m_dbRefreshTimeAccum > DB_REFRESH_INTERVAL_SEC)
+	{
+		m_dbRefreshTimeAccum = 0.0f;
+		reloadChangedScenes();
+	}
+
 	m_fpsMeasurer.tickFrame(a_deltaSec);
 	m_cameraController.update(m_camera, a_deltaSec, !m_guiManager.isFocused());
+	GLGPUProfiler& gpuProfiler = m_renderer.getGPUProfiler();
+	gpuProfiler.beginFrame();
 	m_renderer.render(m_camera, m_lightManager);
-	m_guiManager.render(a_deltaSec);
+	{
+		GLGPUProfiler::ScopedPass uiPass(gpuProfiler, "UI");
+		m_guiManager.render(a_deltaSec);
+	}
+	gpuProfiler.endFrame();
 
 	GLEngine::graphics->swap();
 }
@@ -88,6 +111,29 @@ void TestScreen::setSunDirection(glm::vec3 a_direction)
 	m_renderer.setSun(m_sunDir, glm::vec3(0.75f, 0.7f, 0.66f), 1.0f);
 }
 
+void TestScreen::reloadChangedScenes()
+{
+	if (!m_objDB.isOpen())
+		return;
+
+	const eastl::pair<const char*, GLScene*> scenes[] = {
+		{ "sponza.obj", &m_sponzaScene },
+		{ "skysphere.obj", &m_skysphereScene },
+		{ "sphere.obj", &m_sunScene } };
+	for (const eastl::string& assetName : m_objDB.refresh())
+	{
+		for (const auto& scene : scenes)
+		{
+			if (assetName == scene.first)
+			{
+				print("Reloading scene: %s\n", scene.first);
+				scene.second->initialize(assetName, m_objDB);
+				m_renderer.invalidateStaticShadows();
+			}
+		}
+	}
+}
+
 void TestScreen::initializeGUI()
 {
 	m_guiManager.initialize();
@@ -151,8 +197,13 @@ void TestScreen::initializeGUI()
 		T: Place point light\n\
 		Y: Delete all point lights\n\
 		U: Set sun direction\n\
+		Keypad 3: Switch HBAO between full, temporal and deinterleaved\n\
+		Keypad 4: Switch bloom between pyramid and gaussian blur\n\
 		Keypad 5: Reload GUI\n\
 		Keypad 6: Reload Shaders\n\
+		Keypad 7: Toggle occlusion culling\n\
+		Keypad 8: Toggle adaptive quality\n\
+		Keypad 9: Print and save GPU pass timings\n\
 		Keypad Plus: Increase camera speed\n\
 		Keypad Minus: Decrease camera speed\n\
 		Collapse this window by doubleclicking the bar";
@@ -179,8 +230,51 @@ void TestScreen::initializeInputListeners()
 		switch (a_key)
 		{
 		case EKey::ESCAPE:   GLEngine::shutdown(); break;
+		case EKey::KP_3:
+		{
+			// Full, temporal, temporal deinterleaved, deinterleaved
+			HBAO& hbao = m_renderer.getHBAO();
+			const bool wasTemporal = hbao.isTemporalEnabled();
+			hbao.setTemporalEnabled(!hbao.isDeinterleaved());
+			hbao.setDeinterleaved(wasTemporal);
+			print("HBAO %s%s, %u samples per pixel per frame\n", hbao.isTemporalEnabled() ? "temporal" : "full",
+				hbao.isDeinterleaved() ? " deinterleaved" : "", hbao.getNumSamplesPerFrame());
+			break;
+		}
+		case EKey::KP_4:
+		{
+			Bloom& bloom = m_renderer.getBloom();
+			bloom.setMethod(bloom.getMethod() == Bloom::EMethod::PYRAMID ? Bloom::EMethod::GAUSSIAN : Bloom::EMethod::PYRAMID);
+			print("Bloom %s\n", bloom.getMethod() == Bloom::EMethod::PYRAMID ? "pyramid" : "gaussian blur");
+			break;
+		}
 		case EKey::KP_5:     initializeGUI(); break;
 		case EKey::KP_6:     m_renderer.reloadShaders(); break;
+		case EKey::KP_7:
+		{
+			const OcclusionBuffer::Stats& stats = m_renderer.getOcclusionStats();
+			print("Occlusion culling: %u occluders, %u triangles, %u of %u tested meshes culled last frame\n", stats.numOccluders, stats.numTriangles, stats.numOccluded, stats.numTested);
+			m_renderer.setOcclusionCullingEnabled(!m_renderer.isOcclusionCullingEnabled());
+			print("Occlusion culling %s\n", m_renderer.isOcclusionCullingEnabled() ? "enabled" : "disabled");
+			break;
+		}
+		case EKey::KP_8:
+		{
+			const QualityGovernor& governor = m_renderer.getQualityGovernor();
+			print("Adaptive quality: level %u of %u, render scale %.2f, GPU %.2f ms, CPU %.2f ms\n", governor.getLevel(), governor.getNumLevels(),
+				m_renderer.getRenderScale(), governor.getAverageGPUMs(), governor.getAverageCPUMs());
+			m_renderer.setQualityGovernorEnabled(!m_renderer.isQualityGovernorEnabled());
+			print("Adaptive quality %s\n", m_renderer.isQualityGovernorEnabled() ? "enabled" : "disabled");
+			break;
+		}
+		case EKey::KP_9:
+		{
+			const PassTimings& timings = m_renderer.getGPUProfiler().getTimings();
+			timings.printSummary();
+			if (timings.writeReport(GPU_PASS_TIMINGS_FILE_PATH))
+				print("GPU pass timings written to %s\n", GPU_PASS_TIMINGS_FILE_PATH);
+			break;
+		}
 		case EKey::KP_PLUS:  m_cameraController.setCameraSpeed(m_cameraController.getCameraSpeed() * 1.2f); break;
 		case EKey::KP_MINUS: m_cameraController.setCameraSpeed(m_cameraController.getCameraSpeed() * 0.8f); break;
 		case EKey::Y:        m_lightManager.deleteLights(); break;
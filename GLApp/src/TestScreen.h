@@ -33,6 +33,7 @@ private:
 	void initializeGUI();
 	void addWindow(CEGUI::Window* window);
 	void setSunDirection(glm::vec3 direction);
+	void reloadChangedScenes();
 	void checkboxSelectionChanged(const CEGUI::EventArgs& e);
 
 private:
@@ -53,5 +54,6 @@ private:
 	Input::WindowQuitListener m_windowQuitListener;
 
 	float m_timeAccum = 0.0f;
+	float m_dbRefreshTimeAccum = 0.0f;
 	glm::vec3 m_sunDir;
 };
\ No newline at end of file
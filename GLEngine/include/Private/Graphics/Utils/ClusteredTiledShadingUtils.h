@@ -52,6 +52,8 @@ public:
 	static IBounds2D sphereToScreenSpaceBounds2D(const PerspectiveCamera& camera, const glm::vec3& lightPosWorldSpace, float lightRadius, uint screenWidth, uint screenHeight);
 	static IBounds3D sphereToScreenSpaceBounds3D(const PerspectiveCamera& camera, const glm::vec3& lightPosViewSpace, float lightRadius, uint screenWidth, uint screenHeight, 
 	    										 uint pixelsPerTileW, uint pixelsPerTileH, float recLogSD1);
+	/** First and one past the last depth slice the sphere touches, the z part of sphereToScreenSpaceBounds3D */
+	static glm::ivec2 sphereToDepthSliceBounds(const PerspectiveCamera& camera, float lightPosViewSpaceZ, float lightRadius, float recLogSD1);
 private:
 	ClusteredTiledShadingUtils() {}
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Core.h"
 #include "Database/AssetDatabaseEntry.h"
 #include "Database/Assets/EAssetType.h"
+#include "Database/Utils/PerfectHash.h"
 #include "Utils/FileUtils.h"
 #include "EASTL/hash_map.h"
 #include "EASTL/vector.h"
@@ -12,33 +13,52 @@
 
 class IAsset;
 
+/** 64 bit hash of the database entry name, resolve once with AssetDatabase::getAssetID and keep it around */
+typedef uint64 AssetID;
+
 class AssetDatabase
 {
 public:
 	AssetDatabase() {}
 	~AssetDatabase() {}
 
+	static AssetID getAssetID(const eastl::string& databaseEntryName);
+
 	/* Create an empty asset database with the specified name/path to which assets can be added and written */
 	void createNew(const eastl::string& filePath);
 	/* Open an existing asset database file with the specified name/path, returns if succeeded, cannot write new assets */
 	bool openExisting(const eastl::string& filePath);
-	/* Add an asset to the database under the specified name, transfering ownership */
+	/* Open an existing asset database to add or replace assets in place, changes become visible to readers with commitUpdate */
+	bool openForUpdate(const eastl::string& filePath);
+	/* Add an asset to the database under the specified name, transfering ownership. When updating, an existing asset with the name is replaced */
 	void addAsset(const eastl::string& databaseEntryName, owner<IAsset*> asset);
 	/* Write away currently loaded assets to so the memory can be freed */
 	void writeLoadedAssets();
-	/* Write assets and index table and close the file */
+	/* Write assets and index table and close the file, the file only replaces an existing database once it is completely on disk */
 	void writeAndClose();
+	/* Append the added assets and a new index table, then point the file header at it. Replaced assets are left behind as dead space until the next full build */
+	void commitUpdate();
+	/* Reload the index table if the file was updated since it was read, returns the names of the new and changed assets.
+	   Cached assets that did not change are kept, stale ones are unloaded */
+	eastl::vector<eastl::string> refresh();
+	/* Lay out assets in the order they are listed in a load trace file, unlisted assets go after them. Returns if the trace could be read */
+	bool setWriteOrderFromTrace(const eastl::string& traceFilePath);
+	/* Record the names of assets in the order they are loaded from disk, one per line, to be used by setWriteOrderFromTrace */
+	void startLoadTrace(const eastl::string& traceFilePath);
 
 	//TODO: add some form of reference counter to unload assets?
 
 	/* Load an asset with the specified name and type, the result is cached */
 	IAsset* loadAsset(const eastl::string& databaseEntryName, EAssetType type);
+	/* Load an asset by id through the perfect hash table of the database, no string hashing or allocation */
+	IAsset* loadAsset(AssetID id, EAssetType type);
 	/* Unload a loaded/cached asset with the specified name to free it's memory */
 	void unloadAsset(const eastl::string& databaseEntryName);
 	/* Unload a loaded/cached asset to free it's memory */
 	void unloadAsset(IAsset* asset);
 
 	bool hasAsset(const eastl::string& databaseEntryName) const;
+	bool hasAsset(AssetID id) const;
 	bool isOpen() const { return m_openMode != EOpenMode::UNOPENED; }
 	eastl::vector<eastl::string> listAssets() const;
 
@@ -48,14 +68,55 @@ private:
 	{
 		READ,
 		WRITE,
+		UPDATE,
 		UNOPENED
 	};
 
+	/** At the start of the file, written at once. The checksum lets readers tell a header that is being overwritten from a valid one */
+	struct Header
+	{
+		uint64 assetTablePos      = 0;
+		uint64 assetTableByteSize = 0;
+		uint64 checksum           = 0;
+	};
+
+	struct IDTableSlot
+	{
+		AssetID id      = 0;
+		uint64 filePos  = 0;
+		uint64 byteSize = 0;
+	};
+
+private:
+
+	/** Returns false if the header could not be read or its checksum does not match */
+	bool readHeader(uint64& assetTablePos, uint64& assetTableByteSize);
+	void writeHeader();
+	/** Returns false and leaves the tables that are open untouched if the header or the table it points at is not valid */
+	bool readAssetTable();
+	/** Appends the table after the assets, the header points at it once writeHeader is called */
+	void writeAssetTable();
+	void appendToFile(const byte* data, uint64 size);
+	void flushWriteBuffer();
+	void buildIDTable();
+	/** Returns the slot of the asset in the id table or -1 */
+	int findIDTableSlot(AssetID id) const;
+
 private:
 
 	EOpenMode m_openMode = EOpenMode::UNOPENED;
+	eastl::string m_filePath;
 	std::fstream m_file;
 	uint64 m_assetWritePos = 0;
+	uint64 m_assetTablePos = 0;
+	uint64 m_assetTableByteSize = 0;
+	eastl::vector<byte> m_writeBuffer;
+	eastl::hash_map<eastl::string, uint> m_writeOrder;
+	std::ofstream m_loadTraceFile;
 	eastl::hash_map<eastl::string, owner<IAsset*>> m_loadedAssets;
 	eastl::hash_map<eastl::string, AssetDatabaseEntry> m_writtenAssets;
+	PerfectHash m_idHash;
+	eastl::vector<IDTableSlot> m_idTable;
+	eastl::vector<owner<IAsset*>> m_idTableAssets;        // Assets loaded by id, per slot
+	eastl::vector<const eastl::string*> m_idTableNames; // Keys of m_writtenAssets, per slot
 };
\ No newline at end of file
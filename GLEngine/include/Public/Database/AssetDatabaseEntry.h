@@ -5,13 +5,18 @@
 #include "EASTL/string.h"
 #include <assert.h>
 #include <fstream>
+#include <string.h>
 
 #include "gsl/gsl.h"
 class AssetDatabaseEntry
 {
 public:
 	AssetDatabaseEntry::AssetDatabaseEntry(std::fstream& a_file, uint64 a_filePos, uint64 a_size)
-		: m_file(a_file), m_totalSize(a_size), m_filePos(a_filePos)
+		: m_file(&a_file), m_totalSize(a_size), m_filePos(a_filePos)
+	{}
+	/** Writes into the memory of the buffer instead of a file, the buffer must already have the final size */
+	AssetDatabaseEntry(eastl::vector<byte>& a_buffer)
+		: m_buffer(a_buffer.data()), m_totalSize(a_buffer.size())
 	{}
 	
 	uint64 getTotalSize() const    { return m_totalSize; }
@@ -25,12 +30,10 @@ public:
 	template <typename T>
 	void writeVal(const T& a_val)
 	{
-		m_file.seekp(m_filePos + m_numBytesWritten);
 		uint size = sizeof(T);
 		if (m_numBytesWritten + size <= m_totalSize)
 		{
-			m_file.write(rcast<const char*>(&a_val), size);
-			m_numBytesWritten += size;
+			writeBytes(&a_val, size);
 		}
 		else
 		{
@@ -48,8 +51,7 @@ public:
 		{
 			if (m_numBytesWritten + size <= m_totalSize)
 			{
-				m_file.write(rcast<const char*>(a_span.data()), size);
-				m_numBytesWritten += size;
+				writeBytes(a_span.data(), size);
 			}
 			else
 			{
@@ -69,8 +71,7 @@ public:
 			uint64 byteSize = a_vector.size_bytes();
 			if (m_numBytesWritten + byteSize <= m_totalSize)
 			{
-				m_file.write(rcast<const char*>(&a_vector[0]), byteSize);
-				m_numBytesWritten += byteSize;
+				writeBytes(&a_vector[0], byteSize);
 			}
 			else
 			{
@@ -88,8 +89,7 @@ public:
 		{
 			if (m_numBytesWritten + strlen <= m_totalSize)
 			{
-				m_file.write(a_str.c_str(), strlen);
-				m_numBytesWritten += strlen;
+				writeBytes(a_str.c_str(), strlen);
 			}
 			else
 			{
@@ -126,11 +126,11 @@ public:
 	template <typename T>
 	void readVal(T& a_val)
 	{
-		m_file.seekg(m_filePos + m_numBytesRead);
+		m_file->seekg(m_filePos + m_numBytesRead);
 		const uint size = sizeof(T);
 		if (m_numBytesRead + size <= m_totalSize)
 		{
-			m_file.read(rcast<char*>(&a_val), size);
+			m_file->read(rcast<char*>(&a_val), size);
 			m_numBytesRead += size;
 		}
 	}
@@ -144,7 +144,7 @@ public:
 		const uint size = sizeof(T) * length;
 		if (m_numBytesRead + size <= m_totalSize && size)
 		{
-			m_file.read(rcast<char*>(data), size);
+			m_file->read(rcast<char*>(data), size);
 			m_numBytesRead += size;
 		}
 		return as_span(data, length);;
@@ -159,7 +159,7 @@ public:
 		const uint size = sizeof(T) * length;
 		if (m_numBytesRead + size <= m_totalSize && length)
 		{
-			m_file.read(rcast<char*>(&a_vec[0]), size);
+			m_file->read(rcast<char*>(&a_vec[0]), size);
 			m_numBytesRead += size;
 		}
 	}
@@ -171,7 +171,7 @@ public:
 		owner<char*> buffer = new char[length];
 		if (m_numBytesRead + length <= m_totalSize && length)
 		{
-			m_file.read(rcast<char*>(buffer), length);
+			m_file->read(rcast<char*>(buffer), length);
 			a_str.assign(buffer, length);
 			m_numBytesRead += length;
 		}
@@ -180,7 +180,24 @@ public:
 
 private:
 
-	std::fstream& m_file;
+	void writeBytes(const void* a_data, uint64 a_size)
+	{
+		if (m_buffer)
+		{
+			memcpy(m_buffer + m_numBytesWritten, a_data, a_size);
+		}
+		else
+		{
+			m_file->seekp(m_filePos + m_numBytesWritten);
+			m_file->write(rcast<const char*>(a_data), a_size);
+		}
+		m_numBytesWritten += a_size;
+	}
+
+private:
+
+	std::fstream* m_file     = NULL;
+	byte* m_buffer           = NULL;
 	uint64 m_filePos         = 0;
 	uint64 m_numBytesWritten = 0;
 	uint64 m_totalSize       = 0;
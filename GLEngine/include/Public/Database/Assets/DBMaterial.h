@@ -17,6 +17,7 @@ public:
 
 	DBMaterial() {}
 	DBMaterial(const aiMaterial& assimpMaterial);
+	DBMaterial(const eastl::string& name) : m_name(name) {}
 	virtual ~DBMaterial() {}
 
 	virtual uint64 getByteSize() const override;
@@ -24,11 +25,12 @@ public:
 	virtual void write(AssetDatabaseEntry& entry) override;
 	virtual void read(AssetDatabaseEntry& entry) override;
 
-	void setRegion(ETexTypes type, const DBAtlasRegion& region) { m_atlasRegions[type] = region; }
-	const DBAtlasRegion& getRegion(ETexTypes type) const        { return m_atlasRegions[type]; }
-	const eastl::string& getTexturePath(ETexTypes type) const   { return m_atlasRegions[type].m_filePath; }
-	bool hasTexture(ETexTypes type) const                       { return !m_atlasRegions[type].m_filePath.empty(); }
-	const eastl::string& getName() const                        { return m_name; }
+	void setRegion(ETexTypes type, const DBAtlasRegion& region)    { m_atlasRegions[type] = region; }
+	void setTexturePath(ETexTypes type, const eastl::string& path) { m_atlasRegions[type].m_filePath = path; }
+	const DBAtlasRegion& getRegion(ETexTypes type) const           { return m_atlasRegions[type]; }
+	const eastl::string& getTexturePath(ETexTypes type) const      { return m_atlasRegions[type].m_filePath; }
+	bool hasTexture(ETexTypes type) const                          { return !m_atlasRegions[type].m_filePath.empty(); }
+	const eastl::string& getName() const                           { return m_name; }
 
 private:
 
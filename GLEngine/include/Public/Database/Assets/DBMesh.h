@@ -27,6 +27,7 @@ public:
 
 	DBMesh() {}
 	DBMesh(const aiMesh& assimpMesh);
+	DBMesh(const eastl::string& name, eastl::vector<Vertex>&& vertices, eastl::vector<uint>&& indices);
 	virtual ~DBMesh() {}
 
 	void merge(const DBMesh& mesh, const glm::mat4& transform);
@@ -16,6 +16,7 @@ public:
 
 	DBNode() {}
 	DBNode(const aiNode& assimpNode, uint parentIdx);
+	DBNode(const eastl::string& name, uint parentIdx) : m_name(name), m_transform(1.0f), m_parentIdx(parentIdx) {}
 	virtual ~DBNode() {}
 
 	void addChild(uint childIdx);
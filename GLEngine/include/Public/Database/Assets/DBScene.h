@@ -23,10 +23,22 @@ class DBScene : public IAsset
 {
 public:
 
+	enum class EImporter
+	{
+		AUTO,   // Fast path for .obj files, assimp for everything else or if the fast path fails
+		ASSIMP,
+		OBJ
+	};
+
 	DBScene() {}
-	DBScene(const eastl::string& sceneFilePath);
+	DBScene(const eastl::string& sceneFilePath, EImporter importer = EImporter::AUTO);
 	virtual ~DBScene() {}
 
+	/** Imports the scene and builds its texture atlases, returns false if the import failed */
+	bool build(const eastl::string& sceneFilePath, EImporter importer = EImporter::AUTO);
+	/** Imports nodes, meshes and materials without building the texture atlases, returns false if the import failed */
+	bool importScene(const eastl::string& sceneFilePath, EImporter importer);
+
 	/** Collapse the entire scene into one node with one mesh, removes culling but greatly speeds up rendering */
 	void mergeMeshes();
 
@@ -47,6 +59,7 @@ public:
 private:
 
 	void mergeMeshes(DBMesh& mergedMesh, DBNode& node, const glm::mat4& parentTransform);
+	bool importAssimp(const eastl::string& sceneFilePath);
 
 private:
 
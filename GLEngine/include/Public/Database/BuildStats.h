@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Core.h"
+#include "Database/Assets/EAssetType.h"
+#include "EASTL/string.h"
+
+#include <chrono>
+
+/** Collects timings, sizes and counts while building an asset database and writes them out as a report.
+    Everything is a no-op unless a build is active, so the hooks can stay in code that also runs in the game. */
+class BuildStats
+{
+public:
+
+	enum class EStage
+	{
+		IMPORT,
+		MERGE,
+		ATLAS_PACK,
+		COMPOSITE,
+		ENCODE,
+		WRITE,
+		COUNT
+	};
+
+	/** Adds the time spent in the enclosing scope to a stage of the current asset */
+	class ScopedStageTimer
+	{
+	public:
+		ScopedStageTimer(EStage stage);
+		~ScopedStageTimer();
+	private:
+		EStage m_stage;
+		std::chrono::high_resolution_clock::time_point m_startTime;
+	};
+
+	/** Attributes everything recorded on this thread within the scope to the given asset */
+	class ScopedAsset
+	{
+	public:
+		ScopedAsset(const eastl::string& assetName);
+		~ScopedAsset();
+	private:
+		eastl::string m_assetName;
+		const eastl::string* m_prevAssetName;
+	};
+
+public:
+
+	static void beginBuild();
+	/** Writes the JSON report to the given path and prints a text summary */
+	static void endBuild(const eastl::string& reportFilePath);
+	static bool isActive();
+
+	static void addMeshCounts(uint numMeshes, uint64 numVertices, uint64 numIndices);
+	static void addAtlasPage(const char* texType, uint pageIdx, uint width, uint height, uint numRegions, uint64 usedPixels);
+	/** Size of a complete database entry */
+	static void addAssetOutput(EAssetType type, uint64 byteSize);
+	/** Size of an asset nested in a database entry, used for the per type breakdown */
+	static void addOutputSize(EAssetType type, uint64 byteSize);
+
+private:
+	BuildStats() {}
+};
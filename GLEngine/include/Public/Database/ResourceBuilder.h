@@ -13,8 +13,15 @@ public:
 
 	typedef eastl::hash_map<eastl::string, ResourceProcessor*> ResourceProcessorMap;
 	static void buildResourcesDB(const ResourceProcessorMap& processors, const eastl::string& inDirectoryPath, AssetDatabase& assetDatabase);
+	/** Stays resident with the processors and the database opened for update, rebuilds the resources affected by file changes in the directory
+	    and commits them after every batch so running games and editors can pick them up with AssetDatabase::refresh. Only returns if watching fails. */
+	static void watchResourcesDB(const ResourceProcessorMap& processors, const eastl::string& inDirectoryPath, AssetDatabase& assetDatabase);
 	static void copyFiles(const eastl::vector<eastl::string>& extensions, const eastl::string& inDirectoryPath, const eastl::string& outDirectoryPath);
 
+private:
+
+	static bool buildResource(ResourceProcessor& processor, const eastl::string& filePath, AssetDatabase& assetDatabase);
+
 private:
 
 	ResourceBuilder() {};
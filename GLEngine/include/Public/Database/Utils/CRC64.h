@@ -7,6 +7,7 @@ class CRC64
 public:
 
 	static uint64 getHash(const char* str);
+	static uint64 getHash(const byte* data, uint64 size);
 
 private:
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+#include "EASTL/string.h"
+
+class DBMaterial;
+class DBMesh;
+class DBNode;
+
+/** Fast path for Wavefront .obj/.mtl files, parses the file in parallel chunks and builds the database assets directly.
+    Output matches the assimp import: triangulated, flipped uv's, generated normals/tangents and joined identical vertices. */
+class ObjImporter
+{
+public:
+	/** Returns false if the file could not be read or contains something we do not handle, the caller should fall back to assimp */
+	static bool importScene(const eastl::string& filePath, eastl::vector<DBNode>& nodes, eastl::vector<DBMesh>& meshes, eastl::vector<DBMaterial>& materials);
+
+private:
+	ObjImporter() {}
+};
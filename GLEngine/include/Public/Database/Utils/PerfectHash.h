@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+/** Minimal perfect hash over a fixed set of 64 bit keys (hash and displace).
+    Maps every key of the set to its own slot in [0, numKeys), built once by the resource builder and stored in the database. */
+class PerfectHash
+{
+public:
+
+	/** Returns false if no displacement could be found, which only happens with duplicate keys */
+	bool build(const eastl::vector<uint64>& keys);
+	void initialize(const eastl::vector<uint>& seeds, uint numSlots);
+
+	/** Keys that are not in the set map to an arbitrary slot, so the caller has to verify the key stored there */
+	uint getSlot(uint64 a_key) const
+	{
+		const uint bucket = uint(hash(a_key, BUCKET_SEED) % m_seeds.size());
+		return uint(hash(a_key, m_seeds[bucket]) % m_numSlots);
+	}
+
+	uint getNumSlots() const                    { return m_numSlots; }
+	const eastl::vector<uint>& getSeeds() const { return m_seeds; }
+	bool isEmpty() const                        { return m_numSlots == 0; }
+
+private:
+
+	enum : uint { BUCKET_SEED = 0xFFFFFFFF };
+
+	static uint64 hash(uint64 a_key, uint a_seed)
+	{	// splitmix64 finalizer
+		uint64 x = a_key + (uint64(a_seed) + 1) * 0x9E3779B97F4A7C15ull;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		return x ^ (x >> 31);
+	}
+
+private:
+
+	eastl::vector<uint> m_seeds; // Displacement seed per bucket
+	uint m_numSlots = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Core.h"
+
+/** Shadow copy of the GL state the engine changes, calls that would not change anything are skipped.
+    All state changes and binds of the engine should go through here, code that changes GL state behind its back
+    (like the GUI renderer) has to call invalidate() afterwards. GLenum values are passed as uint to keep GL.h out of this header.
+    With validation enabled every skipped call and the whole cache at the end of a frame are checked against glGet. */
+class GLStateCache
+{
+public:
+
+	struct Stats
+	{
+		uint numIssued  = 0;
+		uint numSkipped = 0;
+	};
+
+public:
+
+	/** Forgets everything, the next call for every state is issued. Call after a context is created or after third party rendering */
+	static void invalidate();
+	/** Validates the cache if enabled and starts counting the calls of the next frame */
+	static void endFrame();
+	static void setValidationEnabled(bool enabled) { s_validationEnabled = enabled; }
+	/** Checks the whole cache against the GL state, returns false and prints the differences if there are any */
+	static bool validate();
+
+	/** GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_MULTISAMPLE or GL_SCISSOR_TEST */
+	static void setCapability(uint capability, bool enabled);
+	static void setDepthMask(bool enabled);
+	static void setColorMask(bool enabled);
+	static void setDepthFunc(uint func);
+	static void setCullFace(uint face);
+	static void setBlendFunc(uint srcFactor, uint dstFactor);
+	static void setViewport(int x, int y, uint width, uint height);
+
+	static void useProgram(uint program);
+	/** Binds as both the draw and the read framebuffer */
+	static void bindFramebuffer(uint framebuffer);
+	/** Separate read and draw framebuffers, for blits */
+	static void bindFramebuffers(uint readFramebuffer, uint drawFramebuffer);
+	static void bindVertexArray(uint vertexArray);
+	/** Binds to the given unit, making it the active one */
+	static void bindTexture(uint unit, uint target, uint texture);
+	/** Binds to the active unit, for creating and updating textures */
+	static void bindTexture(uint target, uint texture);
+	/** GL_ELEMENT_ARRAY_BUFFER is part of the vertex array state and always issued */
+	static void bindBuffer(uint target, uint buffer);
+	/** Also binds the generic binding point of the target, like GL does */
+	static void bindBufferBase(uint target, uint index, uint buffer);
+	static void bindBufferRange(uint target, uint index, uint buffer, uint offset, uint numBytes);
+
+	/** Deleting an object unbinds it, the cache has to forget it too since its name can be reused */
+	static void onTextureDeleted(uint texture);
+	static void onBufferDeleted(uint buffer);
+	static void onProgramDeleted(uint program);
+	static void onFramebufferDeleted(uint framebuffer);
+	static void onVertexArrayDeleted(uint vertexArray);
+
+	static const Stats& getLastFrameStats() { return s_lastFrameStats; }
+	static const Stats& getFrameStats()     { return s_frameStats; }
+	static bool isValidationEnabled()       { return s_validationEnabled; }
+
+private:
+
+	static Stats s_frameStats;
+	static Stats s_lastFrameStats;
+	static bool s_validationEnabled;
+};
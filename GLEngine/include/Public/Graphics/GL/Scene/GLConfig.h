@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Graphics/GL/Wrappers/GLConstantBuffer.h"
+#include "Graphics/GL/Wrappers/GLShaderStorageBuffer.h"
 #include "Graphics/GL/Wrappers/GLVertexBuffer.h"
 #include "Graphics/GL/Wrappers/GLTexture.h"
 #include "EASTL/string.h"
@@ -28,6 +29,8 @@ public:
 		Blur,
 		HBAOResult,
 		BloomResult,
+		HBAOHistory,
+		HBAOHistoryDepth,
 		NUM_BINDING_POINTS
 	};
 	enum class EUBOs 
@@ -36,17 +39,25 @@ public:
 		CameraVars,
 		LightingGlobals,
 		MaterialProperties,
-		ClusteredLightPositionRange,
-		ClusteredLightColorIntensities,
 		ClusteredGlobals,
 		HBAOGlobals,
 		SettingsGlobals,
 		NUM_UBOS
 	};
+	enum class ESSBOs
+	{
+		MaterialProperties,
+		DrawTransforms,
+		LightPositionRanges,
+		LightColorIntensities,
+		LightDirectionAngles,
+		NUM_SSBOS
+	};
 	enum class EVBOs 
 	{
 		GLMeshVertex,
 		GLMeshIndice,
+		GLMeshDrawID,
 		NUM_VBOS
 	};
 
@@ -54,30 +65,41 @@ public:
 
 	static void initialize();
 	static const eastl::vector<eastl::string>& getGlobalShaderDefines();
+	/** Global defines and extensions plus the ones of the shaders drawing GLScenes */
+	static const eastl::vector<eastl::string>& getSceneShaderDefines();
+	static const eastl::vector<eastl::string>& getSceneShaderExtensions();
 	/** Reinitializes all the shader definitions, shaders should be reloaded */
 	static void setMultisampleType(GLTexture::EMultiSampleType multisampleType);
 
 	static uint getTextureBindingPoint(ETextures bindingPoint);
 	static GLConstantBuffer::Config getUBOConfig(EUBOs ubo);
+	static uint getUBOBindingPoint(EUBOs ubo);
+	static GLShaderStorageBuffer::Config getSSBOConfig(ESSBOs ssbo);
+	static uint getSSBOBindingPoint(ESSBOs ssbo);
 	static GLVertexBuffer::Config getVBOConfig(EVBOs vbo);
-	static uint getMaxLights();
 	static uint getMaxMaterials();
 	static GLTexture::EMultiSampleType getMultisampleType();
 	static void setupFramebufferTextures();
 	static uint getHBAOResolutionScale();
+	/** Size of the atlas holding all shadow cascades */
 	static glm::ivec2 getSunShadowMapRes();
+	static uint getNumShadowCascades();
+	static uint getShadowCascadeResolution();
+	/** Creates the shadow atlas textures again, framebuffers holding them have to attach them again */
+	static void setShadowCascadeResolution(uint resolution);
+	static float getShadowCascadeSplitLambda();
+	/** GPU memory for the mip levels of scene textures, 0 uploads every level at load instead of streaming */
+	static uint getTextureStreamingBudgetMB();
+	/** Scenes submit their visible meshes with one multi draw indirect per bucket instead of a draw per mesh */
+	static bool isDrawIndirectEnabled();
 
 public:
 
+	/** The targets kept across frames, the ones of a single frame are transients of the GLRenderGraph of the renderer */
 	struct RenderTargets
 	{
-		GLTexture sceneColor;
-		GLTexture sceneDepth;
 		GLTexture sunShadow;
-		GLTexture bloom;
-		GLTexture hbao;
-		GLTexture downsampleDepth;
-		GLTexture fxaa;
+		GLTexture sunShadowStatic; // Cached depth of the static casters, copied into sunShadow
 	};
 
 	static RenderTargets rt;
@@ -89,16 +111,22 @@ private:
 private:
 
 	static eastl::vector<eastl::string> defines;
+	static eastl::vector<eastl::string> sceneDefines;
+	static eastl::vector<eastl::string> sceneExtensions;
 
 	static uint textureBindingPoints[uint(ETextures::NUM_BINDING_POINTS)];
 	static GLConstantBuffer::Config uboConfigs[uint(EUBOs::NUM_UBOS)];
+	static GLShaderStorageBuffer::Config ssboConfigs[uint(ESSBOs::NUM_SSBOS)];
 	static GLVertexBuffer::Config vboConfigs[uint(EVBOs::NUM_VBOS)];
 
 	static uint maxMaterials;
-	static uint maxLights;
 	static GLTexture::EMultiSampleType multisampleType;
 	static uint hbaoResolutionScale;
-	static glm::ivec2 sunShadowMapResolution;
+	static uint numShadowCascades;
+	static uint shadowCascadeResolution;
+	static float shadowCascadeSplitLambda;
+	static uint textureStreamingBudgetMB;
+	static bool drawIndirectEnabled;
 
 private:
 
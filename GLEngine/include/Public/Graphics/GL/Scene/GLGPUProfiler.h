@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Graphics/Utils/PassTimings.h"
+#include "EASTL/vector.h"
+
+/** Measures the GPU time of the passes of a frame with a timestamp query before and after every pass. The queries of a frame are read
+    a few frames later once the GPU wrote them, so the CPU never waits for the GPU. A frame is not measured while the queries of all
+    frames in flight are still unread. Passes can nest, passes with the same name in a frame add up. Passes outside of beginFrame and
+    endFrame or while disabled are not measured. */
+class GLGPUProfiler
+{
+public:
+
+	/** Measures the enclosing scope */
+	class ScopedPass
+	{
+	public:
+		ScopedPass(GLGPUProfiler& a_profiler, const char* a_name) : m_profiler(a_profiler) { m_profiler.beginPass(a_name); }
+		~ScopedPass()                                                                       { m_profiler.endPass(); }
+	private:
+		GLGPUProfiler& m_profiler;
+	};
+
+public:
+
+	GLGPUProfiler() {}
+	~GLGPUProfiler();
+	GLGPUProfiler(const GLGPUProfiler& copy) = delete;
+
+	void initialize(uint numFramesInFlight = 4, uint numSamples = 256);
+	/** Reads the frames the GPU finished and measures the whole frame as the pass "Frame" */
+	void beginFrame();
+	void endFrame();
+	void beginPass(const char* name);
+	void endPass();
+
+	void setEnabled(bool a_enabled)          { m_enabled = a_enabled; }
+	bool isEnabled() const                   { return m_enabled; }
+	/** Of the frames read so far, for the statistics and the report */
+	const PassTimings& getTimings() const    { return m_timings; }
+	void clearTimings()                      { m_timings.clearSamples(); }
+
+private:
+
+	struct Frame
+	{
+		eastl::vector<uint> queries;     // Timestamp before and after every measured pass
+		eastl::vector<uint> passIndices; // In the timings of every measured pass
+		uint numPasses;
+		bool isPending;                  // Written to the GPU and not read yet
+	};
+
+private:
+
+	void readFinishedFrames();
+
+private:
+
+	bool m_initialized = false;
+	bool m_enabled     = true;
+	bool m_isMeasuring = false; // Between beginFrame and endFrame of a frame that is measured
+	uint m_currentFrame = 0;
+	eastl::vector<Frame> m_frames;
+	eastl::vector<uint> m_openPasses; // Stack of the measured passes that did not end yet
+	eastl::vector<float> m_frameMs;   // Scratch, time of every pass of a read frame
+	PassTimings m_timings;
+	uint m_framePassIdx = 0;
+};
@@ -3,6 +3,7 @@
 #include "Core.h"
 #include "Graphics/GL/Wrappers/GLStateBuffer.h"
 #include "Graphics/GL/Wrappers/GLVertexBuffer.h"
+#include "EASTL/vector.h"
 
 #include <glm/glm.hpp>
 
@@ -12,16 +13,34 @@ class GLVertexBuffer;
 
 class GLMesh
 {
+public:
+
+	struct MaterialUsage
+	{
+		uint materialID;
+		float uvPerUnit; // Average texture coordinate units per object space unit
+	};
+
 public:
 	GLMesh() {}
 	GLMesh(const GLMesh& copy);
 	~GLMesh() {};
 
 	void initialize(const DBMesh& mesh);
+	/** Does not create buffers, the mesh is drawn from geometry shared with the other meshes of its scene at the given offsets */
+	void initializeShared(const DBMesh& mesh, uint firstIndex, uint baseVertex);
 	void render();
 
-	const glm::vec3& getBoundsMin() const { return m_boundsMin; }
-	const glm::vec3& getBoundsMax() const { return m_boundsMax; }
+	uint getNumIndices() const                                    { return m_numIndices; }
+	uint getFirstIndex() const                                    { return m_firstIndex; }
+	uint getBaseVertex() const                                    { return m_baseVertex; }
+	const glm::vec3& getBoundsMin() const                         { return m_boundsMin; }
+	const glm::vec3& getBoundsMax() const                         { return m_boundsMax; }
+	const eastl::vector<MaterialUsage>& getMaterialUsages() const { return m_materialUsages; }
+
+private:
+
+	void calculateMaterialUsages(const DBMesh& mesh);
 
 private:
 
@@ -29,6 +48,9 @@ private:
 	GLVertexBuffer m_indiceBuffer;
 	GLVertexBuffer m_vertexBuffer;
 	uint m_numIndices     = 0;
+	uint m_firstIndex     = 0;
+	uint m_baseVertex     = 0;
 	glm::vec3 m_boundsMin = glm::vec3(FLT_MAX);
 	glm::vec3 m_boundsMax = glm::vec3(FLT_MIN);
+	eastl::vector<MaterialUsage> m_materialUsages; // Used to estimate the texture resolution needed on screen
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Graphics/GL/Wrappers/GLFramebuffer.h"
+#include "Graphics/GL/Wrappers/GLTexture.h"
+#include "Graphics/Utils/RenderGraph.h"
+#include "EASTL/vector.h"
+
+class GLGPUProfiler;
+
+/** Runs a RenderGraph with GL. The physical targets the graph asks for are kept across frames while the frames keep asking for the same
+    descriptions, targets no frame asked for in a while are deleted so disabled effects give their memory back. Before every pass the
+    framebuffer of its attachments is bound when the graph says so, passes writing the default framebuffer draw to the screen,
+    and the attachments the graph says are cleared. Passes without attachments bind their own framebuffers. */
+class GLRenderGraph
+{
+public:
+
+	GLRenderGraph() {}
+	~GLRenderGraph();
+	GLRenderGraph(const GLRenderGraph& copy) = delete;
+
+	/** Declare the passes of the frame in here, reset it first */
+	RenderGraph& getGraph()             { return m_graph; }
+	const RenderGraph& getGraph() const { return m_graph; }
+	/** The description of a GL texture for createTransient and importResource */
+	static RenderGraph::ResourceDesc makeDesc(GLTexture::ESizedFormat format, uint width, uint height,
+		GLTexture::EMultiSampleType multiSampleType = GLTexture::EMultiSampleType::NONE);
+	/** The texture an imported resource is, NULL for the default framebuffer */
+	void setImportedTexture(RenderGraph::ResourceHandle resource, GLTexture* texture);
+	/** Deletes the kept framebuffers attaching the texture, before an imported texture is initialized again since the new texture can
+	    get the id of the old one */
+	void releaseFramebuffers(const GLTexture& texture);
+	/** Compiles the graph and runs its passes, returns false if it did not compile */
+	bool execute();
+	/** Of a transient or imported resource, for the passes to bind the resources they read */
+	GLTexture& getTexture(RenderGraph::ResourceHandle resource);
+	/** Measures every pass that runs with its name, NULL to measure none */
+	void setProfiler(GLGPUProfiler* a_profiler) { m_profiler = a_profiler; }
+
+	/** Of the targets kept for the graph */
+	uint getNumTargets() const { return uint(m_targets.size()); }
+	uint64 getTargetBytes() const;
+
+private:
+
+	struct Target
+	{
+		RenderGraph::ResourceDesc desc;
+		owner<GLTexture*> texture;
+		uint lastUsedFrame;
+	};
+
+	struct Framebuffer
+	{
+		eastl::vector<uint> textureIDs; // Of the attachments in order
+		owner<GLFramebuffer*> framebuffer;
+		uint lastUsedFrame;
+	};
+
+private:
+
+	GLTexture* getAttachmentTexture(RenderGraph::ResourceHandle resource);
+	GLFramebuffer& getFramebuffer(const eastl::vector<RenderGraph::ResourceHandle>& attachments);
+	void clearAttachments(const eastl::vector<RenderGraph::ResourceHandle>& attachments, uint clearMask);
+	void deleteUnusedTargets();
+
+private:
+
+	RenderGraph m_graph;
+	eastl::vector<Target> m_targets;
+	eastl::vector<uint> m_physicalTargets; // Index in m_targets of every physical target of the graph this frame
+	eastl::vector<GLTexture*> m_importedTextures;
+	eastl::vector<Framebuffer> m_framebuffers;
+	eastl::vector<uint> m_attachmentTextureIDs; // Scratch
+	uint m_frame = 0;
+	GLGPUProfiler* m_profiler = NULL;
+};
@@ -2,6 +2,8 @@
 
 class GLRenderer;
 class GLConstantBuffer;
+class OcclusionBuffer;
+class PerspectiveCamera;
 
 class GLRenderObject
 {
@@ -9,4 +11,6 @@ public:
 	virtual ~GLRenderObject() {}
 
 	virtual void render(GLRenderer& renderer, bool depthOnly) = 0;
+	/** Called before the depth prepass when occlusion culling, objects that hide others add their occluders */
+	virtual void addOccluders(OcclusionBuffer& occlusionBuffer, const PerspectiveCamera& camera) {}
 };
\ No newline at end of file
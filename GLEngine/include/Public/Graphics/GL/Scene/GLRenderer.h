@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Graphics/GL/Scene/GLGPUProfiler.h"
+#include "Graphics/GL/Scene/GLRenderGraph.h"
 #include "Graphics/GL/Scene/GLScene.h"
 #include "Graphics/GL/Tech/ClusteredShading.h"
 #include "Graphics/GL/Tech/Bloom.h"
@@ -8,9 +10,15 @@
 #include "Graphics/GL/Tech/HBAO.h"
 #include "Graphics/GL/Wrappers/GLConstantBuffer.h"
 #include "Graphics/GL/Wrappers/GLFramebuffer.h"
+#include "Graphics/GL/Wrappers/GLRingBuffer.h"
 #include "Graphics/GL/Wrappers/GLShader.h"
 #include "Graphics/GL/Wrappers/GLTexture.h"
+#include "Graphics/GL/Wrappers/GLTimerQuery.h"
+#include "Graphics/Utils/OcclusionBuffer.h"
 #include "Graphics/Utils/PerspectiveCamera.h"
+#include "Graphics/Utils/QualityGovernor.h"
+#include "Graphics/Utils/ShadowCascades.h"
+#include "Utils/Stopwatch.h"
 #include "EASTL/vector.h"
 
 #include <glm/glm.hpp>
@@ -51,7 +59,10 @@ public:
 		glm::vec3 u_cubemapPos;
 		float padding3_LightingGlobals;
 		glm::vec4 u_sunColorIntensity;
-		glm::mat4 u_shadowMat;
+		glm::mat4 u_shadowMats[ShadowCascades::MAX_CASCADES];
+		glm::vec4 u_shadowCascadeSplits; // Far distance of every cascade
+		glm::vec4 u_shadowAtlasRects[ShadowCascades::MAX_CASCADES]; // Texture coordinates of the tile of every cascade, min xy max zw
+		int u_numShadowCascades;
 	};
 
 	struct SettingsGlobalsData
@@ -67,16 +78,23 @@ public:
 	GLRenderer(const GLRenderer& copy) = delete;
 
 	void initialize(const PerspectiveCamera& camera);
-	void render(const PerspectiveCamera& camera, const LightManager& lightManager);
+	void render(const PerspectiveCamera& camera, LightManager& lightManager);
 
-	void addRenderObject(GLRenderObject* renderObject);
+	/** Static objects do not move or change, their shadows are cached until invalidateStaticShadows or the sun changes */
+	void addRenderObject(GLRenderObject* renderObject, bool isStatic = false);
 	void removeRenderObject(GLRenderObject* renderObject);
+	/** Renders the cached shadows of the static objects again, for when one of them changed */
+	void invalidateStaticShadows() { m_shadowCascades.invalidateStatic(); }
 	void addSkybox(GLRenderObject* renderObject);
 	void removeSkybox(GLRenderObject* renderObject);
 
 	void reloadShaders();
 
 	const PerspectiveCamera* getSceneCamera() const { return m_sceneCamera; }
+	/** For data that changes every draw or pass, valid until the GPU finished the frame */
+	GLRingBuffer& getFrameDataBuffer()              { return m_frameDataBuffer; }
+	/** NULL unless occlusion culling for the scene camera, filled with the occluders of this frame before the depth prepass */
+	OcclusionBuffer* getOcclusionBuffer()           { return (m_occlusionCamera && m_occlusionCamera == m_sceneCamera) ? &m_occlusionBuffer : NULL; }
 
 	void setModelDataUBO(const ModelData& modelData);
 	void setSun(const glm::vec3& direction, const glm::vec3& color, float intensity);
@@ -86,27 +104,48 @@ public:
 	void setBloomEnabled(bool a_enabled);
 	void setShadowsEnabled(bool a_enabled);
 	void setFXAAEnabled(bool a_enabled) { m_fxaaEnabled = a_enabled; }
+	void setOcclusionCullingEnabled(bool a_enabled) { m_occlusionCullingEnabled = a_enabled; }
+	/** Lowers the render resolution and the cost of the effects when the GPU takes longer than the target frame time,
+	    disabled renders at the resolution of the screen with the settings of the GLConfig */
+	void setQualityGovernorEnabled(bool enabled);
 
 	bool isHBAOEnabled() const         { return m_hbaoEnabled; }
 	bool isBloomEnabled() const        { return m_bloomEnabled; }
 	bool isShadowsEnabled() const      { return m_shadowsEnabled; }
 	bool isFXAAEnabled() const         { return m_fxaaEnabled; }
+	bool isOcclusionCullingEnabled() const { return m_occlusionCullingEnabled; }
+	bool isQualityGovernorEnabled() const  { return m_qualityGovernorEnabled; }
+	const QualityGovernor& getQualityGovernor() const       { return m_qualityGovernor; }
+	/** Of the resolution the scene was rendered at to the resolution of the screen */
+	float getRenderScale() const                            { return m_renderScale; }
+	const OcclusionBuffer::Stats& getOcclusionStats() const { return m_occlusionBuffer.getStats(); }
+	Bloom& getBloom()                                       { return m_bloom; }
+	HBAO& getHBAO()                                         { return m_hbao; }
+	/** Measures the shadows and every pass of the frame graph, the application begins and ends its frames */
+	GLGPUProfiler& getGPUProfiler()                         { return m_gpuProfiler; }
+	/** Of the frame graph of the last frame */
+	const RenderGraph::Stats& getRenderGraphStats() const   { return m_renderGraph.getGraph().getStats(); }
 
 private:
 
 	void updateLightingGlobalsUBO(const PerspectiveCamera& camera);
 	void updateCameraDataUBO(const PerspectiveCamera& camera);
 	void updateSettingsGlobalsUBO();
+	void applyQualityLevel(const QualityGovernor::QualityLevel& level, uint renderWidth, uint renderHeight);
 
 private:
 
 	eastl::vector<GLRenderObject*> m_renderObjects;
+	eastl::vector<GLRenderObject*> m_staticRenderObjects;  // Also in m_renderObjects
+	eastl::vector<GLRenderObject*> m_dynamicRenderObjects; // Also in m_renderObjects
 	eastl::vector<GLRenderObject*> m_skyboxObjects;
 
 	bool m_hbaoEnabled    = true;
 	bool m_bloomEnabled   = true;
 	bool m_shadowsEnabled = true;
 	bool m_fxaaEnabled    = false;
+	bool m_occlusionCullingEnabled = true;
+	bool m_qualityGovernorEnabled  = true;
 
 	HBAO m_hbao;
 	FXAA m_fxaa;
@@ -118,21 +157,26 @@ private:
 	GLShader m_modelShader;
 	GLShader m_combineShader;
 
-	GLTexture m_sceneColorTexture;
-	GLTexture m_sceneDepthTexture;
-	GLTexture m_shadowDepthTexture;
-
-	GLFramebuffer m_sceneFBO;
+	GLRenderGraph m_renderGraph; // Owns the targets of the passes after the shadows
 	GLFramebuffer m_shadowFBO;
-	PerspectiveCamera m_shadowCamera;
+	GLFramebuffer m_staticShadowFBO;
+	ShadowCascades m_shadowCascades;
 	const PerspectiveCamera* m_sceneCamera = NULL;
 
+	OcclusionBuffer m_occlusionBuffer;
+	const PerspectiveCamera* m_occlusionCamera = NULL; // Camera the occlusion buffer was filled for this frame
+
+	GLGPUProfiler m_gpuProfiler;
+	QualityGovernor m_qualityGovernor;
+	QualityGovernor::QualityLevel m_defaultQualityLevel; // Used while the governor is disabled
+	GLTimerQuery m_gpuTimer;   // Of the frame from the shadows to the end of the frame graph
+	Stopwatch m_cpuStopwatch;  // Of the renderer submitting the frame
+	float m_renderScale = 1.0f;
+
 	GLTexture m_dfvTexture;
 	GLCubeMap* m_cubeMap = NULL;
 
-	GLConstantBuffer m_modelDataUBO;
-	GLConstantBuffer m_cameraVarsUBO;
-	GLConstantBuffer m_lightningGlobalsUBO;
+	GLRingBuffer m_frameDataBuffer; // Model, camera and lighting data
 	GLConstantBuffer m_settingsGlobalsUBO;
 
 	glm::vec3 m_sunDir;
@@ -4,7 +4,15 @@
 #include "Database/Assets/DBMaterial.h"
 #include "Graphics/GL/Scene/GLMesh.h"
 #include "Graphics/GL/Wrappers/GLConstantBuffer.h"
+#include "Graphics/GL/Wrappers/GLShaderStorageBuffer.h"
+#include "Graphics/GL/Wrappers/GLStateBuffer.h"
 #include "Graphics/GL/Wrappers/GLTextureArray.h"
+#include "Graphics/GL/Wrappers/GLVertexBuffer.h"
+#include "Graphics/Utils/AABBList.h"
+#include "Graphics/Utils/DrawCommandBuffer.h"
+#include "Graphics/Utils/OcclusionBuffer.h"
+#include "Graphics/Utils/RenderQueue.h"
+#include "Graphics/Utils/TextureStreamingPolicy.h"
 
 #include "EASTL/string.h"
 #include "EASTL/vector.h"
@@ -13,6 +21,7 @@
 class AssetDatabase;
 class DBScene;
 class GLRenderer;
+class PerspectiveCamera;
 
 class GLScene
 {
@@ -20,14 +29,19 @@ public:
 	friend class GLRenderer;
 
 	GLScene() {}
-	virtual ~GLScene() {}
+	virtual ~GLScene();
 
 	void initialize(const eastl::string& assetName, AssetDatabase& database);
 	void initialize(const DBScene& dbScene);
 	void render(GLRenderer& a_renderer, const glm::mat4& transform, bool depthOnly = false);
+	/** Offers the solid meshes in the frustum of the camera as occluders, bigger on screen first */
+	void addOccluders(OcclusionBuffer& occlusionBuffer, const PerspectiveCamera& camera, const glm::mat4& transform);
 	bool isInitialized() const { return m_initialized; }
 	void setAsSkybox(bool isSkybox);
 
+	/** Shared by all scenes, the renderer updates it once per frame */
+	static TextureStreamingPolicy& getTextureStreaming() { return s_textureStreaming; }
+
 protected:
 
 	void updateMaterialBuffer(const DBMaterial& material, uint materialIdx);
@@ -35,7 +49,34 @@ protected:
 
 private:
 
-	void renderNode(const DBNode& node, GLRenderer& a_renderer, const glm::mat4& parentTransform);
+	struct MeshSortInfo
+	{
+		RenderQueue::EPass pass;
+		uint materialID; // Of the first material of the mesh
+	};
+
+	struct MeshInstance
+	{
+		uint nodeIdx;
+		uint meshIdx;
+	};
+
+private:
+
+	/** Uploads the geometry of every mesh into one vertex and index buffer so they can be drawn with a single multi draw */
+	void initializeSharedGeometry(const DBScene& dbScene);
+	/** Keeps the positions and indices of the meshes that can be occluders on the CPU */
+	void initializeOccluders(const DBScene& dbScene);
+	/** Updates the transforms of the nodes and the world bounds of the mesh instances, and frustum culls all of them at once.
+	    With an occlusion buffer the ones in the frustum are also tested against it */
+	void cullMeshInstances(const glm::mat4& transform, const PerspectiveCamera& camera, OcclusionBuffer* occlusionBuffer);
+	void addNodeBounds(uint nodeIdx, const glm::mat4& parentTransform);
+	/** Draws the visible mesh instances directly, or adds them to m_drawCommands when drawing indirect */
+	void renderVisibleMeshes(GLRenderer& renderer, bool requestTextureLevels);
+	void submitDrawCommands(GLRenderer& renderer);
+	/** Reports the mip levels the textures of a visible mesh need for its projected size */
+	void requestTextureLevels(const GLMesh& mesh, const glm::mat4& modelMatrix, const glm::vec3& center, const glm::vec3& extent, const PerspectiveCamera& camera);
+	void releaseTextureStreaming();
 
 protected:
 
@@ -45,5 +86,28 @@ protected:
 	eastl::vector<DBMaterial> m_materials;
 	eastl::vector<GLMesh> m_meshes;
 	GLConstantBuffer m_materialBuffer;
+	GLShaderStorageBuffer m_materialStorageBuffer; // Replaces m_materialBuffer when drawing indirect, not limited to MAX_MATERIALS
 	GLTextureArray m_textureArrays[DBMaterial::ETexTypes_COUNT];
+	TextureStreamingHandle m_textureStreamingHandles[DBMaterial::ETexTypes_COUNT] = {
+		TextureStreamingPolicy::INVALID_HANDLE, TextureStreamingPolicy::INVALID_HANDLE, TextureStreamingPolicy::INVALID_HANDLE,
+		TextureStreamingPolicy::INVALID_HANDLE, TextureStreamingPolicy::INVALID_HANDLE };
+
+	// Draw indirect, the meshes only keep their range in the shared buffers
+	bool m_drawIndirect = false;
+	GLStateBuffer m_stateBuffer;
+	GLVertexBuffer m_vertexBuffer;
+	GLVertexBuffer m_indiceBuffer;
+	GLVertexBuffer m_drawIDBuffer; // 0..numNodes - 1, every visible node uses one transform per pass
+	DrawCommandBuffer m_drawCommands; // Uploaded to the frame data buffer of the renderer
+	eastl::vector<MeshSortInfo> m_meshSortInfos;
+
+	eastl::vector<OcclusionBuffer::OccluderMesh> m_occluderMeshes; // Empty for meshes that are not solid or have too many triangles
+
+	// Rebuilt every render since the scene transform can change, instances are in depth first node order
+	eastl::vector<glm::mat4> m_nodeTransforms;
+	eastl::vector<MeshInstance> m_meshInstances;
+	AABBList m_meshInstanceBounds;
+	eastl::vector<uint> m_meshInstanceVisibility; // See Frustum::aabbsInFrustum
+
+	static TextureStreamingPolicy s_textureStreaming;
 };
\ No newline at end of file
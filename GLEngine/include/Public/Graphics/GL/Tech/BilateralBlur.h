@@ -1,7 +1,10 @@
 #pragma once
 
-#include "Graphics/GL/Wrappers/GLFramebuffer.h"
 #include "Graphics/GL/Wrappers/GLShader.h"
+#include "Graphics/GL/Wrappers/GLTexture.h"
+#include "Graphics/Utils/RenderGraph.h"
+
+class GLRenderGraph;
 
 class BilateralBlur
 {
@@ -12,10 +15,10 @@ public:
 	BilateralBlur() {}
 	BilateralBlur(const BilateralBlur& copy) = delete;
 
-	void initialize(EBlurValueType type, uint xRes, uint yRes, uint blurRadius, uint blurTexWidth, uint blurTexHeight);
-	// Blurs the first texture in the blurredFBO, uses the depth texture of the depthFBO for the bilateral blur.
-	// blurredFBO and depthFBO can be identical
-	void blurFBO(GLFramebuffer& blurredFBO, GLFramebuffer& depthFBO);
+	void initialize(EBlurValueType type, uint blurRadius);
+	/** Adds a horizontal and a vertical pass to the graph that blur the input weighted by the depth, the input can have a lower resolution.
+	    Returns the result in a target with the resolution of the depth */
+	RenderGraph::ResourceHandle addPasses(GLRenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle depth);
 	void reloadShader();
 
 private:
@@ -23,15 +26,9 @@ private:
 	bool m_initialized    = false;
 	float m_blurRadius    = 0.0f;
 	float m_sharpness     = 1000.0f;
-	uint m_xRes           = 0;
-	uint m_yRes           = 0;
-	uint m_blurTexWidth   = 0;
-	uint m_blurTexHeight  = 0;
 	EBlurValueType m_type = EBlurValueType::VEC3;
 	GLTexture::ESizedFormat m_format = GLTexture::ESizedFormat::RGB8;
 
 	GLShader m_blurXShader;
 	GLShader m_blurYShader;
-	GLTexture m_blurResultTexture;
-	GLFramebuffer m_blurXResultFBO;
 };
\ No newline at end of file
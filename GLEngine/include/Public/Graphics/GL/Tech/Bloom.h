@@ -1,28 +1,50 @@
 #pragma once
 
-#include "Graphics/GL/Wrappers/GLFramebuffer.h"
 #include "Graphics/GL/Wrappers/GLShader.h"
 #include "Graphics/GL/Tech/GaussianBlur.h"
+#include "Graphics/Utils/RenderGraph.h"
+
+class GLRenderGraph;
 
 class Bloom
 {
+public:
+
+	/** PYRAMID halves the bright parts of the scene level by level and adds the levels back up from the smallest, every level widens
+	    the glow at a quarter of the cost of the one before. GAUSSIAN blurs the bright parts at the resolution of the scene, kept to compare */
+	enum class EMethod { PYRAMID, GAUSSIAN };
+
+	enum : uint { DEFAULT_NUM_LEVELS = 5 };
+
 public:
 
 	Bloom() {}
 	Bloom(const Bloom& copy) = delete;
 
-	void initialize(uint xRes, uint yRes);
+	void initialize();
 	void reloadShader();
-	GLFramebuffer& getBloomResultFBO(GLFramebuffer& sceneFBO);
+	/** Adds the passes to the graph, returns the glow of the bright parts of the scene color in a single sampled target,
+	    at half the resolution of the scene color for the pyramid */
+	RenderGraph::ResourceHandle addPasses(GLRenderGraph& graph, RenderGraph::ResourceHandle sceneColor);
+
+	void setMethod(EMethod a_method)      { m_method = a_method; }
+	/** Of the pyramid, the first level has half the resolution of the scene color. Stops early at levels of a single pixel */
+	void setNumLevels(uint a_numLevels)   { m_numLevels = a_numLevels; }
+	EMethod getMethod() const             { return m_method; }
+	uint getNumLevels() const             { return m_numLevels; }
+
+private:
+
+	RenderGraph::ResourceHandle addPyramidPasses(GLRenderGraph& graph, RenderGraph::ResourceHandle bright);
 
 private:
 
 	bool m_initialized = false;
-	uint m_xRes        = 0;
-	uint m_yRes        = 0;
+	EMethod m_method   = EMethod::PYRAMID;
+	uint m_numLevels   = DEFAULT_NUM_LEVELS;
 
 	GLShader m_bloomShader;
-	GLTexture m_bloomResultTexture;
-	GLFramebuffer m_bloomResultFBO;
+	GLShader m_downsampleShader;
+	GLShader m_upsampleShader;
 	GaussianBlur m_gaussianBlur;
-};
\ No newline at end of file
+};
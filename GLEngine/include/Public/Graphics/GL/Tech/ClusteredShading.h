@@ -3,11 +3,12 @@
 #include "Core.h"
 #include "EASTL/vector.h"
 #include "Graphics/GL/Wrappers/GLConstantBuffer.h"
+#include "Graphics/GL/Wrappers/GLShaderStorageBuffer.h"
 #include "Graphics/GL/Wrappers/GLTextureBuffer.h"
+#include "Graphics/Utils/LightClusterBuilder.h"
 
 class PerspectiveCamera;
 class LightManager;
-struct IBounds3D;
 
 class ClusteredShading
 {
@@ -23,6 +24,8 @@ public:
 
 		int u_gridHeight;
 		int u_gridDepth;
+
+		float u_invRenderScale;
 	};
 
 public:
@@ -32,52 +35,37 @@ public:
 	~ClusteredShading();
 
 	void initialize(const PerspectiveCamera& camera, uint screenWidth, uint screenHeight);
-	void update(const PerspectiveCamera& camera, const LightManager& lightManager);
-	void bindTextureBuffers();
+	/** Uploads the lights that changed and clears the dirty ranges of the light manager */
+	void update(const PerspectiveCamera& camera, LightManager& lightManager);
+	void bindBuffers();
+	/** Of the resolution the scene is rendered at to the screen resolution the clusters were built for */
+	void setRenderScale(float renderScale);
 
 	uint getTileWidth() const  { return m_pixelsPerTileW; }
 	uint getTileHeight() const { return m_pixelsPerTileH; }
-	uint getGridWidth() const  { return m_gridWidth; }
-	uint getGridHeight() const { return m_gridHeight; }
-	uint getGridDepth() const  { return m_gridDepth; }
-	uint getGridSize() const   { return m_gridSize; }
+	uint getGridWidth() const  { return m_lightClusters.getGridWidth(); }
+	uint getGridHeight() const { return m_lightClusters.getGridHeight(); }
+	uint getGridDepth() const  { return m_lightClusters.getGridDepth(); }
+	uint getGridSize() const   { return m_lightClusters.getGridSize(); }
 
 private:
 
-	uint writeLightIndices(const IBounds3D& lightBounds, ushort lightIdx);
+	void uploadGlobals();
 
 private:
 
 	bool m_initialized        = false;
-	uint m_screenWidth        = 0;
-	uint m_screenHeight       = 0;
-	uint m_gridWidth          = 0;
-	uint m_gridHeight         = 0;
-	uint m_gridDepth          = 0;
-	uint m_gridSize           = 0;
+	float m_renderScale       = 1.0f;
 	uint m_pixelsPerTileW     = 0;
 	uint m_pixelsPerTileH     = 0;
-	uint m_maxNumLightIndices = 0;
-	float m_recLogSD1         = 0.0f;
-	float m_recNear           = 0.0f;
-
-	enum { MAX_NUM_INDICES_PER_TILE = 10 };
+	uint m_maxNumLightIndices = 0; // Capacity of the index texture buffer, grows when a frame needs more
+	uint m_maxNumLights       = 0; // Capacity of the light storage buffers
 
-	struct TileIndiceList
-	{
-		ushort count;
-		ushort indices[MAX_NUM_INDICES_PER_TILE];
-
-		inline void push_back(ushort val)
-		{
-			if (count < MAX_NUM_INDICES_PER_TILE)
-				indices[count++] = val;
-		}
-	};
-	eastl::vector<TileIndiceList> m_tileLightIndices;
+	LightClusterBuilder m_lightClusters;
 
-	GLConstantBuffer m_lightPositionRangesUBO;
-	GLConstantBuffer m_lightColorIntensitiesUBO;
+	GLShaderStorageBuffer m_lightPositionRangesSSBO;
+	GLShaderStorageBuffer m_lightColorIntensitiesSSBO;
+	GLShaderStorageBuffer m_lightDirectionAnglesSSBO;
 	GLConstantBuffer m_clusteredShadingGlobalsUBO;
 
 	GLTextureBuffer m_lightIndiceTextureBuffer;
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Graphics/GL/Wrappers/GLShader.h"
-#include "Graphics/GL/Wrappers/GLFramebuffer.h"
+#include "Graphics/Utils/RenderGraph.h"
+
+class GLRenderGraph;
 
 class FXAA
 {
@@ -12,13 +14,11 @@ public:
 	FXAA() {}
 	FXAA(const FXAA& copy) = delete;
 
-	void initialize(EQuality quality, uint screenWidth, uint screenHeight);
-	void begin();
-	void endAndRender();
+	void initialize(EQuality quality);
+	/** Adds a pass to the graph that writes the antialiased input to the output, an input with a lower resolution is upscaled */
+	void addPass(GLRenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle output);
 
 private:
 
 	GLShader m_fxaaShader;
-	GLTexture m_fxaaTexture;
-	GLFramebuffer m_fxaaFBO;
-};
\ No newline at end of file
+};
@@ -1,8 +1,12 @@
 #pragma once
 
-#include "Graphics/GL/Wrappers/GLFramebuffer.h"
 #include "Graphics/GL/Wrappers/GLShader.h"
 #include "Graphics/GL/Wrappers/GLTexture.h"
+#include "Graphics/Utils/RenderGraph.h"
+
+#include <glm/glm.hpp>
+
+class GLRenderGraph;
 
 class GaussianBlur
 {
@@ -13,21 +17,19 @@ public:
 	GaussianBlur() {}
 	GaussianBlur(const GaussianBlur& copy) = delete;
 
-	void initialize(EBlurValueType type, uint xRes, uint yRes);
-	// Blurs the first texture in the blurredFBO, uses the depth texture of the depthFBO for the bilateral blur.
-	// blurredFBO and depthFBO can be identical
-	void blurFBO(GLFramebuffer& blurredFBO);
+	void initialize(EBlurValueType type);
+	/** Adds a horizontal and a vertical pass to the graph, returns the blurred input in a target like the input */
+	RenderGraph::ResourceHandle addPasses(GLRenderGraph& graph, RenderGraph::ResourceHandle input);
 	void reloadShader();
 
+private:
+
+	void blur(GLTexture& texture, const glm::vec2& pixelOffset);
+
 private:
 
 	bool m_initialized    = false;
-	float m_pixelXOffset  = 0.0;
-	float m_pixelYOffset  = 0.0;
 	EBlurValueType m_type = EBlurValueType::VEC3;
-	GLTexture::ESizedFormat m_format = GLTexture::ESizedFormat::RGB8;
 
 	GLShader m_blurShader;
-	GLTexture m_blurResultTexture;
-	GLFramebuffer m_blurXResultFBO;
-};
\ No newline at end of file
+};
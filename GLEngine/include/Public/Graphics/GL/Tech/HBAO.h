@@ -1,14 +1,15 @@
 #pragma once
 
-#include "Graphics/GL/Wrappers/GLFramebuffer.h"
 #include "Graphics/GL/Wrappers/GLShader.h"
 #include "Graphics/GL/Wrappers/GLConstantBuffer.h"
 #include "Graphics/GL/Wrappers/GLTexture.h"
 #include "Graphics/GL/Tech/BilateralBlur.h"
+#include "Graphics/Utils/RenderGraph.h"
 
 #include <glm/glm.hpp>
 
 class PerspectiveCamera;
+class GLRenderGraph;
 
 class HBAO
 {
@@ -46,21 +47,56 @@ public:
 
 	void initialize(const PerspectiveCamera& camera, uint screenWidth, uint screenHeight);
 	void reloadShader();
-	GLFramebuffer& getHBAOResultFBO(GLFramebuffer& a_sceneFBO);
+	/** Of the scene depth the passes read, the ambient occlusion is computed at renderWidth / resolutionScale */
+	void setResolution(uint renderWidth, uint renderHeight, uint resolutionScale);
+	/** Adds the passes to the graph, returns the blurred ambient occlusion at the resolution of the scene depth.
+	    The camera is the one the scene depth was rendered with, the frames add up with its view projection */
+	RenderGraph::ResourceHandle addPasses(GLRenderGraph& graph, RenderGraph::ResourceHandle sceneDepth, const PerspectiveCamera& camera);
+
+	/** Every frame samples a few of the directions, turned a bit further every frame, and blends into the ambient occlusion of the
+	    frames before reprojected to this frame. Where the depth of the frame before does not match the history is dropped */
+	void setTemporalEnabled(bool a_enabled)     { m_temporalEnabled = a_enabled; }
+	/** Computes the ambient occlusion in 4x4 layers of every 4th pixel, every layer samples the same direction and only its own
+	    pixels, so neighbouring pixels sample neighbouring texels */
+	void setDeinterleaved(bool a_deinterleaved) { m_deinterleaved = a_deinterleaved; }
+	bool isTemporalEnabled() const              { return m_temporalEnabled; }
+	bool isDeinterleaved() const                { return m_deinterleaved; }
+	/** Of the depth, every pixel samples this many per frame at most */
+	uint getNumSamplesPerFrame() const;
 
 private:
 
-	bool m_initialized = false;
+	void uploadGlobals();
+	/** The history of the ambient occlusion and of the depth it had, created again when the resolution changes */
+	void initializeHistory(GLRenderGraph& graph, uint width, uint height);
 
-	glm::ivec2 m_screenRes;
-	GLShader m_downsampleDepthShader;
-	GLShader m_hbaoFullShader;
-	GLTexture m_downsampleDepthTexture;
+private:
+
+	enum : uint { NUM_HBAO_SHADERS = 4 }; // Temporal and deinterleaved variants
+
+private:
+
+	bool m_initialized     = false;
+	bool m_temporalEnabled = true;
+	bool m_deinterleaved   = false;
 
-	GLTexture m_hbaoResultTexture;
-	GLFramebuffer m_downsampleDepthFBO;
-	GLFramebuffer m_hbaoResultFBO;
+	glm::ivec2 m_renderRes;
+	uint m_resolutionScale = 1;
+	float m_fovRad         = 0.0f;
+	float m_near           = 0.0f;
+	float m_far            = 0.0f;
+	GLShader m_downsampleDepthShader;
+	GLShader m_deinterleaveDepthShader;
+	GLShader m_reinterleaveShader;
+	GLShader m_temporalResolveShader;
+	GLShader m_hbaoShaders[NUM_HBAO_SHADERS]; // Index 1 temporal, 2 deinterleaved
 	GLConstantBuffer m_hbaoGlobalsBuffer;
 	GLTexture m_noiseTexture;
 	BilateralBlur m_bilateralBlur;
-};
\ No newline at end of file
+
+	GLTexture m_historyTextures[2];      // Written by every other frame, the one of the frame before is read
+	GLTexture m_historyDepthTextures[2];
+	uint m_frame             = 0;        // Counts the frames passes were added
+	uint m_lastResolvedFrame = 0xFFFFFFFF;
+	glm::mat4 m_prevViewProjection;
+};
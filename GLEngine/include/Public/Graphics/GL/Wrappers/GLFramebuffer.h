@@ -34,6 +34,9 @@ public:
 	void end();
 	void begin();
 
+	/** Copies the depth of a rectangle in texels to the same rectangle of the target, outside of begin and end */
+	void blitDepth(GLFramebuffer& target, int x, int y, uint width, uint height);
+
 	void bindDepthTexture(uint textureUnit = 0);
 	void bindTexture(uint textureIndex, uint textureUnit);
 	void unbindTexture(uint textureIndex, uint textureUnit);
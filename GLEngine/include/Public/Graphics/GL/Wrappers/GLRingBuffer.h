@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Core.h"
+#include "Graphics/Utils/RingBufferAllocator.h"
+#include "EASTL/vector.h"
+
+struct __GLsync;
+
+/** Persistently mapped, coherent buffer for data written every frame, like per draw uniforms.
+    Allocations are written through the mapping and bound with glBindBufferRange, so updating never stalls or orphans in the driver.
+    A fence at the end of every frame guards its ranges until the GPU is done with them. */
+class GLRingBuffer
+{
+public:
+
+	enum class EBindTarget
+	{
+		UNIFORM        = 0x8A11, // GL_UNIFORM_BUFFER
+		SHADER_STORAGE = 0x90D2  // GL_SHADER_STORAGE_BUFFER
+	};
+
+	struct Allocation
+	{
+		byte* data    = NULL;
+		uint offset   = 0;
+		uint numBytes = 0;
+
+		bool isValid() const { return data != NULL; }
+	};
+
+public:
+
+	GLRingBuffer() {}
+	~GLRingBuffer();
+	GLRingBuffer(const GLRingBuffer& copy) = delete;
+
+	void initialize(uint sizeBytes, uint maxFramesInFlight = 3);
+	/** Aligned for uniform and storage buffer bindings, waits for the GPU if the frames in flight fill the ring */
+	Allocation allocate(uint numBytes);
+	Allocation upload(uint numBytes, const void* data);
+	void bindRange(EBindTarget target, uint bindingPoint, const Allocation& allocation);
+	/** Binds the whole buffer as GL_DRAW_INDIRECT_BUFFER, the commands of an allocation start at its offset */
+	void bindAsDrawIndirect();
+	/** Fences the allocations of this frame, and waits if more than maxFramesInFlight frames are still being processed */
+	void endFrame();
+	bool isInitialized() const { return m_initialized; }
+
+private:
+
+	void waitForOldestFrame();
+
+private:
+
+	bool m_initialized       = false;
+	uint m_buffer            = 0;
+	byte* m_mappedData       = NULL;
+	uint m_alignment         = 0;
+	uint m_maxFramesInFlight = 0;
+	RingBufferAllocator m_allocator;
+	eastl::vector<__GLsync*> m_frameFences; // Oldest first
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Core.h"
+
+class GLShaderStorageBuffer
+{
+public:
+
+	enum class EDrawUsage
+	{
+		STATIC  = 0x88E4, // GL_STATIC_DRAW,
+		DYNAMIC = 0x88E8, // GL_DYNAMIC_DRAW,
+		STREAM  = 0x88E0  // GL_STREAM_DRAW
+	};
+
+	struct Config
+	{
+		uint bindingPoint;
+		EDrawUsage drawUsage;
+	};
+
+public:
+
+	GLShaderStorageBuffer() {}
+	~GLShaderStorageBuffer();
+	GLShaderStorageBuffer(const GLShaderStorageBuffer& copy) = delete;
+
+	void initialize(const Config& config);
+	void initialize(uint bindingPoint, EDrawUsage drawUsage);
+	/** Replaces the contents, the storage is orphaned so draws still reading the previous contents do not stall */
+	void upload(uint numBytes, const void* data);
+	/** Overwrites part of the contents uploaded before */
+	void uploadRange(uint offset, uint numBytes, const void* data);
+	void bind();
+	bool isInitialized() const { return m_initialized; }
+	uint getSizeBytes() const  { return m_sizeBytes; }
+
+private:
+
+	bool m_initialized     = false;
+	EDrawUsage m_drawUsage = EDrawUsage::DYNAMIC;
+	uint m_ssbo            = 0;
+	uint m_bindingPoint    = 0;
+	uint m_sizeBytes       = 0;
+};
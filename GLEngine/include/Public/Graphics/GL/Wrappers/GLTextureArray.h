@@ -45,10 +45,24 @@ public:
 			ETextureWrap textureWrapS = ETextureWrap::CLAMP_TO_EDGE,
 			ETextureWrap textureWrapT = ETextureWrap::CLAMP_TO_EDGE);
 
+	/** Like startInit, but keeps every mip level on the CPU and only allocates the resident levels on the GPU.
+	    Starts out with just the coarsest level resident, use setResidentLevel to stream in finer levels */
+	void startInitStreamed(uint width, uint height, uint depth, uint numComponents, bool isFloatTexture, uint numMipMaps = 4,
+			ETextureMinFilter minFilter = ETextureMinFilter::LINEAR_MIPMAP_LINEAR,
+			ETextureMagFilter magFilter = ETextureMagFilter::LINEAR,
+			ETextureWrap textureWrapS = ETextureWrap::CLAMP_TO_EDGE,
+			ETextureWrap textureWrapT = ETextureWrap::CLAMP_TO_EDGE);
+
 	// Add a texture, returning the index it is placed in
 	uint addTexture(const DBTexture& tex);
 	void finishInit();
 
+	/** Reallocates a streamed texture with the given level as its finest level, keeps the levels that stay resident on the GPU
+	    and only uploads the newly resident levels from the CPU copy */
+	void setResidentLevel(uint level);
+	/** Size of a mip level for all layers together */
+	uint64 getLevelByteSize(uint level) const;
+
 	void bind(uint index = 0);
 	void unbind(uint index = 0);
 	
@@ -61,6 +75,14 @@ public:
 	uint getDepth() const            { return m_depth; }
 	uint getNumComponents() const    { return m_numComponents; }
 	bool isFloatTexture() const      { return m_isFloatTexture; }
+	bool isStreamed() const          { return m_isStreamed; }
+	uint getResidentLevel() const    { return m_residentLevel; }
+
+private:
+
+	void createTexture(uint baseLevel);
+	void uploadLevels(uint beginLevel, uint endLevel);
+	void generateMipMapsOnCPU();
 
 private:
 
@@ -74,4 +96,13 @@ private:
 	uint m_depth          = 0;
 	uint m_numComponents  = 0;
 	bool m_isFloatTexture = false;
+
+	ETextureMinFilter m_minFilter = ETextureMinFilter::LINEAR_MIPMAP_LINEAR;
+	ETextureMagFilter m_magFilter = ETextureMagFilter::LINEAR;
+	ETextureWrap m_textureWrapS   = ETextureWrap::CLAMP_TO_EDGE;
+	ETextureWrap m_textureWrapT   = ETextureWrap::CLAMP_TO_EDGE;
+
+	bool m_isStreamed    = false;
+	uint m_residentLevel = 0;
+	eastl::vector<eastl::vector<byte>> m_levelData; // CPU copy of every level when streamed, layers are contiguous
 };
\ No newline at end of file
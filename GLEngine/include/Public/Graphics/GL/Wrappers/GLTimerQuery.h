@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+/** Measures how long the GPU takes for the commands between begin and end without ever waiting for it.
+    Every measurement writes its own pair of timestamp queries, the results are read once the GPU wrote them a few frames later.
+    When all pairs are still in flight the measurement is skipped instead of stalling. */
+class GLTimerQuery
+{
+public:
+
+	GLTimerQuery() {}
+	~GLTimerQuery();
+	GLTimerQuery(const GLTimerQuery& copy) = delete;
+
+	void initialize(uint maxMeasurementsInFlight = 4);
+	void begin();
+	void end();
+	/** Reads the measurements the GPU finished, returns the latest in milliseconds or -1 if none finished since the last call */
+	float readLatestMs();
+	bool isInitialized() const { return m_initialized; }
+
+private:
+
+	bool m_initialized   = false;
+	bool m_isMeasuring   = false; // Between begin and end of a measurement that was not skipped
+	uint m_oldestPending = 0;
+	uint m_numPending    = 0;
+	eastl::vector<uint> m_queries; // Begin and end timestamp of every measurement in the ring
+};
@@ -14,17 +14,19 @@ struct VertexAttribute
 		FLOAT         = 0x1406  // GL_FLOAT
 	};
 
-	VertexAttribute(uint idx, EFormat format, uint numElements, bool normalize = false) :
+	VertexAttribute(uint idx, EFormat format, uint numElements, bool normalize = false, uint divisor = 0) :
 		attributeIndex(idx),
 		format(format),
 		numElements(numElements),
-		normalize(normalize)
+		normalize(normalize),
+		divisor(divisor)
 	{}
 
 	uint attributeIndex = 0;
 	EFormat format      = EFormat::UNSIGNED_BYTE;
 	uint numElements    = 0;
 	bool normalize      = false;
+	uint divisor        = 0; // Advance once per this many instances instead of per vertex
 };
 
 class GLVertexBuffer
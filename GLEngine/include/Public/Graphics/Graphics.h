@@ -44,6 +44,8 @@ public:
 	void setBlending(bool enabled); // TODO blend func vars
 	void setMultisample(bool enabled);
 	void clearDepthOnly();
+	/** Clears the depth of a rectangle of the framebuffer in pixels */
+	void clearDepthOnly(int x, int y, uint width, uint height);
 
 	uint getViewportWidth() const  { return m_viewportWidth; }
 	uint getViewportHeight() const { return m_viewportHeight; }
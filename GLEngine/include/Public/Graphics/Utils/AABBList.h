@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+
+/** Axis aligned boxes stored as one array per component of their center and half size,
+    so Frustum::aabbsInFrustum can load the same component of several boxes at once */
+class AABBList
+{
+public:
+
+	AABBList() {}
+	AABBList(const AABBList& copy) = delete;
+
+	void clear()
+	{
+		for (eastl::vector<float>& component : m_components)
+			component.clear();
+	}
+
+	void reserve(uint a_numBoxes)
+	{
+		for (eastl::vector<float>& component : m_components)
+			component.reserve(a_numBoxes);
+	}
+
+	/** Returns the index of the box */
+	uint add(const glm::vec3& a_center, const glm::vec3& a_halfSize)
+	{
+		for (uint i = 0; i < 3; ++i)
+		{
+			m_components[CENTER_X + i].push_back(a_center[i]);
+			m_components[HALF_SIZE_X + i].push_back(a_halfSize[i]);
+		}
+		return getNumBoxes() - 1;
+	}
+
+	glm::vec3 getCenter(uint a_idx) const   { return glm::vec3(m_components[CENTER_X][a_idx], m_components[CENTER_Y][a_idx], m_components[CENTER_Z][a_idx]); }
+	glm::vec3 getHalfSize(uint a_idx) const { return glm::vec3(m_components[HALF_SIZE_X][a_idx], m_components[HALF_SIZE_Y][a_idx], m_components[HALF_SIZE_Z][a_idx]); }
+	const float* getCenters(uint a_axis) const   { return m_components[CENTER_X + a_axis].data(); }
+	const float* getHalfSizes(uint a_axis) const { return m_components[HALF_SIZE_X + a_axis].data(); }
+	uint getNumBoxes() const                     { return uint(m_components[CENTER_X].size()); }
+
+private:
+
+	enum EComponent { CENTER_X, CENTER_Y, CENTER_Z, HALF_SIZE_X, HALF_SIZE_Y, HALF_SIZE_Z, NUM_COMPONENTS };
+
+	eastl::vector<float> m_components[NUM_COMPONENTS];
+};
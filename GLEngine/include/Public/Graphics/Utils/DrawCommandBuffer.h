@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Core.h"
+#include "Graphics/Utils/RenderQueue.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+
+/** Layout of an indirect draw as read by glMultiDrawElementsIndirect, same as DrawElementsIndirectCommand in GLTypes.h */
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+/** Per draw data read by the vertex shaders from the DrawTransforms buffer, see globals.glsl */
+struct DrawTransform
+{
+	glm::mat4 modelMatrix;
+	glm::mat4 normalMatrix;
+};
+
+/** Collects the visible draws of a frame on the CPU so they can be submitted with one multi draw per bucket.
+    Draws are ordered by their RenderQueue key, draws sharing a bucket key (pass and shader) are submitted together. The baseInstance of every command is the index of its transform,
+    the vertex shader gets it back through an instanced draw id attribute. Knows nothing about GL so it can be tested without a GPU. */
+class DrawCommandBuffer
+{
+public:
+
+	struct Bucket
+	{
+		uint64 key; // RenderQueue::getBucketKey of the draws
+		uint firstCommand;
+		uint numCommands;
+	};
+
+public:
+
+	DrawCommandBuffer() {}
+	DrawCommandBuffer(const DrawCommandBuffer& copy) = delete;
+
+	void clear();
+	/** Returns the index to pass to addDraw for draws using this transform */
+	uint addTransform(const glm::mat4& modelMatrix, const glm::mat4& normalMatrix);
+	/** The sort key is made with RenderQueue::makeKey */
+	void addDraw(uint64 sortKey, uint numIndices, uint firstIndex, int baseVertex, uint transformIdx);
+	/** Sorts the commands by key and groups them by bucket, commands with equal keys keep their order */
+	void finish();
+
+	const eastl::vector<DrawCommand>& getCommands() const     { return m_commands; }
+	const eastl::vector<DrawTransform>& getTransforms() const { return m_transforms; }
+	const eastl::vector<Bucket>& getBuckets() const           { return m_buckets; }
+	bool isEmpty() const                                      { return m_commands.empty(); }
+
+private:
+
+	eastl::vector<DrawCommand> m_commands;
+	eastl::vector<DrawCommand> m_sortedCommands; // Kept to not reallocate every frame
+	RenderQueue m_queue;
+	eastl::vector<DrawTransform> m_transforms;
+	eastl::vector<Bucket> m_buckets;
+	bool m_finished = false;
+};
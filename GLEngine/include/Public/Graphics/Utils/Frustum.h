@@ -1,9 +1,12 @@
 #pragma once
 
+#include "Core.h"
 #include "Graphics/Utils/Plane.h"
+#include "EASTL/vector.h"
 
 #include <glm/glm.hpp>
 
+class AABBList;
 class PerspectiveCamera;
 
 class Frustum
@@ -30,6 +33,13 @@ public:
 	bool pointInFrustum(const glm::vec3& point) const;
 	bool sphereInFrustum(const glm::vec3& point, float radius) const;
 	bool aabbInFrustum(const glm::vec3& min, const glm::vec3& max) const;
+	/** Bit i % 32 of visibilityMask[i / 32] is set if box i intersects the frustum, with the same result as aabbInFrustum.
+	    Tests four boxes at a time with SSE, or eight with AVX when compiled for it. If multithreaded, large lists are split over the ParallelUtils workers */
+	void aabbsInFrustum(const AABBList& boxes, eastl::vector<uint>& visibilityMask, bool multithreaded = false) const;
+	/** One box at a time, for platforms without SSE and to check the SIMD version against */
+	void aabbsInFrustumScalar(const AABBList& boxes, eastl::vector<uint>& visibilityMask) const;
+
+	static bool isVisible(const eastl::vector<uint>& a_visibilityMask, uint a_idx) { return (a_visibilityMask[a_idx / 32] >> (a_idx % 32)) & 1; }
 
 public:
 
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+
+class PerspectiveCamera;
+
+/** Assigns point and spot lights to the clusters of a camera, screen tiles split into logarithmic depth slices, and lays out the lights of
+    every cluster in one compact index list without a limit per cluster. The lights are split over threads that compute their cluster
+    bounds 4 at a time and count them per cluster, a prefix sum over the counts gives every cluster its range, then the threads fill it.
+    The screen rectangle and depth range of a light are conservative, so with refinement enabled every cluster in them is also tested
+    against the sphere of the light in view space, keeping only the lights that can reach a cluster. Spot lights are bounded by the smallest sphere
+    around their cone and with refinement also tested against the cone itself. While the camera does not move, update only
+    bins the lights that changed since the last build again and merges them into the lists. A moving camera moves every light relative to the
+    clusters, at walking speed a third of the lights reach other clusters every frame and proving that the rest did not costs as much as binning
+    them, so then update builds everything. Knows nothing about GL so it can be tested without a GPU. */
+class LightClusterBuilder
+{
+public:
+
+	struct Stats
+	{
+		uint numIndices          = 0;
+		uint numOccupiedClusters = 0; // With at least one light
+		uint maxLightsPerCluster = 0;
+		float avgLightsPerOccupiedCluster = 0.0f;
+	};
+
+public:
+
+	LightClusterBuilder() {}
+	LightClusterBuilder(const LightClusterBuilder& copy) = delete;
+
+	void initialize(const PerspectiveCamera& camera, uint screenWidth, uint screenHeight, uint tileWidth, uint tileHeight);
+	/** Bins the lights, world space positions and ranges, into the clusters of the camera. lightDirectionAngles holds the world space
+	    direction and the cosine of half the cone angle of every light, a cosine of -1 is a point light. NULL makes every light a point light */
+	void build(const PerspectiveCamera& camera, const glm::vec4* lightPositionRanges, const glm::vec4* lightDirectionAngles, uint numLights, bool multithreaded = true);
+	/** Same result as build, but while the view and projection of the camera stay the same only the lights that moved, changed their range,
+	    were added or removed since the last build or update are binned again. Returns false when nothing changed and the lists are the same */
+	bool update(const PerspectiveCamera& camera, const glm::vec4* lightPositionRanges, const glm::vec4* lightDirectionAngles, uint numLights, bool multithreaded = true);
+	/** Same result one light and one cluster at a time on the calling thread, to check build against */
+	void buildReference(const PerspectiveCamera& camera, const glm::vec4* lightPositionRanges, const glm::vec4* lightDirectionAngles, uint numLights);
+	/** Tests every cluster in the bounds of a light against its sphere, on by default */
+	void setRefinementEnabled(bool a_enabled) { m_refinementEnabled = a_enabled; m_canUpdate = false; }
+	/** Of the last build, counted when called */
+	Stats getStats() const;
+
+	/** Begin and end in getLightIndices of every cluster, indexed by (x * gridHeight + y) * gridDepth + z */
+	const eastl::vector<glm::uvec2>& getClusterRanges() const               { return m_clusterRanges; }
+	/** Lights of every cluster in increasing order */
+	const eastl::vector<uint>& getLightIndices() const                      { return m_lightIndices; }
+	const eastl::vector<glm::vec4>& getLightPositionRangesViewSpace() const { return m_lightPositionRangesViewSpace; }
+	const eastl::vector<glm::vec4>& getLightDirectionAnglesViewSpace() const { return m_lightDirectionAnglesViewSpace; }
+
+	uint getGridWidth() const   { return m_gridWidth; }
+	uint getGridHeight() const  { return m_gridHeight; }
+	uint getGridDepth() const   { return m_gridDepth; }
+	uint getGridSize() const    { return m_gridWidth * m_gridHeight * m_gridDepth; }
+	float getRecNear() const    { return m_recNear; }
+	float getRecLogSD1() const  { return m_recLogSD1; }
+	bool isRefinementEnabled() const { return m_refinementEnabled; }
+	/** Binned again by the last update, all lights when it had to build everything */
+	uint getNumUpdatedLights() const { return m_numUpdatedLights; }
+
+private:
+
+	struct ClusterBounds
+	{
+		glm::ivec3 min;
+		glm::ivec3 max; // One past the last cluster
+	};
+
+private:
+
+	/** View space position, direction and bounding sphere of a light */
+	void transformLight(const glm::mat4& viewMatrix, const glm::vec4* lightPositionRanges, const glm::vec4* lightDirectionAngles, uint lightIdx);
+	void calculateBounds(const PerspectiveCamera& camera, uint begin, uint end);
+	void calculateTileSlopes(const PerspectiveCamera& camera);
+	void getClusterBox(int x, int y, int z, glm::vec3& min, glm::vec3& max) const;
+	bool sphereIntersectsCluster(const glm::vec4& sphereViewSpace, int x, int y, int z) const;
+	/** Tests the bounding sphere of the cluster against the cone, conservative for cones up to 90 degrees */
+	bool coneIntersectsCluster(const glm::vec4& lightPositionRangeViewSpace, const glm::vec4& lightDirectionAngleViewSpace, int x, int y, int z) const;
+	/** Calls func(clusterIdx) for every cluster the light is assigned to */
+	template <typename Func>
+	void forEachCluster(uint lightIdx, const Func& func) const;
+	uint getClusterIdx(int x, int y, int z) const { return (uint(x) * m_gridHeight + uint(y)) * m_gridDepth + uint(z); }
+
+private:
+
+	uint m_screenWidth  = 0;
+	uint m_screenHeight = 0;
+	uint m_tileWidth    = 0;
+	uint m_tileHeight   = 0;
+	uint m_gridWidth    = 0;
+	uint m_gridHeight   = 0;
+	uint m_gridDepth    = 0;
+	float m_recNear     = 0.0f;
+	float m_recLogSD1   = 0.0f;
+	bool m_refinementEnabled = true;
+	bool m_canUpdate         = false; // The lists are of the lights, view and projection below and can be updated incrementally
+	uint m_numUpdatedLights  = 0;
+
+	eastl::vector<float> m_sliceDepths; // Distance to the near plane of every depth slice and the far plane of the last
+	eastl::vector<float> m_tileSlopesX; // View space x over depth of the left edge of every tile column and the right edge of the last
+	eastl::vector<float> m_tileSlopesY;
+
+	eastl::vector<glm::vec4> m_lightPositionRangesViewSpace;
+	eastl::vector<glm::vec4> m_lightDirectionAnglesViewSpace;
+	eastl::vector<glm::vec4> m_lightBoundingSpheres; // View space, the light itself for point lights
+	eastl::vector<ClusterBounds> m_lightBounds;
+	eastl::vector<uint> m_rangeCounts; // Lights per cluster for every range of lights, turned into the write offsets of the range
+	eastl::vector<uint> m_chunkOffsets; // Of the chunks of clusters the prefix sum is split in
+	eastl::vector<glm::uvec2> m_clusterRanges;
+	eastl::vector<uint> m_lightIndices;
+
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	eastl::vector<glm::vec4> m_lightPositionRanges; // World space, of the last build or update
+	eastl::vector<glm::vec4> m_lightDirectionAngles;
+	eastl::vector<uint> m_changedLights;
+	eastl::vector<byte> m_lightChanged;
+	eastl::vector<uint> m_removedCounts; // Changed lights leaving every cluster
+	eastl::vector<uint> m_addedOffsets;  // Begin of the changed lights entering every cluster in m_addedIndices
+	eastl::vector<uint> m_addedIndices;
+	eastl::vector<uint> m_updatedLightIndices;
+};
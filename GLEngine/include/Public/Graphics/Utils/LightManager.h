@@ -1,55 +1,100 @@
 #pragma once
 
 #include "Core.h"
-#include "gsl/gsl.h"
+#include "EASTL/vector.h"
 
-#include "Utils/VecForward.h"
+#include <glm/glm.hpp>
 
-typedef ushort LightHandle;
+/** Index of a slot in the indirection table in the low bits and the generation of the slot in the high bits.
+    Deleting a light bumps the generation of its slot, so handles of deleted lights are detected instead of pointing at another light */
+typedef uint LightHandle;
 
 class GLShader;
 class PerspectiveCamera;
 class ClusteredShading;
 
+/** Keeps point and spot lights packed in arrays without gaps that grow as needed, in the layout the shaders read them.
+    Deleting a light moves the last one into its place, handles stay valid because they go through the indirection table.
+    The part of the arrays that changed since the last clearDirtyRanges is tracked so only that part has to be uploaded */
 class LightManager
 {
 public:
-	LightManager(uint maxLights);
+
+	struct DirtyRange
+	{
+		uint begin = 0;
+		uint end   = 0;
+		bool isEmpty() const { return begin >= end; }
+	};
+
+public:
+
+	LightManager(uint initialCapacity = 0);
 	~LightManager();
 	LightManager(const LightManager& copy) = delete;
 
 	LightHandle createLight();
 	LightHandle createLight(const glm::vec3& pos, float radius, const glm::vec3& color, float intensity);
+	/** angle is half the opening angle of the cone in degrees */
+	LightHandle createSpotLight(const glm::vec3& pos, float radius, const glm::vec3& direction, float angle, const glm::vec3& color, float intensity);
 	void deleteLight(LightHandle light);
 	void deleteLights();
+	/** If the light was not deleted since the handle was created */
+	bool isValid(LightHandle light) const;
 
 	void setLight(LightHandle light, const glm::vec3& pos, float radius, const glm::vec3& color, float intensity);
 	void setLightPosition(LightHandle light, const glm::vec3& position);
 	void setLightRange(LightHandle light, float range);
 	void setLightColor(LightHandle light, const glm::vec3& color);
 	void setLightIntensity(LightHandle light, float intensity);
+	/** Turns the light into a spot light, an angle of 180 degrees turns it back into a point light */
+	void setLightSpot(LightHandle light, const glm::vec3& direction, float angle);
 
 	const glm::vec3& getLightPosition(LightHandle light) const;
 	float getLightRange(LightHandle light) const;
 	const glm::vec3& getLightColor(LightHandle light) const;
 	float getLightIntensity(LightHandle light) const;
+	const glm::vec3& getLightDirection(LightHandle light) const;
+	float getLightSpotAngle(LightHandle light) const;
+	bool isSpotLight(LightHandle light) const;
 
-	uint getMaxLights() const                         { return m_maxLights; }
-	uint getNumLights() const                         { return m_numUsedLights; }
-	const glm::vec4* getLightColorIntensities() const { return m_lightColorIntensities; }
-	const glm::vec4* getLightPositionRanges() const   { return m_lightPositionRanges; }
-	glm::vec4* getLightColorIntensities()             { return m_lightColorIntensities; }
-	glm::vec4* getLightPositionRanges()               { return m_lightPositionRanges; }
+	uint getNumLights() const                                { return uint(m_lightPositionRanges.size()); }
+	const glm::vec4* getLightColorIntensities() const        { return m_lightColorIntensities.data(); }
+	const glm::vec4* getLightPositionRanges() const          { return m_lightPositionRanges.data(); }
+	/** Direction and cosine of the spot angle, -1 for point lights */
+	const glm::vec4* getLightDirectionAngles() const         { return m_lightDirectionAngles.data(); }
+	/** Of the packed arrays, the lights that were set, created or moved by a delete since the last clearDirtyRanges.
+	    Changes of the spot cone count as changes of the position */
+	const DirtyRange& getDirtyPositionRanges() const         { return m_dirtyPositionRanges; }
+	const DirtyRange& getDirtyColorIntensities() const       { return m_dirtyColorIntensities; }
+	void clearDirtyRanges();
 
 public:
 
-	static LightHandle INVALID_HANDLE;
+	static const LightHandle INVALID_HANDLE;
 
 private:
 
-	uint m_maxLights                          = 0;
-	uint m_numUsedLights                      = 0;
-	owner<ushort*> m_lightHandles             = NULL;
-	owner<glm::vec4*> m_lightPositionRanges   = NULL;
-	owner<glm::vec4*> m_lightColorIntensities = NULL;
-};
\ No newline at end of file
+	struct Slot
+	{
+		uint lightIdx; // In the packed arrays
+		uint generation;
+	};
+
+private:
+
+	uint getLightIdx(LightHandle light) const;
+	void markDirty(DirtyRange& range, uint lightIdx);
+
+private:
+
+	eastl::vector<glm::vec4> m_lightPositionRanges;
+	eastl::vector<glm::vec4> m_lightColorIntensities;
+	eastl::vector<glm::vec4> m_lightDirectionAngles;
+	eastl::vector<uint> m_lightSlots; // Slot of every light in the packed arrays
+	eastl::vector<Slot> m_slots;
+	eastl::vector<uint> m_freeSlots;
+
+	DirtyRange m_dirtyPositionRanges;
+	DirtyRange m_dirtyColorIntensities;
+};
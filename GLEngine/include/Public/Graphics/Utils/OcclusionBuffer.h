@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+
+class AABBList;
+
+/** Low resolution software depth buffer for occlusion culling on the CPU.
+    Every frame the largest occluders are rasterized until the triangle budget is used, then boxes are tested against a hierarchy of the farthest depth per texel.
+    Like the GPU a pixel is covered when its center is inside a triangle, boxes are grown by a pixel so this never hides anything that peeks out behind an occluder.
+    Back faces are skipped since the renderer culls them too. Knows nothing about GL so it can be tested without a GPU. */
+class OcclusionBuffer
+{
+public:
+
+	struct Settings
+	{
+		uint width                = 256; // Multiples of 4, a power of two keeps every level of the hierarchy exact
+		uint height               = 128;
+		uint maxTrianglesPerFrame = 20000;
+	};
+
+	/** Positions and indices of a mesh kept on the CPU to be used as occluder */
+	struct OccluderMesh
+	{
+		eastl::vector<glm::vec3> positions;
+		eastl::vector<uint> indices;
+	};
+
+	struct Stats
+	{
+		uint numOccluders  = 0; // Rasterized this frame
+		uint numTriangles  = 0; // Rasterized this frame, including back faces and clipped ones
+		uint numTested     = 0;
+		uint numOccluded   = 0;
+	};
+
+public:
+
+	OcclusionBuffer() {}
+	OcclusionBuffer(const OcclusionBuffer& copy) = delete;
+
+	void initialize(const Settings& settings);
+	/** Clears the depth and the occluders, viewProjection is the GL projection times view matrix of the camera the boxes are tested for */
+	void beginFrame(const glm::mat4& viewProjection);
+	/** The mesh has to stay alive until rasterizeOccluders, occluders with a higher priority are rasterized first */
+	void addOccluder(const OccluderMesh& mesh, const glm::mat4& modelMatrix, float priority);
+	/** Rasterizes the occluders by priority until the triangle budget is used and builds the depth hierarchy */
+	void rasterizeOccluders();
+
+	/** False if the box is hidden behind the occluders */
+	bool isVisible(const glm::vec3& center, const glm::vec3& halfSize);
+	/** Clears the bit of every visible box in visibilityMask that is hidden, the mask is laid out like Frustum::aabbsInFrustum writes it */
+	void cullOccluded(const AABBList& boxes, eastl::vector<uint>& visibilityMask);
+
+	bool isReady() const                { return m_ready; }
+	uint getWidth(uint a_level) const   { return m_levelSizes[a_level].x; }
+	uint getHeight(uint a_level) const  { return m_levelSizes[a_level].y; }
+	uint getNumLevels() const           { return uint(m_levels.size()); }
+	/** Normalized device depth, level 0 is the nearest occluder depth per pixel, higher levels the farthest of 2x2 texels below */
+	const float* getDepth(uint a_level) const { return m_levels[a_level].data(); }
+	const Stats& getStats() const       { return m_stats; }
+
+private:
+
+	struct Occluder
+	{
+		const OccluderMesh* mesh;
+		glm::mat4 modelMatrix;
+		float priority;
+	};
+
+private:
+
+	void rasterizeOccluder(const Occluder& occluder);
+	void rasterizeTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2);
+	void buildHierarchy();
+
+private:
+
+	Settings m_settings;
+	bool m_ready = false;
+	glm::mat4 m_viewProjection;
+	eastl::vector<Occluder> m_occluders;
+	eastl::vector<glm::vec4> m_clipPositions; // Of the occluder being rasterized
+	eastl::vector<eastl::vector<float>> m_levels;
+	eastl::vector<glm::uvec2> m_levelSizes;
+	Stats m_stats;
+};
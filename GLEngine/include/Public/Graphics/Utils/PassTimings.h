@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/string.h"
+#include "EASTL/vector.h"
+
+/** Keeps the times of the last frames of every pass and calculates their statistics, the passes are identified by name.
+    Knows nothing about GL so it can be tested with synthetic timings. */
+class PassTimings
+{
+public:
+
+	struct PassStats
+	{
+		const char* name;
+		uint numSamples;
+		float lastMs;
+		float averageMs;
+		float minMs;
+		float maxMs;
+		float p50Ms;
+		float p95Ms;
+		float p99Ms;
+	};
+
+public:
+
+	PassTimings() {}
+	PassTimings(const PassTimings& copy) = delete;
+
+	/** Statistics are calculated over the last numSamples frames of a pass */
+	void initialize(uint numSamples = 256);
+	/** Index of the pass with the name, adds the pass the first time */
+	uint getPassIndex(const char* name);
+	void addSample(uint passIdx, float ms);
+	/** Forgets the samples but keeps the passes */
+	void clearSamples();
+
+	/** Of every pass in the order they were added, percentiles are of the nearest rank */
+	void getStats(eastl::vector<PassStats>& stats) const;
+	/** Writes the statistics as JSON */
+	bool writeReport(const eastl::string& filePath) const;
+	void printSummary() const;
+
+	uint getNumPasses() const                     { return uint(m_passes.size()); }
+	const char* getPassName(uint a_passIdx) const { return m_passes[a_passIdx].name.c_str(); }
+
+private:
+
+	struct Pass
+	{
+		eastl::string name;
+		eastl::vector<float> samples; // Ring of the last samples
+		uint nextSample;
+		uint numSamples;
+	};
+
+private:
+
+	uint m_maxNumSamples = 256;
+	eastl::vector<Pass> m_passes;
+	mutable eastl::vector<float> m_sorted; // Scratch
+};
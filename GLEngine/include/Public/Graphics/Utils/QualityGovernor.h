@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+/** Picks the quality level of the renderer from the measured GPU and CPU frame times so frames keep taking about the target time.
+    The levels are ordered from the best to the cheapest. The quality drops one level after the averaged GPU time stayed over the target
+    for a while and rises one level after the better level was predicted to fit under the target for longer. Upgrades that had to be undone
+    soon after double the time the next upgrade waits, so a level right at the edge of the target does not flip back and forth.
+    Frames that are bound by the CPU leave the level alone, a cheaper level would not make them faster.
+    Knows nothing about GL so it can be tested with synthetic timings. */
+class QualityGovernor
+{
+public:
+
+	struct QualityLevel
+	{
+		float resolutionScale;        // Of the internal render resolution to the screen, the result is upscaled to the screen
+		uint hbaoResolutionScale;     // Divides the render resolution for the ambient occlusion
+		uint shadowCascadeResolution;
+		uint numBloomLevels;          // Of the bloom pyramid, every level widens the glow
+		float relativeCost;           // Estimated GPU time relative to the first level, predicts if a better level fits
+	};
+
+	struct Settings
+	{
+		float targetFrameMs   = 1000.0f / 60.0f;
+		float smoothing       = 0.1f;  // Weight of a new measurement in the moving averages
+		float downgradeMargin = 0.05f; // Fraction the averaged GPU time has to be over the target to count as over
+		float upgradeMargin   = 0.1f;  // Fraction the predicted GPU time of the better level has to be under the target
+		uint settleFrames     = 8;     // Measurements ignored after a change, the timings lag behind and the averages start again
+		uint downgradeFrames  = 8;     // Measurements over the target before the quality drops
+		uint upgradeFrames    = 60;    // Measurements with room for the better level before the quality rises
+		uint maxUpgradeFrames = 1920;  // Limit of the upgrade wait that doubles every time an upgrade is undone
+	};
+
+	struct Stats
+	{
+		uint numDowngrades     = 0;
+		uint numUpgrades       = 0;
+		uint numUndoneUpgrades = 0;
+		uint numCPUBoundFrames = 0;
+	};
+
+public:
+
+	QualityGovernor() {}
+	QualityGovernor(const QualityGovernor& copy) = delete;
+
+	void initialize(const Settings& settings, const eastl::vector<QualityLevel>& levels, uint startLevel);
+	/** Feeds the times of a frame, a negative GPU time for frames without a finished measurement is ignored. Returns if the level changed */
+	bool update(float gpuMs, float cpuMs);
+	void setTargetFrameMs(float a_targetFrameMs) { m_settings.targetFrameMs = a_targetFrameMs; }
+
+	uint getLevel() const                       { return m_level; }
+	uint getNumLevels() const                   { return uint(m_levels.size()); }
+	const QualityLevel& getQualityLevel() const { return m_levels[m_level]; }
+	const Settings& getSettings() const         { return m_settings; }
+	float getAverageGPUMs() const               { return m_averageGPUMs; }
+	float getAverageCPUMs() const               { return m_averageCPUMs; }
+	uint getUpgradeFrames() const               { return m_upgradeFrames; }
+	const Stats& getStats() const               { return m_stats; }
+
+private:
+
+	void setLevel(uint level);
+
+private:
+
+	Settings m_settings;
+	eastl::vector<QualityLevel> m_levels;
+	uint m_level               = 0;
+	float m_averageGPUMs       = 0.0f;
+	float m_averageCPUMs       = 0.0f;
+	uint m_numAveraged         = 0;
+	uint m_settleFramesLeft    = 0;
+	uint m_framesOver          = 0;
+	uint m_framesUnder         = 0;
+	uint m_framesAtLevel       = 0; // Measurements since the last change
+	uint m_upgradeFrames       = 0;
+	bool m_lastChangeUpgraded  = false;
+	Stats m_stats;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+#include <functional>
+#include <glm/glm.hpp>
+
+/** The passes of a frame with the render targets they read and write, declared in the order they run in every frame.
+    Compiling culls the passes that contribute nothing to an output, gives every transient target the lifetime from the first to the last
+    pass using it and lets transients with the same description share one physical target when their lifetimes do not overlap.
+    Every pass gets the framebuffer bind and the clears it needs: consecutive passes with the same attachments stay bound and only
+    attachments that are cleared on purpose or would show what another transient left behind are cleared.
+    Knows nothing about GL so it can be tested without a GPU, GLRenderGraph creates the targets and runs the passes. */
+class RenderGraph
+{
+public:
+
+	typedef uint ResourceHandle;
+	typedef uint PassHandle;
+
+	/** What an attachment holds when the pass begins */
+	enum class ELoad
+	{
+		LOAD,     // What the passes before wrote, cleared if nothing wrote a transient yet this frame
+		CLEAR,
+		DONT_CARE // The pass overwrites every pixel
+	};
+
+	struct ResourceDesc
+	{
+		uint format        = 0; // Only compared, GLRenderGraph passes the GL format
+		uint width         = 0;
+		uint height        = 0;
+		uint numSamples    = 0;
+		uint bytesPerPixel = 0; // Of one sample, for the stats
+
+		bool operator==(const ResourceDesc& a_other) const
+		{
+			return format == a_other.format && width == a_other.width && height == a_other.height && numSamples == a_other.numSamples;
+		}
+		uint64 getNumBytes() const { return uint64(width) * height * glm::max(numSamples, 1u) * bytesPerPixel; }
+	};
+
+	struct CompiledPass
+	{
+		PassHandle pass;
+		bool bindFramebuffer; // The attachments differ from the ones of the pass before
+		uint clearMask;       // Bit i clears getAttachments(pass)[i]
+	};
+
+	struct Stats
+	{
+		uint numPasses           = 0;
+		uint numCulledPasses     = 0;
+		uint numTransients       = 0; // Used by passes that were not culled
+		uint numPhysical         = 0;
+		uint numFramebufferBinds = 0;
+		uint numClears           = 0;
+		uint64 transientBytes    = 0; // Every transient in its own target
+		uint64 physicalBytes     = 0;
+	};
+
+public:
+
+	RenderGraph() {}
+	RenderGraph(const RenderGraph& copy) = delete;
+
+	/** Forgets all passes and resources, to declare the next frame */
+	void reset();
+
+	ResourceHandle createTransient(const char* name, const ResourceDesc& desc);
+	/** Lives outside of the graph, like the default framebuffer or targets kept across frames. Passes writing an output are never culled */
+	ResourceHandle importResource(const char* name, const ResourceDesc& desc, bool isOutput);
+	PassHandle addPass(const char* name, std::function<void()> execute);
+	/** The pass samples the resource */
+	void read(PassHandle pass, ResourceHandle resource);
+	/** The resource is an attachment of the framebuffer of the pass, in the order they are written */
+	void write(PassHandle pass, ResourceHandle resource, ELoad load = ELoad::LOAD);
+	/** Never culled, for passes with effects outside of the graph */
+	void setSideEffect(PassHandle pass);
+
+	/** Returns false and prints why if a pass reads a transient that nothing wrote before it */
+	bool compile();
+	/** Runs the execute function of the pass, GLRenderGraph binds and clears its attachments before */
+	void executePass(PassHandle a_pass) const { if (m_passes[a_pass].execute) m_passes[a_pass].execute(); }
+
+	const eastl::vector<CompiledPass>& getCompiledPasses() const { return m_compiledPasses; }
+	const eastl::vector<ResourceHandle>& getAttachments(PassHandle a_pass) const { return m_passes[a_pass].attachments; }
+	const eastl::vector<ResourceHandle>& getReads(PassHandle a_pass) const       { return m_passes[a_pass].reads; }
+	const eastl::vector<ELoad>& getLoads(PassHandle a_pass) const                { return m_passes[a_pass].loads; }
+	const char* getPassName(PassHandle a_pass) const           { return m_passes[a_pass].name; }
+	bool hasSideEffect(PassHandle a_pass) const                { return m_passes[a_pass].sideEffect; }
+	bool isCulled(PassHandle a_pass) const                     { return m_passes[a_pass].culled; }
+	uint getNumPasses() const                                  { return uint(m_passes.size()); }
+
+	uint getNumResources() const                               { return uint(m_resources.size()); }
+	const char* getResourceName(ResourceHandle a_resource) const         { return m_resources[a_resource].name; }
+	const ResourceDesc& getResourceDesc(ResourceHandle a_resource) const { return m_resources[a_resource].desc; }
+	bool isImported(ResourceHandle a_resource) const           { return m_resources[a_resource].imported; }
+	bool isOutput(ResourceHandle a_resource) const             { return m_resources[a_resource].output; }
+	/** Physical target of a transient, INVALID_INDEX for imported resources and transients only culled passes use */
+	uint getPhysicalIdx(ResourceHandle a_resource) const       { return m_resources[a_resource].physicalIdx; }
+	/** Index in getCompiledPasses of the first and last pass using a transient */
+	uint getFirstUse(ResourceHandle a_resource) const          { return m_resources[a_resource].firstUse; }
+	uint getLastUse(ResourceHandle a_resource) const           { return m_resources[a_resource].lastUse; }
+	uint getNumPhysical() const                                { return uint(m_physicalDescs.size()); }
+	const ResourceDesc& getPhysicalDesc(uint a_idx) const      { return m_physicalDescs[a_idx]; }
+	const Stats& getStats() const                              { return m_stats; }
+
+public:
+
+	enum : uint
+	{
+		INVALID_INDEX   = 0xFFFFFFFF,
+		MAX_ATTACHMENTS = 32 // Of one pass, the bits of clearMask
+	};
+
+private:
+
+	struct Resource
+	{
+		const char* name;
+		ResourceDesc desc;
+		bool imported;
+		bool output;
+		uint physicalIdx;
+		uint firstUse;
+		uint lastUse;
+	};
+
+	struct Pass
+	{
+		const char* name;
+		std::function<void()> execute;
+		eastl::vector<ResourceHandle> reads;
+		eastl::vector<ResourceHandle> attachments;
+		eastl::vector<ELoad> loads; // Of every attachment
+		bool sideEffect;
+		bool culled;
+	};
+
+private:
+
+	/** Imported resources by handle and transients by physical target, so aliased transients share framebuffers */
+	uint getAttachmentKey(ResourceHandle resource) const;
+
+private:
+
+	eastl::vector<Resource> m_resources;
+	eastl::vector<Pass> m_passes;
+	eastl::vector<CompiledPass> m_compiledPasses;
+	eastl::vector<ResourceDesc> m_physicalDescs;
+	Stats m_stats;
+
+	eastl::vector<byte> m_needed;  // Compile scratch, the contents of the resource are read by a pass that was not culled
+	eastl::vector<byte> m_written; // Compile scratch, written by a pass before
+	eastl::vector<uint> m_physicalLastUse;
+	eastl::vector<ResourceHandle> m_transientsByFirstUse;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+/** Orders the draws of a frame by a 64 bit key with a radix sort.
+    Opaque and alpha tested keys sort by pass, shader, material and then front to back, transparent keys by pass, shader and then back to front.
+    Draws with the same bucket key (pass and shader) need the same GL state, so they can be submitted together.
+    Knows nothing about GL so it can be benchmarked without a GPU. */
+class RenderQueue
+{
+public:
+
+	enum class EPass
+	{
+		SOLID,        // Opaque, OPAQUE and TRANSPARENT are taken by wingdi.h macros
+		ALPHA_TESTED, // Drawn after the opaque draws, discarding fragments disables early depth testing
+		BLENDED,      // Transparent
+		COUNT
+	};
+
+	struct Item
+	{
+		uint64 key;
+		uint index; // Of the draw in the caller's list
+	};
+
+public:
+
+	RenderQueue() {}
+	RenderQueue(const RenderQueue& copy) = delete;
+
+	/** Depth is the view depth divided by the far plane, values outside [0, 1] are clamped */
+	static uint64 makeKey(EPass pass, uint shaderID, uint materialID, float normalizedDepth);
+	static uint64 getBucketKey(uint64 a_key) { return a_key >> BUCKET_SHIFT; }
+
+	void clear()                             { m_items.clear(); }
+	void add(uint64 a_key, uint a_index)     { const Item item = { a_key, a_index }; m_items.push_back(item); }
+	/** Stable, items with equal keys keep the order they were added in */
+	void sort();
+
+	const eastl::vector<Item>& getItems() const { return m_items; }
+	uint getNumItems() const                    { return uint(m_items.size()); }
+
+public:
+
+	enum : uint
+	{
+		PASS_BITS     = 2,
+		SHADER_BITS   = 8,
+		MATERIAL_BITS = 16,
+		DEPTH_BITS    = 24,
+		BUCKET_SHIFT  = 64 - PASS_BITS - SHADER_BITS
+	};
+
+private:
+
+	eastl::vector<Item> m_items;
+	eastl::vector<Item> m_scratch;
+};
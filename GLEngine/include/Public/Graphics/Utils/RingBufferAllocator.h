@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+/** Hands out aligned ranges of a ring buffer that is written by the CPU while the GPU still reads the ranges of previous frames.
+    Every frame's ranges stay in use until the frame is released, which GLRingBuffer does once the fence of the frame signaled.
+    Knows nothing about GL so it can be tested without a GPU. */
+class RingBufferAllocator
+{
+public:
+
+	RingBufferAllocator() {}
+	RingBufferAllocator(const RingBufferAllocator& copy) = delete;
+
+	/** The size has to be a multiple of every alignment used */
+	void initialize(uint64 sizeBytes);
+	/** Returns INVALID_OFFSET when the ring is full with ranges of frames that were not released yet.
+	    A range never wraps around the end of the ring */
+	uint64 allocate(uint64 numBytes, uint64 alignment);
+	/** Closes the current frame, its ranges are kept until releaseOldestFrame is called for it */
+	void endFrame();
+	void releaseOldestFrame();
+
+	uint64 getSizeBytes() const       { return m_sizeBytes; }
+	/** Bytes between the oldest unreleased range and the next allocation, including alignment and wrap padding */
+	uint64 getUsedBytes() const       { return m_head - m_tail; }
+	uint getNumFramesInFlight() const { return uint(m_frameEnds.size()); }
+
+public:
+
+	static const uint64 INVALID_OFFSET;
+
+private:
+
+	// Positions keep increasing and are taken modulo the size, so a full ring can be told apart from an empty one
+	uint64 m_sizeBytes = 0;
+	uint64 m_head      = 0;
+	uint64 m_tail      = 0;
+	eastl::vector<uint64> m_frameEnds; // Head at the end of every frame in flight, oldest first
+};
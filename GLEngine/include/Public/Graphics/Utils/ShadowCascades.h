@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Core.h"
+#include "Graphics/Utils/PerspectiveCamera.h"
+
+#include <glm/glm.hpp>
+
+/** Splits the view of a camera into cascades that each get their own orthographic shadow camera along the sun direction.
+    The cascades are tiles of one shadow map atlas. Every cascade is fitted around a bounding sphere of its part of the view,
+    so its size does not change when the camera turns, and moved in whole texels so shadow edges do not shimmer when the camera moves.
+    The spheres are fitted with a margin and a cascade only moves when its part of the view gets close to leaving it, so the static casters
+    can be rendered once into a cached layer and only the dynamic casters have to be rendered on top every frame.
+    Knows nothing about GL so it can be tested without a GPU. */
+class ShadowCascades
+{
+public:
+
+	enum { MAX_CASCADES = 4 };
+
+	struct Settings
+	{
+		uint numCascades     = 4;
+		uint resolution      = 2048;   // Of one cascade
+		float splitLambda    = 0.75f;  // 0 splits the distance evenly, 1 logarithmic
+		float shadowDistance = 200.0f; // Beyond this or the far plane of the camera nothing is shadowed
+		float casterDistance = 100.0f; // How far towards the sun casters outside a cascade are still rendered into it
+		float cacheMargin    = 1.25f;  // Cascades are fitted this much larger than their part of the view so they can stay in place while it moves
+		uint numFullRateCascades = 2;  // The cascades after these render their dynamic casters only every farUpdateInterval frames
+		uint farUpdateInterval   = 4;
+	};
+
+	struct Cascade
+	{
+		float splitNear;
+		float splitFar;
+		glm::vec3 center; // Of the bounding sphere, after snapping to texels
+		float radius = 0.0f;
+		PerspectiveCamera camera;
+		glm::mat4 shadowMatrix; // From world space to the atlas texture coordinates and depth
+		glm::ivec4 viewport;    // Tile of the atlas in texels, x y width height
+		bool renderStatic  = true; // The cascade moved or was invalidated, the static casters have to be rendered into the cached layer this frame
+		bool renderDynamic = true; // The tile has to be copied from the cached layer and the dynamic casters rendered on top this frame
+	};
+
+public:
+
+	ShadowCascades() {}
+	ShadowCascades(const ShadowCascades& copy) = delete;
+
+	void setSettings(const Settings& settings);
+	/** Fits the cascades to the view of the camera, sunDirection points towards the sun */
+	void update(const PerspectiveCamera& camera, const glm::vec3& sunDirection);
+	/** The static casters of every cascade are rendered again in the next update, for when static geometry changed */
+	void invalidateStatic() { m_staticInvalid = true; }
+
+	/** Writes numCascades + 1 distances, the near and far plane of every cascade in turn */
+	static void calculateSplits(float near, float far, uint numCascades, float lambda, float* splits);
+	/** Number of tiles of the atlas horizontally and vertically */
+	static glm::ivec2 getAtlasGrid(uint numCascades);
+	static glm::ivec2 getAtlasSize(uint numCascades, uint resolution) { return getAtlasGrid(numCascades) * int(resolution); }
+
+	const Settings& getSettings() const         { return m_settings; }
+	uint getNumCascades() const                 { return m_settings.numCascades; }
+	const Cascade& getCascade(uint a_idx) const { return m_cascades[a_idx]; }
+	glm::ivec2 getAtlasSize() const             { return getAtlasSize(m_settings.numCascades, m_settings.resolution); }
+
+private:
+
+	void fitCascade(uint idx, glm::vec3 center, float radius);
+
+private:
+
+	Settings m_settings;
+	Cascade m_cascades[MAX_CASCADES];
+	glm::vec3 m_lightDirection = glm::vec3(0.0f); // Towards the ground, of the last update
+	glm::vec3 m_lightRight;
+	glm::vec3 m_lightUp;
+	glm::vec3 m_worldUp;
+	bool m_staticInvalid = true;
+	uint m_frame = 0;
+};
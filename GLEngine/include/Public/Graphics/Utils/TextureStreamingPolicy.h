@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/vector.h"
+
+typedef uint TextureStreamingHandle;
+
+/** Decides which mip levels of streamed textures are resident within a memory budget.
+    Textures report the finest level they need every frame. The policy loads the largest deficits first, at most a few levels per frame,
+    and only evicts levels that are no longer needed when the budget runs out, least recently requested first.
+    Knows nothing about GL so it can be simulated on the CPU. Level 0 is the finest level, the coarsest level is always resident. */
+class TextureStreamingPolicy
+{
+public:
+
+	struct Settings
+	{
+		uint64 budgetBytes            = 512ull * 1024 * 1024;
+		uint64 maxUploadBytesPerFrame = 32ull * 1024 * 1024; // At least one level is loaded per frame when there is a deficit
+		uint numKeepFrames            = 120;                 // Frames a requested level is still considered needed without new requests
+	};
+
+	struct Stats
+	{
+		uint64 residentBytes  = 0;
+		uint64 uploadedBytes  = 0; // Last update only
+		uint numLoads         = 0; // Levels loaded since creation
+		uint numEvictions     = 0; // Levels evicted since creation
+		uint numMissingLevels = 0; // Levels requested but not resident after the last update
+	};
+
+public:
+
+	TextureStreamingPolicy() {}
+	TextureStreamingPolicy(const TextureStreamingPolicy& copy) = delete;
+
+	void setSettings(const Settings& settings) { m_settings = settings; }
+	const Settings& getSettings() const        { return m_settings; }
+
+	/** Registers a texture with the byte size of every mip level, finest first. Starts with only the coarsest level resident */
+	TextureStreamingHandle addTexture(const eastl::vector<uint64>& levelByteSizes);
+	void removeTexture(TextureStreamingHandle handle);
+
+	/** Reports the finest level the texture needs this frame, multiple requests in a frame keep the finest */
+	void requestLevel(TextureStreamingHandle handle, uint level);
+	/** Applies this frame's requests and decides the new resident levels */
+	void update();
+
+	uint getResidentLevel(TextureStreamingHandle handle) const { return m_textures[handle].residentLevel; }
+	uint getNumLevels(TextureStreamingHandle handle) const     { return uint(m_textures[handle].levelByteSizes.size()); }
+	const Stats& getStats() const                              { return m_stats; }
+
+public:
+
+	static const TextureStreamingHandle INVALID_HANDLE;
+
+private:
+
+	struct StreamedTexture
+	{
+		eastl::vector<uint64> levelByteSizes;
+		uint residentLevel     = 0;
+		uint wantedLevel       = 0;
+		uint requestedLevel    = 0; // Finest level requested this frame, numLevels when none
+		uint64 lastNeededFrame = 0;
+		bool inUse             = false;
+
+		uint getCoarsestLevel() const { return uint(levelByteSizes.size()) - 1; }
+	};
+
+private:
+
+	/** Frees levels that are not wanted, least recently needed textures first, until the bytes fit in the budget */
+	bool evictUnneeded(uint64 numBytesNeeded);
+
+private:
+
+	Settings m_settings;
+	Stats m_stats;
+	uint64 m_frameIdx = 0;
+	eastl::vector<StreamedTexture> m_textures;
+	eastl::vector<TextureStreamingHandle> m_freeHandles;
+};
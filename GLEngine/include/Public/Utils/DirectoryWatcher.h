@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Core.h"
+#include "EASTL/string.h"
+#include "EASTL/vector.h"
+
+struct _OVERLAPPED;
+
+/** Reports files that are created, modified or renamed anywhere inside a directory tree, backed by ReadDirectoryChangesW */
+class DirectoryWatcher
+{
+public:
+	DirectoryWatcher() {}
+	DirectoryWatcher(const DirectoryWatcher& copy) = delete;
+	~DirectoryWatcher();
+
+	/** Returns false if the directory could not be opened */
+	bool initialize(const eastl::string& directoryPath);
+	/** Blocks until something changes or the timeout passes and adds the changed paths relative to the directory, without duplicates.
+	    Returns false if the OS dropped notifications, in which case anything may have changed. */
+	bool waitForChanges(uint timeoutMs, eastl::vector<eastl::string>& changedFilePaths);
+
+	bool isInitialized() const { return m_directory != NULL; }
+
+private:
+
+	bool startRead();
+
+private:
+
+	void* m_directory = NULL;
+	owner<_OVERLAPPED*> m_overlapped = NULL;
+	eastl::vector<uint> m_buffer; // Notifications are DWORD aligned
+};
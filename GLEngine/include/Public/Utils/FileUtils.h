@@ -25,6 +25,10 @@ public:
 	static eastl::string getExtensionForFilePath(const eastl::string& path);
 	static void createDirectoryForFile(const eastl::string& filePath);
 	static bool fileExists(const eastl::string& filePath);
+	/** Blocks until the contents of the file have reached the disk, also while the file is open for writing */
+	static bool flushFileToDisk(const eastl::string& filePath);
+	/** Atomically replaces the destination file (if any) with the source file, the rename is written through to disk */
+	static bool replaceFile(const eastl::string& srcFilePath, const eastl::string& dstFilePath);
 	static eastl::string getApplicationExePath();
 
 private:
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Core.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+/** Blocking fork/join helpers, the calling thread always takes part in the work. The work is handed to a pool of worker threads
+    that is created on first use and kept until exit. Calls from inside the work run on the calling thread alone */
+class ParallelUtils
+{
+public:
+
+	static uint getNumWorkers()
+	{
+		static const uint s_numWorkers = std::max(1u, uint(std::thread::hardware_concurrency()));
+		return s_numWorkers;
+	}
+
+	/** Splits [0, numItems) in contiguous ranges of at least minItemsPerRange and calls func(begin, end, rangeIdx) for every range */
+	template <typename Func>
+	static void forRanges(uint a_numItems, const Func& a_func, uint a_minItemsPerRange = 1)
+	{
+		const uint numRanges = getNumRanges(a_numItems, a_minItemsPerRange);
+		if (numRanges <= 1)
+		{
+			if (a_numItems)
+				a_func(0u, a_numItems, 0u);
+			return;
+		}
+
+		auto range = [&a_func, a_numItems, numRanges](uint a_rangeIdx)
+		{
+			const uint begin = uint(uint64(a_numItems) * a_rangeIdx / numRanges);
+			const uint end = uint(uint64(a_numItems) * (a_rangeIdx + 1) / numRanges);
+			a_func(begin, end, a_rangeIdx);
+		};
+		runTasks(numRanges, &callTask<decltype(range)>, &range);
+	}
+
+	/** Calls func(idx) for every idx in [0, numItems), items are handed out dynamically so uneven workloads balance out */
+	template <typename Func>
+	static void forEach(uint a_numItems, const Func& a_func)
+	{
+		const uint numWorkers = std::min(getNumWorkers(), a_numItems);
+		if (numWorkers <= 1)
+		{
+			for (uint i = 0; i < a_numItems; ++i)
+				a_func(i);
+			return;
+		}
+
+		std::atomic<uint> nextIdx(0);
+		auto worker = [&a_func, &nextIdx, a_numItems](uint)
+		{
+			for (uint i = nextIdx++; i < a_numItems; i = nextIdx++)
+				a_func(i);
+		};
+		runTasks(numWorkers, &callTask<decltype(worker)>, &worker);
+	}
+
+	static uint getNumRanges(uint a_numItems, uint a_minItemsPerRange)
+	{
+		const uint maxRanges = a_numItems / std::max(1u, a_minItemsPerRange);
+		return std::max(1u, std::min(getNumWorkers(), maxRanges));
+	}
+
+private:
+
+	typedef void(*TaskFunc)(const void* task, uint taskIdx);
+
+	template <typename Task>
+	static void callTask(const void* a_task, uint a_taskIdx)
+	{
+		(*scast<const Task*>(a_task))(a_taskIdx);
+	}
+
+	/** Calls func(task, taskIdx) for every taskIdx in [0, numTasks) on the pool and the calling thread, returns when all are done */
+	static void runTasks(uint numTasks, TaskFunc func, const void* task);
+
+private:
+	ParallelUtils() {}
+};
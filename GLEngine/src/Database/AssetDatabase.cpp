@@ -2,24 +2,51 @@
 
 #include "Database/AssetDatabaseEntry.h"
 #include "Database/Assets/IAsset.h"
+#include "Database/BuildStats.h"
+#include "Database/Utils/CRC64.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/sort.h"
 #include "Utils/FileUtils.h"
+#include "Utils/ParallelUtils.h"
 
 #include <assert.h>
+#include <climits>
+#include <string>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const char* const TEMP_FILE_SUFFIX = ".tmp";
+const uint64 WRITE_BLOCK_SIZE = 4 * 1024 * 1024;
+const uint NUM_ENCODE_BATCH_ASSETS_PER_WORKER = 2;
+
+uint64 getHeaderChecksum(uint64 a_assetTablePos, uint64 a_assetTableByteSize)
+{
+	const uint64 values[] = { a_assetTablePos, a_assetTableByteSize };
+	return CRC64::getHash(rcast<const byte*>(values), sizeof(values));
+}
+
+END_UNNAMED_NAMESPACE()
+
+AssetID AssetDatabase::getAssetID(const eastl::string& a_databaseEntryName)
+{
+	return CRC64::getHash(a_databaseEntryName.c_str());
+}
 
 void AssetDatabase::createNew(const eastl::string& a_filePath)
 {
 	assert(m_openMode == EOpenMode::UNOPENED);
 	
+	// Write to a temporary file so an existing database stays intact until the new one is complete
 	m_openMode = EOpenMode::WRITE;
-	m_file.open(a_filePath.c_str(), std::ios::out | std::ios::binary);
+	m_filePath = a_filePath;
+	m_file.rdbuf()->pubsetbuf(NULL, 0); // We do our own buffering in block sized writes
+	m_file.open((a_filePath + TEMP_FILE_SUFFIX).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
 	assert(m_file.is_open());
 	
 	// Ensure there is dummy data at the start of the file to hold asset table info
-	const uint64 assetTablePos = 0;
-	const uint64 assetTableByteSize = 0;
-	m_file.write(reinterpret_cast<const char*>(&assetTablePos), sizeof(assetTablePos));
-	m_file.write(reinterpret_cast<const char*>(&assetTableByteSize), sizeof(assetTableByteSize));
-	m_assetWritePos = sizeof(assetTablePos) + sizeof(assetTableByteSize);
+	const Header header;
+	m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_assetWritePos = sizeof(header);
 }
 
 bool AssetDatabase::openExisting(const eastl::string& a_filePath)
@@ -27,48 +54,217 @@ bool AssetDatabase::openExisting(const eastl::string& a_filePath)
 	assert(m_openMode == EOpenMode::UNOPENED);
 	
 	m_file.open(a_filePath.c_str(), std::ios::in | std::ios::binary);
-	if (m_file.is_open())
+	if (!m_file.is_open())
 	{
-		m_openMode = EOpenMode::READ;
+		print("Could not find AssetDatabase: %s, did you run the resource builder?\n", a_filePath.c_str());
+		return false;
 	}
-	else
+
+	m_openMode = EOpenMode::READ;
+	m_filePath = a_filePath;
+	if (!readAssetTable())
 	{
-		print("Could not find AssetDatabase: %s, did you run the resource builder?\n", a_filePath.c_str());
+		m_file.close();
+		m_openMode = EOpenMode::UNOPENED;
 		return false;
 	}
+	return true;
+}
+
+bool AssetDatabase::openForUpdate(const eastl::string& a_filePath)
+{
+	assert(m_openMode == EOpenMode::UNOPENED);
+
+	m_file.open(a_filePath.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+	if (!m_file.is_open())
+	{
+		print("Could not open AssetDatabase for update: %s\n", a_filePath.c_str());
+		return false;
+	}
+
+	m_openMode = EOpenMode::UPDATE;
+	m_filePath = a_filePath;
+	if (!readAssetTable())
+	{
+		m_file.close();
+		m_openMode = EOpenMode::UNOPENED;
+		return false;
+	}
+
+	// Everything is appended, the existing assets and table stay valid for readers until the header is replaced
+	m_file.seekp(0, std::ios::end);
+	m_assetWritePos = m_file.tellp();
+	return true;
+}
+
+bool AssetDatabase::readHeader(uint64& a_assetTablePos, uint64& a_assetTableByteSize)
+{
+	Header header;
+	m_file.clear();
+	m_file.seekg(0, std::ios::beg);
+	m_file.read(rcast<char*>(&header), sizeof(header));
+	if (!m_file || header.checksum != getHeaderChecksum(header.assetTablePos, header.assetTableByteSize))
+		return false;
+
+	a_assetTablePos = header.assetTablePos;
+	a_assetTableByteSize = header.assetTableByteSize;
+	return true;
+}
+
+void AssetDatabase::writeHeader()
+{
+	Header header;
+	header.assetTablePos = m_assetTablePos;
+	header.assetTableByteSize = m_assetTableByteSize;
+	header.checksum = getHeaderChecksum(m_assetTablePos, m_assetTableByteSize);
+	m_file.seekp(0, std::ios::beg);
+	m_file.write(rcast<const char*>(&header), sizeof(header));
+	m_file.flush();
+}
 
+bool AssetDatabase::readAssetTable()
+{
 	// Get the file size
+	m_file.clear();
 	m_file.seekg(0, std::ios::end);
 	const uint64 fileSize = m_file.tellg();
 	
 	// Read the position and size of the asset table
-	uint64 assetTablePos, assetTableByteSize;
-	m_file.seekg(0, std::ios::beg);
-	m_file.read(rcast<char*>(&assetTablePos), sizeof(assetTablePos));
-	m_file.read(rcast<char*>(&assetTableByteSize), sizeof(assetTableByteSize));
+	uint64 assetTablePos = 0, assetTableByteSize = 0;
+	if (!readHeader(assetTablePos, assetTableByteSize) || !assetTableByteSize || assetTablePos + assetTableByteSize > fileSize)
+	{
+		print("AssetDatabase: %s has no valid asset table, it may be from an older build\n", m_filePath.c_str());
+		return false;
+	}
 
+	// Parse into locals so a damaged table leaves the tables that are already open untouched
+	const uint64 minEntryByteSize = sizeof(uint) + 2 * sizeof(uint64);
+	eastl::hash_map<eastl::string, AssetDatabaseEntry> writtenAssets;
 	AssetDatabaseEntry assetTableEntry(m_file, assetTablePos, assetTableByteSize);
-	uint assetTableNumElements;
+	uint assetTableNumElements = 0;
 	assetTableEntry.readVal(assetTableNumElements);
-	print("Opening DB: %s, num assets: %i filesize: %i MB\n", a_filePath.c_str(), assetTableNumElements, fileSize / 1024 / 1024);
-	for (uint i = 0; i < assetTableNumElements; ++i)
+	bool valid = assetTableNumElements <= assetTableByteSize / minEntryByteSize;
+	for (uint i = 0; i < assetTableNumElements && valid; ++i)
 	{
 		eastl::string filePath;
-		uint64 filePos, byteSize;
+		uint64 filePos = 0, byteSize = 0;
 		assetTableEntry.readString(filePath);
 		assetTableEntry.readVal(filePos);
 		assetTableEntry.readVal(byteSize);
+		valid = filePos + byteSize <= fileSize;
 		AssetDatabaseEntry entry(m_file, filePos, byteSize);
-		m_writtenAssets.insert({filePath, entry});
+		writtenAssets.insert({filePath, entry});
+	}
+
+	// The id table follows the named entries, databases built before it existed are rejected with their header
+	eastl::vector<uint> seeds;
+	eastl::vector<IDTableSlot> idTable;
+	if (valid)
+	{
+		assetTableEntry.readVector(seeds);
+		assetTableEntry.readVector(idTable);
+	}
+	valid = valid && m_file && assetTableEntry.validateRead() && idTable.size() == writtenAssets.size() && (!seeds.empty() || idTable.empty());
+	PerfectHash idHash;
+	if (valid)
+	{
+		idHash.initialize(seeds, uint(idTable.size()));
+		for (auto it = writtenAssets.begin(); it != writtenAssets.end() && valid; ++it)
+			valid = idTable[idHash.getSlot(getAssetID(it->first))].id == getAssetID(it->first);
+	}
+	if (!valid)
+	{
+		print("AssetDatabase: the asset table of %s is damaged\n", m_filePath.c_str());
+		return false;
+	}
+
+	print("Opening DB: %s, num assets: %i filesize: %i MB\n", m_filePath.c_str(), assetTableNumElements, fileSize / 1024 / 1024);
+	m_assetTablePos = assetTablePos;
+	m_assetTableByteSize = assetTableByteSize;
+	m_writtenAssets.swap(writtenAssets);
+	m_idTable.swap(idTable);
+	m_idHash = idHash;
+
+	// Only readers cache assets by id, an update rebuilds the table when it is committed
+	if (m_openMode == EOpenMode::READ)
+	{
+		m_idTableAssets.clear();
+		m_idTableNames.clear();
+		m_idTableAssets.resize(m_idTable.size(), NULL);
+		m_idTableNames.resize(m_idTable.size(), NULL);
+		for (const auto& pair : m_writtenAssets)
+		{
+			const int slot = findIDTableSlot(getAssetID(pair.first));
+			assert(slot >= 0);
+			m_idTableNames[slot] = &pair.first;
+		}
 	}
 	return true;
 }
 
+eastl::vector<eastl::string> AssetDatabase::refresh()
+{
+	assert(m_openMode == EOpenMode::READ);
+	eastl::vector<eastl::string> changedAssets;
+
+	// The updater points the header at a new table once everything it references is on disk, so the header is all we need to check.
+	// A header that does not match its checksum is being written, the next refresh picks it up
+	uint64 assetTablePos = 0, assetTableByteSize = 0;
+	if (!readHeader(assetTablePos, assetTableByteSize) || (assetTablePos == m_assetTablePos && assetTableByteSize == m_assetTableByteSize))
+		return changedAssets;
+
+	// Keep the previous table to compare against and to hand over the cached assets that are still valid
+	eastl::hash_map<eastl::string, AssetDatabaseEntry> prevAssets;
+	eastl::vector<owner<IAsset*>> prevIDTableAssets;
+	eastl::vector<const eastl::string*> prevIDTableNames;
+	prevAssets.swap(m_writtenAssets);
+	prevIDTableAssets.swap(m_idTableAssets);
+	prevIDTableNames.swap(m_idTableNames);
+	if (!readAssetTable())
+	{	// Nothing was replaced, keep using the previous table and try again on the next refresh
+		prevAssets.swap(m_writtenAssets);
+		prevIDTableAssets.swap(m_idTableAssets);
+		prevIDTableNames.swap(m_idTableNames);
+		return changedAssets;
+	}
+
+	auto isUnchanged = [&](const eastl::string& a_name)
+	{
+		const auto it = m_writtenAssets.find(a_name);
+		const auto prevIt = prevAssets.find(a_name);
+		return it != m_writtenAssets.end() && prevIt != prevAssets.end() &&
+			it->second.getFileStartPos() == prevIt->second.getFileStartPos() && it->second.getTotalSize() == prevIt->second.getTotalSize();
+	};
+	for (const auto& pair : m_writtenAssets)
+		if (!isUnchanged(pair.first))
+			changedAssets.push_back(pair.first);
+
+	for (uint i = 0; i < prevIDTableAssets.size(); ++i)
+	{
+		if (!prevIDTableAssets[i])
+			continue;
+		const eastl::string& name = *prevIDTableNames[i];
+		if (isUnchanged(name))
+			m_idTableAssets[findIDTableSlot(getAssetID(name))] = prevIDTableAssets[i];
+		else
+			delete prevIDTableAssets[i];
+	}
+
+	print("Refreshed DB: %s, %u changed assets\n", m_filePath.c_str(), uint(changedAssets.size()));
+	return changedAssets;
+}
+
 void AssetDatabase::addAsset(const eastl::string& a_databaseEntryName, owner<IAsset*> a_asset)
 {
 	const auto unwrittenIt = m_loadedAssets.find(a_databaseEntryName);
 	const auto writtenIt = m_writtenAssets.find(a_databaseEntryName);
-	if (unwrittenIt != m_loadedAssets.end() || writtenIt != m_writtenAssets.end())
+	if (m_openMode == EOpenMode::UPDATE && writtenIt != m_writtenAssets.end())
+	{	// The old data stays in the file but is no longer referenced once the update is committed
+		print("Replacing asset: %s\n", a_databaseEntryName.c_str());
+		m_writtenAssets.erase(writtenIt);
+		m_loadedAssets.insert(eastl::make_pair(a_databaseEntryName, a_asset));
+	}
+	else if (unwrittenIt != m_loadedAssets.end() || writtenIt != m_writtenAssets.end())
 	{
 		print("Asset with name: %s already exists\n", a_databaseEntryName.c_str());
 		assert(false);
@@ -88,36 +284,115 @@ IAsset* AssetDatabase::loadAsset(const eastl::string& a_databaseEntryName, EAsse
 	if (unwrittenIt != m_loadedAssets.end())
 		return unwrittenIt->second;
 
-	auto writtenIt = m_writtenAssets.find(a_databaseEntryName);
-	if (writtenIt != m_writtenAssets.end())
+	return loadAsset(getAssetID(a_databaseEntryName), a_type);
+}
+
+IAsset* AssetDatabase::loadAsset(AssetID a_id, EAssetType a_type)
+{
+	assert(m_openMode == EOpenMode::READ);
+
+	const int slot = findIDTableSlot(a_id);
+	if (slot < 0)
+		return NULL;
+	if (m_idTableAssets[slot])
+		return m_idTableAssets[slot];
+
+	const IDTableSlot& tableSlot = m_idTable[slot];
+	AssetDatabaseEntry entry(m_file, tableSlot.filePos, tableSlot.byteSize);
+	IAsset* asset = IAsset::create(a_type);
+	asset->read(entry);
+	m_idTableAssets[slot] = asset;
+	if (m_loadTraceFile.is_open())
+		m_loadTraceFile << m_idTableNames[slot]->c_str() << std::endl;
+	return asset;
+}
+
+int AssetDatabase::findIDTableSlot(AssetID a_id) const
+{
+	if (m_idHash.isEmpty())
+		return -1;
+	const uint slot = m_idHash.getSlot(a_id);
+	return m_idTable[slot].id == a_id ? int(slot) : -1;
+}
+
+void AssetDatabase::buildIDTable()
+{
+	eastl::vector<AssetID> ids;
+	ids.reserve(m_writtenAssets.size());
+	for (const auto& pair : m_writtenAssets)
+		ids.push_back(getAssetID(pair.first));
+
+	const bool built = m_idHash.build(ids);
+	assert(built);
+
+	m_idTable.clear();
+	m_idTable.resize(ids.size());
+	for (const auto& pair : m_writtenAssets)
 	{
-		IAsset* asset = IAsset::create(a_type);
-		asset->read(writtenIt->second);
-		m_loadedAssets.insert({a_databaseEntryName, asset});
-		return asset;
+		IDTableSlot& tableSlot = m_idTable[m_idHash.getSlot(getAssetID(pair.first))];
+		if (tableSlot.byteSize)
+		{	// Two names with the same 64 bit hash, the perfect hash build should already have failed
+			print("Asset id collision: %s\n", pair.first.c_str());
+			assert(false);
+		}
+		tableSlot.id = getAssetID(pair.first);
+		tableSlot.filePos = pair.second.getFileStartPos();
+		tableSlot.byteSize = pair.second.getTotalSize();
 	}
-	return NULL;
 }
 
 void AssetDatabase::writeLoadedAssets()
 {
-	assert(m_openMode == EOpenMode::WRITE);
+	assert(m_openMode == EOpenMode::WRITE || m_openMode == EOpenMode::UPDATE);
 
-	for (auto& pair : m_loadedAssets)
-	{	// Create db entry to hold the asset
-		print("Writing %s\n", pair.first.c_str());
-		uint64 size = pair.second->getByteSize();
-		AssetDatabaseEntry entry(m_file, m_assetWritePos, size);
-		m_assetWritePos += size;
-		
-		// Write the asset
-		pair.second->write(entry);
-		assert(entry.validateWritten());
-		SAFE_DELETE(pair.second);
-		m_writtenAssets.insert({pair.first, entry});
-		print("Done writing %s\n", pair.first.c_str());
-	}
+	eastl::vector<eastl::pair<eastl::string, owner<IAsset*>>> assets(m_loadedAssets.begin(), m_loadedAssets.end());
 	m_loadedAssets.clear();
+
+	// Order by load trace so assets needed together are contiguous, by name otherwise to keep builds deterministic
+	auto getWriteOrder = [this](const eastl::string& a_name)
+	{
+		const auto it = m_writeOrder.find(a_name);
+		return it != m_writeOrder.end() ? it->second : UINT_MAX;
+	};
+	eastl::sort(assets.begin(), assets.end(), [&](const eastl::pair<eastl::string, owner<IAsset*>>& a, const eastl::pair<eastl::string, owner<IAsset*>>& b)
+	{
+		const uint orderA = getWriteOrder(a.first);
+		const uint orderB = getWriteOrder(b.first);
+		return orderA != orderB ? orderA < orderB : a.first < b.first;
+	});
+
+	// Encode a batch of assets into memory buffers in parallel, then append the buffers to the file sequentially.
+	// Working in batches keeps the memory use bounded to a few encoded assets per worker.
+	const uint batchSize = ParallelUtils::getNumWorkers() * NUM_ENCODE_BATCH_ASSETS_PER_WORKER;
+	eastl::vector<eastl::vector<byte>> buffers(batchSize);
+	for (uint batchStart = 0; batchStart < assets.size(); batchStart += batchSize)
+	{
+		const uint numInBatch = eastl::min(batchSize, uint(assets.size()) - batchStart);
+		ParallelUtils::forEach(numInBatch, [&](uint a_idx)
+		{
+			auto& pair = assets[batchStart + a_idx];
+			BuildStats::ScopedAsset statsAsset(pair.first);
+			BuildStats::ScopedStageTimer timer(BuildStats::EStage::ENCODE);
+			eastl::vector<byte>& buffer = buffers[a_idx];
+			buffer.resize(pair.second->getByteSize());
+			AssetDatabaseEntry entry(buffer);
+			pair.second->write(entry);
+			assert(entry.validateWritten());
+			BuildStats::addAssetOutput(pair.second->getAssetType(), buffer.size());
+			SAFE_DELETE(pair.second);
+		});
+
+		for (uint i = 0; i < numInBatch; ++i)
+		{
+			const eastl::string& name = assets[batchStart + i].first;
+			BuildStats::ScopedAsset statsAsset(name);
+			BuildStats::ScopedStageTimer timer(BuildStats::EStage::WRITE);
+			const uint64 size = buffers[i].size();
+			m_writtenAssets.insert({name, AssetDatabaseEntry(m_file, m_assetWritePos, size)});
+			appendToFile(buffers[i].data(), size);
+			print("Written %s, %llu bytes\n", name.c_str(), size);
+		}
+	}
 }
 
 void AssetDatabase::writeAndClose()
@@ -125,10 +400,50 @@ void AssetDatabase::writeAndClose()
 	assert(m_openMode == EOpenMode::WRITE);
 	// Write any remaining unwritten assets
 	writeLoadedAssets();
+	writeAssetTable();
+	writeHeader();
+
+	// Close the file since nothing should be written after the asset table
+	m_file.close();
+	m_openMode = EOpenMode::UNOPENED;
+
+	// Only swap in the new database once all of it has reached the disk, so a crash leaves either the old or the new file
+	const eastl::string tempFilePath = m_filePath + TEMP_FILE_SUFFIX;
+	if (!FileUtils::flushFileToDisk(tempFilePath) || !FileUtils::replaceFile(tempFilePath, m_filePath))
+	{
+		print("Failed to replace AssetDatabase: %s with %s\n", m_filePath.c_str(), tempFilePath.c_str());
+		assert(false);
+	}
+}
+
+void AssetDatabase::commitUpdate()
+{
+	assert(m_openMode == EOpenMode::UPDATE);
+	writeLoadedAssets();
+	// Nothing that the old table references is overwritten, so a crash before the header is patched leaves the previous state.
+	// The new assets and table have to be on disk before the header points at them, and the header before the update counts as done
+	writeAssetTable();
+	if (!FileUtils::flushFileToDisk(m_filePath))
+	{
+		print("Failed to flush the asset table of AssetDatabase: %s\n", m_filePath.c_str());
+		assert(false);
+		return;
+	}
+	writeHeader();
+	if (!FileUtils::flushFileToDisk(m_filePath))
+	{
+		print("Failed to flush the header of AssetDatabase: %s\n", m_filePath.c_str());
+		assert(false);
+	}
+	m_file.seekp(m_assetWritePos, std::ios::beg);
+}
+
+void AssetDatabase::writeAssetTable()
+{
+	buildIDTable();
 
 	// Get the position and size of the asset table
-	m_file.seekg(0, std::ios::end);
-	const uint64 assetTablePos = m_file.tellg();
+	const uint64 assetTablePos = m_assetWritePos;
 	uint64 assetTableByteSize = AssetDatabaseEntry::getValWriteSize(uint(m_writtenAssets.size()));
 	for (const auto& pair : m_writtenAssets)
 	{
@@ -136,13 +451,12 @@ void AssetDatabase::writeAndClose()
 		assetTableByteSize += AssetDatabaseEntry::getValWriteSize(pair.second.getFileStartPos());
 		assetTableByteSize += AssetDatabaseEntry::getValWriteSize(pair.second.getTotalSize());
 	}
-	// Write the position and size of the asset table at the beginning of the asset file (overwriting placeholders)
-	m_file.seekp(0, std::ios::beg);
-	m_file.write(rcast<const char*>(&assetTablePos), sizeof(assetTablePos));
-	m_file.write(rcast<const char*>(&assetTableByteSize), sizeof(assetTableByteSize));
+	assetTableByteSize += AssetDatabaseEntry::getVectorWriteSize(m_idHash.getSeeds());
+	assetTableByteSize += AssetDatabaseEntry::getVectorWriteSize(m_idTable);
 
-	// Create an entry object to make it easy to write to the file.
-	AssetDatabaseEntry assetTableEntry(m_file, assetTablePos, assetTableByteSize);
+	// Encode the table in memory and append it after the assets
+	eastl::vector<byte> assetTable(assetTableByteSize);
+	AssetDatabaseEntry assetTableEntry(assetTable);
 	// Write the number of elements in the table
 	assetTableEntry.writeVal(uint(m_writtenAssets.size()));
 	// For ever asset, write the file path, start byte position in the file, and the size in bytes
@@ -152,9 +466,77 @@ void AssetDatabase::writeAndClose()
 		assetTableEntry.writeVal(pair.second.getFileStartPos());
 		assetTableEntry.writeVal(pair.second.getTotalSize());
 	}
-	// Close the file since nothing should be written after the asset table
-	m_file.close();
-	m_openMode = EOpenMode::UNOPENED;
+	// Followed by the perfect hash for id lookups
+	assetTableEntry.writeVector(m_idHash.getSeeds());
+	assetTableEntry.writeVector(m_idTable);
+	assert(assetTableEntry.validateWritten());
+	appendToFile(assetTable.data(), assetTable.size());
+	flushWriteBuffer();
+	// The table has to be in the file before the header points at it
+	m_file.flush();
+	m_assetTablePos = assetTablePos;
+	m_assetTableByteSize = assetTableByteSize;
+}
+
+bool AssetDatabase::setWriteOrderFromTrace(const eastl::string& a_traceFilePath)
+{
+	std::ifstream file(a_traceFilePath.c_str());
+	if (!file.is_open())
+		return false;
+
+	m_writeOrder.clear();
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (!line.empty())
+			m_writeOrder.insert(eastl::make_pair(eastl::string(line.c_str()), uint(m_writeOrder.size()))); // Keeps the first occurrence
+	}
+	print("Using asset load order from %s, %u assets\n", a_traceFilePath.c_str(), uint(m_writeOrder.size()));
+	return true;
+}
+
+void AssetDatabase::startLoadTrace(const eastl::string& a_traceFilePath)
+{
+	m_loadTraceFile.close();
+	m_loadTraceFile.open(a_traceFilePath.c_str(), std::ios::out | std::ios::trunc);
+	if (!m_loadTraceFile.is_open())
+		print("Could not open load trace file: %s\n", a_traceFilePath.c_str());
+}
+
+/** Appends through a staging buffer so the file only sees large writes that end on block boundaries */
+void AssetDatabase::appendToFile(const byte* a_data, uint64 a_size)
+{
+	while (a_size)
+	{
+		const uint64 spaceInBlock = WRITE_BLOCK_SIZE - (m_assetWritePos % WRITE_BLOCK_SIZE);
+		if (m_writeBuffer.empty() && spaceInBlock == WRITE_BLOCK_SIZE && a_size >= WRITE_BLOCK_SIZE)
+		{	// Block aligned with nothing staged, write the whole blocks straight from the source
+			const uint64 numBytes = a_size - (a_size % WRITE_BLOCK_SIZE);
+			m_file.write(rcast<const char*>(a_data), numBytes);
+			m_assetWritePos += numBytes;
+			a_data += numBytes;
+			a_size -= numBytes;
+			continue;
+		}
+
+		const uint64 numBytes = eastl::min(a_size, spaceInBlock);
+		m_writeBuffer.insert(m_writeBuffer.end(), a_data, a_data + numBytes);
+		m_assetWritePos += numBytes;
+		a_data += numBytes;
+		a_size -= numBytes;
+		if (m_assetWritePos % WRITE_BLOCK_SIZE == 0)
+			flushWriteBuffer();
+	}
+}
+
+void AssetDatabase::flushWriteBuffer()
+{
+	if (m_writeBuffer.empty())
+		return;
+	m_file.write(rcast<const char*>(m_writeBuffer.data()), m_writeBuffer.size());
+	m_writeBuffer.clear();
 }
 
 void AssetDatabase::unloadAsset(const eastl::string& a_databaseEntryName)
@@ -165,7 +547,12 @@ void AssetDatabase::unloadAsset(const eastl::string& a_databaseEntryName)
 		IAsset* asset = it->second;
 		delete asset;
 		m_loadedAssets.erase(it);
+		return;
 	}
+
+	const int slot = findIDTableSlot(getAssetID(a_databaseEntryName));
+	if (slot >= 0)
+		SAFE_DELETE(m_idTableAssets[slot]);
 }
 
 void AssetDatabase::unloadAsset(IAsset* a_asset)
@@ -180,6 +567,14 @@ void AssetDatabase::unloadAsset(IAsset* a_asset)
 			return;
 		}
 	}
+	for (owner<IAsset*>& asset : m_idTableAssets)
+	{
+		if (asset == a_asset)
+		{
+			SAFE_DELETE(asset);
+			return;
+		}
+	}
 }
 
 bool AssetDatabase::hasAsset(const eastl::string& a_databaseEntryName) const
@@ -190,6 +585,11 @@ bool AssetDatabase::hasAsset(const eastl::string& a_databaseEntryName) const
 	return found; 
 }
 
+bool AssetDatabase::hasAsset(AssetID a_id) const
+{
+	return findIDTableSlot(a_id) >= 0;
+}
+
 eastl::vector<eastl::string> AssetDatabase::listAssets() const
 {
 	eastl::vector<eastl::string> result;
@@ -50,6 +50,18 @@ DBMesh::DBMesh(const aiMesh& a_assimpMesh)
 	}
 }
 
+DBMesh::DBMesh(const eastl::string& a_name, eastl::vector<Vertex>&& a_vertices, eastl::vector<uint>&& a_indices)
+	: m_name(a_name)
+	, m_vertices(eastl::move(a_vertices))
+	, m_indices(eastl::move(a_indices))
+{
+	for (const Vertex& v : m_vertices)
+	{
+		m_boundsMin = glm::min(m_boundsMin, v.position);
+		m_boundsMax = glm::max(m_boundsMax, v.position);
+	}
+}
+
 void DBMesh::merge(const DBMesh& a_mesh, const glm::mat4& a_transform)
 {
 	m_name += ":MERGED:" + a_mesh.getName();
@@ -1,6 +1,8 @@
 #include "Database/Assets/DBScene.h"
 
+#include "Database/BuildStats.h"
 #include "Database/Utils/AtlasBuilder.h"
+#include "Database/Utils/ObjImporter.h"
 #include "EASTL/string.h"
 #include "Utils/FileUtils.h"
 
@@ -23,7 +25,58 @@ uint processNodes(eastl::vector<DBNode>& a_nodes, const aiNode* a_assimpNode, ui
 
 END_UNNAMED_NAMESPACE()
 
-DBScene::DBScene(const eastl::string& a_sceneFilePath)
+DBScene::DBScene(const eastl::string& a_sceneFilePath, EImporter a_importer)
+{
+	build(a_sceneFilePath, a_importer);
+}
+
+bool DBScene::build(const eastl::string& a_sceneFilePath, EImporter a_importer)
+{
+	if (!importScene(a_sceneFilePath, a_importer))
+	{
+		print("Failed to import scene: %s\n", a_sceneFilePath.c_str());
+		return false;
+	}
+
+	if (BuildStats::isActive())
+	{
+		uint64 numVertices = 0;
+		uint64 numIndices = 0;
+		for (const DBMesh& mesh : m_meshes)
+		{
+			numVertices += mesh.getVertices().size();
+			numIndices += mesh.getIndices().size();
+		}
+		BuildStats::addMeshCounts(uint(m_meshes.size()), numVertices, numIndices);
+	}
+
+	m_atlasTextures = AtlasBuilder::createAtlases(m_materials, FileUtils::getFolderPathForFile(a_sceneFilePath));
+	return true;
+}
+
+bool DBScene::importScene(const eastl::string& a_sceneFilePath, EImporter a_importer)
+{
+	BuildStats::ScopedStageTimer timer(BuildStats::EStage::IMPORT);
+	m_nodes.clear();
+	m_meshes.clear();
+	m_materials.clear();
+
+	const bool isObj = FileUtils::getFileExtension(a_sceneFilePath) == "obj";
+	if (a_importer == EImporter::OBJ || (a_importer == EImporter::AUTO && isObj))
+	{
+		if (ObjImporter::importScene(a_sceneFilePath, m_nodes, m_meshes, m_materials))
+			return true;
+		if (a_importer == EImporter::OBJ)
+			return false;
+		print("Obj fast path failed, falling back to assimp: %s\n", a_sceneFilePath.c_str());
+		m_nodes.clear();
+		m_meshes.clear();
+		m_materials.clear();
+	}
+	return importAssimp(a_sceneFilePath);
+}
+
+bool DBScene::importAssimp(const eastl::string& a_sceneFilePath)
 {
 	const uint flags = 0
 	// Required flags
@@ -44,7 +97,8 @@ DBScene::DBScene(const eastl::string& a_sceneFilePath)
 	| 0;
 
 	const aiScene* assimpScene = aiImportFile(a_sceneFilePath.c_str(), flags);
-	const eastl::string baseAssetPath = FileUtils::getFolderPathForFile(a_sceneFilePath);
+	if (!assimpScene)
+		return false;
 
 	processNodes(m_nodes, assimpScene->mRootNode, 0);
 
@@ -57,12 +111,12 @@ DBScene::DBScene(const eastl::string& a_sceneFilePath)
 		m_materials[i] = DBMaterial(*assimpScene->mMaterials[i]);
 
 	aiReleaseImport(assimpScene);
-
-	m_atlasTextures = AtlasBuilder::createAtlases(m_materials, baseAssetPath);
+	return true;
 }
 
 void DBScene::mergeMeshes()
 {
+	BuildStats::ScopedStageTimer timer(BuildStats::EStage::MERGE);
 	DBMesh mergedMesh;
 	mergeMeshes(mergedMesh, m_nodes[0], glm::mat4(1));
 
@@ -112,6 +166,19 @@ uint64 DBScene::getByteSize() const
 
 void DBScene::write(AssetDatabaseEntry& entry)
 {
+	if (BuildStats::isActive())
+	{
+		for (const DBNode& node : m_nodes)
+			BuildStats::addOutputSize(EAssetType::NODE, node.getByteSize());
+		for (const DBMesh& mesh : m_meshes)
+			BuildStats::addOutputSize(EAssetType::MESH, mesh.getByteSize());
+		for (const DBMaterial& material : m_materials)
+			BuildStats::addOutputSize(EAssetType::MATERIAL, material.getByteSize());
+		for (const eastl::vector<DBAtlasTexture>& atlasTextures : m_atlasTextures)
+			for (const DBAtlasTexture& atlasTexture : atlasTextures)
+				BuildStats::addOutputSize(EAssetType::ATLAS_TEXTURE, atlasTexture.getByteSize());
+	}
+
 	entry.writeVal(uint(m_nodes.size()));
 	for (uint i = 0; i < m_nodes.size(); ++i)
 		m_nodes[i].write(entry);
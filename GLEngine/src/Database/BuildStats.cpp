@@ -0,0 +1,285 @@
+#include "Database/BuildStats.h"
+
+#include "EASTL/algorithm.h"
+#include "EASTL/array.h"
+#include "EASTL/hash_map.h"
+#include "EASTL/sort.h"
+#include "EASTL/vector.h"
+#include "json/json.h"
+#include "Utils/Mutex.h"
+#include "Utils/ScopeLock.h"
+
+#include <assert.h>
+#include <atomic>
+#include <fstream>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint NUM_STAGES = uint(BuildStats::EStage::COUNT);
+const uint NUM_LARGEST_CONTRIBUTORS = 10;
+const char* const STAGE_NAMES[NUM_STAGES] = { "import", "merge", "atlasPack", "composite", "encode", "write" };
+const char* const UNATTRIBUTED_ASSET_NAME = "<unattributed>";
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct AssetStats
+{
+	eastl::string name;
+	const char* typeName = "";
+	uint64 outputSize    = 0;
+	uint numMeshes       = 0;
+	uint64 numVertices   = 0;
+	uint64 numIndices    = 0;
+	eastl::array<uint64, NUM_STAGES> stageMicroSec = {};
+
+	uint64 getTotalMicroSec() const
+	{
+		uint64 total = 0;
+		for (uint64 t : stageMicroSec)
+			total += t;
+		return total;
+	}
+};
+
+struct AtlasPageStats
+{
+	eastl::string assetName;
+	const char* texType;
+	uint pageIdx;
+	uint width;
+	uint height;
+	uint numRegions;
+	uint64 usedPixels;
+
+	double getOccupancy() const { return double(usedPixels) / double(uint64(width) * height); }
+};
+
+// Read without s_mutex by the threads of parallel imports and encodes while the builder thread begins and ends the build
+std::atomic<bool> s_active(false);
+Clock::time_point s_buildStartTime;
+Mutex s_mutex;
+eastl::vector<AssetStats> s_assets;
+eastl::hash_map<eastl::string, uint> s_assetLookup;
+eastl::vector<AtlasPageStats> s_atlasPages;
+eastl::hash_map<eastl::string, uint64> s_sizeByType;
+thread_local const eastl::string* t_currentAssetName = NULL;
+
+const char* getAssetTypeName(EAssetType a_type)
+{
+	switch (a_type)
+	{
+	case EAssetType::SCENE:         return "scene";
+	case EAssetType::ATLAS_REGION:  return "atlasRegion";
+	case EAssetType::ATLAS_TEXTURE: return "atlasTexture";
+	case EAssetType::MATERIAL:      return "material";
+	case EAssetType::MESH:          return "mesh";
+	case EAssetType::NODE:          return "node";
+	case EAssetType::SHADER:        return "shader";
+	case EAssetType::TEXTURE:       return "texture";
+	default: assert(false);         return "unknown";
+	}
+}
+
+/** Stats of the asset the calling thread is working on, s_mutex must be held */
+AssetStats& getCurrentAssetStats()
+{
+	const eastl::string name = t_currentAssetName ? *t_currentAssetName : eastl::string(UNATTRIBUTED_ASSET_NAME);
+	auto it = s_assetLookup.find(name);
+	if (it == s_assetLookup.end())
+	{
+		it = s_assetLookup.insert(eastl::make_pair(name, uint(s_assets.size()))).first;
+		s_assets.push_back(AssetStats());
+		s_assets.back().name = name;
+	}
+	return s_assets[it->second];
+}
+
+double toMs(uint64 a_microSec)
+{
+	return double(a_microSec) / 1000.0;
+}
+
+Json::Value toJson(const eastl::array<uint64, NUM_STAGES>& a_stageMicroSec)
+{
+	Json::Value stages(Json::objectValue);
+	for (uint i = 0; i < NUM_STAGES; ++i)
+		stages[STAGE_NAMES[i]] = toMs(a_stageMicroSec[i]);
+	return stages;
+}
+
+END_UNNAMED_NAMESPACE()
+
+BuildStats::ScopedStageTimer::ScopedStageTimer(EStage a_stage)
+	: m_stage(a_stage)
+	, m_startTime(Clock::now())
+{
+}
+
+BuildStats::ScopedStageTimer::~ScopedStageTimer()
+{
+	if (!s_active)
+		return;
+	const uint64 elapsed = uint64(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_startTime).count());
+	ScopeLock lock(s_mutex);
+	getCurrentAssetStats().stageMicroSec[uint(m_stage)] += elapsed;
+}
+
+BuildStats::ScopedAsset::ScopedAsset(const eastl::string& a_assetName)
+	: m_assetName(a_assetName)
+	, m_prevAssetName(t_currentAssetName)
+{
+	t_currentAssetName = &m_assetName;
+}
+
+BuildStats::ScopedAsset::~ScopedAsset()
+{
+	t_currentAssetName = m_prevAssetName;
+}
+
+void BuildStats::beginBuild()
+{
+	ScopeLock lock(s_mutex);
+	s_assets.clear();
+	s_assetLookup.clear();
+	s_atlasPages.clear();
+	s_sizeByType.clear();
+	s_buildStartTime = Clock::now();
+	s_active = true;
+}
+
+bool BuildStats::isActive()
+{
+	return s_active;
+}
+
+void BuildStats::addMeshCounts(uint a_numMeshes, uint64 a_numVertices, uint64 a_numIndices)
+{
+	if (!s_active)
+		return;
+	ScopeLock lock(s_mutex);
+	AssetStats& stats = getCurrentAssetStats();
+	stats.numMeshes += a_numMeshes;
+	stats.numVertices += a_numVertices;
+	stats.numIndices += a_numIndices;
+}
+
+void BuildStats::addAtlasPage(const char* a_texType, uint a_pageIdx, uint a_width, uint a_height, uint a_numRegions, uint64 a_usedPixels)
+{
+	if (!s_active)
+		return;
+	ScopeLock lock(s_mutex);
+	const AtlasPageStats page = { getCurrentAssetStats().name, a_texType, a_pageIdx, a_width, a_height, a_numRegions, a_usedPixels };
+	s_atlasPages.push_back(page);
+}
+
+void BuildStats::addAssetOutput(EAssetType a_type, uint64 a_byteSize)
+{
+	if (!s_active)
+		return;
+	ScopeLock lock(s_mutex);
+	AssetStats& stats = getCurrentAssetStats();
+	stats.typeName = getAssetTypeName(a_type);
+	stats.outputSize += a_byteSize;
+	// Scenes report their contents by type while being written
+	if (a_type != EAssetType::SCENE)
+		s_sizeByType[getAssetTypeName(a_type)] += a_byteSize;
+}
+
+void BuildStats::addOutputSize(EAssetType a_type, uint64 a_byteSize)
+{
+	if (!s_active)
+		return;
+	ScopeLock lock(s_mutex);
+	s_sizeByType[getAssetTypeName(a_type)] += a_byteSize;
+}
+
+void BuildStats::endBuild(const eastl::string& a_reportFilePath)
+{
+	assert(s_active);
+	ScopeLock lock(s_mutex);
+	s_active = false;
+
+	const uint64 buildMicroSec = uint64(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - s_buildStartTime).count());
+	eastl::array<uint64, NUM_STAGES> stageTotals = {};
+	uint64 totalOutputSize = 0;
+	for (const AssetStats& asset : s_assets)
+	{
+		for (uint i = 0; i < NUM_STAGES; ++i)
+			stageTotals[i] += asset.stageMicroSec[i];
+		totalOutputSize += asset.outputSize;
+	}
+
+	eastl::vector<const AssetStats*> bySize;
+	for (const AssetStats& asset : s_assets)
+		bySize.push_back(&asset);
+	eastl::vector<const AssetStats*> byTime = bySize;
+	eastl::sort(bySize.begin(), bySize.end(), [](const AssetStats* a, const AssetStats* b) { return a->outputSize > b->outputSize; });
+	eastl::sort(byTime.begin(), byTime.end(), [](const AssetStats* a, const AssetStats* b) { return a->getTotalMicroSec() > b->getTotalMicroSec(); });
+	const uint numLargest = eastl::min(NUM_LARGEST_CONTRIBUTORS, uint(s_assets.size()));
+
+	Json::Value root(Json::objectValue);
+	root["buildTimeMs"] = toMs(buildMicroSec);
+	root["outputBytes"] = Json::UInt64(totalOutputSize);
+	root["stagesMs"] = toJson(stageTotals);
+
+	Json::Value& sizeByType = root["outputBytesByType"] = Json::Value(Json::objectValue);
+	for (const auto& pair : s_sizeByType)
+		sizeByType[pair.first.c_str()] = Json::UInt64(pair.second);
+
+	Json::Value& assets = root["assets"] = Json::Value(Json::arrayValue);
+	for (const AssetStats& asset : s_assets)
+	{
+		Json::Value& a = assets.append(Json::Value(Json::objectValue));
+		a["name"] = asset.name.c_str();
+		a["type"] = asset.typeName;
+		a["outputBytes"] = Json::UInt64(asset.outputSize);
+		a["numMeshes"] = asset.numMeshes;
+		a["numVertices"] = Json::UInt64(asset.numVertices);
+		a["numIndices"] = Json::UInt64(asset.numIndices);
+		a["totalMs"] = toMs(asset.getTotalMicroSec());
+		a["stagesMs"] = toJson(asset.stageMicroSec);
+	}
+
+	Json::Value& atlasPages = root["atlasPages"] = Json::Value(Json::arrayValue);
+	for (const AtlasPageStats& page : s_atlasPages)
+	{
+		Json::Value& p = atlasPages.append(Json::Value(Json::objectValue));
+		p["asset"] = page.assetName.c_str();
+		p["texType"] = page.texType;
+		p["page"] = page.pageIdx;
+		p["width"] = page.width;
+		p["height"] = page.height;
+		p["numRegions"] = page.numRegions;
+		p["occupancy"] = page.getOccupancy();
+	}
+
+	Json::Value& largestBySize = root["largestBySize"] = Json::Value(Json::arrayValue);
+	Json::Value& largestByTime = root["largestByTime"] = Json::Value(Json::arrayValue);
+	for (uint i = 0; i < numLargest; ++i)
+	{
+		largestBySize.append(bySize[i]->name.c_str());
+		largestByTime.append(byTime[i]->name.c_str());
+	}
+
+	std::ofstream file(a_reportFilePath.c_str());
+	if (file.is_open())
+		file << Json::StyledWriter().write(root);
+	else
+		print("Could not write build report: %s\n", a_reportFilePath.c_str());
+
+	print("---- Build report: %s ----\n", a_reportFilePath.c_str());
+	print("Total: %.1f ms, %.2f MB in %u assets\n", toMs(buildMicroSec), double(totalOutputSize) / (1024.0 * 1024.0), uint(s_assets.size()));
+	for (uint i = 0; i < NUM_STAGES; ++i)
+		print("  %-10s %10.1f ms\n", STAGE_NAMES[i], toMs(stageTotals[i]));
+	for (const auto& pair : s_sizeByType)
+		print("  %-14s %10.2f MB\n", pair.first.c_str(), double(pair.second) / (1024.0 * 1024.0));
+	for (const AtlasPageStats& page : s_atlasPages)
+		print("  atlas %s %s[%u] %ux%u, %u regions, %.1f%% used\n", page.assetName.c_str(), page.texType, page.pageIdx, page.width, page.height, page.numRegions, page.getOccupancy() * 100.0);
+	print("Largest assets:\n");
+	for (uint i = 0; i < numLargest; ++i)
+		print("  %-32s %10.2f MB %10.1f ms %10llu verts %10llu indices\n", bySize[i]->name.c_str(), double(bySize[i]->outputSize) / (1024.0 * 1024.0),
+			toMs(bySize[i]->getTotalMicroSec()), bySize[i]->numVertices, bySize[i]->numIndices);
+	print("Slowest assets:\n");
+	for (uint i = 0; i < numLargest; ++i)
+		print("  %-32s %10.1f ms\n", byTime[i]->name.c_str(), toMs(byTime[i]->getTotalMicroSec()));
+}
@@ -5,7 +5,13 @@
 
 bool SceneProcessor::process(const eastl::string& a_inResourcePath, AssetDatabase& a_assetDatabase)
 {
-	owner<DBScene*> scene = new DBScene(a_inResourcePath);
+	// A scene that fails to import, like one that is still being saved, must not replace the one in the database
+	owner<DBScene*> scene = new DBScene();
+	if (!scene->build(a_inResourcePath))
+	{
+		delete scene;
+		return false;
+	}
 	a_assetDatabase.addAsset(FileUtils::getFileNameFromPath(a_inResourcePath), scene);
 	return true;
 }
\ No newline at end of file
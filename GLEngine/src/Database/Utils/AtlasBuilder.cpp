@@ -3,6 +3,7 @@
 #include "Database/Assets/DBAtlasRegion.h"
 #include "Database/Assets/DBAtlasTexture.h"
 #include "Database/Assets/DBMaterial.h"
+#include "Database/BuildStats.h"
 #include "Database/Utils/MaxRectsPacker.h"
 #include "EASTL/algorithm.h"
 #include "EASTL/hash_set.h"
@@ -15,6 +16,8 @@ enum {
 	ATLAS_NUM_MIPMAPS    = 4
 };
 
+const char* const TEX_TYPE_NAMES[DBMaterial::ETexTypes_COUNT] = { "diffuse", "normal", "metalness", "roughness", "opacity" };
+
 glm::vec4 getTextureMapping(uint a_atlasWidth, uint a_atlasHeight, const glm::vec4& a_atlasPos)
 {
 	const float xOffset = a_atlasPos.x / float(a_atlasWidth);
@@ -71,7 +74,12 @@ eastl::array<eastl::vector<DBAtlasTexture>, DBMaterial::ETexTypes_COUNT> AtlasBu
 		if (rects[i].empty())
 			continue;
 
-		eastl::vector<Page> pages = packer.pack(rects[i]);
+		eastl::vector<Page> pages;
+		{
+			BuildStats::ScopedStageTimer timer(BuildStats::EStage::ATLAS_PACK);
+			pages = packer.pack(rects[i]);
+		}
+		BuildStats::ScopedStageTimer timer(BuildStats::EStage::COMPOSITE);
 		atlasTextures[i].reserve(pages.size());
 		const uint atlasWidth = pages[0].width;
 		const uint atlasHeight = pages[0].height;
@@ -82,6 +90,7 @@ eastl::array<eastl::vector<DBAtlasTexture>, DBMaterial::ETexTypes_COUNT> AtlasBu
 			uint numComponents = numComponentsForType[i];
 			atlasTextures[i].emplace_back(atlasWidth, atlasHeight, numComponents, ATLAS_NUM_MIPMAPS);
 			DBAtlasTexture& tex = atlasTextures[i].back();
+			uint64 usedPixels = 0;
 
 			for (const Rect& rect : page.rects)
 			{
@@ -94,7 +103,9 @@ eastl::array<eastl::vector<DBAtlasTexture>, DBMaterial::ETexTypes_COUNT> AtlasBu
 				for (DBMaterial& mat : a_materials)
 					if (a_baseAssetPath + mat.getTexturePath(i) == region.m_filePath)
 						mat.setRegion(i, region);
+				usedPixels += uint64(rect.width) * rect.height;
 			}
+			BuildStats::addAtlasPage(TEX_TYPE_NAMES[i], j, atlasWidth, atlasHeight, uint(page.rects.size()), usedPixels);
 		}
 	}
 
@@ -148,3 +148,13 @@ uint64 CRC64::getHash(const char* a_str)
 	return crc;
 }
 
+uint64 CRC64::getHash(const byte* a_data, uint64 a_size)
+{
+	uint64 crc = 0xffffffffffffffffULL;
+	for (uint64 i = 0; i < a_size; ++i)
+	{
+		crc = CRC64_Table[byte((crc >> 56) ^ a_data[i])] ^ (crc << 8);
+	}
+	return crc;
+}
+
@@ -0,0 +1,642 @@
+#include "Database/Utils/ObjImporter.h"
+
+#include "Database/Assets/DBMaterial.h"
+#include "Database/Assets/DBMesh.h"
+#include "Database/Assets/DBNode.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/fixed_vector.h"
+#include "EASTL/hash_map.h"
+#include "EASTL/hash_set.h"
+#include "Utils/FileUtils.h"
+#include "Utils/ParallelUtils.h"
+
+#include <assert.h>
+#include <cmath>
+#include <fstream>
+#include <glm/glm.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint64 MIN_CHUNK_SIZE = 256 * 1024;
+const uint64 MAX_CHUNK_SIZE = 1024 * 1024 * 1024; // Keeps the face vertex counts of a chunk in 32 bits for files of any size
+const int MISSING_IDX = -1;
+const char* const DEFAULT_OBJECT_NAME = "defaultobject";
+const char* const DEFAULT_MATERIAL_NAME = "DefaultMaterial";
+
+const double POW10_NEG[] = { 1e0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9, 1e-10, 1e-11, 1e-12, 1e-13, 1e-14, 1e-15, 1e-16, 1e-17, 1e-18 };
+
+enum EFaceVertexFlags : byte
+{
+	RELATIVE_POSITION = 1 << 0,
+	RELATIVE_TEXCOORD = 1 << 1,
+	RELATIVE_NORMAL   = 1 << 2,
+	HAS_TEXCOORD      = 1 << 3,
+	HAS_NORMAL        = 1 << 4,
+};
+
+struct FaceVertex
+{
+	int position = MISSING_IDX;
+	int texcoord = MISSING_IDX;
+	int normal   = MISSING_IDX;
+	byte flags = 0; // Negative indices are relative to the end of the chunk's own attribute list until resolved
+};
+
+struct VertexKey
+{
+	int position;
+	int texcoord;
+	int normal;
+	bool operator==(const VertexKey& a_other) const { return position == a_other.position && texcoord == a_other.texcoord && normal == a_other.normal; }
+};
+
+struct VertexKeyHash
+{
+	size_t operator()(const VertexKey& a_key) const
+	{
+		return (size_t(uint(a_key.position)) * 73856093u) ^ (size_t(uint(a_key.texcoord)) * 19349663u) ^ (size_t(uint(a_key.normal)) * 83492791u);
+	}
+};
+
+enum class EEventType { OBJECT, MATERIAL };
+
+/** Object or material switch, applies to all faces from faceVertexIdx onwards */
+struct Event
+{
+	EEventType type;
+	uint faceVertexIdx;
+	eastl::string name;
+};
+
+struct ParsedChunk
+{
+	eastl::vector<glm::vec3> positions;
+	eastl::vector<glm::vec2> texcoords;
+	eastl::vector<glm::vec3> normals;
+	eastl::vector<FaceVertex> faceVertices; // Triangulated, three per face
+	eastl::vector<Event> events;
+	eastl::vector<eastl::string> materialLibs;
+	bool failed = false;
+};
+
+struct FaceRange
+{
+	uint chunkIdx;
+	uint begin;
+	uint end;
+};
+
+/** All faces that end up in one DBMesh, obj files can switch back and forth between objects and materials */
+struct MeshGroup
+{
+	uint objectIdx;
+	uint materialIdx;
+	eastl::vector<FaceRange> ranges;
+};
+
+inline bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+inline const char* skipSpaces(const char* p)
+{
+	while (isSpace(*p))
+		++p;
+	return p;
+}
+
+inline const char* skipLine(const char* p)
+{
+	while (*p != '\n')
+		++p;
+	return p + 1;
+}
+
+inline bool startsWithToken(const char* p, const char* token)
+{
+	while (*token)
+		if (*p++ != *token++)
+			return false;
+	return isSpace(*p);
+}
+
+/** Returns the trimmed remainder of the line */
+eastl::string readLine(const char* p)
+{
+	p = skipSpaces(p);
+	const char* end = p;
+	while (*end != '\n' && *end != '\0')
+		++end;
+	while (end > p && isSpace(end[-1]))
+		--end;
+	return eastl::string(p, end);
+}
+
+/** Returns the last whitespace separated token of the line, texture options in .mtl files precede the path */
+eastl::string readLastToken(const char* p)
+{
+	const eastl::string line = readLine(p);
+	const eastl::string::size_type idx = line.find_last_of(" \t");
+	return idx == eastl::string::npos ? line : line.substr(idx + 1);
+}
+
+const char* parseFloat(const char* p, float& a_out)
+{
+	p = skipSpaces(p);
+	bool negative = false;
+	if (*p == '-' || *p == '+')
+		negative = *p++ == '-';
+
+	double value = 0.0;
+	while (isDigit(*p))
+		value = value * 10.0 + (*p++ - '0');
+
+	if (*p == '.')
+	{
+		++p;
+		uint64 fraction = 0;
+		uint numDigits = 0;
+		while (isDigit(*p))
+		{
+			if (numDigits < ARRAY_SIZE(POW10_NEG) - 1)
+			{
+				fraction = fraction * 10 + (*p - '0');
+				numDigits++;
+			}
+			++p;
+		}
+		value += double(fraction) * POW10_NEG[numDigits];
+	}
+
+	if (*p == 'e' || *p == 'E')
+	{
+		++p;
+		bool negativeExponent = false;
+		if (*p == '-' || *p == '+')
+			negativeExponent = *p++ == '-';
+		int exponent = 0;
+		while (isDigit(*p))
+			exponent = exponent * 10 + (*p++ - '0');
+		value *= std::pow(10.0, negativeExponent ? -exponent : exponent);
+	}
+
+	a_out = float(negative ? -value : value);
+	return p;
+}
+
+const char* parseInt(const char* p, int& a_out)
+{
+	bool negative = false;
+	if (*p == '-' || *p == '+')
+		negative = *p++ == '-';
+	int value = 0;
+	while (isDigit(*p))
+		value = value * 10 + (*p++ - '0');
+	a_out = negative ? -value : value;
+	return p;
+}
+
+/** Converts a one based obj index to zero based, negative indices get resolved after all chunks are parsed */
+inline bool convertIndex(int a_objIdx, uint a_numParsed, byte a_relativeFlag, int& a_outIdx, byte& a_outFlags)
+{
+	if (a_objIdx > 0)
+		a_outIdx = a_objIdx - 1;
+	else if (a_objIdx < 0)
+	{
+		a_outIdx = int(a_numParsed) + a_objIdx;
+		a_outFlags |= a_relativeFlag;
+	}
+	else
+		return false;
+	return true;
+}
+
+const char* parseFace(const char* p, ParsedChunk& a_chunk)
+{
+	eastl::fixed_vector<FaceVertex, 8> polygon;
+	while (true)
+	{
+		p = skipSpaces(p);
+		if (*p == '\n' || !(isDigit(*p) || *p == '-' || *p == '+'))
+			break;
+
+		FaceVertex fv;
+		int idx = 0;
+		p = parseInt(p, idx);
+		if (!convertIndex(idx, uint(a_chunk.positions.size()), RELATIVE_POSITION, fv.position, fv.flags))
+			a_chunk.failed = true;
+		if (*p == '/')
+		{
+			++p;
+			if (*p != '/')
+			{
+				p = parseInt(p, idx);
+				fv.flags |= HAS_TEXCOORD;
+				if (!convertIndex(idx, uint(a_chunk.texcoords.size()), RELATIVE_TEXCOORD, fv.texcoord, fv.flags))
+					a_chunk.failed = true;
+			}
+			if (*p == '/')
+			{
+				++p;
+				p = parseInt(p, idx);
+				fv.flags |= HAS_NORMAL;
+				if (!convertIndex(idx, uint(a_chunk.normals.size()), RELATIVE_NORMAL, fv.normal, fv.flags))
+					a_chunk.failed = true;
+			}
+		}
+		polygon.push_back(fv);
+		while (!isSpace(*p) && *p != '\n')
+			++p;
+	}
+
+	// Fan triangulation, fine for the convex polygons exporters write
+	for (uint i = 1; i + 1 < polygon.size(); ++i)
+	{
+		a_chunk.faceVertices.push_back(polygon[0]);
+		a_chunk.faceVertices.push_back(polygon[i]);
+		a_chunk.faceVertices.push_back(polygon[i + 1]);
+	}
+	return p;
+}
+
+void parseChunk(const char* p, const char* a_end, ParsedChunk& a_chunk)
+{
+	while (p < a_end && !a_chunk.failed)
+	{
+		p = skipSpaces(p);
+		switch (*p)
+		{
+		case 'v':
+			if (isSpace(p[1]))
+			{
+				glm::vec3 v;
+				p = parseFloat(p + 1, v.x);
+				p = parseFloat(p, v.y);
+				p = parseFloat(p, v.z);
+				a_chunk.positions.push_back(v);
+			}
+			else if (p[1] == 't' && isSpace(p[2]))
+			{
+				glm::vec2 vt;
+				p = parseFloat(p + 2, vt.x);
+				p = parseFloat(p, vt.y);
+				vt.y = 1.0f - vt.y; // Flip uv's because OpenGL
+				a_chunk.texcoords.push_back(vt);
+			}
+			else if (p[1] == 'n' && isSpace(p[2]))
+			{
+				glm::vec3 vn;
+				p = parseFloat(p + 2, vn.x);
+				p = parseFloat(p, vn.y);
+				p = parseFloat(p, vn.z);
+				a_chunk.normals.push_back(vn);
+			}
+			break;
+		case 'f':
+			if (isSpace(p[1]))
+				p = parseFace(p + 1, a_chunk);
+			break;
+		case 'o':
+		case 'g':
+			if (isSpace(p[1]))
+				a_chunk.events.push_back({ EEventType::OBJECT, uint(a_chunk.faceVertices.size()), readLine(p + 1) });
+			break;
+		case 'u':
+			if (startsWithToken(p, "usemtl"))
+				a_chunk.events.push_back({ EEventType::MATERIAL, uint(a_chunk.faceVertices.size()), readLine(p + 6) });
+			break;
+		case 'm':
+			if (startsWithToken(p, "mtllib"))
+				a_chunk.materialLibs.push_back(readLine(p + 6));
+			break;
+		default:
+			break;
+		}
+		p = skipLine(p);
+	}
+}
+
+bool readFile(const eastl::string& a_filePath, eastl::vector<char>& a_outData)
+{
+	std::ifstream file(a_filePath.c_str(), std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+	const uint64 size = uint64(file.tellg());
+	file.seekg(0, std::ios::beg);
+	a_outData.resize(size + 2);
+	file.read(a_outData.data(), size);
+	// Terminate with a newline so the last line needs no special casing
+	a_outData[size] = '\n';
+	a_outData[size + 1] = '\0';
+	return true;
+}
+
+void parseMaterialLib(const eastl::string& a_filePath, eastl::vector<DBMaterial>& a_materials, eastl::hash_map<eastl::string, uint>& a_materialLookup)
+{
+	eastl::vector<char> data;
+	if (!readFile(a_filePath, data))
+	{
+		print("Could not open material lib: %s\n", a_filePath.c_str());
+		return;
+	}
+
+	DBMaterial* material = NULL;
+	const char* p = data.data();
+	const char* end = p + data.size() - 1;
+	while (p < end)
+	{
+		p = skipSpaces(p);
+		if (startsWithToken(p, "newmtl"))
+		{
+			const eastl::string name = readLine(p + 6);
+			auto it = a_materialLookup.find(name);
+			if (it == a_materialLookup.end())
+			{
+				it = a_materialLookup.insert(eastl::make_pair(name, uint(a_materials.size()))).first;
+				a_materials.push_back(DBMaterial(name));
+			}
+			material = &a_materials[it->second];
+		}
+		else if (material)
+		{
+			if (startsWithToken(p, "map_Kd"))
+				material->setTexturePath(DBMaterial::ETexTypes_Diffuse, readLastToken(p + 6));
+			else if (startsWithToken(p, "norm"))
+				material->setTexturePath(DBMaterial::ETexTypes_Normal, readLastToken(p + 4));
+			else if ((startsWithToken(p, "map_bump") || startsWithToken(p, "map_Bump")) && !material->hasTexture(DBMaterial::ETexTypes_Normal))
+				material->setTexturePath(DBMaterial::ETexTypes_Normal, readLastToken(p + 8));
+			else if (startsWithToken(p, "bump") && !material->hasTexture(DBMaterial::ETexTypes_Normal))
+				material->setTexturePath(DBMaterial::ETexTypes_Normal, readLastToken(p + 4));
+			else if (startsWithToken(p, "map_Ka"))
+				material->setTexturePath(DBMaterial::ETexTypes_Metalness, readLastToken(p + 6));
+			else if (startsWithToken(p, "map_d"))
+				material->setTexturePath(DBMaterial::ETexTypes_Opacity, readLastToken(p + 5));
+			else if (startsWithToken(p, "map_Ks"))
+				material->setTexturePath(DBMaterial::ETexTypes_Roughness, readLastToken(p + 6));
+		}
+		p = skipLine(p);
+	}
+}
+
+void calculateTangents(eastl::vector<DBMesh::Vertex>& a_vertices, const eastl::vector<uint>& a_indices)
+{
+	eastl::vector<glm::vec3> tangents(a_vertices.size(), glm::vec3(0.0f));
+	eastl::vector<glm::vec3> bitangents(a_vertices.size(), glm::vec3(0.0f));
+	for (uint i = 0; i < a_indices.size(); i += 3)
+	{
+		const DBMesh::Vertex& v0 = a_vertices[a_indices[i + 0]];
+		const DBMesh::Vertex& v1 = a_vertices[a_indices[i + 1]];
+		const DBMesh::Vertex& v2 = a_vertices[a_indices[i + 2]];
+		const glm::vec3 edge1 = v1.position - v0.position;
+		const glm::vec3 edge2 = v2.position - v0.position;
+		const glm::vec2 deltaUV1 = v1.texcoords - v0.texcoords;
+		const glm::vec2 deltaUV2 = v2.texcoords - v0.texcoords;
+		const float det = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+		if (std::abs(det) < 1e-12f)
+			continue;
+		const float r = 1.0f / det;
+		const glm::vec3 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) * r;
+		const glm::vec3 bitangent = (edge2 * deltaUV1.x - edge1 * deltaUV2.x) * r;
+		for (uint j = 0; j < 3; ++j)
+		{
+			tangents[a_indices[i + j]] += tangent;
+			bitangents[a_indices[i + j]] += bitangent;
+		}
+	}
+
+	for (uint i = 0; i < a_vertices.size(); ++i)
+	{
+		DBMesh::Vertex& v = a_vertices[i];
+		glm::vec3 tangent = tangents[i] - v.normal * glm::dot(v.normal, tangents[i]);
+		if (glm::dot(tangent, tangent) < 1e-12f) // No usable uv's, pick any vector perpendicular to the normal
+			tangent = glm::cross(v.normal, std::abs(v.normal.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0));
+		tangent = glm::normalize(tangent);
+		const float handedness = glm::dot(v.normal, glm::cross(tangent, bitangents[i])) >= 0.0f ? 1.0f : -1.0f;
+		v.tangents = glm::vec4(tangent, handedness);
+	}
+}
+
+DBMesh buildMesh(const MeshGroup& a_group, const eastl::string& a_name, const eastl::vector<ParsedChunk>& a_chunks,
+	const eastl::vector<glm::vec3>& a_positions, const eastl::vector<glm::vec2>& a_texcoords, const eastl::vector<glm::vec3>& a_normals)
+{
+	uint numFaceVertices = 0;
+	for (const FaceRange& range : a_group.ranges)
+		numFaceVertices += range.end - range.begin;
+
+	eastl::vector<DBMesh::Vertex> vertices;
+	eastl::vector<uint> indices;
+	eastl::hash_map<VertexKey, uint, VertexKeyHash> vertexLookup;
+	vertices.reserve(numFaceVertices / 2);
+	indices.reserve(numFaceVertices);
+
+	int faceIdx = 0;
+	for (const FaceRange& range : a_group.ranges)
+	{
+		const eastl::vector<FaceVertex>& faceVertices = a_chunks[range.chunkIdx].faceVertices;
+		for (uint i = range.begin; i < range.end; i += 3, ++faceIdx)
+		{
+			const FaceVertex* face = &faceVertices[i];
+			if (face[0].position == face[1].position || face[0].position == face[2].position || face[1].position == face[2].position)
+				continue; // Degenerate
+
+			const glm::vec3& p0 = a_positions[face[0].position];
+			const glm::vec3 faceNormal = glm::cross(a_positions[face[1].position] - p0, a_positions[face[2].position] - p0);
+			const float faceNormalLength = glm::length(faceNormal);
+
+			for (uint j = 0; j < 3; ++j)
+			{
+				const FaceVertex& fv = face[j];
+				// Vertices without a normal get the flat face normal, so they must not be shared between faces
+				const VertexKey key = { fv.position, fv.texcoord, fv.normal != MISSING_IDX ? fv.normal : MISSING_IDX - faceIdx };
+				auto it = vertexLookup.find(key);
+				if (it == vertexLookup.end())
+				{
+					DBMesh::Vertex v;
+					v.position = a_positions[fv.position];
+					v.texcoords = fv.texcoord != MISSING_IDX ? a_texcoords[fv.texcoord] : glm::vec2(0.0f);
+					if (fv.normal != MISSING_IDX)
+						v.normal = glm::normalize(a_normals[fv.normal]);
+					else
+						v.normal = faceNormalLength > 0.0f ? faceNormal / faceNormalLength : glm::vec3(0, 1, 0);
+					v.materialID = a_group.materialIdx;
+					it = vertexLookup.insert(eastl::make_pair(key, uint(vertices.size()))).first;
+					vertices.push_back(v);
+				}
+				indices.push_back(it->second);
+			}
+		}
+	}
+
+	calculateTangents(vertices, indices);
+	return DBMesh(a_name, eastl::move(vertices), eastl::move(indices));
+}
+
+END_UNNAMED_NAMESPACE()
+
+bool ObjImporter::importScene(const eastl::string& a_filePath, eastl::vector<DBNode>& a_nodes, eastl::vector<DBMesh>& a_meshes, eastl::vector<DBMaterial>& a_materials)
+{
+	eastl::vector<char> data;
+	if (!readFile(a_filePath, data))
+		return false;
+
+	// Split the file at line boundaries and parse every chunk on its own thread
+	const uint64 fileSize = uint64(data.size() - 1);
+	const uint64 numMinChunks = eastl::min(fileSize / MIN_CHUNK_SIZE, uint64(0xFFFFFFFF));
+	const uint numChunks = eastl::max(ParallelUtils::getNumRanges(uint(numMinChunks), 1), uint((fileSize + MAX_CHUNK_SIZE - 1) / MAX_CHUNK_SIZE));
+	eastl::vector<uint64> chunkStarts(numChunks + 1);
+	chunkStarts[0] = 0;
+	chunkStarts[numChunks] = fileSize;
+	for (uint i = 1; i < numChunks; ++i)
+	{
+		uint64 pos = fileSize * i / numChunks;
+		pos = eastl::max(pos, chunkStarts[i - 1]);
+		while (pos < fileSize && data[pos - 1] != '\n')
+			++pos;
+		chunkStarts[i] = pos;
+	}
+
+	eastl::vector<ParsedChunk> chunks(numChunks);
+	ParallelUtils::forEach(numChunks, [&](uint a_chunkIdx)
+	{
+		parseChunk(data.data() + chunkStarts[a_chunkIdx], data.data() + chunkStarts[a_chunkIdx + 1], chunks[a_chunkIdx]);
+	});
+
+	// Concatenate attributes and resolve relative indices now that we know the base offset of every chunk
+	eastl::vector<glm::vec3> positions;
+	eastl::vector<glm::vec2> texcoords;
+	eastl::vector<glm::vec3> normals;
+	eastl::vector<glm::ivec3> chunkBases(numChunks);
+	for (uint i = 0; i < numChunks; ++i)
+	{
+		if (chunks[i].failed)
+			return false;
+		// Indices are ints, like the ones in the file
+		const uint64 maxAttributes = uint64(0x7FFFFFFF);
+		if (positions.size() + chunks[i].positions.size() > maxAttributes || texcoords.size() + chunks[i].texcoords.size() > maxAttributes
+			|| normals.size() + chunks[i].normals.size() > maxAttributes)
+		{
+			print("Too many vertex attributes to import: %s\n", a_filePath.c_str());
+			return false;
+		}
+		chunkBases[i] = glm::ivec3(int(positions.size()), int(texcoords.size()), int(normals.size()));
+		positions.insert(positions.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+		texcoords.insert(texcoords.end(), chunks[i].texcoords.begin(), chunks[i].texcoords.end());
+		normals.insert(normals.end(), chunks[i].normals.begin(), chunks[i].normals.end());
+	}
+
+	ParallelUtils::forEach(numChunks, [&](uint a_chunkIdx)
+	{
+		ParsedChunk& chunk = chunks[a_chunkIdx];
+		const glm::ivec3 base = chunkBases[a_chunkIdx];
+		for (FaceVertex& fv : chunk.faceVertices)
+		{
+			if (fv.flags & RELATIVE_POSITION) fv.position += base.x;
+			if (fv.flags & RELATIVE_TEXCOORD) fv.texcoord += base.y;
+			if (fv.flags & RELATIVE_NORMAL)   fv.normal += base.z;
+			// Only a slot left empty in the file is missing, an index that resolves to MISSING_IDX is out of range
+			if (fv.position < 0 || fv.position >= int(positions.size())
+				|| ((fv.flags & HAS_TEXCOORD) && (fv.texcoord < 0 || fv.texcoord >= int(texcoords.size())))
+				|| ((fv.flags & HAS_NORMAL) && (fv.normal < 0 || fv.normal >= int(normals.size()))))
+				chunk.failed = true;
+		}
+	});
+	for (const ParsedChunk& chunk : chunks)
+		if (chunk.failed)
+			return false;
+
+	const eastl::string baseAssetPath = FileUtils::getFolderPathForFile(a_filePath);
+	eastl::hash_map<eastl::string, uint> materialLookup;
+	eastl::hash_set<eastl::string> parsedMaterialLibs;
+	for (const ParsedChunk& chunk : chunks)
+	{
+		for (const eastl::string& materialLib : chunk.materialLibs)
+		{
+			if (parsedMaterialLibs.insert(materialLib).second)
+				parseMaterialLib(baseAssetPath + materialLib, a_materials, materialLookup);
+		}
+	}
+
+	// Walk the object/material switches in file order and gather the face ranges of every mesh
+	eastl::vector<eastl::string> objectNames;
+	eastl::hash_map<eastl::string, uint> objectLookup;
+	eastl::vector<MeshGroup> groups;
+	eastl::hash_map<uint64, uint> groupLookup;
+	eastl::string currentObject = DEFAULT_OBJECT_NAME;
+	eastl::string currentMaterial = DEFAULT_MATERIAL_NAME;
+
+	auto addRange = [&](uint a_chunkIdx, uint a_begin, uint a_end)
+	{
+		if (a_begin == a_end)
+			return;
+		auto objectIt = objectLookup.find(currentObject);
+		if (objectIt == objectLookup.end())
+		{
+			objectIt = objectLookup.insert(eastl::make_pair(currentObject, uint(objectNames.size()))).first;
+			objectNames.push_back(currentObject);
+		}
+		auto materialIt = materialLookup.find(currentMaterial);
+		if (materialIt == materialLookup.end())
+		{
+			materialIt = materialLookup.insert(eastl::make_pair(currentMaterial, uint(a_materials.size()))).first;
+			a_materials.push_back(DBMaterial(currentMaterial));
+		}
+		const uint64 groupKey = (uint64(objectIt->second) << 32) | materialIt->second;
+		auto groupIt = groupLookup.find(groupKey);
+		if (groupIt == groupLookup.end())
+		{
+			groupIt = groupLookup.insert(eastl::make_pair(groupKey, uint(groups.size()))).first;
+			groups.push_back({ objectIt->second, materialIt->second });
+		}
+		MeshGroup& group = groups[groupIt->second];
+		if (!group.ranges.empty() && group.ranges.back().chunkIdx == a_chunkIdx && group.ranges.back().end == a_begin)
+			group.ranges.back().end = a_end;
+		else
+			group.ranges.push_back({ a_chunkIdx, a_begin, a_end });
+	};
+
+	for (uint i = 0; i < numChunks; ++i)
+	{
+		uint begin = 0;
+		for (const Event& e : chunks[i].events)
+		{
+			addRange(i, begin, e.faceVertexIdx);
+			begin = e.faceVertexIdx;
+			if (e.type == EEventType::OBJECT)
+				currentObject = e.name.empty() ? DEFAULT_OBJECT_NAME : e.name;
+			else
+				currentMaterial = e.name.empty() ? DEFAULT_MATERIAL_NAME : e.name;
+		}
+		addRange(i, begin, uint(chunks[i].faceVertices.size()));
+	}
+
+	if (groups.empty())
+		return false;
+
+	a_meshes.resize(groups.size());
+	ParallelUtils::forEach(uint(groups.size()), [&](uint a_groupIdx)
+	{
+		const MeshGroup& group = groups[a_groupIdx];
+		a_meshes[a_groupIdx] = buildMesh(group, objectNames[group.objectIdx], chunks, positions, texcoords, normals);
+	});
+
+	// Root node with one child per object
+	a_nodes.clear();
+	a_nodes.push_back(DBNode(FileUtils::getFileNameFromPath(a_filePath), 0));
+	for (uint i = 0; i < objectNames.size(); ++i)
+	{
+		a_nodes[0].addChild(uint(a_nodes.size()));
+		a_nodes.push_back(DBNode(objectNames[i], 0));
+	}
+	for (uint i = 0; i < groups.size(); ++i)
+		a_nodes[1 + groups[i].objectIdx].addMesh(i);
+	for (DBNode& node : a_nodes)
+		node.calculateBounds(a_meshes);
+
+	return true;
+}
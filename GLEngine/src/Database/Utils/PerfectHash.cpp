@@ -0,0 +1,81 @@
+#include "Database/Utils/PerfectHash.h"
+
+#include "EASTL/fixed_vector.h"
+#include "EASTL/sort.h"
+
+#include <assert.h>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint AVG_KEYS_PER_BUCKET = 4;
+const uint MAX_SEED_ATTEMPTS = 1 << 24;
+
+END_UNNAMED_NAMESPACE()
+
+bool PerfectHash::build(const eastl::vector<uint64>& a_keys)
+{
+	m_numSlots = uint(a_keys.size());
+	m_seeds.clear();
+	if (a_keys.empty())
+		return true;
+
+	const uint numBuckets = (m_numSlots + AVG_KEYS_PER_BUCKET - 1) / AVG_KEYS_PER_BUCKET;
+	m_seeds.resize(numBuckets, 0);
+
+	eastl::vector<eastl::vector<uint64>> buckets(numBuckets);
+	for (uint64 key : a_keys)
+		buckets[uint(hash(key, BUCKET_SEED) % numBuckets)].push_back(key);
+
+	// Place the largest buckets first while there are still many free slots
+	eastl::vector<uint> bucketOrder(numBuckets);
+	for (uint i = 0; i < numBuckets; ++i)
+		bucketOrder[i] = i;
+	eastl::sort(bucketOrder.begin(), bucketOrder.end(), [&](uint a, uint b) { return buckets[a].size() > buckets[b].size(); });
+
+	eastl::vector<bool> slotTaken(m_numSlots, false);
+	eastl::fixed_vector<uint, 16> bucketSlots;
+	for (uint bucketIdx : bucketOrder)
+	{
+		const eastl::vector<uint64>& bucket = buckets[bucketIdx];
+		if (bucket.empty())
+			break;
+
+		bool placed = false;
+		for (uint seed = 0; seed < MAX_SEED_ATTEMPTS && !placed; ++seed)
+		{
+			bucketSlots.clear();
+			placed = true;
+			for (uint64 key : bucket)
+			{
+				const uint slot = uint(hash(key, seed) % m_numSlots);
+				if (slotTaken[slot] || eastl::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+				{
+					placed = false;
+					break;
+				}
+				bucketSlots.push_back(slot);
+			}
+			if (placed)
+			{
+				m_seeds[bucketIdx] = seed;
+				for (uint slot : bucketSlots)
+					slotTaken[slot] = true;
+			}
+		}
+		if (!placed)
+		{
+			print("Failed to build perfect hash for %u keys, are there duplicate keys?\n", m_numSlots);
+			m_seeds.clear();
+			m_numSlots = 0;
+			return false;
+		}
+	}
+	return true;
+}
+
+void PerfectHash::initialize(const eastl::vector<uint>& a_seeds, uint a_numSlots)
+{
+	assert(a_seeds.empty() == (a_numSlots == 0));
+	m_seeds = a_seeds;
+	m_numSlots = a_numSlots;
+}
@@ -0,0 +1,360 @@
+#include "Graphics/GL/GLStateCache.h"
+
+#include "Graphics/GL/GL.h"
+
+#include <assert.h>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint UNKNOWN = 0xFFFFFFFF;
+const uint MAX_TEXTURE_UNITS = 32;
+const uint MAX_INDEXED_BINDINGS = 16;
+
+const GLenum CAPABILITIES[]           = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_MULTISAMPLE, GL_SCISSOR_TEST };
+const GLenum TEXTURE_TARGETS[]        = { GL_TEXTURE_2D, GL_TEXTURE_2D_MULTISAMPLE, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BUFFER };
+const GLenum TEXTURE_TARGET_QUERIES[] = { GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_2D_MULTISAMPLE, GL_TEXTURE_BINDING_2D_ARRAY, GL_TEXTURE_BINDING_CUBE_MAP, GL_TEXTURE_BINDING_BUFFER };
+const GLenum BUFFER_TARGETS[]         = { GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_TEXTURE_BUFFER, GL_DRAW_INDIRECT_BUFFER };
+const GLenum BUFFER_TARGET_QUERIES[]  = { GL_ARRAY_BUFFER_BINDING, GL_UNIFORM_BUFFER_BINDING, GL_SHADER_STORAGE_BUFFER_BINDING, GL_TEXTURE_BUFFER, GL_DRAW_INDIRECT_BUFFER_BINDING }; // GL_TEXTURE_BUFFER doubles as its binding query
+const GLenum INDEXED_TARGETS[]        = { GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER };
+const GLenum INDEXED_TARGET_QUERIES[] = { GL_UNIFORM_BUFFER_BINDING, GL_SHADER_STORAGE_BUFFER_BINDING };
+
+const uint NUM_CAPABILITIES    = ARRAY_SIZE(CAPABILITIES);
+const uint NUM_TEXTURE_TARGETS = ARRAY_SIZE(TEXTURE_TARGETS);
+const uint NUM_BUFFER_TARGETS  = ARRAY_SIZE(BUFFER_TARGETS);
+const uint NUM_INDEXED_TARGETS = ARRAY_SIZE(INDEXED_TARGETS);
+
+struct IndexedBinding
+{
+	uint buffer;
+	uint offset;
+	uint numBytes; // 0 for glBindBufferBase
+};
+
+struct State
+{
+	uint capabilities[NUM_CAPABILITIES];
+	uint depthMask;
+	uint colorMask;
+	uint depthFunc;
+	uint cullFace;
+	uint blendSrc;
+	uint blendDst;
+	int viewport[4];
+	bool viewportKnown;
+	uint program;
+	uint framebuffer; // Draw framebuffer
+	uint readFramebuffer;
+	uint vertexArray;
+	uint activeTextureUnit;
+	uint textures[MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+	uint buffers[NUM_BUFFER_TARGETS];
+	IndexedBinding indexedBuffers[NUM_INDEXED_TARGETS][MAX_INDEXED_BINDINGS];
+};
+
+State s_state;
+
+/** Returns ARRAY_SIZE if the value is not in the array */
+uint findIndex(const GLenum* a_values, uint a_numValues, uint a_value)
+{
+	for (uint i = 0; i < a_numValues; ++i)
+		if (a_values[i] == a_value)
+			return i;
+	return a_numValues;
+}
+
+bool isCached(uint& a_cached, uint a_value)
+{
+	if (a_cached == a_value)
+		return true;
+	a_cached = a_value;
+	return false;
+}
+
+void forgetName(uint* a_names, uint a_numNames, uint a_name)
+{
+	for (uint i = 0; i < a_numNames; ++i)
+		if (a_names[i] == a_name)
+			a_names[i] = UNKNOWN;
+}
+
+GLint getInteger(GLenum a_query)
+{
+	GLint value = 0;
+	glGetIntegerv(a_query, &value);
+	return value;
+}
+
+GLint getIntegerIndexed(GLenum a_query, uint a_index)
+{
+	GLint value = 0;
+	glGetIntegeri_v(a_query, a_index, &value);
+	return value;
+}
+
+bool checkValue(const char* a_name, uint a_cached, GLint a_actual)
+{
+	if (a_cached == UNKNOWN || a_cached == uint(a_actual))
+		return true;
+	print("GLStateCache mismatch for %s, cached %u actual %i\n", a_name, a_cached, a_actual);
+	return false;
+}
+
+END_UNNAMED_NAMESPACE()
+
+GLStateCache::Stats GLStateCache::s_frameStats;
+GLStateCache::Stats GLStateCache::s_lastFrameStats;
+bool GLStateCache::s_validationEnabled = false;
+
+#define CACHED_CALL(IS_CACHED, CALL) \
+	if (IS_CACHED) \
+	{ \
+		s_frameStats.numSkipped++; \
+		if (s_validationEnabled && !validate()) \
+			assert(false); \
+	} \
+	else \
+	{ \
+		s_frameStats.numIssued++; \
+		CALL; \
+	}
+
+void GLStateCache::invalidate()
+{
+	for (uint& capability : s_state.capabilities)
+		capability = UNKNOWN;
+	s_state.depthMask = UNKNOWN;
+	s_state.colorMask = UNKNOWN;
+	s_state.depthFunc = UNKNOWN;
+	s_state.cullFace = UNKNOWN;
+	s_state.blendSrc = UNKNOWN;
+	s_state.blendDst = UNKNOWN;
+	s_state.viewportKnown = false;
+	s_state.program = UNKNOWN;
+	s_state.framebuffer = UNKNOWN;
+	s_state.readFramebuffer = UNKNOWN;
+	s_state.vertexArray = UNKNOWN;
+	s_state.activeTextureUnit = UNKNOWN;
+	for (uint unit = 0; unit < MAX_TEXTURE_UNITS; ++unit)
+		for (uint target = 0; target < NUM_TEXTURE_TARGETS; ++target)
+			s_state.textures[unit][target] = UNKNOWN;
+	for (uint& buffer : s_state.buffers)
+		buffer = UNKNOWN;
+	for (uint target = 0; target < NUM_INDEXED_TARGETS; ++target)
+		for (uint index = 0; index < MAX_INDEXED_BINDINGS; ++index)
+			s_state.indexedBuffers[target][index].buffer = UNKNOWN;
+}
+
+void GLStateCache::endFrame()
+{
+	if (s_validationEnabled)
+		validate();
+	s_lastFrameStats = s_frameStats;
+	s_frameStats = Stats();
+}
+
+bool GLStateCache::validate()
+{
+	bool valid = true;
+	for (uint i = 0; i < NUM_CAPABILITIES; ++i)
+		valid &= checkValue("capability", s_state.capabilities[i], glIsEnabled(CAPABILITIES[i]));
+	GLboolean colorMask[4];
+	glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+	valid &= checkValue("color mask", s_state.colorMask, colorMask[0]);
+	valid &= checkValue("depth mask", s_state.depthMask, getInteger(GL_DEPTH_WRITEMASK));
+	valid &= checkValue("depth func", s_state.depthFunc, getInteger(GL_DEPTH_FUNC));
+	valid &= checkValue("cull face", s_state.cullFace, getInteger(GL_CULL_FACE_MODE));
+	valid &= checkValue("blend src", s_state.blendSrc, getInteger(GL_BLEND_SRC_RGB));
+	valid &= checkValue("blend dst", s_state.blendDst, getInteger(GL_BLEND_DST_RGB));
+	if (s_state.viewportKnown)
+	{
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		for (uint i = 0; i < 4; ++i)
+			valid &= checkValue("viewport", uint(s_state.viewport[i]), viewport[i]);
+	}
+	valid &= checkValue("program", s_state.program, getInteger(GL_CURRENT_PROGRAM));
+	valid &= checkValue("framebuffer", s_state.framebuffer, getInteger(GL_DRAW_FRAMEBUFFER_BINDING));
+	valid &= checkValue("read framebuffer", s_state.readFramebuffer, getInteger(GL_READ_FRAMEBUFFER_BINDING));
+	valid &= checkValue("vertex array", s_state.vertexArray, getInteger(GL_VERTEX_ARRAY_BINDING));
+	for (uint i = 0; i < NUM_BUFFER_TARGETS; ++i)
+		valid &= checkValue("buffer", s_state.buffers[i], getInteger(BUFFER_TARGET_QUERIES[i]));
+	for (uint target = 0; target < NUM_INDEXED_TARGETS; ++target)
+		for (uint index = 0; index < MAX_INDEXED_BINDINGS; ++index)
+			valid &= checkValue("indexed buffer", s_state.indexedBuffers[target][index].buffer, getIntegerIndexed(INDEXED_TARGET_QUERIES[target], index));
+
+	// Texture bindings can only be queried for the active unit
+	const GLint activeTexture = getInteger(GL_ACTIVE_TEXTURE);
+	valid &= checkValue("active texture", s_state.activeTextureUnit, activeTexture - GL_TEXTURE0);
+	for (uint unit = 0; unit < MAX_TEXTURE_UNITS; ++unit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		for (uint target = 0; target < NUM_TEXTURE_TARGETS; ++target)
+			valid &= checkValue("texture", s_state.textures[unit][target], getInteger(TEXTURE_TARGET_QUERIES[target]));
+	}
+	glActiveTexture(activeTexture);
+	return valid;
+}
+
+void GLStateCache::setCapability(uint a_capability, bool a_enabled)
+{
+	const uint idx = findIndex(CAPABILITIES, NUM_CAPABILITIES, a_capability);
+	assert(idx < NUM_CAPABILITIES);
+	CACHED_CALL(isCached(s_state.capabilities[idx], a_enabled), a_enabled ? glEnable(a_capability) : glDisable(a_capability));
+}
+
+void GLStateCache::setDepthMask(bool a_enabled)
+{
+	CACHED_CALL(isCached(s_state.depthMask, a_enabled), glDepthMask(a_enabled));
+}
+
+void GLStateCache::setColorMask(bool a_enabled)
+{
+	CACHED_CALL(isCached(s_state.colorMask, a_enabled), glColorMask(a_enabled, a_enabled, a_enabled, a_enabled));
+}
+
+void GLStateCache::setDepthFunc(uint a_func)
+{
+	CACHED_CALL(isCached(s_state.depthFunc, a_func), glDepthFunc(a_func));
+}
+
+void GLStateCache::setCullFace(uint a_face)
+{
+	CACHED_CALL(isCached(s_state.cullFace, a_face), glCullFace(a_face));
+}
+
+void GLStateCache::setBlendFunc(uint a_srcFactor, uint a_dstFactor)
+{
+	const bool cached = s_state.blendSrc == a_srcFactor && s_state.blendDst == a_dstFactor;
+	s_state.blendSrc = a_srcFactor;
+	s_state.blendDst = a_dstFactor;
+	CACHED_CALL(cached, glBlendFunc(a_srcFactor, a_dstFactor));
+}
+
+void GLStateCache::setViewport(int a_x, int a_y, uint a_width, uint a_height)
+{
+	int* viewport = s_state.viewport;
+	const bool cached = s_state.viewportKnown && viewport[0] == a_x && viewport[1] == a_y && viewport[2] == int(a_width) && viewport[3] == int(a_height);
+	viewport[0] = a_x;
+	viewport[1] = a_y;
+	viewport[2] = int(a_width);
+	viewport[3] = int(a_height);
+	s_state.viewportKnown = true;
+	CACHED_CALL(cached, glViewport(a_x, a_y, a_width, a_height));
+}
+
+void GLStateCache::useProgram(uint a_program)
+{
+	CACHED_CALL(isCached(s_state.program, a_program), glUseProgram(a_program));
+}
+
+void GLStateCache::bindFramebuffer(uint a_framebuffer)
+{
+	const bool cached = s_state.framebuffer == a_framebuffer && s_state.readFramebuffer == a_framebuffer;
+	s_state.framebuffer = a_framebuffer;
+	s_state.readFramebuffer = a_framebuffer;
+	CACHED_CALL(cached, glBindFramebuffer(GL_FRAMEBUFFER, a_framebuffer));
+}
+
+void GLStateCache::bindFramebuffers(uint a_readFramebuffer, uint a_drawFramebuffer)
+{
+	CACHED_CALL(isCached(s_state.readFramebuffer, a_readFramebuffer), glBindFramebuffer(GL_READ_FRAMEBUFFER, a_readFramebuffer));
+	CACHED_CALL(isCached(s_state.framebuffer, a_drawFramebuffer), glBindFramebuffer(GL_DRAW_FRAMEBUFFER, a_drawFramebuffer));
+}
+
+void GLStateCache::bindVertexArray(uint a_vertexArray)
+{
+	CACHED_CALL(isCached(s_state.vertexArray, a_vertexArray), glBindVertexArray(a_vertexArray));
+}
+
+void GLStateCache::bindTexture(uint a_unit, uint a_target, uint a_texture)
+{
+	assert(a_unit < MAX_TEXTURE_UNITS);
+	CACHED_CALL(isCached(s_state.activeTextureUnit, a_unit), glActiveTexture(GL_TEXTURE0 + a_unit));
+	bindTexture(a_target, a_texture);
+}
+
+void GLStateCache::bindTexture(uint a_target, uint a_texture)
+{
+	const uint targetIdx = findIndex(TEXTURE_TARGETS, NUM_TEXTURE_TARGETS, a_target);
+	assert(targetIdx < NUM_TEXTURE_TARGETS);
+	const uint unit = s_state.activeTextureUnit;
+	if (unit == UNKNOWN)
+	{	// Only happens after an invalidate, the binding can't be cached without knowing the unit
+		s_frameStats.numIssued++;
+		glBindTexture(a_target, a_texture);
+		return;
+	}
+	CACHED_CALL(isCached(s_state.textures[unit][targetIdx], a_texture), glBindTexture(a_target, a_texture));
+}
+
+void GLStateCache::bindBuffer(uint a_target, uint a_buffer)
+{
+	const uint targetIdx = findIndex(BUFFER_TARGETS, NUM_BUFFER_TARGETS, a_target);
+	if (targetIdx == NUM_BUFFER_TARGETS)
+	{
+		assert(a_target == GL_ELEMENT_ARRAY_BUFFER);
+		s_frameStats.numIssued++;
+		glBindBuffer(a_target, a_buffer);
+		return;
+	}
+	CACHED_CALL(isCached(s_state.buffers[targetIdx], a_buffer), glBindBuffer(a_target, a_buffer));
+}
+
+void GLStateCache::bindBufferBase(uint a_target, uint a_index, uint a_buffer)
+{
+	bindBufferRange(a_target, a_index, a_buffer, 0, 0);
+}
+
+void GLStateCache::bindBufferRange(uint a_target, uint a_index, uint a_buffer, uint a_offset, uint a_numBytes)
+{
+	const uint targetIdx = findIndex(INDEXED_TARGETS, NUM_INDEXED_TARGETS, a_target);
+	assert(targetIdx < NUM_INDEXED_TARGETS);
+	s_state.buffers[findIndex(BUFFER_TARGETS, NUM_BUFFER_TARGETS, a_target)] = a_buffer;
+
+	if (a_index >= MAX_INDEXED_BINDINGS)
+	{
+		s_frameStats.numIssued++;
+		if (a_numBytes)
+			glBindBufferRange(a_target, a_index, a_buffer, a_offset, a_numBytes);
+		else
+			glBindBufferBase(a_target, a_index, a_buffer);
+		return;
+	}
+
+	IndexedBinding& binding = s_state.indexedBuffers[targetIdx][a_index];
+	const bool cached = binding.buffer == a_buffer && binding.offset == a_offset && binding.numBytes == a_numBytes;
+	binding.buffer = a_buffer;
+	binding.offset = a_offset;
+	binding.numBytes = a_numBytes;
+	CACHED_CALL(cached, a_numBytes ? glBindBufferRange(a_target, a_index, a_buffer, a_offset, a_numBytes) : glBindBufferBase(a_target, a_index, a_buffer));
+}
+
+void GLStateCache::onTextureDeleted(uint a_texture)
+{
+	for (uint unit = 0; unit < MAX_TEXTURE_UNITS; ++unit)
+		forgetName(s_state.textures[unit], NUM_TEXTURE_TARGETS, a_texture);
+}
+
+void GLStateCache::onBufferDeleted(uint a_buffer)
+{
+	forgetName(s_state.buffers, NUM_BUFFER_TARGETS, a_buffer);
+	for (uint target = 0; target < NUM_INDEXED_TARGETS; ++target)
+		for (uint index = 0; index < MAX_INDEXED_BINDINGS; ++index)
+			forgetName(&s_state.indexedBuffers[target][index].buffer, 1, a_buffer);
+}
+
+void GLStateCache::onProgramDeleted(uint a_program)
+{
+	forgetName(&s_state.program, 1, a_program);
+}
+
+void GLStateCache::onFramebufferDeleted(uint a_framebuffer)
+{
+	forgetName(&s_state.framebuffer, 1, a_framebuffer);
+	forgetName(&s_state.readFramebuffer, 1, a_framebuffer);
+}
+
+void GLStateCache::onVertexArrayDeleted(uint a_vertexArray)
+{
+	forgetName(&s_state.vertexArray, 1, a_vertexArray);
+}
@@ -6,18 +6,25 @@
 #include "Graphics/GL/Scene/GLRenderer.h"
 #include "Graphics/GL/Tech/ClusteredShading.h"
 #include "Graphics/GL/Tech/HBAO.h"
+#include "Graphics/Utils/ShadowCascades.h"
 #include "Utils/StringUtils.h"
 
 uint                            GLConfig::maxMaterials = 200;
-uint                            GLConfig::maxLights = 100;
 GLTexture::EMultiSampleType     GLConfig::multisampleType = GLTexture::EMultiSampleType::NONE;
 uint							GLConfig::hbaoResolutionScale = 2;
 GLConfig::RenderTargets			GLConfig::rt;
-glm::ivec2						GLConfig::sunShadowMapResolution(8192);
+uint							GLConfig::numShadowCascades = 4;
+uint							GLConfig::shadowCascadeResolution = 2048;
+float							GLConfig::shadowCascadeSplitLambda = 0.75f;
+uint							GLConfig::textureStreamingBudgetMB = 1024;
+bool							GLConfig::drawIndirectEnabled = true;
 
 eastl::vector<eastl::string>    GLConfig::defines;
+eastl::vector<eastl::string>    GLConfig::sceneDefines;
+eastl::vector<eastl::string>    GLConfig::sceneExtensions;
 uint                            GLConfig::textureBindingPoints[uint(ETextures::NUM_BINDING_POINTS)];
 GLConstantBuffer::Config        GLConfig::uboConfigs[uint(EUBOs::NUM_UBOS)];
+GLShaderStorageBuffer::Config   GLConfig::ssboConfigs[uint(ESSBOs::NUM_SSBOS)];
 GLVertexBuffer::Config          GLConfig::vboConfigs[uint(EVBOs::NUM_VBOS)];
 
 void GLConfig::initialize()
@@ -37,17 +44,23 @@ void GLConfig::initialize()
 	textureBindingPoints[uint(ETextures::Blur)]                 = 3;
 	textureBindingPoints[uint(ETextures::HBAOResult)]           = 4;
 	textureBindingPoints[uint(ETextures::BloomResult)]          = 5;
+	textureBindingPoints[uint(ETextures::HBAOHistory)]          = 6;
+	textureBindingPoints[uint(ETextures::HBAOHistoryDepth)]     = 7;
 
 	uboConfigs[uint(EUBOs::ModelData)] =                      { 0, "ModelData",               GLConstantBuffer::EDrawUsage::STREAM, sizeof(GLRenderer::ModelData) };
 	uboConfigs[uint(EUBOs::CameraVars)] =                     { 1, "CameraVars",              GLConstantBuffer::EDrawUsage::STREAM, sizeof(GLRenderer::CameraVarsData) };
 	uboConfigs[uint(EUBOs::LightingGlobals)] =                { 2, "LightingGlobals",         GLConstantBuffer::EDrawUsage::DYNAMIC, sizeof(GLRenderer::LightingGlobalsData) };
 	uboConfigs[uint(EUBOs::MaterialProperties)] =             { 3, "MaterialProperties",      GLConstantBuffer::EDrawUsage::STATIC, sizeof(GLMaterial) * maxMaterials };
-	uboConfigs[uint(EUBOs::ClusteredLightPositionRange)] =    { 4, "LightPositionRanges",     GLConstantBuffer::EDrawUsage::STREAM, sizeof(glm::vec4) * maxLights };
-	uboConfigs[uint(EUBOs::ClusteredLightColorIntensities)] = { 5, "LightColorIntensities",   GLConstantBuffer::EDrawUsage::STREAM, sizeof(glm::vec4) * maxLights };
 	uboConfigs[uint(EUBOs::ClusteredGlobals)] =               { 6, "ClusteredShadingGlobals", GLConstantBuffer::EDrawUsage::STATIC, sizeof(ClusteredShading::GlobalsUBO) };
 	uboConfigs[uint(EUBOs::HBAOGlobals)] =                    { 7, "HBAOGlobals",             GLConstantBuffer::EDrawUsage::STATIC, sizeof(HBAO::GlobalsUBO) };
 	uboConfigs[uint(EUBOs::SettingsGlobals)] =                { 8, "SettingsGlobals",         GLConstantBuffer::EDrawUsage::STATIC, sizeof(GLRenderer::SettingsGlobalsData) };
 
+	ssboConfigs[uint(ESSBOs::MaterialProperties)] = { 0, GLShaderStorageBuffer::EDrawUsage::STATIC };
+	ssboConfigs[uint(ESSBOs::DrawTransforms)] =     { 1, GLShaderStorageBuffer::EDrawUsage::STREAM };
+	ssboConfigs[uint(ESSBOs::LightPositionRanges)] =   { 2, GLShaderStorageBuffer::EDrawUsage::DYNAMIC };
+	ssboConfigs[uint(ESSBOs::LightColorIntensities)] = { 3, GLShaderStorageBuffer::EDrawUsage::DYNAMIC };
+	ssboConfigs[uint(ESSBOs::LightDirectionAngles)] =  { 4, GLShaderStorageBuffer::EDrawUsage::DYNAMIC };
+
 	static VertexAttribute GLMESH_VB_ATTRIBS[] = {
 		VertexAttribute(0, VertexAttribute::EFormat::FLOAT, 3),       // Position
 		VertexAttribute(1, VertexAttribute::EFormat::FLOAT, 2),       // Texcoord
@@ -64,6 +77,14 @@ void GLConfig::initialize()
 		GLVertexBuffer::EBufferType::ELEMENT_ARRAY,
 		GLVertexBuffer::EDrawUsage::STATIC
 	};
+	static VertexAttribute GLMESH_DRAW_ID_ATTRIBS[] = {
+		VertexAttribute(5, VertexAttribute::EFormat::UNSIGNED_INT, 1, false, 1) // DrawID, offset by the baseInstance of the draw
+	};
+	vboConfigs[uint(EVBOs::GLMeshDrawID)] = {
+		GLVertexBuffer::EBufferType::ARRAY,
+		GLVertexBuffer::EDrawUsage::STATIC,
+		eastl::vector<VertexAttribute>(GLMESH_DRAW_ID_ATTRIBS, GLMESH_DRAW_ID_ATTRIBS + ARRAY_SIZE(GLMESH_DRAW_ID_ATTRIBS))
+	};
 
 	initializeShaderDefines();
 	setupFramebufferTextures();
@@ -71,16 +92,8 @@ void GLConfig::initialize()
 
 void GLConfig::setupFramebufferTextures()
 {
-	const uint screenWidth = GLEngine::graphics->getViewportWidth();
-	const uint screenHeight = GLEngine::graphics->getViewportHeight();
-
-	rt.sceneColor.initialize(		GLTexture::ESizedFormat::RGB8,		screenWidth, screenHeight, getMultisampleType());
-	rt.sceneDepth.initialize(		GLTexture::ESizedFormat::DEPTH24,	screenWidth, screenHeight, getMultisampleType());
-	rt.sunShadow.initialize(		GLTexture::ESizedFormat::DEPTH32,	sunShadowMapResolution.x, sunShadowMapResolution.y, GLTexture::EMultiSampleType::NONE, GLTexture::ETextureCompareMode::COMPARE_R_TO_TEXTURE);
-	rt.downsampleDepth.initialize(	GLTexture::ESizedFormat::R32F,		screenWidth / hbaoResolutionScale, screenHeight / hbaoResolutionScale);
-	rt.bloom.initialize(			GLTexture::ESizedFormat::RGB8,		screenWidth, screenHeight, getMultisampleType());
-	rt.hbao.initialize(				GLTexture::ESizedFormat::R8,		screenWidth, screenHeight, getMultisampleType());
-	rt.fxaa.initialize(				GLTexture::ESizedFormat::RGB8,		screenWidth, screenHeight);
+	rt.sunShadow.initialize(		GLTexture::ESizedFormat::DEPTH32,	getSunShadowMapRes().x, getSunShadowMapRes().y, GLTexture::EMultiSampleType::NONE, GLTexture::ETextureCompareMode::COMPARE_R_TO_TEXTURE);
+	rt.sunShadowStatic.initialize(	GLTexture::ESizedFormat::DEPTH32,	getSunShadowMapRes().x, getSunShadowMapRes().y);
 }
 
 uint GLConfig::getHBAOResolutionScale()
@@ -90,7 +103,38 @@ uint GLConfig::getHBAOResolutionScale()
 
 glm::ivec2 GLConfig::getSunShadowMapRes()
 {
-	return sunShadowMapResolution;
+	return ShadowCascades::getAtlasSize(numShadowCascades, shadowCascadeResolution);
+}
+
+uint GLConfig::getNumShadowCascades()
+{
+	return numShadowCascades;
+}
+
+uint GLConfig::getShadowCascadeResolution()
+{
+	return shadowCascadeResolution;
+}
+
+void GLConfig::setShadowCascadeResolution(uint a_resolution)
+{
+	shadowCascadeResolution = a_resolution;
+	setupFramebufferTextures();
+}
+
+float GLConfig::getShadowCascadeSplitLambda()
+{
+	return shadowCascadeSplitLambda;
+}
+
+uint GLConfig::getTextureStreamingBudgetMB()
+{
+	return textureStreamingBudgetMB;
+}
+
+bool GLConfig::isDrawIndirectEnabled()
+{
+	return drawIndirectEnabled;
 }
 
 uint GLConfig::getTextureBindingPoint(ETextures a_texture)
@@ -101,6 +145,18 @@ GLConstantBuffer::Config GLConfig::getUBOConfig(EUBOs a_ubo)
 {
 	return uboConfigs[uint(a_ubo)];
 }
+uint GLConfig::getUBOBindingPoint(EUBOs a_ubo)
+{
+	return uboConfigs[uint(a_ubo)].bindingPoint;
+}
+GLShaderStorageBuffer::Config GLConfig::getSSBOConfig(ESSBOs a_ssbo)
+{
+	return ssboConfigs[uint(a_ssbo)];
+}
+uint GLConfig::getSSBOBindingPoint(ESSBOs a_ssbo)
+{
+	return ssboConfigs[uint(a_ssbo)].bindingPoint;
+}
 GLVertexBuffer::Config GLConfig::getVBOConfig(EVBOs a_vbo)
 {
 	return vboConfigs[uint(a_vbo)];
@@ -109,9 +165,13 @@ const eastl::vector<eastl::string>& GLConfig::getGlobalShaderDefines()
 {
 	return defines;
 }
-uint GLConfig::getMaxLights()
+const eastl::vector<eastl::string>& GLConfig::getSceneShaderDefines()
+{
+	return sceneDefines;
+}
+const eastl::vector<eastl::string>& GLConfig::getSceneShaderExtensions()
 {
-	return maxLights;
+	return sceneExtensions;
 }
 uint GLConfig::getMaxMaterials()
 {
@@ -130,13 +190,14 @@ void GLConfig::setMultisampleType(GLTexture::EMultiSampleType a_multisampleType)
 
 #define TEX_BINDING_POINT_STR(X) StringUtils::to_string(textureBindingPoints[uint(X)])
 #define UBO_BINDING_POINT_STR(X) StringUtils::to_string(uboConfigs[uint(X)].bindingPoint)
+#define SSBO_BINDING_POINT_STR(X) StringUtils::to_string(ssboConfigs[uint(X)].bindingPoint)
 
 void GLConfig::initializeShaderDefines()
 {
 	defines.clear();
 
 	defines.push_back("MAX_MATERIALS "    + StringUtils::to_string(GLConfig::maxMaterials));
-	defines.push_back("MAX_LIGHTS "       + StringUtils::to_string(GLConfig::maxLights));
+	defines.push_back("MAX_SHADOW_CASCADES " + StringUtils::to_string(uint(ShadowCascades::MAX_CASCADES)));
 	defines.push_back("NUM_MULTISAMPLES " + StringUtils::to_string(uint(GLConfig::multisampleType)));
 
 	defines.push_back("DIFFUSE_ARRAY_BINDING_POINT "   + TEX_BINDING_POINT_STR(ETextures::DiffuseAtlasArray));
@@ -155,18 +216,32 @@ void GLConfig::initializeShaderDefines()
 	defines.push_back("COLOR_TEXTURE_BINDING_POINT "        + TEX_BINDING_POINT_STR(ETextures::Color));
 	defines.push_back("AO_RESULT_TEXTURE_BINDING_POINT "    + TEX_BINDING_POINT_STR(ETextures::HBAOResult));
 	defines.push_back("BLOOM_RESULT_TEXTURE_BINDING_POINT " + TEX_BINDING_POINT_STR(ETextures::BloomResult));
+	defines.push_back("HBAO_HISTORY_TEXTURE_BINDING_POINT " + TEX_BINDING_POINT_STR(ETextures::HBAOHistory));
+	defines.push_back("HBAO_HISTORY_DEPTH_TEXTURE_BINDING_POINT " + TEX_BINDING_POINT_STR(ETextures::HBAOHistoryDepth));
 
 	defines.push_back("MODEL_DATA_BINDING_POINT "	             + UBO_BINDING_POINT_STR(EUBOs::ModelData));
 	defines.push_back("CAMERA_VARS_BINDING_POINT "               + UBO_BINDING_POINT_STR(EUBOs::CameraVars));
 	defines.push_back("LIGHTING_GLOBALS_BINDING_POINT "          + UBO_BINDING_POINT_STR(EUBOs::LightingGlobals));
 	defines.push_back("MATERIAL_PROPERTIES_BINDING_POINT "       + UBO_BINDING_POINT_STR(EUBOs::MaterialProperties));
-	defines.push_back("LIGHT_POSITION_RANGES_BINDING_POINT "     + UBO_BINDING_POINT_STR(EUBOs::ClusteredLightPositionRange));
-	defines.push_back("LIGHT_COLOR_INTENSITIES_BINDING_POINT "   + UBO_BINDING_POINT_STR(EUBOs::ClusteredLightColorIntensities));
 	defines.push_back("CLUSTERED_SHADING_GLOBALS_BINDING_POINT " + UBO_BINDING_POINT_STR(EUBOs::ClusteredGlobals));
 	defines.push_back("HBAO_GLOBALS_BINDING_POINT "              + UBO_BINDING_POINT_STR(EUBOs::HBAOGlobals));
 	defines.push_back("SETTINGS_GLOBALS_BINDING_POINT "          + UBO_BINDING_POINT_STR(EUBOs::SettingsGlobals));
+
+	defines.push_back("MATERIAL_PROPERTIES_SSBO_BINDING_POINT " + SSBO_BINDING_POINT_STR(ESSBOs::MaterialProperties));
+	defines.push_back("DRAW_TRANSFORMS_BINDING_POINT "          + SSBO_BINDING_POINT_STR(ESSBOs::DrawTransforms));
+	defines.push_back("LIGHT_POSITION_RANGES_BINDING_POINT "    + SSBO_BINDING_POINT_STR(ESSBOs::LightPositionRanges));
+	defines.push_back("LIGHT_COLOR_INTENSITIES_BINDING_POINT "  + SSBO_BINDING_POINT_STR(ESSBOs::LightColorIntensities));
+	defines.push_back("LIGHT_DIRECTION_ANGLES_BINDING_POINT "   + SSBO_BINDING_POINT_STR(ESSBOs::LightDirectionAngles));
+
+	// Storage buffers need GL 4.3, only the scene shaders use them, for the lights and with draw indirect, so the rest keeps working on 4.2
+	sceneDefines = defines;
+	sceneExtensions.clear();
+	sceneExtensions.push_back("GL_ARB_shader_storage_buffer_object");
+	if (drawIndirectEnabled)
+		sceneDefines.push_back("DRAW_INDIRECT 1");
 }
 
 #undef TEX_BINDING_POINT_STR
 #undef UBO_BINDING_POINT_STR
+#undef SSBO_BINDING_POINT_STR
 
@@ -0,0 +1,135 @@
+#include "Graphics/GL/Scene/GLGPUProfiler.h"
+
+#include "Graphics/GL/GL.h"
+#include "Graphics/Utils/CheckGLError.h"
+
+#include <assert.h>
+#include <glm/glm.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const char* const FRAME_PASS_NAME = "Frame";
+
+END_UNNAMED_NAMESPACE()
+
+GLGPUProfiler::~GLGPUProfiler()
+{
+	for (Frame& frame : m_frames)
+		if (!frame.queries.empty())
+			glDeleteQueries(GLsizei(frame.queries.size()), frame.queries.data());
+}
+
+void GLGPUProfiler::initialize(uint a_numFramesInFlight, uint a_numSamples)
+{
+	assert(a_numFramesInFlight);
+	for (Frame& frame : m_frames)
+		if (!frame.queries.empty())
+			glDeleteQueries(GLsizei(frame.queries.size()), frame.queries.data());
+
+	m_frames.clear();
+	m_frames.resize(a_numFramesInFlight);
+	for (Frame& frame : m_frames)
+	{
+		frame.numPasses = 0;
+		frame.isPending = false;
+	}
+	m_timings.initialize(a_numSamples);
+	m_framePassIdx = m_timings.getPassIndex(FRAME_PASS_NAME);
+	m_currentFrame = 0;
+	m_openPasses.clear();
+	m_isMeasuring = false;
+	m_initialized = true;
+}
+
+void GLGPUProfiler::beginFrame()
+{
+	assert(m_initialized && !m_isMeasuring);
+	readFinishedFrames();
+
+	Frame& frame = m_frames[m_currentFrame];
+	if (!m_enabled || frame.isPending)
+		return;
+
+	frame.numPasses = 0;
+	m_isMeasuring = true;
+	beginPass(FRAME_PASS_NAME);
+}
+
+void GLGPUProfiler::endFrame()
+{
+	assert(m_initialized);
+	if (!m_isMeasuring)
+		return;
+
+	endPass();
+	assert(m_openPasses.empty() && "A pass did not end");
+	m_openPasses.clear();
+	m_frames[m_currentFrame].isPending = true;
+	m_currentFrame = (m_currentFrame + 1) % m_frames.size();
+	m_isMeasuring = false;
+}
+
+void GLGPUProfiler::beginPass(const char* a_name)
+{
+	if (!m_isMeasuring)
+		return;
+
+	Frame& frame = m_frames[m_currentFrame];
+	if (frame.numPasses * 2 == frame.queries.size())
+	{
+		// The frames keep their queries, they only grow until they fit the passes of a frame
+		const uint numQueries = uint(frame.queries.size());
+		frame.queries.resize(glm::max(numQueries * 2, 32u));
+		glGenQueries(GLsizei(frame.queries.size() - numQueries), frame.queries.data() + numQueries);
+		frame.passIndices.resize(frame.queries.size() / 2);
+		CHECK_GL_ERROR();
+	}
+	frame.passIndices[frame.numPasses] = m_timings.getPassIndex(a_name);
+	glQueryCounter(frame.queries[frame.numPasses * 2], GL_TIMESTAMP);
+	m_openPasses.push_back(frame.numPasses++);
+}
+
+void GLGPUProfiler::endPass()
+{
+	if (!m_isMeasuring)
+		return;
+
+	assert(!m_openPasses.empty());
+	Frame& frame = m_frames[m_currentFrame];
+	glQueryCounter(frame.queries[m_openPasses.back() * 2 + 1], GL_TIMESTAMP);
+	m_openPasses.pop_back();
+}
+
+void GLGPUProfiler::readFinishedFrames()
+{
+	// The oldest frame in flight is the one after the current, the GPU finishes them in order
+	const uint numFrames = uint(m_frames.size());
+	for (uint i = 1; i <= numFrames; ++i)
+	{
+		Frame& frame = m_frames[(m_currentFrame + i) % numFrames];
+		if (!frame.isPending)
+			continue;
+
+		// The end of the frame pass is the last timestamp of the frame
+		GLint available = 0;
+		glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		m_frameMs.clear();
+		m_frameMs.resize(m_timings.getNumPasses(), -1.0f);
+		for (uint pass = 0; pass < frame.numPasses; ++pass)
+		{
+			GLuint64 beginNs = 0;
+			GLuint64 endNs = 0;
+			glGetQueryObjectui64v(frame.queries[pass * 2], GL_QUERY_RESULT, &beginNs);
+			glGetQueryObjectui64v(frame.queries[pass * 2 + 1], GL_QUERY_RESULT, &endNs);
+			float& ms = m_frameMs[frame.passIndices[pass]];
+			ms = glm::max(ms, 0.0f) + float(double(endNs - beginNs) / 1000000.0);
+		}
+		for (uint passIdx = 0; passIdx < m_frameMs.size(); ++passIdx)
+			if (m_frameMs[passIdx] >= 0.0f)
+				m_timings.addSample(passIdx, m_frameMs[passIdx]);
+		frame.isPending = false;
+	}
+}
@@ -12,6 +12,7 @@ void GLMesh::initialize(const DBMesh& a_mesh)
 	m_numIndices = uint(indices.size());
 	m_boundsMin = a_mesh.getBoundsMin();
 	m_boundsMax = a_mesh.getBoundsMax();
+	calculateMaterialUsages(a_mesh);
 
 	m_stateBuffer.initialize();
 	m_stateBuffer.begin();
@@ -25,8 +26,50 @@ void GLMesh::initialize(const DBMesh& a_mesh)
 	m_stateBuffer.end();
 }
 
+void GLMesh::initializeShared(const DBMesh& a_mesh, uint a_firstIndex, uint a_baseVertex)
+{
+	m_numIndices = uint(a_mesh.getIndices().size());
+	m_firstIndex = a_firstIndex;
+	m_baseVertex = a_baseVertex;
+	m_boundsMin = a_mesh.getBoundsMin();
+	m_boundsMax = a_mesh.getBoundsMax();
+	calculateMaterialUsages(a_mesh);
+}
+
+void GLMesh::calculateMaterialUsages(const DBMesh& a_mesh)
+{
+	const eastl::vector<DBMesh::Vertex>& vertices = a_mesh.getVertices();
+	const eastl::vector<uint>& indices = a_mesh.getIndices();
+
+	// Sum the texture coordinate and object space area of the triangles per material, x = uv area, y = object area
+	eastl::vector<glm::dvec2> areas;
+	for (uint i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const DBMesh::Vertex& v0 = vertices[indices[i]];
+		const DBMesh::Vertex& v1 = vertices[indices[i + 1]];
+		const DBMesh::Vertex& v2 = vertices[indices[i + 2]];
+		const glm::vec2 uvEdge0 = v1.texcoords - v0.texcoords;
+		const glm::vec2 uvEdge1 = v2.texcoords - v0.texcoords;
+		if (v0.materialID >= areas.size())
+			areas.resize(v0.materialID + 1, glm::dvec2(0.0));
+		areas[v0.materialID].x += glm::abs(uvEdge0.x * uvEdge1.y - uvEdge0.y * uvEdge1.x) * 0.5;
+		areas[v0.materialID].y += glm::length(glm::cross(v1.position - v0.position, v2.position - v0.position)) * 0.5;
+	}
+
+	m_materialUsages.clear();
+	for (uint i = 0; i < areas.size(); ++i)
+	{
+		if (areas[i].x > 0.0 && areas[i].y > 0.0)
+		{
+			const MaterialUsage usage = { i, float(glm::sqrt(areas[i].x / areas[i].y)) };
+			m_materialUsages.push_back(usage);
+		}
+	}
+}
+
 void GLMesh::render()
 {
+	assert(m_stateBuffer.isInitialized());
 	m_stateBuffer.begin();
 	glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, NULL);
 	m_stateBuffer.end();
@@ -0,0 +1,262 @@
+#include "Graphics/GL/Scene/GLRenderGraph.h"
+
+#include "GLEngine.h"
+#include "Graphics/GL/GL.h"
+#include "Graphics/GL/Scene/GLGPUProfiler.h"
+#include "Graphics/Graphics.h"
+#include "Graphics/Utils/CheckGLError.h"
+#include "EASTL/algorithm.h"
+
+#include <assert.h>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint MAX_UNUSED_FRAMES = 30; // Targets and framebuffers no frame used in this many frames are deleted
+const float CLEAR_COLOR[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+const float CLEAR_DEPTH = 1.0f;
+
+bool isDepthFormat(uint a_format)
+{
+	return a_format == uint(GLTexture::ESizedFormat::DEPTH16) || a_format == uint(GLTexture::ESizedFormat::DEPTH24) ||
+		a_format == uint(GLTexture::ESizedFormat::DEPTH32);
+}
+
+/** What drivers allocate, 3 component formats are padded to 4 */
+uint getBytesPerPixel(GLTexture::ESizedFormat a_format)
+{
+	switch (a_format)
+	{
+	case GLTexture::ESizedFormat::R8:      return 1;
+	case GLTexture::ESizedFormat::R16:
+	case GLTexture::ESizedFormat::R16F:
+	case GLTexture::ESizedFormat::RG8:
+	case GLTexture::ESizedFormat::DEPTH16: return 2;
+	case GLTexture::ESizedFormat::RG16F:
+	case GLTexture::ESizedFormat::RG16:
+	case GLTexture::ESizedFormat::R32F:
+	case GLTexture::ESizedFormat::RGB8:
+	case GLTexture::ESizedFormat::RGBA8:
+	case GLTexture::ESizedFormat::DEPTH24:
+	case GLTexture::ESizedFormat::DEPTH32: return 4;
+	case GLTexture::ESizedFormat::RG32F:
+	case GLTexture::ESizedFormat::RGB16F:
+	case GLTexture::ESizedFormat::RGBA16F: return 8;
+	case GLTexture::ESizedFormat::RGB32F:
+	case GLTexture::ESizedFormat::RGBA32F: return 16;
+	default:                               return 4;
+	}
+}
+
+END_UNNAMED_NAMESPACE()
+
+GLRenderGraph::~GLRenderGraph()
+{
+	for (Framebuffer& framebuffer : m_framebuffers)
+		SAFE_DELETE(framebuffer.framebuffer);
+	for (Target& target : m_targets)
+		SAFE_DELETE(target.texture);
+}
+
+RenderGraph::ResourceDesc GLRenderGraph::makeDesc(GLTexture::ESizedFormat a_format, uint a_width, uint a_height, GLTexture::EMultiSampleType a_multiSampleType)
+{
+	RenderGraph::ResourceDesc desc;
+	desc.format = uint(a_format);
+	desc.width = a_width;
+	desc.height = a_height;
+	desc.numSamples = uint(a_multiSampleType);
+	desc.bytesPerPixel = getBytesPerPixel(a_format);
+	return desc;
+}
+
+void GLRenderGraph::setImportedTexture(RenderGraph::ResourceHandle a_resource, GLTexture* a_texture)
+{
+	assert(m_graph.isImported(a_resource));
+	if (a_resource >= m_importedTextures.size())
+		m_importedTextures.resize(a_resource + 1, NULL);
+	m_importedTextures[a_resource] = a_texture;
+}
+
+void GLRenderGraph::releaseFramebuffers(const GLTexture& a_texture)
+{
+	for (uint i = 0; i < m_framebuffers.size();)
+	{
+		const eastl::vector<uint>& textureIDs = m_framebuffers[i].textureIDs;
+		if (eastl::find(textureIDs.begin(), textureIDs.end(), a_texture.getTextureID()) != textureIDs.end())
+		{
+			SAFE_DELETE(m_framebuffers[i].framebuffer);
+			m_framebuffers[i] = m_framebuffers.back();
+			m_framebuffers.pop_back();
+		}
+		else
+			++i;
+	}
+}
+
+bool GLRenderGraph::execute()
+{
+	if (!m_graph.compile())
+		return false;
+	++m_frame;
+
+	// Every physical target of the graph takes a kept texture of the same description or a new one
+	m_physicalTargets.clear();
+	for (uint i = 0; i < m_graph.getNumPhysical(); ++i)
+	{
+		const RenderGraph::ResourceDesc& desc = m_graph.getPhysicalDesc(i);
+		uint targetIdx = RenderGraph::INVALID_INDEX;
+		for (uint j = 0; j < m_targets.size() && targetIdx == RenderGraph::INVALID_INDEX; ++j)
+			if (m_targets[j].lastUsedFrame != m_frame && m_targets[j].desc == desc)
+				targetIdx = j;
+		if (targetIdx == RenderGraph::INVALID_INDEX)
+		{
+			Target target;
+			target.desc = desc;
+			target.texture = new GLTexture();
+			target.texture->initialize(GLTexture::ESizedFormat(desc.format), desc.width, desc.height, GLTexture::EMultiSampleType(desc.numSamples));
+			targetIdx = uint(m_targets.size());
+			m_targets.push_back(target);
+		}
+		m_targets[targetIdx].lastUsedFrame = m_frame;
+		m_physicalTargets.push_back(targetIdx);
+	}
+
+	GLFramebuffer* framebuffer = NULL;
+	for (const RenderGraph::CompiledPass& compiled : m_graph.getCompiledPasses())
+	{
+		const eastl::vector<RenderGraph::ResourceHandle>& attachments = m_graph.getAttachments(compiled.pass);
+		if (framebuffer && (compiled.bindFramebuffer || attachments.empty()))
+		{
+			framebuffer->end();
+			framebuffer = NULL;
+		}
+		// Ending the framebuffer before binds the default framebuffer
+		if (compiled.bindFramebuffer && getAttachmentTexture(attachments[0]))
+		{
+			framebuffer = &getFramebuffer(attachments);
+			framebuffer->begin();
+		}
+		if (!attachments.empty())
+		{
+			const RenderGraph::ResourceDesc& desc = m_graph.getResourceDesc(attachments[0]);
+			GLEngine::graphics->setViewportPosition(0, 0);
+			GLEngine::graphics->setViewportSize(desc.width, desc.height);
+		}
+		if (m_profiler)
+			m_profiler->beginPass(m_graph.getPassName(compiled.pass));
+		if (compiled.clearMask)
+			clearAttachments(attachments, compiled.clearMask);
+		m_graph.executePass(compiled.pass);
+		if (m_profiler)
+			m_profiler->endPass();
+	}
+	if (framebuffer)
+		framebuffer->end();
+
+	deleteUnusedTargets();
+	return true;
+}
+
+GLTexture& GLRenderGraph::getTexture(RenderGraph::ResourceHandle a_resource)
+{
+	GLTexture* texture = getAttachmentTexture(a_resource);
+	assert(texture);
+	return *texture;
+}
+
+uint64 GLRenderGraph::getTargetBytes() const
+{
+	uint64 numBytes = 0;
+	for (const Target& target : m_targets)
+		numBytes += target.desc.getNumBytes();
+	return numBytes;
+}
+
+GLTexture* GLRenderGraph::getAttachmentTexture(RenderGraph::ResourceHandle a_resource)
+{
+	if (m_graph.isImported(a_resource))
+		return a_resource < m_importedTextures.size() ? m_importedTextures[a_resource] : NULL;
+	const uint physicalIdx = m_graph.getPhysicalIdx(a_resource);
+	assert(physicalIdx < m_physicalTargets.size());
+	return m_targets[m_physicalTargets[physicalIdx]].texture;
+}
+
+GLFramebuffer& GLRenderGraph::getFramebuffer(const eastl::vector<RenderGraph::ResourceHandle>& a_attachments)
+{
+	m_attachmentTextureIDs.clear();
+	for (RenderGraph::ResourceHandle resource : a_attachments)
+		m_attachmentTextureIDs.push_back(getTexture(resource).getTextureID());
+
+	for (Framebuffer& framebuffer : m_framebuffers)
+	{
+		if (framebuffer.textureIDs == m_attachmentTextureIDs)
+		{
+			framebuffer.lastUsedFrame = m_frame;
+			return *framebuffer.framebuffer;
+		}
+	}
+
+	Framebuffer framebuffer;
+	framebuffer.textureIDs = m_attachmentTextureIDs;
+	framebuffer.framebuffer = new GLFramebuffer();
+	framebuffer.framebuffer->initialize(getTexture(a_attachments[0]).getMultiSampleType());
+	framebuffer.lastUsedFrame = m_frame;
+	uint colorIdx = 0;
+	for (RenderGraph::ResourceHandle resource : a_attachments)
+	{
+		if (isDepthFormat(m_graph.getResourceDesc(resource).format))
+			framebuffer.framebuffer->setDepthbufferTexture(getTexture(resource));
+		else
+			framebuffer.framebuffer->addFramebufferTexture(getTexture(resource), GLFramebuffer::EAttachment(uint(GLFramebuffer::EAttachment::COLOR0) + colorIdx++));
+	}
+	m_framebuffers.push_back(framebuffer);
+	return *m_framebuffers.back().framebuffer;
+}
+
+void GLRenderGraph::clearAttachments(const eastl::vector<RenderGraph::ResourceHandle>& a_attachments, uint a_clearMask)
+{
+	// Clears go through the write masks, the passes set the ones they need themselves
+	GLEngine::graphics->setColorWrite(true);
+	GLEngine::graphics->setDepthWrite(true);
+	uint colorIdx = 0;
+	for (uint i = 0; i < a_attachments.size(); ++i)
+	{
+		const bool isDepth = isDepthFormat(m_graph.getResourceDesc(a_attachments[i]).format);
+		if (a_clearMask & (1u << i))
+		{
+			if (isDepth)
+				glClearBufferfv(GL_DEPTH, 0, &CLEAR_DEPTH);
+			else
+				glClearBufferfv(GL_COLOR, colorIdx, CLEAR_COLOR);
+		}
+		if (!isDepth)
+			++colorIdx;
+	}
+	CHECK_GL_ERROR();
+}
+
+void GLRenderGraph::deleteUnusedTargets()
+{
+	for (uint i = 0; i < m_framebuffers.size();)
+	{
+		if (m_frame - m_framebuffers[i].lastUsedFrame > MAX_UNUSED_FRAMES)
+		{
+			SAFE_DELETE(m_framebuffers[i].framebuffer);
+			m_framebuffers[i] = m_framebuffers.back();
+			m_framebuffers.pop_back();
+		}
+		else
+			++i;
+	}
+	// Framebuffers go unused at least as long as their targets, so none of the ones left attach a deleted target
+	for (uint i = 0; i < m_targets.size();)
+	{
+		if (m_frame - m_targets[i].lastUsedFrame > MAX_UNUSED_FRAMES)
+		{
+			SAFE_DELETE(m_targets[i].texture);
+			m_targets[i] = m_targets.back();
+			m_targets.pop_back();
+		}
+		else
+			++i;
+	}
+}
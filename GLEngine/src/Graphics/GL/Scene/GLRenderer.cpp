@@ -31,8 +31,21 @@ const char* const COMBINE_FRAG_SHADER_PATH = "../EngineAssets/Shaders/combine.fr
 // TODO: Settings struct
 const glm::vec3 AMBIENT(0.125f);
 const glm::ivec2 CUBE_MAP_RES(4096);
-const float SHADOW_VIEW_RANGE = 200.0f;
-const float SUN_DISTANCE = 50.0f;
+const uint FRAME_DATA_BUFFER_SIZE = 16 * 1024 * 1024;
+
+// From the best to the cheapest, the costs are estimates of the GPU time relative to the first level
+const QualityGovernor::QualityLevel QUALITY_LEVELS[] =
+{
+	// resolutionScale, hbaoResolutionScale, shadowCascadeResolution, numBloomLevels, relativeCost
+	{ 1.0f, 1, 2048, 6, 1.0f  },
+	{ 1.0f, 2, 2048, 5, 0.85f },
+	{ 0.9f, 2, 2048, 5, 0.7f  },
+	{ 0.8f, 2, 1024, 4, 0.56f },
+	{ 0.7f, 4, 1024, 4, 0.44f },
+	{ 0.6f, 4, 512,  3, 0.33f },
+	{ 0.5f, 4, 512,  3, 0.25f },
+};
+const uint START_QUALITY_LEVEL = 1; // The same as the settings of the GLConfig
 
 END_UNNAMED_NAMESPACE()
 
@@ -41,23 +54,35 @@ void GLRenderer::initialize(const PerspectiveCamera& a_camera)
 	const uint screenWidth = GLEngine::graphics->getViewportWidth();
 	const uint screenHeight = GLEngine::graphics->getViewportHeight();
 
-	m_sceneFBO.initialize(GLConfig::getMultisampleType());
-	m_sceneFBO.addFramebufferTexture(GLConfig::rt.sceneColor);
-	m_sceneFBO.setDepthbufferTexture(GLConfig::rt.sceneDepth);
-
 	m_shadowFBO.initialize();
 	m_shadowFBO.setDepthbufferTexture(GLConfig::rt.sunShadow);
+	m_staticShadowFBO.initialize();
+	m_staticShadowFBO.setDepthbufferTexture(GLConfig::rt.sunShadowStatic);
+
+	TextureStreamingPolicy::Settings streamingSettings;
+	streamingSettings.budgetBytes = uint64(GLConfig::getTextureStreamingBudgetMB()) * 1024 * 1024;
+	GLScene::getTextureStreaming().setSettings(streamingSettings);
 
-	m_shadowCamera.initialize(SHADOW_VIEW_RANGE, SHADOW_VIEW_RANGE, 90.0f, 0.1f, SHADOW_VIEW_RANGE, PerspectiveCamera::EProjection::ORTHOGRAPHIC);
+	ShadowCascades::Settings cascadeSettings;
+	cascadeSettings.numCascades = GLConfig::getNumShadowCascades();
+	cascadeSettings.resolution = GLConfig::getShadowCascadeResolution();
+	cascadeSettings.splitLambda = GLConfig::getShadowCascadeSplitLambda();
+	m_shadowCascades.setSettings(cascadeSettings);
 
 	m_clusteredShading.initialize(a_camera, screenWidth, screenHeight);
 	m_hbao.initialize(a_camera, screenWidth, screenHeight);
-	m_bloom.initialize(screenWidth, screenHeight);
-	m_fxaa.initialize(FXAA::EQuality::EXTREME, screenWidth, screenHeight);
-
-	m_modelDataUBO.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::ModelData));
-	m_cameraVarsUBO.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::CameraVars));
-	m_lightningGlobalsUBO.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::LightingGlobals));
+	m_bloom.initialize();
+	m_fxaa.initialize(FXAA::EQuality::EXTREME);
+
+	m_qualityGovernor.initialize(QualityGovernor::Settings(),
+		eastl::vector<QualityGovernor::QualityLevel>(QUALITY_LEVELS, QUALITY_LEVELS + ARRAY_SIZE(QUALITY_LEVELS)), START_QUALITY_LEVEL);
+	m_defaultQualityLevel = { 1.0f, GLConfig::getHBAOResolutionScale(), GLConfig::getShadowCascadeResolution(), Bloom::DEFAULT_NUM_LEVELS, 1.0f };
+	m_gpuTimer.initialize();
+	m_gpuProfiler.initialize();
+	m_renderGraph.setProfiler(&m_gpuProfiler);
+
+	m_frameDataBuffer.initialize(FRAME_DATA_BUFFER_SIZE);
+	m_occlusionBuffer.initialize(OcclusionBuffer::Settings());
 	m_settingsGlobalsUBO.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::SettingsGlobals));
 
 	DBTexture dfvDBTexture;
@@ -71,9 +96,9 @@ void GLRenderer::initialize(const PerspectiveCamera& a_camera)
 
 void GLRenderer::reloadShaders()
 {
-	m_depthPrepassShader.initialize(DEPTH_VERT_SHADER_PATH, DEPTH_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
-	m_modelShader.initialize(MODEL_VERT_SHADER_PATH, MODEL_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
-	m_skyboxShader.initialize(SKYBOX_VERT_SHADER_PATH, SKYBOX_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
+	m_depthPrepassShader.initialize(DEPTH_VERT_SHADER_PATH, DEPTH_FRAG_SHADER_PATH, &GLConfig::getSceneShaderDefines(), &GLConfig::getSceneShaderExtensions());
+	m_modelShader.initialize(MODEL_VERT_SHADER_PATH, MODEL_FRAG_SHADER_PATH, &GLConfig::getSceneShaderDefines(), &GLConfig::getSceneShaderExtensions());
+	m_skyboxShader.initialize(SKYBOX_VERT_SHADER_PATH, SKYBOX_FRAG_SHADER_PATH, &GLConfig::getSceneShaderDefines(), &GLConfig::getSceneShaderExtensions());
 	m_combineShader.initialize(COMBINE_VERT_SHADER_PATH, COMBINE_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
 
 	m_hbao.reloadShader();
@@ -81,40 +106,71 @@ void GLRenderer::reloadShaders()
 	QuadDrawer::reloadShader();
 }
 
-void GLRenderer::render(const PerspectiveCamera& a_camera, const LightManager& a_lightManager)
+void GLRenderer::render(const PerspectiveCamera& a_camera, LightManager& a_lightManager)
 {
+	m_cpuStopwatch.start();
+	m_gpuTimer.begin();
 	m_sceneCamera = &a_camera;
 	const uint screenWidth = GLEngine::graphics->getViewportWidth();
 	const uint screenHeight = GLEngine::graphics->getViewportHeight();
-	
+
+	// The scene and its effects are rendered at a lower resolution when the GPU could not keep up, the last pass upscales to the screen
+	const QualityGovernor::QualityLevel& qualityLevel = m_qualityGovernorEnabled ? m_qualityGovernor.getQualityLevel() : m_defaultQualityLevel;
+	const uint renderWidth = glm::max(uint(float(screenWidth) * qualityLevel.resolutionScale + 0.5f), 1u);
+	const uint renderHeight = glm::max(uint(float(screenHeight) * qualityLevel.resolutionScale + 0.5f), 1u);
+	m_renderScale = float(renderWidth) / float(screenWidth);
+	applyQualityLevel(qualityLevel, renderWidth, renderHeight);
+
 	m_clusteredShading.update(a_camera, a_lightManager);
-	m_clusteredShading.bindTextureBuffers();
+	m_clusteredShading.bindBuffers();
 	m_dfvTexture.bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::DFVTexture));
 
+	m_shadowCascades.update(a_camera, m_sunDir);
 	updateLightingGlobalsUBO(a_camera);
 
-	// Shadows and depth prepass first
+	// Shadows first
 	GLEngine::graphics->setDepthWrite(true);
 	GLEngine::graphics->setColorWrite(false);
 	GLEngine::graphics->setDepthTest(true);
 	GLEngine::graphics->setDepthFunc(Graphics::EDepthFunc::LESS);
 	
-	// SUN SHADOW MAP GENERATION //
+	// SUN SHADOW MAP GENERATION // The static casters of every cascade are cached and only rendered again when the cascade moved,
+	// the tiles that update this frame copy them and render the dynamic casters on top. Far cascades update less often
+	m_gpuProfiler.beginPass("Shadows");
 	if (m_shadowsEnabled)
 	{
-		m_shadowFBO.begin();
-		m_sceneCamera = &m_shadowCamera;
-		updateCameraDataUBO(m_shadowCamera);
-		GLEngine::graphics->setViewportSize(GLConfig::getSunShadowMapRes().x, GLConfig::getSunShadowMapRes().y);
 		GLEngine::graphics->setFaceCulling(Graphics::EFaceCulling::FRONT);
-		GLEngine::graphics->clearDepthOnly();
 		m_depthPrepassShader.begin();
-		for (GLRenderObject* renderObject : m_renderObjects)
-			renderObject->render(*this, true);
+		// Every cascade renders into its tile of the atlas, the scenes cull their casters with the frustum of the cascade
+		for (uint i = 0; i < m_shadowCascades.getNumCascades(); ++i)
+		{
+			const ShadowCascades::Cascade& cascade = m_shadowCascades.getCascade(i);
+			if (!cascade.renderDynamic)
+				continue;
+
+			m_sceneCamera = &cascade.camera;
+			updateCameraDataUBO(cascade.camera);
+			GLEngine::graphics->setViewportPosition(cascade.viewport.x, cascade.viewport.y);
+			GLEngine::graphics->setViewportSize(cascade.viewport.z, cascade.viewport.w);
+			if (cascade.renderStatic)
+			{
+				m_staticShadowFBO.begin();
+				GLEngine::graphics->clearDepthOnly(cascade.viewport.x, cascade.viewport.y, cascade.viewport.z, cascade.viewport.w);
+				for (GLRenderObject* renderObject : m_staticRenderObjects)
+					renderObject->render(*this, true);
+				m_staticShadowFBO.end();
+			}
+			m_staticShadowFBO.blitDepth(m_shadowFBO, cascade.viewport.x, cascade.viewport.y, cascade.viewport.z, cascade.viewport.w);
+
+			m_shadowFBO.begin();
+			for (GLRenderObject* renderObject : m_dynamicRenderObjects)
+				renderObject->render(*this, true);
+			m_shadowFBO.end();
+		}
 		m_depthPrepassShader.end();
+		GLEngine::graphics->setViewportPosition(0, 0);
 		GLEngine::graphics->setFaceCulling(Graphics::EFaceCulling::BACK);
 		m_sceneCamera = &a_camera;
-		m_shadowFBO.end();
 	}
 	else
 	{
@@ -122,79 +178,146 @@ void GLRenderer::render(const PerspectiveCamera& a_camera, const LightManager& a
 		GLEngine::graphics->clearDepthOnly();
 		m_shadowFBO.end();
 	}
+	m_gpuProfiler.endPass();
 	
-	// MAIN SCENE //
-	m_sceneFBO.begin();
-	GLEngine::graphics->setViewportSize(screenWidth, screenHeight);
-	GLEngine::graphics->clearDepthOnly();
-	updateCameraDataUBO(a_camera);
+	// OCCLUSION CULLING // The occluders of all objects are rasterized on the CPU, the scenes test their meshes against them in the passes below
+	if (m_occlusionCullingEnabled)
+	{
+		m_occlusionBuffer.beginFrame(a_camera.getCombinedMatrix());
+		for (GLRenderObject* renderObject : m_renderObjects)
+			renderObject->addOccluders(m_occlusionBuffer, a_camera);
+		m_occlusionBuffer.rasterizeOccluders();
+		m_occlusionCamera = &a_camera;
+	}
+
+	// FRAME GRAPH // The passes declare the targets they read and write, the graph culls the passes nothing reads,
+	// lets targets that do not live at the same time share memory and binds and clears the framebuffers
+	RenderGraph& graph = m_renderGraph.getGraph();
+	graph.reset();
+	const GLTexture::EMultiSampleType multisampleType = GLConfig::getMultisampleType();
+	const RenderGraph::ResourceHandle backbuffer = graph.importResource("Backbuffer",
+		GLRenderGraph::makeDesc(GLTexture::ESizedFormat::RGB8, screenWidth, screenHeight), true);
+	m_renderGraph.setImportedTexture(backbuffer, NULL);
+	const RenderGraph::ResourceHandle sceneColor = graph.createTransient("Scene color",
+		GLRenderGraph::makeDesc(GLTexture::ESizedFormat::RGB8, renderWidth, renderHeight, multisampleType));
+	const RenderGraph::ResourceHandle sceneDepth = graph.createTransient("Scene depth",
+		GLRenderGraph::makeDesc(GLTexture::ESizedFormat::DEPTH24, renderWidth, renderHeight, multisampleType));
 
 	// DEPTH PREPASS //
-	m_depthPrepassShader.begin();
-	for (GLRenderObject* renderObject : m_renderObjects)
-		renderObject->render(*this, true);
-	m_depthPrepassShader.end();
-	
-	GLEngine::graphics->setDepthFunc(Graphics::EDepthFunc::LEQUAL);
-	GLEngine::graphics->setDepthWrite(false);
-	GLEngine::graphics->setColorWrite(true);
+	const RenderGraph::PassHandle depthPrepass = graph.addPass("Depth prepass", [this, &a_camera]()
+	{
+		GLEngine::graphics->setDepthWrite(true);
+		GLEngine::graphics->setColorWrite(false);
+		GLEngine::graphics->setDepthTest(true);
+		GLEngine::graphics->setDepthFunc(Graphics::EDepthFunc::LESS);
+		updateCameraDataUBO(a_camera);
 
-	// RENDER SKYBOXES // TODO: render skyboxes last with depth test to reduce fillrate
-	GLEngine::graphics->setDepthTest(false);
-	m_skyboxShader.begin();
-	for (GLRenderObject* renderObject : m_skyboxObjects)
-		renderObject->render(*this, false);
-	m_skyboxShader.end();
-	
-	// RENDER MODELS //
-	GLEngine::graphics->setDepthTest(true);
-	m_modelShader.begin();
-	m_shadowFBO.bindDepthTexture(GLConfig::getTextureBindingPoint(GLConfig::ETextures::SunShadow));
-	for (GLRenderObject* renderObject : m_renderObjects)
-		renderObject->render(*this, false);
-	m_modelShader.end();
-
-	m_sceneFBO.end();
-	m_sceneFBO.bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::Color));
-
-	GLEngine::graphics->setDepthTest(false);
-	m_combineShader.begin();
-	QuadDrawer::drawQuad(m_combineShader);
-	m_combineShader.end();
-
-	// APPLY HBAO //
-	GLFramebuffer* hbaoResult = NULL;
-	if (m_hbaoEnabled)
-		hbaoResult = &m_hbao.getHBAOResultFBO(m_sceneFBO);
+		m_depthPrepassShader.begin();
+		for (GLRenderObject* renderObject : m_renderObjects)
+			renderObject->render(*this, true);
+		m_depthPrepassShader.end();
+	});
+	graph.write(depthPrepass, sceneColor);
+	graph.write(depthPrepass, sceneDepth, RenderGraph::ELoad::CLEAR);
 
-	// APPLY BLOOM // 
-	GLFramebuffer* bloomResult = NULL;
-	if (m_bloomEnabled)
-		bloomResult = &m_bloom.getBloomResultFBO(m_sceneFBO);
+	// RENDER SKYBOXES // TODO: render skyboxes last with depth test to reduce fillrate
+	const RenderGraph::PassHandle skyboxPass = graph.addPass("Skybox", [this]()
+	{
+		GLEngine::graphics->setDepthFunc(Graphics::EDepthFunc::LEQUAL);
+		GLEngine::graphics->setDepthWrite(false);
+		GLEngine::graphics->setColorWrite(true);
+		GLEngine::graphics->setDepthTest(false);
+
+		m_skyboxShader.begin();
+		for (GLRenderObject* renderObject : m_skyboxObjects)
+			renderObject->render(*this, false);
+		m_skyboxShader.end();
+	});
+	graph.write(skyboxPass, sceneColor);
+	graph.write(skyboxPass, sceneDepth);
 
-	// BIND RESULT TEXTURES OF ALL PASSES // 
+	// RENDER MODELS //
+	const RenderGraph::PassHandle modelPass = graph.addPass("Models", [this]()
+	{
+		GLEngine::graphics->setDepthTest(true);
+		m_modelShader.begin();
+		m_shadowFBO.bindDepthTexture(GLConfig::getTextureBindingPoint(GLConfig::ETextures::SunShadow));
+		for (GLRenderObject* renderObject : m_renderObjects)
+			renderObject->render(*this, false);
+		m_modelShader.end();
+
+		// The passes after draw quads
+		GLEngine::graphics->setDepthTest(false);
+	});
+	graph.write(modelPass, sceneColor);
+	graph.write(modelPass, sceneDepth);
+
+	// HBAO AND BLOOM // Culled by the graph when they are disabled, the combine pass does not read them then
+	const RenderGraph::ResourceHandle hbaoResult = m_hbao.addPasses(m_renderGraph, sceneDepth, a_camera);
+	const RenderGraph::ResourceHandle bloomResult = m_bloom.addPasses(m_renderGraph, sceneColor);
+
+	// COMBINE, FXAA AND UPSCALE // FXAA upscales while it filters, without it a pass stretches the combined image to the screen
+	const bool isUpscaled = renderWidth != screenWidth || renderHeight != screenHeight;
+	const RenderGraph::ResourceHandle combined = (m_fxaaEnabled || isUpscaled) ?
+		graph.createTransient("Combined", GLRenderGraph::makeDesc(GLTexture::ESizedFormat::RGB8, renderWidth, renderHeight)) : backbuffer;
+	const RenderGraph::PassHandle combinePass = graph.addPass("Combine", [this, sceneColor, hbaoResult, bloomResult]()
+	{
+		m_renderGraph.getTexture(sceneColor).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Color));
+		if (m_hbaoEnabled)
+			m_renderGraph.getTexture(hbaoResult).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::HBAOResult));
+		if (m_bloomEnabled)
+			m_renderGraph.getTexture(bloomResult).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::BloomResult));
+		m_combineShader.begin();
+		QuadDrawer::drawQuad(m_combineShader);
+		m_combineShader.end();
+	});
+	graph.read(combinePass, sceneColor);
 	if (m_hbaoEnabled)
-		hbaoResult->bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::HBAOResult));
-
+		graph.read(combinePass, hbaoResult);
 	if (m_bloomEnabled)
-		bloomResult->bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::BloomResult));
-
-	// APPLY FXAA AND RENDER COMBINED SCENE //
+		graph.read(combinePass, bloomResult);
+	graph.write(combinePass, combined, RenderGraph::ELoad::DONT_CARE);
 	if (m_fxaaEnabled)
-		m_fxaa.begin();
-	m_combineShader.begin();
-	QuadDrawer::drawQuad(m_combineShader);
-	m_combineShader.end();
-	if (m_fxaaEnabled)
-		m_fxaa.endAndRender();
+		m_fxaa.addPass(m_renderGraph, combined, backbuffer);
+	else if (isUpscaled)
+	{
+		const RenderGraph::PassHandle upscalePass = graph.addPass("Upscale", [this, combined]()
+		{
+			m_renderGraph.getTexture(combined).bind(0);
+			QuadDrawer::drawQuad();
+		});
+		graph.read(upscalePass, combined);
+		graph.write(upscalePass, backbuffer, RenderGraph::ELoad::DONT_CARE);
+	}
+
+	m_renderGraph.execute();
+	m_gpuTimer.end();
 
 	GLEngine::graphics->setDepthTest(true);
 	m_sceneCamera = NULL;
+	m_occlusionCamera = NULL;
+
+	// Decide which texture levels to load or evict with the requests of this frame
+	GLScene::getTextureStreaming().update();
+	m_frameDataBuffer.endFrame();
+
+	// The GPU time arrives a few frames late, the new level is used from the next frame on
+	m_cpuStopwatch.stop();
+	const float gpuMs = m_gpuTimer.readLatestMs();
+	if (m_qualityGovernorEnabled)
+		m_qualityGovernor.update(gpuMs, float(m_cpuStopwatch.avgMicroSec().count()) / 1000.0f);
 }
 
-void GLRenderer::addRenderObject(GLRenderObject* a_renderObject)
+void GLRenderer::addRenderObject(GLRenderObject* a_renderObject, bool a_isStatic)
 {
 	m_renderObjects.push_back(a_renderObject);
+	if (a_isStatic)
+	{
+		m_staticRenderObjects.push_back(a_renderObject);
+		invalidateStaticShadows();
+	}
+	else
+		m_dynamicRenderObjects.push_back(a_renderObject);
 }
 
 void GLRenderer::removeRenderObject(GLRenderObject* a_renderObject)
@@ -202,6 +325,16 @@ void GLRenderer::removeRenderObject(GLRenderObject* a_renderObject)
 	auto it = eastl::find(m_renderObjects.begin(), m_renderObjects.end(), a_renderObject);
 	if (it != m_renderObjects.end())
 		m_renderObjects.erase(it);
+
+	auto staticIt = eastl::find(m_staticRenderObjects.begin(), m_staticRenderObjects.end(), a_renderObject);
+	if (staticIt != m_staticRenderObjects.end())
+	{
+		m_staticRenderObjects.erase(staticIt);
+		invalidateStaticShadows();
+	}
+	auto dynamicIt = eastl::find(m_dynamicRenderObjects.begin(), m_dynamicRenderObjects.end(), a_renderObject);
+	if (dynamicIt != m_dynamicRenderObjects.end())
+		m_dynamicRenderObjects.erase(dynamicIt);
 }
 
 void GLRenderer::addSkybox(GLRenderObject* a_renderObject)
@@ -230,24 +363,28 @@ void GLRenderer::setBloomEnabled(bool a_enabled)
 
 void GLRenderer::setShadowsEnabled(bool a_enabled)
 {
+	// The cascades kept moving while the shadows were disabled
+	if (a_enabled && !m_shadowsEnabled)
+		invalidateStaticShadows();
 	m_shadowsEnabled = a_enabled;
 	updateSettingsGlobalsUBO();
 }
 
+void GLRenderer::setQualityGovernorEnabled(bool a_enabled)
+{
+	m_qualityGovernorEnabled = a_enabled;
+}
+
 void GLRenderer::setSun(const glm::vec3& a_direction, const glm::vec3& a_color, float a_intensity)
 {
 	m_sunDir = a_direction;
 	m_sunColorIntensity = glm::vec4(a_color, a_intensity);
-
-	// TODO: more efficient camera positioning
-	m_shadowCamera.setPosition(glm::vec3(a_direction * SUN_DISTANCE));
-	m_shadowCamera.lookAtPoint(glm::vec3(0));
-	m_shadowCamera.updateMatrices();
 }
 
 void GLRenderer::setModelDataUBO(const ModelData& a_modelData)
 {
-	m_modelDataUBO.upload(sizeof(ModelData), &a_modelData);
+	const GLRingBuffer::Allocation allocation = m_frameDataBuffer.upload(sizeof(ModelData), &a_modelData);
+	m_frameDataBuffer.bindRange(GLRingBuffer::EBindTarget::UNIFORM, GLConfig::getUBOBindingPoint(GLConfig::EUBOs::ModelData), allocation);
 }
 
 void GLRenderer::drawDebugSphere(const glm::vec3& position, float radius)
@@ -255,41 +392,67 @@ void GLRenderer::drawDebugSphere(const glm::vec3& position, float radius)
 	if (!m_debugSphere.isInitialized())
 		m_debugSphere.initialize(DBScene("assets/Models/sphere/sphere.obj"));
 
-	ModelData data;
-	data.u_modelMatrix = glm::translate(glm::mat4(), position);
-	data.u_modelMatrix = glm::scale(data.u_modelMatrix, glm::vec3(radius));
-	data.u_normalMatrix = glm::inverse(glm::transpose(data.u_modelMatrix * m_sceneCamera->getViewMatrix()));
-
-	setModelDataUBO(data);
-	m_debugSphere.m_meshes[0].render();
+	glm::mat4 transform = glm::translate(glm::mat4(), position);
+	transform = glm::scale(transform, glm::vec3(radius));
+	// Goes through the scene so it is drawn the same way, directly or indirect, as the other scenes
+	m_debugSphere.render(*this, transform);
 }
 
 void GLRenderer::updateLightingGlobalsUBO(const PerspectiveCamera& a_camera)
 {
-	LightingGlobalsData* lightingGlobals = rcast<LightingGlobalsData*>(m_lightningGlobalsUBO.mapBuffer());
+	const GLRingBuffer::Allocation allocation = m_frameDataBuffer.allocate(sizeof(LightingGlobalsData));
+	LightingGlobalsData* lightingGlobals = rcast<LightingGlobalsData*>(allocation.data);
 	lightingGlobals->u_ambient = AMBIENT;
 	lightingGlobals->u_sunDir = glm::normalize(glm::mat3(a_camera.getViewMatrix()) * m_sunDir);
 	lightingGlobals->u_sunColorIntensity = m_sunColorIntensity;
 	lightingGlobals->u_cubemapPos = m_cubeMap ? m_cubeMap->getPosition() : glm::vec3(0);
-	static const glm::mat4 biasMatrix(
-		0.5, 0.0, 0.0, 0.0,
-		0.0, 0.5, 0.0, 0.0,
-		0.0, 0.0, 0.5, 0.0,
-		0.5, 0.5, 0.5, 1.0);
-	lightingGlobals->u_shadowMat = biasMatrix * m_shadowCamera.getCombinedMatrix();
-	m_lightningGlobalsUBO.unmapBuffer();
+	// Filter taps are clamped half a texel inside the tile so they never sample a neighbouring cascade
+	const glm::vec2 atlasSize = glm::vec2(m_shadowCascades.getAtlasSize());
+	lightingGlobals->u_numShadowCascades = int(m_shadowCascades.getNumCascades());
+	for (uint i = 0; i < m_shadowCascades.getNumCascades(); ++i)
+	{
+		const ShadowCascades::Cascade& cascade = m_shadowCascades.getCascade(i);
+		lightingGlobals->u_shadowMats[i] = cascade.shadowMatrix;
+		lightingGlobals->u_shadowCascadeSplits[i] = cascade.splitFar;
+		const glm::vec2 tileMin = (glm::vec2(cascade.viewport.x, cascade.viewport.y) + 0.5f) / atlasSize;
+		const glm::vec2 tileMax = (glm::vec2(cascade.viewport.x + cascade.viewport.z, cascade.viewport.y + cascade.viewport.w) - 0.5f) / atlasSize;
+		lightingGlobals->u_shadowAtlasRects[i] = glm::vec4(tileMin, tileMax);
+	}
+	m_frameDataBuffer.bindRange(GLRingBuffer::EBindTarget::UNIFORM, GLConfig::getUBOBindingPoint(GLConfig::EUBOs::LightingGlobals), allocation);
 }
 
 void GLRenderer::updateCameraDataUBO(const PerspectiveCamera& a_camera)
 {
-	CameraVarsData* cameraVars = rcast<CameraVarsData*>(m_cameraVarsUBO.mapBuffer());
+	const GLRingBuffer::Allocation allocation = m_frameDataBuffer.allocate(sizeof(CameraVarsData));
+	CameraVarsData* cameraVars = rcast<CameraVarsData*>(allocation.data);
 	cameraVars->u_vpMatrix     = a_camera.getCombinedMatrix();
 	cameraVars->u_viewMatrix   = a_camera.getViewMatrix();
 	cameraVars->u_eyePos       = glm::vec3(a_camera.getViewMatrix() * glm::vec4(a_camera.getPosition(), 1.0));
 	cameraVars->u_wsEyePos     = a_camera.getPosition();
 	cameraVars->u_camNear      = a_camera.getNear();
 	cameraVars->u_camFar       = a_camera.getFar();
-	m_cameraVarsUBO.unmapBuffer();
+	m_frameDataBuffer.bindRange(GLRingBuffer::EBindTarget::UNIFORM, GLConfig::getUBOBindingPoint(GLConfig::EUBOs::CameraVars), allocation);
+}
+
+void GLRenderer::applyQualityLevel(const QualityGovernor::QualityLevel& a_level, uint a_renderWidth, uint a_renderHeight)
+{
+	m_clusteredShading.setRenderScale(m_renderScale);
+	m_hbao.setResolution(a_renderWidth, a_renderHeight, a_level.hbaoResolutionScale);
+	m_bloom.setNumLevels(a_level.numBloomLevels);
+
+	if (a_level.shadowCascadeResolution != GLConfig::getShadowCascadeResolution())
+	{
+		// The atlas is created again, the new settings render every cascade into it again
+		GLConfig::setShadowCascadeResolution(a_level.shadowCascadeResolution);
+		m_shadowFBO.initialize();
+		m_shadowFBO.setDepthbufferTexture(GLConfig::rt.sunShadow);
+		m_staticShadowFBO.initialize();
+		m_staticShadowFBO.setDepthbufferTexture(GLConfig::rt.sunShadowStatic);
+
+		ShadowCascades::Settings cascadeSettings = m_shadowCascades.getSettings();
+		cascadeSettings.resolution = a_level.shadowCascadeResolution;
+		m_shadowCascades.setSettings(cascadeSettings);
+	}
 }
 
 void GLRenderer::updateSettingsGlobalsUBO()
@@ -2,27 +2,57 @@
 
 #include "Database/AssetDatabase.h"
 #include "Database/Assets/DBScene.h"
+#include "Graphics/GL/GL.h"
 #include "Graphics/GL/Scene/GLMaterial.h"
 #include "Graphics/GL/Scene/GLConfig.h"
 #include "Graphics/GL/Scene/GLRenderer.h"
+#include "Graphics/Utils/PerspectiveCamera.h"
+#include "EASTL/algorithm.h"
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint MAX_OCCLUDER_TRIANGLES = 4096;
+const float MIN_OCCLUDER_SCREEN_SIZE = 0.1f; // Bounds radius divided by distance
+
+END_UNNAMED_NAMESPACE()
+
+TextureStreamingPolicy GLScene::s_textureStreaming;
+
+GLScene::~GLScene()
+{
+	releaseTextureStreaming();
+}
 
 void GLScene::initialize(const eastl::string& a_assetName, AssetDatabase& a_database)
 {
 	DBScene* scene = dcast<DBScene*>(a_database.loadAsset(a_assetName, EAssetType::SCENE));
-	scene->mergeMeshes();
+	// Merging trades culling granularity for fewer draw calls, which multi draw indirect already makes cheap
+	if (!GLConfig::isDrawIndirectEnabled())
+		scene->mergeMeshes();
 	initialize(*scene);
 	a_database.unloadAsset(scene);
 }
 
 void GLScene::initialize(const DBScene& a_dbScene)
 {
+	releaseTextureStreaming();
 	m_nodes = a_dbScene.getNodes();
 	m_materials = a_dbScene.getMaterials();
+	m_drawIndirect = GLConfig::isDrawIndirectEnabled();
 	m_meshes.resize(a_dbScene.numMeshes());
-	for (uint i = 0; i < a_dbScene.numMeshes(); ++i)
-		m_meshes[i].initialize(a_dbScene.getMeshes()[i]);
-	m_materialBuffer.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::MaterialProperties));
+	if (m_drawIndirect)
+	{
+		initializeSharedGeometry(a_dbScene);
+		m_materialStorageBuffer.initialize(GLConfig::getSSBOConfig(GLConfig::ESSBOs::MaterialProperties));
+	}
+	else
+	{
+		for (uint i = 0; i < a_dbScene.numMeshes(); ++i)
+			m_meshes[i].initialize(a_dbScene.getMeshes()[i]);
+		m_materialBuffer.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::MaterialProperties));
+	}
 	updateMaterialBuffer();
+	initializeOccluders(a_dbScene);
 
 	for (DBNode& node : m_nodes)
 		node.calculateBounds(a_dbScene.getMeshes());
@@ -35,19 +65,131 @@ void GLScene::initialize(const DBScene& a_dbScene)
 
 		// Use info from the first texture since all textures use the same format.
 		const DBTexture& tex = atlasTextures[0].getTexture();
-		m_textureArrays[i].startInit(tex.getWidth(), tex.getHeight(), uint(atlasTextures.size()), tex.getNumComponents(),
-			(tex.getFormat() == DBTexture::EFormat::FLOAT), atlasTextures[0].getNumMipmaps());
+		const bool streamed = GLConfig::getTextureStreamingBudgetMB() != 0;
+		if (streamed)
+			m_textureArrays[i].startInitStreamed(tex.getWidth(), tex.getHeight(), uint(atlasTextures.size()), tex.getNumComponents(),
+				(tex.getFormat() == DBTexture::EFormat::FLOAT), atlasTextures[0].getNumMipmaps());
+		else
+			m_textureArrays[i].startInit(tex.getWidth(), tex.getHeight(), uint(atlasTextures.size()), tex.getNumComponents(),
+				(tex.getFormat() == DBTexture::EFormat::FLOAT), atlasTextures[0].getNumMipmaps());
 
 		for (const DBAtlasTexture& atlasTexture : atlasTextures)
 			m_textureArrays[i].addTexture(atlasTexture.getTexture());
 		m_textureArrays[i].finishInit();
+
+		if (streamed)
+		{
+			eastl::vector<uint64> levelByteSizes;
+			for (uint level = 0; level <= m_textureArrays[i].getNumMipMaps(); ++level)
+				levelByteSizes.push_back(m_textureArrays[i].getLevelByteSize(level));
+			m_textureStreamingHandles[i] = s_textureStreaming.addTexture(levelByteSizes);
+		}
 	}
 	m_initialized = true;
 }
 
+void GLScene::initializeSharedGeometry(const DBScene& a_dbScene)
+{
+	eastl::vector<DBMesh::Vertex> vertices;
+	eastl::vector<uint> indices;
+	for (uint i = 0; i < a_dbScene.numMeshes(); ++i)
+	{
+		const DBMesh& mesh = a_dbScene.getMeshes()[i];
+		m_meshes[i].initializeShared(mesh, uint(indices.size()), uint(vertices.size()));
+		vertices.insert(vertices.end(), mesh.getVertices().begin(), mesh.getVertices().end());
+		indices.insert(indices.end(), mesh.getIndices().begin(), mesh.getIndices().end());
+	}
+
+	// Meshes with an opacity texture discard fragments, they are drawn after the solid ones to keep early depth testing for those
+	m_meshSortInfos.resize(m_meshes.size());
+	for (uint i = 0; i < m_meshes.size(); ++i)
+	{
+		MeshSortInfo& sortInfo = m_meshSortInfos[i];
+		sortInfo.pass = RenderQueue::EPass::SOLID;
+		sortInfo.materialID = 0;
+		for (const GLMesh::MaterialUsage& usage : m_meshes[i].getMaterialUsages())
+		{
+			if (usage.materialID < m_materials.size() && m_materials[usage.materialID].hasTexture(DBMaterial::ETexTypes_Opacity))
+				sortInfo.pass = RenderQueue::EPass::ALPHA_TESTED;
+		}
+		if (!m_meshes[i].getMaterialUsages().empty())
+			sortInfo.materialID = m_meshes[i].getMaterialUsages()[0].materialID;
+	}
+
+	eastl::vector<uint> drawIDs(m_nodes.size());
+	for (uint i = 0; i < drawIDs.size(); ++i)
+		drawIDs[i] = i;
+
+	m_stateBuffer.initialize();
+	m_stateBuffer.begin();
+
+	m_vertexBuffer.initialize(GLConfig::getVBOConfig(GLConfig::EVBOs::GLMeshVertex));
+	m_vertexBuffer.upload(as_span(rcast<const byte*>(vertices.data()), vertices.size_bytes()));
+
+	m_indiceBuffer.initialize(GLConfig::getVBOConfig(GLConfig::EVBOs::GLMeshIndice));
+	m_indiceBuffer.upload(as_span(rcast<const byte*>(indices.data()), indices.size_bytes()));
+
+	m_drawIDBuffer.initialize(GLConfig::getVBOConfig(GLConfig::EVBOs::GLMeshDrawID));
+	m_drawIDBuffer.upload(as_span(rcast<const byte*>(drawIDs.data()), drawIDs.size_bytes()));
+
+	m_stateBuffer.end();
+}
+
+void GLScene::initializeOccluders(const DBScene& a_dbScene)
+{
+	m_occluderMeshes.clear();
+	m_occluderMeshes.resize(m_meshes.size());
+	for (uint i = 0; i < m_meshes.size(); ++i)
+	{
+		// Meshes with an opacity texture have holes
+		bool solid = true;
+		for (const GLMesh::MaterialUsage& usage : m_meshes[i].getMaterialUsages())
+			solid = solid && !(usage.materialID < m_materials.size() && m_materials[usage.materialID].hasTexture(DBMaterial::ETexTypes_Opacity));
+
+		const DBMesh& mesh = a_dbScene.getMeshes()[i];
+		if (!solid || mesh.getIndices().size() / 3 > MAX_OCCLUDER_TRIANGLES)
+			continue;
+
+		OcclusionBuffer::OccluderMesh& occluder = m_occluderMeshes[i];
+		occluder.positions.reserve(mesh.getVertices().size());
+		for (const DBMesh::Vertex& vertex : mesh.getVertices())
+			occluder.positions.push_back(vertex.position);
+		occluder.indices.assign(mesh.getIndices().begin(), mesh.getIndices().end());
+	}
+}
+
+void GLScene::addOccluders(OcclusionBuffer& a_occlusionBuffer, const PerspectiveCamera& a_camera, const glm::mat4& a_transform)
+{
+	if (m_isSkybox)
+		return;
+
+	cullMeshInstances(a_transform, a_camera, NULL);
+	for (uint i = 0; i < m_meshInstances.size(); ++i)
+	{
+		const MeshInstance& instance = m_meshInstances[i];
+		const OcclusionBuffer::OccluderMesh& occluder = m_occluderMeshes[instance.meshIdx];
+		if (occluder.indices.empty() || !Frustum::isVisible(m_meshInstanceVisibility, i))
+			continue;
+
+		const glm::vec3 center = m_meshInstanceBounds.getCenter(i);
+		const float distance = glm::max(glm::length(a_camera.getPosition() - center), a_camera.getNear());
+		const float screenSize = glm::length(m_meshInstanceBounds.getHalfSize(i)) / distance;
+		if (screenSize >= MIN_OCCLUDER_SCREEN_SIZE)
+			a_occlusionBuffer.addOccluder(occluder, m_nodeTransforms[instance.nodeIdx], screenSize);
+	}
+}
+
 void GLScene::render(GLRenderer& a_renderer, const glm::mat4& a_transform, bool a_depthOnly)
 {
-	m_materialBuffer.bind();
+	if (m_drawIndirect)
+		m_materialStorageBuffer.bind();
+	else
+		m_materialBuffer.bind();
+
+	// Apply the residency decided at the end of the previous frame
+	for (uint i = 0; i < DBMaterial::ETexTypes_COUNT; ++i)
+		if (m_textureStreamingHandles[i] != TextureStreamingPolicy::INVALID_HANDLE)
+			m_textureArrays[i].setResidentLevel(s_textureStreaming.getResidentLevel(m_textureStreamingHandles[i]));
 	
 	// When rendering depth only, we just bind the opacity texture, otherwise every texture.
 	if (a_depthOnly)
@@ -72,7 +214,43 @@ void GLScene::render(GLRenderer& a_renderer, const glm::mat4& a_transform, bool
 		}
 	}
 
-	renderNode(m_nodes[0], a_renderer, a_transform);
+	cullMeshInstances(a_transform, *a_renderer.getSceneCamera(), a_renderer.getOcclusionBuffer());
+
+	// Only the color pass requests texture levels, the depth passes mostly see the same meshes and only sample opacity
+	if (m_drawIndirect)
+	{
+		m_drawCommands.clear();
+		renderVisibleMeshes(a_renderer, !a_depthOnly);
+		submitDrawCommands(a_renderer);
+	}
+	else
+		renderVisibleMeshes(a_renderer, !a_depthOnly);
+}
+
+void GLScene::submitDrawCommands(GLRenderer& a_renderer)
+{
+	m_drawCommands.finish();
+	if (m_drawCommands.isEmpty())
+		return;
+
+	const eastl::vector<DrawTransform>& transforms = m_drawCommands.getTransforms();
+	const eastl::vector<DrawCommand>& commands = m_drawCommands.getCommands();
+	assert(transforms.size() <= m_nodes.size());
+	GLRingBuffer& frameData = a_renderer.getFrameDataBuffer();
+	const GLRingBuffer::Allocation transformData = frameData.upload(uint(transforms.size_bytes()), transforms.data());
+	const GLRingBuffer::Allocation commandData = frameData.upload(uint(commands.size_bytes()), commands.data());
+	if (!transformData.isValid() || !commandData.isValid())
+		return;
+	frameData.bindRange(GLRingBuffer::EBindTarget::SHADER_STORAGE, GLConfig::getSSBOBindingPoint(GLConfig::ESSBOs::DrawTransforms), transformData);
+
+	m_stateBuffer.begin();
+	frameData.bindAsDrawIndirect();
+	for (const DrawCommandBuffer::Bucket& bucket : m_drawCommands.getBuckets())
+	{
+		const uint64 offset = commandData.offset + uint64(bucket.firstCommand) * sizeof(DrawCommand);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, rcast<const void*>(offset), bucket.numCommands, 0);
+	}
+	m_stateBuffer.end();
 }
 
 void GLScene::setAsSkybox(bool a_isSkybox)
@@ -80,37 +258,140 @@ void GLScene::setAsSkybox(bool a_isSkybox)
 	m_isSkybox = a_isSkybox;
 }
 
-void GLScene::renderNode(const DBNode& a_node, GLRenderer& a_renderer, const glm::mat4& a_parentTransform)
+void GLScene::cullMeshInstances(const glm::mat4& a_transform, const PerspectiveCamera& a_camera, OcclusionBuffer* a_occlusionBuffer)
+{
+	m_nodeTransforms.resize(m_nodes.size());
+	m_meshInstances.clear();
+	m_meshInstanceBounds.clear();
+	addNodeBounds(0, a_transform);
+	// The skybox is always drawn, around the camera
+	if (m_isSkybox)
+		return;
+
+	a_camera.getFrustum().aabbsInFrustum(m_meshInstanceBounds, m_meshInstanceVisibility, true);
+	if (!a_occlusionBuffer || m_meshInstances.empty())
+		return;
+
+	// Test the bounds of the whole scene first, a hidden object skips testing its meshes
+	glm::vec3 min(FLT_MAX);
+	glm::vec3 max(-FLT_MAX);
+	for (uint i = 0; i < m_meshInstanceBounds.getNumBoxes(); ++i)
+	{
+		min = glm::min(min, m_meshInstanceBounds.getCenter(i) - m_meshInstanceBounds.getHalfSize(i));
+		max = glm::max(max, m_meshInstanceBounds.getCenter(i) + m_meshInstanceBounds.getHalfSize(i));
+	}
+	if (a_occlusionBuffer->isVisible((max + min) / 2.0f, (max - min) / 2.0f))
+		a_occlusionBuffer->cullOccluded(m_meshInstanceBounds, m_meshInstanceVisibility);
+	else
+		eastl::fill(m_meshInstanceVisibility.begin(), m_meshInstanceVisibility.end(), 0u);
+}
+
+void GLScene::addNodeBounds(uint a_nodeIdx, const glm::mat4& a_parentTransform)
+{
+	const DBNode& node = m_nodes[a_nodeIdx];
+	const glm::mat4& modelMatrix = m_nodeTransforms[a_nodeIdx] = a_parentTransform * node.getTransform();
+	for (uint i : node.getMeshIndices())
+	{
+		const GLMesh& mesh = m_meshes[i];
+		// The world box has to contain all corners of the rotated box, every model axis adds the length of its projection on a world axis
+		const glm::vec3 center = glm::vec3(modelMatrix * glm::vec4((mesh.getBoundsMax() + mesh.getBoundsMin()) / 2.0f, 1.0f));
+		const glm::mat3 absModelMatrix(glm::abs(glm::vec3(modelMatrix[0])), glm::abs(glm::vec3(modelMatrix[1])), glm::abs(glm::vec3(modelMatrix[2])));
+		m_meshInstanceBounds.add(center, absModelMatrix * ((mesh.getBoundsMax() - mesh.getBoundsMin()) / 2.0f));
+		const MeshInstance instance = { a_nodeIdx, i };
+		m_meshInstances.push_back(instance);
+	}
+	for (uint i : node.getChildIndices())
+		addNodeBounds(i, modelMatrix);
+}
+
+void GLScene::renderVisibleMeshes(GLRenderer& a_renderer, bool a_requestTextureLevels)
 {
 	const PerspectiveCamera* camera = a_renderer.getSceneCamera();
-	GLRenderer::ModelData data;
-	data.u_modelMatrix = a_parentTransform * a_node.getTransform();
-	glm::vec3 min = glm::vec3(data.u_modelMatrix * glm::vec4(a_node.getBoundsMin(), 1.0));
-	glm::vec3 max = glm::vec3(data.u_modelMatrix * glm::vec4(a_node.getBoundsMax(), 1.0));
-	glm::vec3 center = (max + min) / 2.0f;
-	glm::vec3 extent = (max - min) / 2.0f;
-	if (camera->getFrustum().aabbInFrustum(center, extent) || m_isSkybox)
-	{
-		data.u_normalMatrix = glm::inverse(glm::transpose(data.u_modelMatrix * camera->getViewMatrix()));
-		a_renderer.setModelDataUBO(data);
-
-		for (uint i : a_node.getMeshIndices())
+	uint currentNodeIdx = uint(m_nodes.size());
+	uint transformIdx = 0;
+	for (uint i = 0; i < m_meshInstances.size(); ++i)
+	{
+		if (!m_isSkybox && !Frustum::isVisible(m_meshInstanceVisibility, i))
+			continue;
+
+		const MeshInstance& instance = m_meshInstances[i];
+		const glm::mat4& modelMatrix = m_nodeTransforms[instance.nodeIdx];
+		if (instance.nodeIdx != currentNodeIdx)
+		{	// The instances of a node are consecutive, so its transform is only set once
+			currentNodeIdx = instance.nodeIdx;
+			GLRenderer::ModelData data;
+			data.u_modelMatrix = modelMatrix;
+			data.u_normalMatrix = glm::inverse(glm::transpose(modelMatrix * camera->getViewMatrix()));
+			if (m_drawIndirect)
+				transformIdx = m_drawCommands.addTransform(data.u_modelMatrix, data.u_normalMatrix);
+			else
+				a_renderer.setModelDataUBO(data);
+		}
+
+		GLMesh& mesh = m_meshes[instance.meshIdx];
+		const glm::vec3 center = m_meshInstanceBounds.getCenter(i);
+		const glm::vec3 extent = m_meshInstanceBounds.getHalfSize(i);
+		if (m_drawIndirect)
 		{
-			GLMesh& mesh = m_meshes[i];
-			min = glm::vec3(data.u_modelMatrix * glm::vec4(mesh.getBoundsMin(), 1.0));
-			max = glm::vec3(data.u_modelMatrix * glm::vec4(mesh.getBoundsMax(), 1.0));
-			center = (max + min) / 2.0f;
-			extent = (max - min) / 2.0f;
-			if (camera->getFrustum().aabbInFrustum(center, extent) || m_isSkybox)
-				mesh.render();
+			// The renderer picks one shader per pass, so only the pass and material split and order the draws
+			const float viewDepth = -(camera->getViewMatrix() * glm::vec4(center, 1.0f)).z;
+			const MeshSortInfo& sortInfo = m_meshSortInfos[instance.meshIdx];
+			const uint64 key = RenderQueue::makeKey(sortInfo.pass, 0, sortInfo.materialID, viewDepth / camera->getFar());
+			m_drawCommands.addDraw(key, mesh.getNumIndices(), mesh.getFirstIndex(), int(mesh.getBaseVertex()), transformIdx);
 		}
-		for (uint i : a_node.getChildIndices())
-			renderNode(m_nodes[i], a_renderer, data.u_modelMatrix);
+		else
+			mesh.render();
+		if (a_requestTextureLevels)
+			requestTextureLevels(mesh, modelMatrix, center, extent, *camera);
+	}
+}
+
+void GLScene::requestTextureLevels(const GLMesh& a_mesh, const glm::mat4& a_modelMatrix, const glm::vec3& a_center, const glm::vec3& a_extent, const PerspectiveCamera& a_camera)
+{
+	// The closest point of the bounds decides the detail, texels per pixel of 2^n means level n is sharp enough
+	const glm::vec3 delta = glm::max(glm::abs(a_camera.getPosition() - a_center) - a_extent, glm::vec3(0.0f));
+	const float distance = glm::max(glm::length(delta), a_camera.getNear());
+	const float pixelsPerUnit = a_camera.getHeight() / (2.0f * distance * glm::tan(glm::radians(a_camera.getVFov()) * 0.5f));
+	const float worldUnitsPerObjectUnit = glm::length(glm::vec3(a_modelMatrix[0]));
+
+	for (const GLMesh::MaterialUsage& usage : a_mesh.getMaterialUsages())
+	{
+		if (usage.materialID >= m_materials.size())
+			continue;
+		const DBMaterial& material = m_materials[usage.materialID];
+		for (uint i = 0; i < DBMaterial::ETexTypes_COUNT; ++i)
+		{
+			const DBMaterial::ETexTypes type = DBMaterial::ETexTypes(i);
+			if (m_textureStreamingHandles[i] == TextureStreamingPolicy::INVALID_HANDLE || !material.hasTexture(type))
+				continue;
+			const float texelsPerUnit = usage.uvPerUnit * float(material.getRegion(type).m_atlasPosition.z) / worldUnitsPerObjectUnit;
+			const float level = glm::log2(glm::max(texelsPerUnit / pixelsPerUnit, 1.0f));
+			s_textureStreaming.requestLevel(m_textureStreamingHandles[i], uint(level));
+		}
+	}
+}
+
+void GLScene::releaseTextureStreaming()
+{
+	for (TextureStreamingHandle& handle : m_textureStreamingHandles)
+	{
+		if (handle != TextureStreamingPolicy::INVALID_HANDLE)
+			s_textureStreaming.removeTexture(handle);
+		handle = TextureStreamingPolicy::INVALID_HANDLE;
 	}
 }
 
 void GLScene::updateMaterialBuffer()
 {
+	if (m_drawIndirect)
+	{
+		eastl::vector<GLMaterial> materials(m_materials.size());
+		for (uint i = 0; i < m_materials.size(); ++i)
+			materials[i].initialize(m_materials[i]);
+		m_materialStorageBuffer.upload(uint(materials.size_bytes()), materials.data());
+		return;
+	}
+
 	uint numMaterials = uint(m_materials.size());
 	if (numMaterials > GLConfig::getMaxMaterials())
 	{
@@ -130,5 +411,8 @@ void GLScene::updateMaterialBuffer(const DBMaterial& a_material, uint a_material
 {
 	GLMaterial mat;
 	mat.initialize(a_material);
-	m_materialBuffer.upload(sizeof(mat), &mat, sizeof(mat) * a_materialIdx);
+	if (m_drawIndirect)
+		m_materialStorageBuffer.uploadRange(sizeof(mat) * a_materialIdx, sizeof(mat), &mat);
+	else
+		m_materialBuffer.upload(sizeof(mat), &mat, sizeof(mat) * a_materialIdx);
 }
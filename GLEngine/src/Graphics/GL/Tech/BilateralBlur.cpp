@@ -1,6 +1,7 @@
 #include "Graphics/GL/Tech/BilateralBlur.h"
 
 #include "Graphics/GL/Scene/GLConfig.h"
+#include "Graphics/GL/Scene/GLRenderGraph.h"
 #include "Graphics/GL/Tech/QuadDrawer.h"
 #include "Utils/StringUtils.h"
 
@@ -15,21 +16,13 @@ const char* const BLURY_FRAG_SHADER_PATH = "../EngineAssets/Shaders/Blur/bilater
 
 END_UNNAMED_NAMESPACE()
 
-void BilateralBlur::initialize(EBlurValueType a_type, uint a_xRes, uint a_yRes, uint a_blurRadius, uint a_blurTexWidth, uint a_blurTexHeight)
+void BilateralBlur::initialize(EBlurValueType a_type, uint a_blurRadius)
 {
 	m_type = a_type;
 	m_blurRadius = float(a_blurRadius);
-	m_xRes = a_xRes;
-	m_yRes = a_yRes;
-	m_blurTexWidth = a_blurTexWidth;
-	m_blurTexHeight = a_blurTexHeight;
 
 	reloadShader();
 
-	m_blurResultTexture.initialize(m_format, a_xRes, a_yRes, GLConfig::getMultisampleType());
-	m_blurXResultFBO.initialize(GLConfig::getMultisampleType());
-	m_blurXResultFBO.addFramebufferTexture(m_blurResultTexture);
-
 	m_initialized = true;
 }
 
@@ -71,32 +64,45 @@ void BilateralBlur::reloadShader()
 	blurDefines.push_back("SHARPNESS " + StringUtils::to_string(m_sharpness));
 
 	m_blurXShader.initialize(QUAD_VERT_SHADER_PATH, BLURX_FRAG_SHADER_PATH, &blurDefines);
-	m_blurXShader.begin();
-	glm::vec2 invScreenSize = glm::vec2(1.0f / m_xRes, 1.0f / m_yRes);
-	glm::vec2 invBlurTexSize = glm::vec2(1.0f / m_blurTexWidth, 1.0f / m_blurTexHeight);
-	m_blurXShader.setUniform2f("u_invScreenSize", invScreenSize);
-	m_blurXShader.setUniform2f("u_blurTexScale", invScreenSize / invBlurTexSize);
-	m_blurXShader.end();
-
 	m_blurYShader.initialize(QUAD_VERT_SHADER_PATH, BLURY_FRAG_SHADER_PATH, &blurDefines);
-	m_blurYShader.begin();
-	m_blurYShader.setUniform2f("u_invScreenSize", glm::vec2(1.0f / m_xRes, 1.0f / m_yRes));
-	m_blurYShader.end();
 }
 
-void BilateralBlur::blurFBO(GLFramebuffer& a_blurredFBO, GLFramebuffer& a_depthFBO)
+RenderGraph::ResourceHandle BilateralBlur::addPasses(GLRenderGraph& a_graph, RenderGraph::ResourceHandle a_input, RenderGraph::ResourceHandle a_depth)
 {
 	assert(m_initialized);
 
-	a_depthFBO.bindDepthTexture(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
-	a_blurredFBO.bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+	RenderGraph& graph = a_graph.getGraph();
+	const RenderGraph::ResourceDesc& depthDesc = graph.getResourceDesc(a_depth);
+	const RenderGraph::ResourceDesc desc = GLRenderGraph::makeDesc(m_format, depthDesc.width, depthDesc.height);
+	const RenderGraph::ResourceHandle blurredX = graph.createTransient("Bilateral blur X", desc);
+	const RenderGraph::ResourceHandle blurred = graph.createTransient("Bilateral blur", desc);
+	const glm::vec2 invResolution(1.0f / float(desc.width), 1.0f / float(desc.height));
 
-	m_blurXResultFBO.begin();
-	QuadDrawer::drawQuad(m_blurXShader);
-	m_blurXResultFBO.end();
-	m_blurXResultFBO.bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
-	a_blurredFBO.begin();
-	QuadDrawer::drawQuad(m_blurYShader);
-	a_blurredFBO.end();
+	const RenderGraph::PassHandle passX = graph.addPass("Bilateral blur X", [this, &a_graph, a_input, a_depth, invResolution]()
+	{
+		a_graph.getTexture(a_depth).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+		a_graph.getTexture(a_input).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+		m_blurXShader.begin();
+		m_blurXShader.setUniform2f("u_invScreenSize", invResolution);
+		QuadDrawer::drawQuad(m_blurXShader);
+		m_blurXShader.end();
+	});
+	graph.read(passX, a_input);
+	graph.read(passX, a_depth);
+	graph.write(passX, blurredX, RenderGraph::ELoad::DONT_CARE);
+
+	const RenderGraph::PassHandle passY = graph.addPass("Bilateral blur Y", [this, &a_graph, blurredX, a_depth, invResolution]()
+	{
+		a_graph.getTexture(a_depth).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+		a_graph.getTexture(blurredX).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+		m_blurYShader.begin();
+		m_blurYShader.setUniform2f("u_invScreenSize", invResolution);
+		QuadDrawer::drawQuad(m_blurYShader);
+		m_blurYShader.end();
+	});
+	graph.read(passY, blurredX);
+	graph.read(passY, a_depth);
+	graph.write(passY, blurred, RenderGraph::ELoad::DONT_CARE);
+
+	return blurred;
 }
-
@@ -1,42 +1,129 @@
 #include "Graphics/GL/Tech/Bloom.h"
 
 #include "Graphics/GL/Scene/GLConfig.h"
+#include "Graphics/GL/Scene/GLRenderGraph.h"
 #include "Graphics/GL/Tech/QuadDrawer.h"
+#include "EASTL/fixed_vector.h"
+
+#include <assert.h>
 
 BEGIN_UNNAMED_NAMESPACE()
 
 const char* const QUAD_VERT_SHADER_PATH = "../EngineAssets/Shaders/quad.vert";
 const char* const BLOOM_FRAG_SHADER_PATH = "../EngineAssets/Shaders/Bloom/bloom.frag";
+const char* const DOWNSAMPLE_FRAG_SHADER_PATH = "../EngineAssets/Shaders/Bloom/bloomdownsample.frag";
+const char* const UPSAMPLE_FRAG_SHADER_PATH = "../EngineAssets/Shaders/Bloom/bloomupsample.frag";
+
+const uint MAX_LEVELS = 16;
+// Floats since the levels add up, the last upsample averages them so the glow is as bright as with a single blur
+const GLTexture::ESizedFormat PYRAMID_FORMAT = GLTexture::ESizedFormat::RGB16F;
+
+const char* const DOWNSAMPLE_PASS_NAMES[MAX_LEVELS] = {
+	"Bloom downsample 0", "Bloom downsample 1", "Bloom downsample 2", "Bloom downsample 3", "Bloom downsample 4", "Bloom downsample 5",
+	"Bloom downsample 6", "Bloom downsample 7", "Bloom downsample 8", "Bloom downsample 9", "Bloom downsample 10", "Bloom downsample 11",
+	"Bloom downsample 12", "Bloom downsample 13", "Bloom downsample 14", "Bloom downsample 15" };
+const char* const UPSAMPLE_PASS_NAMES[MAX_LEVELS] = {
+	"Bloom upsample 0", "Bloom upsample 1", "Bloom upsample 2", "Bloom upsample 3", "Bloom upsample 4", "Bloom upsample 5",
+	"Bloom upsample 6", "Bloom upsample 7", "Bloom upsample 8", "Bloom upsample 9", "Bloom upsample 10", "Bloom upsample 11",
+	"Bloom upsample 12", "Bloom upsample 13", "Bloom upsample 14", "Bloom upsample 15" };
 
 END_UNNAMED_NAMESPACE()
 
-void Bloom::initialize(uint a_xRes, uint a_yRes)
+void Bloom::initialize()
 {
-	m_bloomResultTexture.initialize(GLTexture::ESizedFormat::RGB8, a_xRes, a_yRes, GLConfig::getMultisampleType());
-	m_bloomResultFBO.initialize(GLConfig::getMultisampleType());
-	m_bloomResultFBO.addFramebufferTexture(m_bloomResultTexture);
-	m_gaussianBlur.initialize(GaussianBlur::EBlurValueType::VEC3, a_xRes, a_yRes);
+	m_gaussianBlur.initialize(GaussianBlur::EBlurValueType::VEC3);
 
 	reloadShader();
 
 	m_initialized = true;
 }
 
-GLFramebuffer& Bloom::getBloomResultFBO(GLFramebuffer& a_sceneFBO)
+RenderGraph::ResourceHandle Bloom::addPasses(GLRenderGraph& a_graph, RenderGraph::ResourceHandle a_sceneColor)
 {
-	a_sceneFBO.bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+	assert(m_initialized);
+
+	// The bright parts are taken at the first level of the pyramid, which also halves the cost of this pass
+	RenderGraph& graph = a_graph.getGraph();
+	const RenderGraph::ResourceDesc& sceneColorDesc = graph.getResourceDesc(a_sceneColor);
+	const uint divisor = m_method == EMethod::PYRAMID ? 2 : 1;
+	const RenderGraph::ResourceHandle bright = graph.createTransient("Bloom bright", GLRenderGraph::makeDesc(
+		m_method == EMethod::PYRAMID ? PYRAMID_FORMAT : GLTexture::ESizedFormat::RGB8,
+		glm::max(sceneColorDesc.width / divisor, 1u), glm::max(sceneColorDesc.height / divisor, 1u)));
+	const RenderGraph::PassHandle pass = graph.addPass("Bloom bright", [this, &a_graph, a_sceneColor]()
+	{
+		a_graph.getTexture(a_sceneColor).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Color));
+		QuadDrawer::drawQuad(m_bloomShader);
+	});
+	graph.read(pass, a_sceneColor);
+	graph.write(pass, bright, RenderGraph::ELoad::DONT_CARE);
 
-	m_bloomResultFBO.begin();
-	QuadDrawer::drawQuad(m_bloomShader);
-	m_bloomResultFBO.end();
+	if (m_method == EMethod::GAUSSIAN)
+		return m_gaussianBlur.addPasses(a_graph, bright);
+	return addPyramidPasses(a_graph, bright);
+}
+
+RenderGraph::ResourceHandle Bloom::addPyramidPasses(GLRenderGraph& a_graph, RenderGraph::ResourceHandle a_bright)
+{
+	RenderGraph& graph = a_graph.getGraph();
+	eastl::fixed_vector<RenderGraph::ResourceHandle, MAX_LEVELS, false> levels;
+	levels.push_back(a_bright);
+	const uint numLevels = glm::clamp(m_numLevels, 1u, MAX_LEVELS);
+	while (levels.size() < numLevels)
+	{
+		const RenderGraph::ResourceHandle source = levels.back();
+		const RenderGraph::ResourceDesc& sourceDesc = graph.getResourceDesc(source);
+		if (sourceDesc.width == 1 && sourceDesc.height == 1)
+			break;
 
-	m_gaussianBlur.blurFBO(m_bloomResultFBO);
+		const uint level = uint(levels.size());
+		const RenderGraph::ResourceHandle downsampled = graph.createTransient(DOWNSAMPLE_PASS_NAMES[level],
+			GLRenderGraph::makeDesc(PYRAMID_FORMAT, glm::max(sourceDesc.width / 2, 1u), glm::max(sourceDesc.height / 2, 1u)));
+		const glm::vec2 sourceTexelSize(1.0f / float(sourceDesc.width), 1.0f / float(sourceDesc.height));
+		const RenderGraph::PassHandle downsamplePass = graph.addPass(DOWNSAMPLE_PASS_NAMES[level], [this, &a_graph, source, sourceTexelSize]()
+		{
+			a_graph.getTexture(source).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+			m_downsampleShader.begin();
+			m_downsampleShader.setUniform2f("u_sourceTexelSize", sourceTexelSize);
+			QuadDrawer::drawQuad(m_downsampleShader);
+			m_downsampleShader.end();
+		});
+		graph.read(downsamplePass, source);
+		graph.write(downsamplePass, downsampled, RenderGraph::ELoad::DONT_CARE);
+		levels.push_back(downsampled);
+	}
 
-	return m_bloomResultFBO;
+	// From the smallest level up every level adds the sum of the levels below it
+	RenderGraph::ResourceHandle summed = levels.back();
+	for (uint level = uint(levels.size()) - 1; level-- > 0;)
+	{
+		const RenderGraph::ResourceHandle source = summed;
+		const RenderGraph::ResourceHandle levelResource = levels[level];
+		const RenderGraph::ResourceDesc& sourceDesc = graph.getResourceDesc(source);
+		const glm::vec2 sourceTexelSize(1.0f / float(sourceDesc.width), 1.0f / float(sourceDesc.height));
+		const float scale = level == 0 ? 1.0f / float(levels.size()) : 1.0f;
+		summed = graph.createTransient(UPSAMPLE_PASS_NAMES[level], graph.getResourceDesc(levelResource));
+		const RenderGraph::PassHandle upsamplePass = graph.addPass(UPSAMPLE_PASS_NAMES[level],
+			[this, &a_graph, source, levelResource, sourceTexelSize, scale]()
+		{
+			a_graph.getTexture(source).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+			a_graph.getTexture(levelResource).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Color));
+			m_upsampleShader.begin();
+			m_upsampleShader.setUniform2f("u_sourceTexelSize", sourceTexelSize);
+			m_upsampleShader.setUniform1f("u_scale", scale);
+			QuadDrawer::drawQuad(m_upsampleShader);
+			m_upsampleShader.end();
+		});
+		graph.read(upsamplePass, source);
+		graph.read(upsamplePass, levelResource);
+		graph.write(upsamplePass, summed, RenderGraph::ELoad::DONT_CARE);
+	}
+	return summed;
 }
 
 void Bloom::reloadShader()
 {
 	m_bloomShader.initialize(QUAD_VERT_SHADER_PATH, BLOOM_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
+	m_downsampleShader.initialize(QUAD_VERT_SHADER_PATH, DOWNSAMPLE_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
+	m_upsampleShader.initialize(QUAD_VERT_SHADER_PATH, UPSAMPLE_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
 	m_gaussianBlur.reloadShader();
 }
@@ -2,7 +2,6 @@
 
 #include "Graphics/GL/Scene/GLConfig.h"
 #include "Graphics/GL/Wrappers/GLShader.h"
-#include "Graphics/Utils/ClusteredTiledShadingUtils.h"
 #include "Graphics/Utils/LightManager.h"
 #include "Graphics/Utils/PerspectiveCamera.h"
 
@@ -12,6 +11,8 @@ BEGIN_UNNAMED_NAMESPACE()
 
 const uint CLUSTERED_SHADING_TILE_WIDTH = 64;
 const uint CLUSTERED_SHADING_TILE_HEIGHT = 64;
+const uint INITIAL_NUM_INDICES_PER_CLUSTER = 4;
+const uint INITIAL_MAX_LIGHTS = 256;
 
 END_UNNAMED_NAMESPACE()
 
@@ -21,114 +22,105 @@ ClusteredShading::~ClusteredShading()
 
 void ClusteredShading::initialize(const PerspectiveCamera& a_camera, uint a_screenWidth, uint a_screenHeight)
 {
-	m_screenWidth    = a_screenWidth;
-	m_screenHeight   = a_screenHeight;
 	m_pixelsPerTileW = CLUSTERED_SHADING_TILE_WIDTH;
 	m_pixelsPerTileH = CLUSTERED_SHADING_TILE_HEIGHT;
-	m_gridWidth      = a_screenWidth / m_pixelsPerTileW + 1;
-	m_gridHeight     = a_screenHeight / m_pixelsPerTileH + 1;
-	m_recNear        = 1.0f / a_camera.getNear();
-	
-	const uint grid2dDimY = (a_screenHeight + m_pixelsPerTileH - 1) / m_pixelsPerTileH;
-	const float sD        = 2.0f * glm::tan(glm::radians(a_camera.getVFov()) * 0.5f) / float(grid2dDimY);
-	m_recLogSD1           = 1.0f / logf(sD + 1.0f);
-	
-	const float zGridLocFar = logf(a_camera.getFar() / a_camera.getNear()) / logf(1.0f + sD);
-	m_gridDepth             = uint(ceilf(zGridLocFar) + 0.5f);
-	m_gridSize              = m_gridWidth * m_gridHeight * m_gridDepth;
-	m_maxNumLightIndices    = m_gridSize * MAX_NUM_INDICES_PER_TILE;
-
-	m_tileLightIndices.resize(m_gridSize);
-
-	m_lightPositionRangesUBO.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::ClusteredLightPositionRange));
-	m_lightColorIntensitiesUBO.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::ClusteredLightColorIntensities));
+	m_lightClusters.initialize(a_camera, a_screenWidth, a_screenHeight, m_pixelsPerTileW, m_pixelsPerTileH);
+	m_maxNumLightIndices = getGridSize() * INITIAL_NUM_INDICES_PER_CLUSTER;
+
+	m_lightPositionRangesSSBO.initialize(GLConfig::getSSBOConfig(GLConfig::ESSBOs::LightPositionRanges));
+	m_lightColorIntensitiesSSBO.initialize(GLConfig::getSSBOConfig(GLConfig::ESSBOs::LightColorIntensities));
+	m_lightDirectionAnglesSSBO.initialize(GLConfig::getSSBOConfig(GLConfig::ESSBOs::LightDirectionAngles));
+	m_maxNumLights = 0;
 	m_clusteredShadingGlobalsUBO.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::ClusteredGlobals));
 
-	m_lightGridTextureBuffer.initialize(m_gridSize * sizeof(glm::uvec2), GLTextureBuffer::ESizedFormat::RG32I, GLTextureBuffer::EDrawUsage::STREAM);
-	m_lightIndiceTextureBuffer.initialize(m_maxNumLightIndices * sizeof(ushort), GLTextureBuffer::ESizedFormat::R16I, GLTextureBuffer::EDrawUsage::STREAM);
+	m_lightGridTextureBuffer.initialize(getGridSize() * sizeof(glm::uvec2), GLTextureBuffer::ESizedFormat::RG32I, GLTextureBuffer::EDrawUsage::STREAM);
+	m_lightIndiceTextureBuffer.initialize(m_maxNumLightIndices * sizeof(uint), GLTextureBuffer::ESizedFormat::R32I, GLTextureBuffer::EDrawUsage::STREAM);
 
-	GlobalsUBO ubo;
-	ubo.u_recNear    = m_recNear;
-	ubo.u_recLogSD1  = m_recLogSD1;
-	ubo.u_tileWidth  = m_pixelsPerTileW;
-	ubo.u_tileHeight = m_pixelsPerTileH;
-	ubo.u_gridHeight = m_gridHeight;
-	ubo.u_gridDepth  = m_gridDepth;
-	m_clusteredShadingGlobalsUBO.upload(sizeof(GlobalsUBO), &ubo);
+	m_renderScale = 1.0f;
+	uploadGlobals();
 
 	m_initialized = true;
 }
 
-void ClusteredShading::update(const PerspectiveCamera& a_camera, const LightManager& a_lightManager)
+void ClusteredShading::setRenderScale(float a_renderScale)
 {
-	assert(m_initialized);
+	assert(a_renderScale > 0.0f);
+	if (a_renderScale == m_renderScale)
+		return;
+	m_renderScale = a_renderScale;
+	uploadGlobals();
+}
 
-	for (TileIndiceList& indiceList : m_tileLightIndices)
-		indiceList.count = 0;
+void ClusteredShading::uploadGlobals()
+{
+	GlobalsUBO ubo;
+	ubo.u_recNear        = m_lightClusters.getRecNear();
+	ubo.u_recLogSD1      = m_lightClusters.getRecLogSD1();
+	ubo.u_tileWidth      = m_pixelsPerTileW;
+	ubo.u_tileHeight     = m_pixelsPerTileH;
+	ubo.u_gridHeight     = getGridHeight();
+	ubo.u_gridDepth      = getGridDepth();
+	ubo.u_invRenderScale = 1.0f / m_renderScale;
+	m_clusteredShadingGlobalsUBO.upload(sizeof(GlobalsUBO), &ubo);
+}
 
-	const glm::mat4& viewMatrix                  = a_camera.getViewMatrix();
-	const uint numLights                         = a_lightManager.getNumLights();
-	const glm::vec4* lightPositionRanges         = a_lightManager.getLightPositionRanges();
-	glm::vec4* lightPositionRangeViewspaceBuffer = rcast<glm::vec4*>(m_lightPositionRangesUBO.mapBuffer());
+void ClusteredShading::update(const PerspectiveCamera& a_camera, LightManager& a_lightManager)
+{
+	assert(m_initialized);
 
-	uint lightIndiceCtr = 0;
-	for (ushort i = 0; i < numLights; ++i)
+	// The storage buffers grow with some headroom, everything is uploaded again after they grew
+	const uint numLights = a_lightManager.getNumLights();
+	const bool grown = numLights > m_maxNumLights;
+	if (grown)
 	{
-		lightPositionRangeViewspaceBuffer[i] = viewMatrix * glm::vec4(glm::vec3(lightPositionRanges[i]), 1.0);
-		lightPositionRangeViewspaceBuffer[i].w = lightPositionRanges[i].w;
-		const glm::vec3 lightPositionViewSpace(lightPositionRangeViewspaceBuffer[i]);
-		const float range = lightPositionRangeViewspaceBuffer[i].w;
-		IBounds3D bounds3D = ClusteredTiledShadingUtils::sphereToScreenSpaceBounds3D(a_camera, 
-		                                                                             lightPositionViewSpace, range, 
-		                                                                             m_screenWidth, m_screenHeight, 
-		                                                                             m_pixelsPerTileW, m_pixelsPerTileH, 
-		                                                                             m_recLogSD1);
-		lightIndiceCtr += writeLightIndices(bounds3D, i);
-		if (lightIndiceCtr > m_maxNumLightIndices)
-			break;
+		m_maxNumLights = glm::max(numLights + numLights / 2, INITIAL_MAX_LIGHTS);
+		m_lightPositionRangesSSBO.upload(m_maxNumLights * sizeof(glm::vec4), NULL);
+		m_lightColorIntensitiesSSBO.upload(m_maxNumLights * sizeof(glm::vec4), NULL);
+		m_lightDirectionAnglesSSBO.upload(m_maxNumLights * sizeof(glm::vec4), NULL);
 	}
-
-	m_lightPositionRangesUBO.unmapBuffer();
-	m_lightColorIntensitiesUBO.upload(numLights * sizeof(glm::vec4), &a_lightManager.getLightColorIntensities()[0]);
-
-	glm::uvec2* gridBuffer = rcast<glm::uvec2*>(m_lightGridTextureBuffer.mapBuffer());
-	ushort* indiceBuffer = rcast<ushort*>(m_lightIndiceTextureBuffer.mapBuffer());
-
-	uint indiceCtr = 0;
-	for (uint i = 0; i < m_gridSize; ++i)
+	auto uploadRange = [&](GLShaderStorageBuffer& a_buffer, const LightManager::DirtyRange& a_range, const glm::vec4* a_data)
+	{
+		const uint begin = grown ? 0 : a_range.begin;
+		const uint end = grown ? numLights : glm::min(a_range.end, numLights);
+		if (begin < end)
+			a_buffer.uploadRange(begin * sizeof(glm::vec4), (end - begin) * sizeof(glm::vec4), a_data + begin);
+	};
+	uploadRange(m_lightColorIntensitiesSSBO, a_lightManager.getDirtyColorIntensities(), a_lightManager.getLightColorIntensities());
+
+	// Without changed lights or camera movement the lists and view space positions on the GPU are still valid.
+	// After an incremental update only the changed lights have new view space positions and directions
+	const bool updated = m_lightClusters.update(a_camera, a_lightManager.getLightPositionRanges(), a_lightManager.getLightDirectionAngles(), numLights);
+	const bool fullBuild = updated && m_lightClusters.getNumUpdatedLights() == numLights;
+	LightManager::DirtyRange positionRange = a_lightManager.getDirtyPositionRanges();
+	if (fullBuild)
 	{
-		ushort numIndicesForTile = m_tileLightIndices[i].count;
-		gridBuffer[i].x = indiceCtr;                     // start idx
-		gridBuffer[i].y = indiceCtr + numIndicesForTile; // end idx
-		if (numIndicesForTile)
-		{
-			memcpy(&indiceBuffer[indiceCtr], &m_tileLightIndices[i].indices[0], numIndicesForTile * sizeof(ushort));
-			indiceCtr += numIndicesForTile;
-		}
+		positionRange.begin = 0;
+		positionRange.end = numLights;
 	}
-
-	m_lightIndiceTextureBuffer.unmapBuffer();
-	m_lightGridTextureBuffer.unmapBuffer();
-}
-
-uint ClusteredShading::writeLightIndices(const IBounds3D& a_lightBounds, ushort a_lightIdx)
-{
-	for (int x = a_lightBounds.min.x; x < a_lightBounds.max.x; ++x)
+	uploadRange(m_lightPositionRangesSSBO, positionRange, m_lightClusters.getLightPositionRangesViewSpace().data());
+	uploadRange(m_lightDirectionAnglesSSBO, positionRange, m_lightClusters.getLightDirectionAnglesViewSpace().data());
+	a_lightManager.clearDirtyRanges();
+	if (!updated)
+		return;
+
+	m_lightGridTextureBuffer.upload(getGridSize() * sizeof(glm::uvec2), m_lightClusters.getClusterRanges().data());
+
+	// The lists have no limit per cluster, the buffer grows with some headroom when they do not fit
+	const eastl::vector<uint>& lightIndices = m_lightClusters.getLightIndices();
+	const uint numLightIndices = uint(lightIndices.size());
+	if (numLightIndices > m_maxNumLightIndices)
 	{
-		for (int y = a_lightBounds.min.y; y < a_lightBounds.max.y; ++y)
-		{
-			for (int z = a_lightBounds.min.z; z < a_lightBounds.max.z; ++z)
-			{
-				const uint gridIdx = (x * m_gridHeight + y) * m_gridDepth + z;
-				m_tileLightIndices[gridIdx].push_back(a_lightIdx);
-			}
-		}
+		m_maxNumLightIndices = numLightIndices + numLightIndices / 2;
+		m_lightIndiceTextureBuffer.initialize(m_maxNumLightIndices * sizeof(uint), GLTextureBuffer::ESizedFormat::R32I, GLTextureBuffer::EDrawUsage::STREAM);
 	}
-	return a_lightBounds.volume();
+	m_lightIndiceTextureBuffer.upload(numLightIndices * sizeof(uint), lightIndices.data());
 }
 
-void ClusteredShading::bindTextureBuffers()
+void ClusteredShading::bindBuffers()
 {
+	m_lightPositionRangesSSBO.bind();
+	m_lightColorIntensitiesSSBO.bind();
+	m_lightDirectionAnglesSSBO.bind();
 	m_lightIndiceTextureBuffer.bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::ClusteredLightIndice));
 	m_lightGridTextureBuffer.bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::ClusteredLightGrid));
 }
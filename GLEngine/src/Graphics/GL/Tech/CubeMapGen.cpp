@@ -1,6 +1,7 @@
 #include "Graphics/GL/Tech/CubeMapGen.h"
 
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/Utils/CheckGLError.h"
 
 BEGIN_UNNAMED_NAMESPACE()
@@ -34,7 +35,10 @@ END_UNNAMED_NAMESPACE()
 void CubeMapGen::initialize(uint a_width, uint a_height)
 {
 	if (m_initialized)
+	{
+		GLStateCache::onFramebufferDeleted(m_fboID);
 		glDeleteFramebuffers(1, &m_fboID);
+	}
 	glGenFramebuffers(1, &m_fboID);
 	m_cubeMap.initialize(a_width, a_height);
 
@@ -44,7 +48,10 @@ void CubeMapGen::initialize(uint a_width, uint a_height)
 CubeMapGen::~CubeMapGen()
 {
 	if (m_initialized)
+	{
+		GLStateCache::onFramebufferDeleted(m_fboID);
 		glDeleteFramebuffers(1, &m_fboID);
+	}
 }
 
 PerspectiveCamera& CubeMapGen::beginRenderCubeMapFace(const glm::vec3& a_position, ECubeMapFace a_face)
@@ -56,11 +63,11 @@ PerspectiveCamera& CubeMapGen::beginRenderCubeMapFace(const glm::vec3& a_positio
 	m_camera.updateMatrices(UP_DIRECTIONS[uint(a_face)]);
 	m_cubeMap.setPosition(a_position);
 
-	glViewport(0, 0, m_cubeMap.getWidth(), m_cubeMap.getHeight());
+	GLStateCache::setViewport(0, 0, m_cubeMap.getWidth(), m_cubeMap.getHeight());
 
 	CHECK_GL_ERROR();
 
-	glBindFramebuffer(GL_FRAMEBUFFER, m_fboID);
+	GLStateCache::bindFramebuffer(m_fboID);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + uint(a_face), m_cubeMap.getTextureID(), 0);
 	
 	CHECK_GL_ERROR();
@@ -68,7 +75,7 @@ PerspectiveCamera& CubeMapGen::beginRenderCubeMapFace(const glm::vec3& a_positio
 	GLuint depthTex;
 	glGenTextures(1, &depthTex);
 
-	glBindTexture(GL_TEXTURE_2D, depthTex);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, depthTex);
 	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32, m_cubeMap.getWidth(), m_cubeMap.getHeight());
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -97,6 +104,6 @@ PerspectiveCamera& CubeMapGen::beginRenderCubeMapFace(const glm::vec3& a_positio
 void CubeMapGen::endRenderCubeMapFace()
 {
 	assert(m_begun);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(0);
 	m_begun = false;
 }
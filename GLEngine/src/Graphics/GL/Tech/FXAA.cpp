@@ -1,5 +1,6 @@
 #include "Graphics/GL/Tech/FXAA.h"
 
+#include "Graphics/GL/Scene/GLRenderGraph.h"
 #include "Graphics/GL/Tech/QuadDrawer.h"
 
 #include <glm/glm.hpp>
@@ -16,32 +17,27 @@ const char* const FXAA_FRAG_SHADER_PATHS[4] = {
 
 END_UNNAMED_NAMESPACE()
 
-void FXAA::initialize(EQuality a_quality, uint a_screenWidth, uint a_screenHeight)
+void FXAA::initialize(EQuality a_quality)
 {
 	uint quality = uint(a_quality);
 	m_fxaaShader.initialize(FXAA_VERT_SHADER_PATH, FXAA_FRAG_SHADER_PATHS[quality]);
-	m_fxaaShader.begin();
-	m_fxaaShader.setUniform2f("RCPFrame", glm::vec2(1.0f / float(a_screenWidth), 1.0f / float(a_screenHeight)));
-	m_fxaaShader.end();
-
-	m_fxaaTexture.initialize(GLTexture::ESizedFormat::RGB8, a_screenWidth, a_screenHeight);
-
-	m_fxaaFBO.initialize();
-	m_fxaaFBO.addFramebufferTexture(m_fxaaTexture);
-}
-
-void FXAA::begin()
-{
-	m_fxaaFBO.begin();
 }
 
-void FXAA::endAndRender()
+void FXAA::addPass(GLRenderGraph& a_graph, RenderGraph::ResourceHandle a_input, RenderGraph::ResourceHandle a_output)
 {
-	m_fxaaFBO.end();
-
-	m_fxaaShader.begin();
-	m_fxaaFBO.bindTexture(0, 0);
-	QuadDrawer::drawQuad(m_fxaaShader);
-	m_fxaaShader.end();
+	RenderGraph& graph = a_graph.getGraph();
+	// The edges are searched in texels of the input
+	const RenderGraph::ResourceDesc& inputDesc = graph.getResourceDesc(a_input);
+	const glm::vec2 rcpFrame(1.0f / float(inputDesc.width), 1.0f / float(inputDesc.height));
+	const RenderGraph::PassHandle pass = graph.addPass("FXAA", [this, &a_graph, a_input, rcpFrame]()
+	{
+		a_graph.getTexture(a_input).bind(0);
+		m_fxaaShader.begin();
+		m_fxaaShader.setUniform2f("RCPFrame", rcpFrame);
+		QuadDrawer::drawQuad(m_fxaaShader);
+		m_fxaaShader.end();
+	});
+	graph.read(pass, a_input);
+	graph.write(pass, a_output, RenderGraph::ELoad::DONT_CARE);
 }
 
@@ -1,9 +1,10 @@
 #include "Graphics/GL/Tech/GaussianBlur.h"
 
 #include "Graphics/GL/Scene/GLConfig.h"
+#include "Graphics/GL/Scene/GLRenderGraph.h"
 #include "Graphics/GL/Tech/QuadDrawer.h"
 
-#include <glm/glm.hpp>
+#include <assert.h>
 
 BEGIN_UNNAMED_NAMESPACE()
 
@@ -12,18 +13,11 @@ const char* const BLUR_FRAG_SHADER_PATH = "../EngineAssets/Shaders/Blur/gaussian
 
 END_UNNAMED_NAMESPACE()
 
-void GaussianBlur::initialize(EBlurValueType a_type, uint a_xRes, uint a_yRes)
+void GaussianBlur::initialize(EBlurValueType a_type)
 {
 	m_type = a_type;
 	reloadShader();
 
-	m_blurResultTexture.initialize(m_format, a_xRes, a_yRes, GLConfig::getMultisampleType());
-	m_blurXResultFBO.initialize(GLConfig::getMultisampleType());
-	m_blurXResultFBO.addFramebufferTexture(m_blurResultTexture);
-
-	m_pixelXOffset = 1.0f / float(a_xRes);
-	m_pixelYOffset = 1.0f / float(a_yRes);
-
 	m_initialized = true;
 }
 
@@ -36,28 +30,24 @@ void GaussianBlur::reloadShader()
 	{
 		blurDefines.push_back(eastl::string("VALTYPE float"));
 		blurDefines.push_back(eastl::string("VALACCESSOR r"));
-		m_format = GLTexture::ESizedFormat::R8;
 		break;
 	}
 	case EBlurValueType::VEC2:
 	{
 		blurDefines.push_back(eastl::string("VALTYPE vec2"));
 		blurDefines.push_back(eastl::string("VALACCESSOR rg"));
-		m_format = GLTexture::ESizedFormat::RG8;
 		break;
 	}
 	case EBlurValueType::VEC3:
 	{
 		blurDefines.push_back(eastl::string("VALTYPE vec3"));
 		blurDefines.push_back(eastl::string("VALACCESSOR rgb"));
-		m_format = GLTexture::ESizedFormat::RGB8;
 		break;
 	}
 	case EBlurValueType::VEC4:
 	{
 		blurDefines.push_back(eastl::string("VALTYPE vec4"));
 		blurDefines.push_back(eastl::string("VALACCESSOR rgba"));
-		m_format = GLTexture::ESizedFormat::RGBA8;
 		break;
 	}
 	}
@@ -65,24 +55,39 @@ void GaussianBlur::reloadShader()
 	m_blurShader.initialize(QUAD_VERT_SHADER_PATH, BLUR_FRAG_SHADER_PATH, &blurDefines);
 }
 
-void GaussianBlur::blurFBO(GLFramebuffer& a_blurredFBO)
+RenderGraph::ResourceHandle GaussianBlur::addPasses(GLRenderGraph& a_graph, RenderGraph::ResourceHandle a_input)
 {
 	assert(m_initialized);
 
-	a_blurredFBO.bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
-	
-	m_blurShader.begin();
-	m_blurShader.setUniform2f("u_pixelOffset", glm::vec2(m_pixelXOffset, 0.0f));
-	m_blurXResultFBO.begin();
-	QuadDrawer::drawQuad(m_blurShader);
-	m_blurXResultFBO.end();
+	RenderGraph& graph = a_graph.getGraph();
+	const RenderGraph::ResourceDesc desc = graph.getResourceDesc(a_input);
+	const RenderGraph::ResourceHandle blurredX = graph.createTransient("Gaussian blur X", desc);
+	const RenderGraph::ResourceHandle blurred = graph.createTransient("Gaussian blur", desc);
+	const float pixelXOffset = 1.0f / float(desc.width);
+	const float pixelYOffset = 1.0f / float(desc.height);
 
-	m_blurShader.setUniform2f("u_pixelOffset", glm::vec2(0.0f, m_pixelYOffset));
-	m_blurXResultFBO.bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
-	a_blurredFBO.begin();
-	QuadDrawer::drawQuad(m_blurShader);
-	a_blurredFBO.end();
+	const RenderGraph::PassHandle passX = graph.addPass("Gaussian blur X", [this, &a_graph, a_input, pixelXOffset]()
+	{
+		blur(a_graph.getTexture(a_input), glm::vec2(pixelXOffset, 0.0f));
+	});
+	graph.read(passX, a_input);
+	graph.write(passX, blurredX, RenderGraph::ELoad::DONT_CARE);
 
-	m_blurShader.end();
+	const RenderGraph::PassHandle passY = graph.addPass("Gaussian blur Y", [this, &a_graph, blurredX, pixelYOffset]()
+	{
+		blur(a_graph.getTexture(blurredX), glm::vec2(0.0f, pixelYOffset));
+	});
+	graph.read(passY, blurredX);
+	graph.write(passY, blurred, RenderGraph::ELoad::DONT_CARE);
+
+	return blurred;
 }
 
+void GaussianBlur::blur(GLTexture& a_texture, const glm::vec2& a_pixelOffset)
+{
+	a_texture.bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+	m_blurShader.begin();
+	m_blurShader.setUniform2f("u_pixelOffset", a_pixelOffset);
+	QuadDrawer::drawQuad(m_blurShader);
+	m_blurShader.end();
+}
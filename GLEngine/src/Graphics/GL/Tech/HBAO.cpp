@@ -2,24 +2,23 @@
 
 #include "Database/Assets/DBTexture.h"
 #include "Graphics/GL/Scene/GLConfig.h"
+#include "Graphics/GL/Scene/GLRenderGraph.h"
 #include "Graphics/GL/Tech/QuadDrawer.h"
 #include "Graphics/Utils/PerspectiveCamera.h"
 #include "Graphics/Utils/CheckGLError.h"
 #include "Utils/StringUtils.h"
 
-#include "GLEngine.h"
-#include "Graphics/Graphics.h"
-
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/random.hpp>
 
 BEGIN_UNNAMED_NAMESPACE()
 
-/* HBAO render resolution, 1 = full resolution, 2 = half resolution etc */
-const uint HBAO_RESOLUTION_SCALE = 2;
-
 const char* const QUAD_VERT_SHADER_PATH = "../EngineAssets/Shaders/quad.vert";
 const char* const HBAO_FRAG_SHADER_PATH = "../EngineAssets/Shaders/HBAO/HBAO.frag";
 const char* const DOWNSAMPLE_DEPTH_FRAG_SHADER_PATH = "../EngineAssets/Shaders/downsampleDepth.frag";
+const char* const DEINTERLEAVE_DEPTH_FRAG_SHADER_PATH = "../EngineAssets/Shaders/HBAO/deinterleavedepth.frag";
+const char* const REINTERLEAVE_FRAG_SHADER_PATH = "../EngineAssets/Shaders/HBAO/reinterleave.frag";
+const char* const TEMPORAL_RESOLVE_FRAG_SHADER_PATH = "../EngineAssets/Shaders/HBAO/temporalresolve.frag";
 							    
 const float AO_RADIUS           = 0.40f; // In meters
 const uint NUM_DIRS             = 6;
@@ -31,21 +30,21 @@ const uint NOISE_TEXTURE_HEIGHT = 8;
 const uint BLUR_RADIUS          = 8;
 const float MAX_RADIUS_PERCENT  = 0.2f; // Max sample distance based on screen size
 
+// The temporal directions turn by a fraction of the angle between them every frame, after NUM_TEMPORAL_FRAMES frames
+// the frames sampled NUM_TEMPORAL_DIRS * NUM_TEMPORAL_FRAMES different directions
+const uint NUM_TEMPORAL_DIRS         = 2;
+const uint NUM_TEMPORAL_FRAMES       = 4;
+const float TEMPORAL_STEP_JITTERS[NUM_TEMPORAL_FRAMES] = { 0.0f, 0.5f, 0.25f, 0.75f };
+const float TEMPORAL_HISTORY_WEIGHT  = 0.8f;
+const float TEMPORAL_DEPTH_TOLERANCE = 0.05f; // Relative difference of the view depth before the history is dropped
+const uint DEINTERLEAVE_FACTOR       = 4;     // The layers of the deinterleaved layout in x and y, fixed in the shaders
+
 END_UNNAMED_NAMESPACE()
 
 void HBAO::initialize(const PerspectiveCamera& a_camera, uint a_xRes, uint a_yRes)
 {
-	m_screenRes = glm::ivec2(a_xRes, a_yRes);
-	const uint screenWidth = a_xRes;
-	const uint screenHeight = a_yRes;
-	const uint aoWidth = screenWidth / GLConfig::getHBAOResolutionScale();
-	const uint aoHeight = screenHeight / GLConfig::getHBAOResolutionScale();
-
-	m_downsampleDepthFBO.initialize();
-	m_downsampleDepthFBO.addFramebufferTexture(GLConfig::rt.downsampleDepth);
-
-	m_hbaoResultFBO.initialize(GLConfig::getMultisampleType());
-	m_hbaoResultFBO.addFramebufferTexture(GLConfig::rt.hbao);
+	m_renderRes = glm::ivec2(a_xRes, a_yRes);
+	m_resolutionScale = GLConfig::getHBAOResolutionScale();
 
 	float *noise = new float[NOISE_TEXTURE_WIDTH * NOISE_TEXTURE_HEIGHT * 4];
 	for (uint y = 0; y < NOISE_TEXTURE_HEIGHT; ++y)
@@ -71,9 +70,37 @@ void HBAO::initialize(const PerspectiveCamera& a_camera, uint a_xRes, uint a_yRe
 	                          GLTexture::ETextureMinFilter::NEAREST, GLTexture::ETextureMagFilter::NEAREST,
 	                          GLTexture::ETextureWrap::REPEAT, GLTexture::ETextureWrap::REPEAT);
 
-	const float fovRad = glm::radians(a_camera.getVFov());
-	const float near = a_camera.getNear();
-	const float far = a_camera.getFar();
+	m_fovRad = glm::radians(a_camera.getVFov());
+	m_near = a_camera.getNear();
+	m_far = a_camera.getFar();
+
+	m_hbaoGlobalsBuffer.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::HBAOGlobals));
+	uploadGlobals();
+
+	m_bilateralBlur.initialize(BilateralBlur::EBlurValueType::FLOAT, BLUR_RADIUS);
+	reloadShader();
+
+	m_initialized = true;
+}
+
+void HBAO::setResolution(uint a_renderWidth, uint a_renderHeight, uint a_resolutionScale)
+{
+	assert(a_resolutionScale);
+	const glm::ivec2 renderRes(a_renderWidth, a_renderHeight);
+	if (renderRes == m_renderRes && a_resolutionScale == m_resolutionScale)
+		return;
+	m_renderRes = renderRes;
+	m_resolutionScale = a_resolutionScale;
+	uploadGlobals();
+}
+
+void HBAO::uploadGlobals()
+{
+	const uint aoWidth = m_renderRes.x / m_resolutionScale;
+	const uint aoHeight = m_renderRes.y / m_resolutionScale;
+	const float fovRad = m_fovRad;
+	const float near = m_near;
+	const float far = m_far;
 
 	GlobalsUBO globals;
 	globals.aoResolution    = glm::vec2(aoWidth, aoHeight);
@@ -94,62 +121,184 @@ void HBAO::initialize(const PerspectiveCamera& a_camera, uint a_xRes, uint a_yRe
 	globals.noiseTexScale   = glm::vec2(globals.aoResolution.x / float(NOISE_TEXTURE_WIDTH), globals.aoResolution.y / float(NOISE_TEXTURE_HEIGHT));
 	globals.ndcDepthConv.x  = (near - far) / (2.0f * near * far);
 	globals.ndcDepthConv.y  = (near + far) / (2.0f * near * far);
-
-	m_hbaoGlobalsBuffer.initialize(GLConfig::getUBOConfig(GLConfig::EUBOs::HBAOGlobals));
 	m_hbaoGlobalsBuffer.upload(sizeof(GlobalsUBO), &globals);
+}
 
-	m_bilateralBlur.initialize(BilateralBlur::EBlurValueType::FLOAT, screenWidth, screenHeight, BLUR_RADIUS, aoWidth, aoHeight);
-	reloadShader();
+uint HBAO::getNumSamplesPerFrame() const
+{
+	return (m_temporalEnabled ? NUM_TEMPORAL_DIRS : NUM_DIRS) * NUM_STEPS;
+}
 
-	m_initialized = true;
+void HBAO::initializeHistory(GLRenderGraph& a_graph, uint a_width, uint a_height)
+{
+	for (uint i = 0; i < 2; ++i)
+	{
+		if (m_historyTextures[i].isInitialized())
+		{
+			a_graph.releaseFramebuffers(m_historyTextures[i]);
+			a_graph.releaseFramebuffers(m_historyDepthTextures[i]);
+		}
+		m_historyTextures[i].initialize(GLTexture::ESizedFormat::R16F, a_width, a_height);
+		m_historyDepthTextures[i].initialize(GLTexture::ESizedFormat::R32F, a_width, a_height);
+	}
+	m_lastResolvedFrame = 0xFFFFFFFF;
 }
 
 void HBAO::reloadShader()
 {
-	eastl::vector<eastl::string> defines = GLConfig::getGlobalShaderDefines();
-	defines.push_back("NUM_DIRECTIONS " + StringUtils::to_string(NUM_DIRS));
-	defines.push_back("NUM_STEPS " + StringUtils::to_string(NUM_STEPS));
-
-	m_hbaoFullShader.initialize(QUAD_VERT_SHADER_PATH, HBAO_FRAG_SHADER_PATH, &defines);
+	for (uint i = 0; i < NUM_HBAO_SHADERS; ++i)
+	{
+		const bool isTemporal = (i & 1) != 0;
+		const bool isDeinterleaved = (i & 2) != 0;
+		eastl::vector<eastl::string> defines = GLConfig::getGlobalShaderDefines();
+		defines.push_back("NUM_DIRECTIONS " + StringUtils::to_string(isTemporal ? NUM_TEMPORAL_DIRS : NUM_DIRS));
+		defines.push_back("NUM_STEPS " + StringUtils::to_string(NUM_STEPS));
+		if (isDeinterleaved)
+			defines.push_back("DEINTERLEAVED");
+		m_hbaoShaders[i].initialize(QUAD_VERT_SHADER_PATH, HBAO_FRAG_SHADER_PATH, &defines);
+	}
 	m_downsampleDepthShader.initialize(QUAD_VERT_SHADER_PATH, DOWNSAMPLE_DEPTH_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
+	m_deinterleaveDepthShader.initialize(QUAD_VERT_SHADER_PATH, DEINTERLEAVE_DEPTH_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
+	m_reinterleaveShader.initialize(QUAD_VERT_SHADER_PATH, REINTERLEAVE_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
+	m_temporalResolveShader.initialize(QUAD_VERT_SHADER_PATH, TEMPORAL_RESOLVE_FRAG_SHADER_PATH, &GLConfig::getGlobalShaderDefines());
 	m_bilateralBlur.reloadShader();
 }
 
-GLFramebuffer& HBAO::getHBAOResultFBO(GLFramebuffer& a_sceneFBO)
+RenderGraph::ResourceHandle HBAO::addPasses(GLRenderGraph& a_graph, RenderGraph::ResourceHandle a_sceneDepth, const PerspectiveCamera& a_camera)
 {
 	assert(m_initialized);
 
-	GLEngine::graphics->setViewportSize(m_screenRes.x / HBAO_RESOLUTION_SCALE, m_screenRes.y / HBAO_RESOLUTION_SCALE);
+	RenderGraph& graph = a_graph.getGraph();
+	const uint aoWidth = m_renderRes.x / m_resolutionScale;
+	const uint aoHeight = m_renderRes.y / m_resolutionScale;
+	++m_frame;
 
-	if (HBAO_RESOLUTION_SCALE != 1)
+	// The temporal frames turn the directions and move the first step, the others sample like the first temporal frame
+	const uint temporalFrame = m_temporalEnabled ? m_frame % NUM_TEMPORAL_FRAMES : 0;
+	const float directionOffset = 2.0f * glm::pi<float>() / float(NUM_TEMPORAL_DIRS) * float(temporalFrame) / float(NUM_TEMPORAL_FRAMES);
+	const float stepJitter = TEMPORAL_STEP_JITTERS[temporalFrame];
+	GLShader* hbaoShader = &m_hbaoShaders[(m_temporalEnabled ? 1 : 0) + (m_deinterleaved ? 2 : 0)];
+
+	const RenderGraph::ResourceHandle ao = graph.createTransient("HBAO", GLRenderGraph::makeDesc(GLTexture::ESizedFormat::R8, aoWidth, aoHeight));
+	if (m_deinterleaved)
 	{
-		GLEngine::graphics->setDepthWrite(true);
-		GLEngine::graphics->setDepthTest(false);
+		// The layers are rounded up to whole pixels, the pixels past the ambient occlusion resolution are never put back
+		const uint layersWidth = (aoWidth + DEINTERLEAVE_FACTOR - 1) / DEINTERLEAVE_FACTOR * DEINTERLEAVE_FACTOR;
+		const uint layersHeight = (aoHeight + DEINTERLEAVE_FACTOR - 1) / DEINTERLEAVE_FACTOR * DEINTERLEAVE_FACTOR;
+		const RenderGraph::ResourceHandle layersDepth = graph.createTransient("HBAO deinterleaved depth",
+			GLRenderGraph::makeDesc(GLTexture::ESizedFormat::R32F, layersWidth, layersHeight));
+		const RenderGraph::PassHandle deinterleavePass = graph.addPass("HBAO deinterleave depth", [this, &a_graph, a_sceneDepth]()
+		{
+			a_graph.getTexture(a_sceneDepth).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+			m_hbaoGlobalsBuffer.bind();
+			QuadDrawer::drawQuad(m_deinterleaveDepthShader);
+		});
+		graph.read(deinterleavePass, a_sceneDepth);
+		graph.write(deinterleavePass, layersDepth, RenderGraph::ELoad::DONT_CARE);
 
-		m_downsampleDepthFBO.begin();
-		GLEngine::graphics->clearDepthOnly();
-		a_sceneFBO.bindDepthTexture(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
-		QuadDrawer::drawQuad(m_downsampleDepthShader);
-		m_downsampleDepthFBO.end();
+		const RenderGraph::ResourceHandle layersAO = graph.createTransient("HBAO deinterleaved",
+			GLRenderGraph::makeDesc(GLTexture::ESizedFormat::R8, layersWidth, layersHeight));
+		const RenderGraph::PassHandle hbaoPass = graph.addPass("HBAO", [this, &a_graph, hbaoShader, layersDepth, directionOffset, stepJitter]()
+		{
+			a_graph.getTexture(layersDepth).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+			m_noiseTexture.bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::HBAONoise));
+			m_hbaoGlobalsBuffer.bind();
+			hbaoShader->begin();
+			hbaoShader->setUniform1f("u_directionOffset", directionOffset);
+			hbaoShader->setUniform1f("u_stepJitter", stepJitter);
+			QuadDrawer::drawQuad(*hbaoShader);
+			hbaoShader->end();
+		});
+		graph.read(hbaoPass, layersDepth);
+		graph.write(hbaoPass, layersAO, RenderGraph::ELoad::DONT_CARE);
 
-		m_downsampleDepthFBO.bindTexture(0, GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+		const RenderGraph::PassHandle reinterleavePass = graph.addPass("HBAO reinterleave", [this, &a_graph, layersAO]()
+		{
+			a_graph.getTexture(layersAO).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+			m_hbaoGlobalsBuffer.bind();
+			QuadDrawer::drawQuad(m_reinterleaveShader);
+		});
+		graph.read(reinterleavePass, layersAO);
+		graph.write(reinterleavePass, ao, RenderGraph::ELoad::DONT_CARE);
 	}
 	else
 	{
-		a_sceneFBO.bindDepthTexture(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+		RenderGraph::ResourceHandle aoDepth = a_sceneDepth;
+		if (m_resolutionScale != 1)
+		{
+			aoDepth = graph.createTransient("HBAO depth", GLRenderGraph::makeDesc(GLTexture::ESizedFormat::R32F, aoWidth, aoHeight));
+			const RenderGraph::PassHandle downsamplePass = graph.addPass("HBAO downsample depth", [this, &a_graph, a_sceneDepth]()
+			{
+				a_graph.getTexture(a_sceneDepth).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+				QuadDrawer::drawQuad(m_downsampleDepthShader);
+			});
+			graph.read(downsamplePass, a_sceneDepth);
+			graph.write(downsamplePass, aoDepth, RenderGraph::ELoad::DONT_CARE);
+		}
+
+		const RenderGraph::PassHandle hbaoPass = graph.addPass("HBAO", [this, &a_graph, hbaoShader, aoDepth, directionOffset, stepJitter]()
+		{
+			a_graph.getTexture(aoDepth).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+			m_noiseTexture.bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::HBAONoise));
+			m_hbaoGlobalsBuffer.bind();
+			hbaoShader->begin();
+			hbaoShader->setUniform1f("u_directionOffset", directionOffset);
+			hbaoShader->setUniform1f("u_stepJitter", stepJitter);
+			QuadDrawer::drawQuad(*hbaoShader);
+			hbaoShader->end();
+		});
+		graph.read(hbaoPass, aoDepth);
+		graph.write(hbaoPass, ao, RenderGraph::ELoad::DONT_CARE);
 	}
 
-	// Apply HBAO //
-	m_noiseTexture.bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::HBAONoise));
-	m_hbaoGlobalsBuffer.bind();
+	if (!m_temporalEnabled)
+		return m_bilateralBlur.addPasses(a_graph, ao, a_sceneDepth);
 
-	m_hbaoResultFBO.begin();
-	QuadDrawer::drawQuad(m_hbaoFullShader);
-	m_hbaoResultFBO.end();
+	// The history lives across frames, the frame before wrote one of the textures and this frame writes the other
+	if (m_historyTextures[0].getWidth() != aoWidth || m_historyTextures[0].getHeight() != aoHeight)
+		initializeHistory(a_graph, aoWidth, aoHeight);
+	const uint current = m_frame % 2;
+	const uint previous = 1 - current;
+	const RenderGraph::ResourceDesc historyDesc = GLRenderGraph::makeDesc(GLTexture::ESizedFormat::R16F, aoWidth, aoHeight);
+	const RenderGraph::ResourceDesc historyDepthDesc = GLRenderGraph::makeDesc(GLTexture::ESizedFormat::R32F, aoWidth, aoHeight);
+	const RenderGraph::ResourceHandle prevHistory = graph.importResource("HBAO history before", historyDesc, false);
+	const RenderGraph::ResourceHandle prevHistoryDepth = graph.importResource("HBAO history depth before", historyDepthDesc, false);
+	const RenderGraph::ResourceHandle history = graph.importResource("HBAO history", historyDesc, false);
+	const RenderGraph::ResourceHandle historyDepth = graph.importResource("HBAO history depth", historyDepthDesc, false);
+	a_graph.setImportedTexture(prevHistory, &m_historyTextures[previous]);
+	a_graph.setImportedTexture(prevHistoryDepth, &m_historyDepthTextures[previous]);
+	a_graph.setImportedTexture(history, &m_historyTextures[current]);
+	a_graph.setImportedTexture(historyDepth, &m_historyDepthTextures[current]);
 
-	GLEngine::graphics->setViewportSize(m_screenRes.x, m_screenRes.y);
+	// Without a resolve the frame before, after a resize or with the effect disabled, the history is stale
+	const glm::mat4& viewProjection = a_camera.getCombinedMatrix();
+	const glm::mat4 reprojection = m_prevViewProjection * glm::inverse(viewProjection);
+	const float historyWeight = m_lastResolvedFrame + 1 == m_frame ? TEMPORAL_HISTORY_WEIGHT : 0.0f;
+	m_prevViewProjection = viewProjection;
 
-	m_bilateralBlur.blurFBO(m_hbaoResultFBO, a_sceneFBO);
+	const uint frame = m_frame;
+	const RenderGraph::PassHandle resolvePass = graph.addPass("HBAO temporal resolve",
+		[this, &a_graph, ao, a_sceneDepth, prevHistory, prevHistoryDepth, reprojection, historyWeight, frame]()
+	{
+		a_graph.getTexture(ao).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Blur));
+		a_graph.getTexture(a_sceneDepth).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::Depth));
+		a_graph.getTexture(prevHistory).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::HBAOHistory));
+		a_graph.getTexture(prevHistoryDepth).bind(GLConfig::getTextureBindingPoint(GLConfig::ETextures::HBAOHistoryDepth));
+		m_hbaoGlobalsBuffer.bind();
+		m_temporalResolveShader.begin();
+		m_temporalResolveShader.setUniformMatrix4f("u_reprojectionMatrix", reprojection);
+		m_temporalResolveShader.setUniform1f("u_historyWeight", historyWeight);
+		m_temporalResolveShader.setUniform1f("u_depthTolerance", TEMPORAL_DEPTH_TOLERANCE);
+		QuadDrawer::drawQuad(m_temporalResolveShader);
+		m_temporalResolveShader.end();
+		m_lastResolvedFrame = frame;
+	});
+	graph.read(resolvePass, ao);
+	graph.read(resolvePass, a_sceneDepth);
+	graph.read(resolvePass, prevHistory);
+	graph.read(resolvePass, prevHistoryDepth);
+	graph.write(resolvePass, history, RenderGraph::ELoad::DONT_CARE);
+	graph.write(resolvePass, historyDepth, RenderGraph::ELoad::DONT_CARE);
 
-	return m_hbaoResultFBO;
-}
\ No newline at end of file
+	return m_bilateralBlur.addPasses(a_graph, history, a_sceneDepth);
+}
@@ -1,6 +1,7 @@
 #include "Graphics/GL/Wrappers/GLConstantBuffer.h"
 
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/Utils/CheckGLError.h"
 
 #include <assert.h>
@@ -13,17 +14,20 @@ void GLConstantBuffer::initialize(const Config& a_config)
 void GLConstantBuffer::initialize(uint a_bindingPoint, const char* a_blockName, EDrawUsage a_drawUsage, uint dataSize)
 {
 	if (m_initialized)
+	{
+		GLStateCache::onBufferDeleted(m_ubo);
 		glDeleteBuffers(1, &m_ubo);
+	}
 
 	m_drawUsage = a_drawUsage;
 	m_bindingPoint = a_bindingPoint;
 
 	CHECK_GL_ERROR();
 	glGenBuffers(1, &m_ubo);
-	glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
-	glBindBufferBase(GL_UNIFORM_BUFFER, m_bindingPoint, m_ubo);
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, m_bindingPoint, m_ubo);
 	glBufferData(GL_UNIFORM_BUFFER, dataSize, NULL, scast<GLenum>(a_drawUsage)); // Reserve memory with glBufferData
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, 0);
 	CHECK_GL_ERROR();
 
 	m_initialized = true;
@@ -32,7 +36,10 @@ void GLConstantBuffer::initialize(uint a_bindingPoint, const char* a_blockName,
 GLConstantBuffer::~GLConstantBuffer()
 {
 	if (m_initialized)
+	{
+		GLStateCache::onBufferDeleted(m_ubo);
 		glDeleteBuffers(1, &m_ubo);
+	}
 }
 
 GLConstantBuffer::GLConstantBuffer(const GLConstantBuffer& copy)
@@ -45,7 +52,7 @@ void GLConstantBuffer::upload(uint a_numBytes, const void* a_data, uint a_offset
 	assert(m_initialized);
 	if (a_numBytes)
 	{
-		glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+		GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, m_ubo);
 		glBufferSubData(GL_UNIFORM_BUFFER, a_offset, a_numBytes, a_data);
 	}
 }
@@ -53,14 +60,14 @@ void GLConstantBuffer::upload(uint a_numBytes, const void* a_data, uint a_offset
 void GLConstantBuffer::bind()
 {
 	assert(m_initialized);
-	glBindBufferBase(GL_UNIFORM_BUFFER, m_bindingPoint, m_ubo);
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, m_bindingPoint, m_ubo);
 }
 
 byte* GLConstantBuffer::mapBuffer()
 {
 	assert(m_initialized);
 	assert(!m_isMapped);
-	glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, m_ubo);
 	byte* buffer = scast<byte*>(glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY | GL_MAP_INVALIDATE_BUFFER_BIT));
 	assert(buffer);
 	m_isMapped = true;
@@ -72,7 +79,7 @@ void GLConstantBuffer::unmapBuffer()
 	assert(m_initialized);
 	assert(m_isMapped);
 	m_isMapped = false;
-	glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, m_ubo);
 	glUnmapBuffer(GL_UNIFORM_BUFFER);
 }
 
@@ -1,6 +1,7 @@
 #include "Graphics/GL/Wrappers/GLFramebuffer.h"
 
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/GL/Wrappers/GLTexture.h"
 #include "Graphics/Utils/CheckGLError.h"
 
@@ -11,13 +12,19 @@ bool GLFramebuffer::s_begun = false;
 GLFramebuffer::~GLFramebuffer()
 {
 	if (m_initialized)
+	{
+		GLStateCache::onFramebufferDeleted(m_fbo);
 		glDeleteFramebuffers(1, &m_fbo);
+	}
 }
 
 void GLFramebuffer::initialize(GLTexture::EMultiSampleType a_multiSampleType)
 {
 	if (m_initialized)
+	{
+		GLStateCache::onFramebufferDeleted(m_fbo);
 		glDeleteFramebuffers(1, &m_fbo);
+	}
 	m_multiSampleType = a_multiSampleType;
 	m_textures.clear();
 	m_drawBuffers.clear();
@@ -34,14 +41,14 @@ void GLFramebuffer::addFramebufferTexture(GLTexture& a_texture, EAttachment a_at
 	m_drawBuffers.push_back(a_attachment);
 
 	CHECK_GL_ERROR();
-	glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+	GLStateCache::bindFramebuffer(m_fbo);
 	glFramebufferTexture(GL_FRAMEBUFFER, GLenum(a_attachment), a_texture.getTextureID(), 0);
 	glDrawBuffers(uint(m_drawBuffers.size()), rcast<GLenum*>(&m_drawBuffers[0]));
 
 	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
 	assert(status == GL_FRAMEBUFFER_COMPLETE);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(0);
 	CHECK_GL_ERROR();
 }
 
@@ -53,13 +60,13 @@ void GLFramebuffer::setDepthbufferTexture(GLTexture& a_texture)
 	m_depthTexture = a_texture.getTextureID();
 
 	CHECK_GL_ERROR()
-	glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+	GLStateCache::bindFramebuffer(m_fbo);
 	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, a_texture.getTextureID(), 0);
 	
 	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
 	assert(status == GL_FRAMEBUFFER_COMPLETE);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(0);
 	CHECK_GL_ERROR();
 }
 
@@ -70,7 +77,7 @@ void GLFramebuffer::end()
 	assert(s_begun);
 	m_begun = false;
 	s_begun = false;
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(0);
 }
 
 void GLFramebuffer::begin()
@@ -80,7 +87,19 @@ void GLFramebuffer::begin()
 	assert(!m_begun);
 	m_begun = true;
 	s_begun = true;
-	glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+	GLStateCache::bindFramebuffer(m_fbo);
+}
+
+void GLFramebuffer::blitDepth(GLFramebuffer& a_target, int a_x, int a_y, uint a_width, uint a_height)
+{
+	assert(m_initialized && a_target.m_initialized);
+	assert(!s_begun);
+	assert(m_depthTexture && a_target.m_depthTexture);
+
+	GLStateCache::bindFramebuffers(m_fbo, a_target.m_fbo);
+	glBlitFramebuffer(a_x, a_y, a_x + a_width, a_y + a_height, a_x, a_y, a_x + a_width, a_y + a_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	GLStateCache::bindFramebuffer(0);
+	CHECK_GL_ERROR();
 }
 
 void GLFramebuffer::bindTexture(uint a_textureIndex, uint a_textureUnit)
@@ -90,23 +109,20 @@ void GLFramebuffer::bindTexture(uint a_textureIndex, uint a_textureUnit)
 	assert(a_textureIndex >= 0);
 	assert(a_textureUnit >= 0);
 
-	glActiveTexture(GL_TEXTURE0 + a_textureUnit);
 	GLenum textureType = (m_multiSampleType == GLTexture::EMultiSampleType::NONE) ? GL_TEXTURE_2D : GL_TEXTURE_2D_MULTISAMPLE;
-	glBindTexture(textureType, m_textures[a_textureIndex]);
+	GLStateCache::bindTexture(a_textureUnit, textureType, m_textures[a_textureIndex]);
 }
 
 void GLFramebuffer::bindDepthTexture(uint a_textureUnit)
 {
 	assert(m_initialized);
-	glActiveTexture(GL_TEXTURE0 + a_textureUnit);
 	GLenum textureType = (m_multiSampleType == GLTexture::EMultiSampleType::NONE) ? GL_TEXTURE_2D : GL_TEXTURE_2D_MULTISAMPLE;
 	//GLenum textureType = GL_TEXTURE_2D;
-	glBindTexture(textureType, m_depthTexture);
+	GLStateCache::bindTexture(a_textureUnit, textureType, m_depthTexture);
 }
 
 void GLFramebuffer::unbindTexture(uint a_textureIndex, uint a_textureUnit)
 {
-	glActiveTexture(GL_TEXTURE0 + a_textureUnit);
 	GLenum textureType = (m_multiSampleType == GLTexture::EMultiSampleType::NONE) ? GL_TEXTURE_2D : GL_TEXTURE_2D_MULTISAMPLE;
-	glBindTexture(textureType, 0);
+	GLStateCache::bindTexture(a_textureUnit, textureType, 0);
 }
@@ -0,0 +1,130 @@
+#include "Graphics/GL/Wrappers/GLRingBuffer.h"
+
+#include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
+#include "Graphics/Utils/CheckGLError.h"
+
+#include <assert.h>
+#include <cstring>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const GLuint64 FENCE_WAIT_TIMEOUT_NS = 1000000; // 1 ms, the wait is repeated until the fence signals
+
+END_UNNAMED_NAMESPACE()
+
+GLRingBuffer::~GLRingBuffer()
+{
+	if (!m_initialized)
+		return;
+	for (GLsync fence : m_frameFences)
+		glDeleteSync(fence);
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	glUnmapBuffer(GL_UNIFORM_BUFFER);
+	GLStateCache::onBufferDeleted(m_buffer);
+	glDeleteBuffers(1, &m_buffer);
+}
+
+void GLRingBuffer::initialize(uint a_sizeBytes, uint a_maxFramesInFlight)
+{
+	assert(!m_initialized);
+	assert(a_maxFramesInFlight);
+
+	GLint uniformAlignment = 0;
+	GLint storageAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+	// Both are powers of two, so the larger one satisfies both
+	m_alignment = uint(uniformAlignment > storageAlignment ? uniformAlignment : storageAlignment);
+	m_alignment = m_alignment ? m_alignment : 256;
+	const uint sizeBytes = (a_sizeBytes + m_alignment - 1) / m_alignment * m_alignment;
+	m_maxFramesInFlight = a_maxFramesInFlight;
+	m_allocator.initialize(sizeBytes);
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	CHECK_GL_ERROR();
+	glGenBuffers(1, &m_buffer);
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	glBufferStorage(GL_UNIFORM_BUFFER, sizeBytes, NULL, flags);
+	m_mappedData = scast<byte*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, sizeBytes, flags));
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, 0);
+	CHECK_GL_ERROR();
+	assert(m_mappedData);
+
+	m_initialized = true;
+}
+
+GLRingBuffer::Allocation GLRingBuffer::allocate(uint a_numBytes)
+{
+	assert(m_initialized);
+	uint64 offset = m_allocator.allocate(a_numBytes, m_alignment);
+	while (offset == RingBufferAllocator::INVALID_OFFSET && !m_frameFences.empty())
+	{
+		waitForOldestFrame();
+		offset = m_allocator.allocate(a_numBytes, m_alignment);
+	}
+
+	Allocation allocation;
+	if (offset == RingBufferAllocator::INVALID_OFFSET)
+	{
+		print("Ring buffer of %llu bytes is too small for the data of one frame\n", m_allocator.getSizeBytes());
+		assert(false);
+		return allocation;
+	}
+	allocation.data = m_mappedData + offset;
+	allocation.offset = uint(offset);
+	allocation.numBytes = a_numBytes;
+	return allocation;
+}
+
+GLRingBuffer::Allocation GLRingBuffer::upload(uint a_numBytes, const void* a_data)
+{
+	const Allocation allocation = allocate(a_numBytes);
+	if (allocation.isValid())
+		memcpy(allocation.data, a_data, a_numBytes);
+	return allocation;
+}
+
+void GLRingBuffer::bindRange(EBindTarget a_target, uint a_bindingPoint, const Allocation& a_allocation)
+{
+	assert(m_initialized);
+	if (a_allocation.isValid())
+		GLStateCache::bindBufferRange(GLenum(a_target), a_bindingPoint, m_buffer, a_allocation.offset, a_allocation.numBytes);
+}
+
+void GLRingBuffer::bindAsDrawIndirect()
+{
+	assert(m_initialized);
+	GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_buffer);
+}
+
+void GLRingBuffer::endFrame()
+{
+	assert(m_initialized);
+	m_frameFences.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_allocator.endFrame();
+
+	// Release whatever the GPU already finished without waiting, and only block when too many frames are queued
+	while (!m_frameFences.empty() && glClientWaitSync(m_frameFences.front(), 0, 0) != GL_TIMEOUT_EXPIRED)
+	{
+		glDeleteSync(m_frameFences.front());
+		m_frameFences.erase(m_frameFences.begin());
+		m_allocator.releaseOldestFrame();
+	}
+	while (m_frameFences.size() > m_maxFramesInFlight)
+		waitForOldestFrame();
+}
+
+void GLRingBuffer::waitForOldestFrame()
+{
+	assert(!m_frameFences.empty());
+	GLsync fence = m_frameFences.front();
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT_NS);
+	while (result == GL_TIMEOUT_EXPIRED)
+		result = glClientWaitSync(fence, 0, FENCE_WAIT_TIMEOUT_NS);
+	assert(result != GL_WAIT_FAILED);
+
+	glDeleteSync(fence);
+	m_frameFences.erase(m_frameFences.begin());
+	m_allocator.releaseOldestFrame();
+}
@@ -3,6 +3,7 @@
 #include "Core.h"
 
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/Utils/CheckGLError.h"
 #include "Utils/FileHandle.h"
 #include "Utils/FileUtils.h"
@@ -144,14 +145,20 @@ END_UNNAMED_NAMESPACE()
 GLShader::~GLShader()
 {
 	if (m_shaderID)
+	{
+		GLStateCache::onProgramDeleted(m_shaderID);
 		glDeleteProgram(m_shaderID);
+	}
 }
 
 void GLShader::initialize(const char* a_vertexShaderFilePath, const char* a_fragmentShaderFilePath,
 	                      const eastl::vector<eastl::string>* a_defines, const eastl::vector<eastl::string>* a_extensions)
 {
 	if (m_shaderID)
+	{
+		GLStateCache::onProgramDeleted(m_shaderID);
 		glDeleteProgram(m_shaderID);
+	}
 
 	const GLuint program = glCreateProgram();
 	assert(program);
@@ -190,7 +197,7 @@ void GLShader::begin()
 	assert(!m_begun);
 	s_begun = true;
 	m_begun = true;
-	glUseProgram(m_shaderID);
+	GLStateCache::useProgram(m_shaderID);
 }
 
 void GLShader::end()
@@ -199,7 +206,7 @@ void GLShader::end()
 	assert(m_begun);
 	s_begun = false;
 	m_begun = false;
-	glUseProgram(0);
+	GLStateCache::useProgram(0);
 }
 
 void GLShader::setUniform1i(const char* a_uniformName, int a_val)
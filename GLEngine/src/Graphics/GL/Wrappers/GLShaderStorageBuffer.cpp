@@ -0,0 +1,71 @@
+#include "Graphics/GL/Wrappers/GLShaderStorageBuffer.h"
+
+#include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
+#include "Graphics/Utils/CheckGLError.h"
+
+#include <assert.h>
+
+void GLShaderStorageBuffer::initialize(const Config& a_config)
+{
+	initialize(a_config.bindingPoint, a_config.drawUsage);
+}
+
+void GLShaderStorageBuffer::initialize(uint a_bindingPoint, EDrawUsage a_drawUsage)
+{
+	if (m_initialized)
+	{
+		GLStateCache::onBufferDeleted(m_ssbo);
+		glDeleteBuffers(1, &m_ssbo);
+	}
+
+	m_drawUsage = a_drawUsage;
+	m_bindingPoint = a_bindingPoint;
+	m_sizeBytes = 0;
+
+	CHECK_GL_ERROR();
+	glGenBuffers(1, &m_ssbo);
+	CHECK_GL_ERROR();
+
+	m_initialized = true;
+}
+
+GLShaderStorageBuffer::~GLShaderStorageBuffer()
+{
+	if (m_initialized)
+	{
+		GLStateCache::onBufferDeleted(m_ssbo);
+		glDeleteBuffers(1, &m_ssbo);
+	}
+}
+
+void GLShaderStorageBuffer::upload(uint a_numBytes, const void* a_data)
+{
+	assert(m_initialized);
+	if (a_numBytes)
+	{
+		GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssbo);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, a_numBytes, a_data, scast<GLenum>(m_drawUsage));
+		GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		m_sizeBytes = a_numBytes;
+	}
+}
+
+void GLShaderStorageBuffer::uploadRange(uint a_offset, uint a_numBytes, const void* a_data)
+{
+	assert(m_initialized);
+	assert(a_offset + a_numBytes <= m_sizeBytes);
+	if (a_numBytes)
+	{
+		GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssbo);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, a_offset, a_numBytes, a_data);
+		GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+}
+
+void GLShaderStorageBuffer::bind()
+{
+	assert(m_initialized);
+	if (m_sizeBytes)
+		GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, m_bindingPoint, m_ssbo);
+}
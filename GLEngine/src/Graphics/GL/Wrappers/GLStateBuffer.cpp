@@ -1,6 +1,7 @@
 #include "Graphics/GL/Wrappers/GLStateBuffer.h"
 
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 
 #include <assert.h>
 
@@ -9,14 +10,20 @@ bool GLStateBuffer::s_isBegun = false;
 GLStateBuffer::~GLStateBuffer()
 {
 	if (m_initialized)
+	{
+		GLStateCache::onVertexArrayDeleted(m_vao);
 		glDeleteVertexArrays(1, &m_vao);
+	}
 }
 
 void GLStateBuffer::initialize()
 {
 	assert(!s_isBegun);
 	if (m_initialized)
+	{
+		GLStateCache::onVertexArrayDeleted(m_vao);
 		glDeleteVertexArrays(1, &m_vao);
+	}
 
 	glGenVertexArrays(1, &m_vao);
 	m_initialized = true;
@@ -29,7 +36,7 @@ void GLStateBuffer::begin()
 	assert(!s_isBegun);
 	m_isBegun = true;
 	s_isBegun = true;
-	glBindVertexArray(m_vao);
+	GLStateCache::bindVertexArray(m_vao);
 }
 
 void GLStateBuffer::end()
@@ -39,5 +46,5 @@ void GLStateBuffer::end()
 	assert(s_isBegun);
 	m_isBegun = false;
 	s_isBegun = false;
-	glBindVertexArray(0);
+	GLStateCache::bindVertexArray(0);
 }
\ No newline at end of file
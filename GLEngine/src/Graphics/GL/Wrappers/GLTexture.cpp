@@ -2,25 +2,27 @@
 
 #include "Database/Assets/DBTexture.h"
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/Utils/CheckGLError.h"
 #include "Graphics/Utils/TextureFormatUtils.h"
 
 GLTexture::~GLTexture()
 {
 	if (m_initialized)
+	{
+		GLStateCache::onTextureDeleted(m_textureID);
 		glDeleteTextures(1, &m_textureID);
+	}
 }
 
 void GLTexture::bind(uint a_index)
 {
-	glActiveTexture(GL_TEXTURE0 + a_index);
-	glBindTexture(GL_TEXTURE_2D, m_textureID);
+	GLStateCache::bindTexture(a_index, m_multiSampleType == EMultiSampleType::NONE ? GL_TEXTURE_2D : GL_TEXTURE_2D_MULTISAMPLE, m_textureID);
 }
 
 void GLTexture::unbind(uint a_index)
 {
-	glActiveTexture(GL_TEXTURE0 + a_index);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::bindTexture(a_index, m_multiSampleType == EMultiSampleType::NONE ? GL_TEXTURE_2D : GL_TEXTURE_2D_MULTISAMPLE, 0);
 }
 
 void GLTexture::initialize(ESizedFormat a_format, uint a_width, uint a_height, 
@@ -28,6 +30,12 @@ void GLTexture::initialize(ESizedFormat a_format, uint a_width, uint a_height,
                            ETextureMinFilter a_minFilter, ETextureMagFilter a_magFilter, 
                            ETextureWrap a_textureWrapS, ETextureWrap a_textureWrapT)
 {
+	if (m_initialized)
+	{
+		GLStateCache::onTextureDeleted(m_textureID);
+		glDeleteTextures(1, &m_textureID);
+	}
+
 	GLenum textureType;
 	m_width = a_width;
 	m_height = a_height;
@@ -38,7 +46,7 @@ void GLTexture::initialize(ESizedFormat a_format, uint a_width, uint a_height,
 	if (a_multiSampleType == EMultiSampleType::NONE)
 	{
 		textureType = GL_TEXTURE_2D;
-		glBindTexture(textureType, m_textureID);
+		GLStateCache::bindTexture(textureType, m_textureID);
 		glTexStorage2D(textureType, 1, GLenum(a_format), a_width, a_height);
 		glTexParameteri(textureType, GL_TEXTURE_MIN_FILTER, GLenum(a_minFilter));
 		glTexParameteri(textureType, GL_TEXTURE_MAG_FILTER, GLenum(a_magFilter));
@@ -48,7 +56,7 @@ void GLTexture::initialize(ESizedFormat a_format, uint a_width, uint a_height,
 	else
 	{
 		textureType = GL_TEXTURE_2D_MULTISAMPLE;
-		glBindTexture(textureType, m_textureID);
+		GLStateCache::bindTexture(textureType, m_textureID);
 		glTexStorage2DMultisample(textureType, GLsizei(a_multiSampleType), GLenum(a_format), a_width, a_height, GL_TRUE);
 	}
 	if (a_compareMode != ETextureCompareMode::NONE)
@@ -58,7 +66,8 @@ void GLTexture::initialize(ESizedFormat a_format, uint a_width, uint a_height,
 	}
 	CHECK_GL_ERROR();
 
-	glBindTexture(textureType, 0);
+	GLStateCache::bindTexture(textureType, 0);
+	m_initialized = true;
 }
 
 void GLTexture::initialize(const DBTexture& a_texture, uint a_numMipmaps,
@@ -66,7 +75,10 @@ void GLTexture::initialize(const DBTexture& a_texture, uint a_numMipmaps,
                            ETextureWrap a_textureWrapS, ETextureWrap a_textureWrapT)
 {
 	if (m_initialized)
+	{
+		GLStateCache::onTextureDeleted(m_textureID);
 		glDeleteTextures(1, &m_textureID);
+	}
 
 	m_width = a_texture.getWidth();
 	m_height = a_texture.getHeight();
@@ -86,7 +98,7 @@ void GLTexture::initialize(const DBTexture& a_texture, uint a_numMipmaps,
 		a_numMipmaps = 0;
 
 	glGenTextures(1, &m_textureID);
-	glBindTexture(GL_TEXTURE_2D, m_textureID);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, m_textureID);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GLenum(a_minFilter));
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GLenum(a_magFilter));
@@ -99,7 +111,7 @@ void GLTexture::initialize(const DBTexture& a_texture, uint a_numMipmaps,
 	if (a_numMipmaps)
 		glGenerateMipmap(GL_TEXTURE_2D);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	bool m_initialized = true;
+	m_initialized = true;
 }
\ No newline at end of file
@@ -1,23 +1,42 @@
 #include "Graphics/GL/Wrappers/GLTextureArray.h"
 
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/Utils/TextureFormatUtils.h"
 #include "Database/Assets/DBTexture.h"
 
+#include "EASTL/algorithm.h"
+#include "Utils/ParallelUtils.h"
+
 #include <assert.h>
+#include <string.h>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint MIN_MIPMAP_ROWS_PER_RANGE = 64;
+
+END_UNNAMED_NAMESPACE()
 
 GLTextureArray::~GLTextureArray()
 {
 	if (m_initialized)
+	{
+		GLStateCache::onTextureDeleted(m_textureID);
 		glDeleteTextures(1, &m_textureID);
+	}
 }
 
 void GLTextureArray::startInit(uint a_width, uint a_height, uint a_depth, uint a_numComponents, bool a_isFloatTexture, uint a_numMipMaps, 
                                ETextureMinFilter a_minFilter, ETextureMagFilter a_magFilter, ETextureWrap a_textureWrapS, ETextureWrap a_textureWrapT)
 {
 	if (m_initialized)
+	{
+		GLStateCache::onTextureDeleted(m_textureID);
 		glDeleteTextures(1, &m_textureID);
+	}
 	m_initialized = false;
+	m_isStreamed = false;
+	m_levelData.clear();
 
 	m_width = a_width;
 	m_height = a_height;
@@ -25,6 +44,11 @@ void GLTextureArray::startInit(uint a_width, uint a_height, uint a_depth, uint a
 	m_numComponents = a_numComponents;
 	m_isFloatTexture = a_isFloatTexture;
 	m_numMipmaps = a_numMipMaps;
+	m_numTexturesAdded = 0;
+	m_minFilter = a_minFilter;
+	m_magFilter = a_magFilter;
+	m_textureWrapS = a_textureWrapS;
+	m_textureWrapT = a_textureWrapT;
 
 	const bool generateMipMaps = (
 		a_minFilter == ETextureMinFilter::NEAREST_MIPMAP_LINEAR ||
@@ -35,18 +59,41 @@ void GLTextureArray::startInit(uint a_width, uint a_height, uint a_depth, uint a
 	if (!generateMipMaps)
 		m_numMipmaps = 0;
 
+	m_residentLevel = 0;
+	createTexture(0);
+}
+
+void GLTextureArray::startInitStreamed(uint a_width, uint a_height, uint a_depth, uint a_numComponents, bool a_isFloatTexture, uint a_numMipMaps,
+                                       ETextureMinFilter a_minFilter, ETextureMagFilter a_magFilter, ETextureWrap a_textureWrapS, ETextureWrap a_textureWrapT)
+{
+	startInit(a_width, a_height, a_depth, a_numComponents, a_isFloatTexture, a_numMipMaps, a_minFilter, a_magFilter, a_textureWrapS, a_textureWrapT);
+	// Nothing is allocated on the GPU until the mip levels are known in finishInit
+	GLStateCache::onTextureDeleted(m_textureID);
+	glDeleteTextures(1, &m_textureID);
+	m_textureID = 0;
+	m_isStreamed = true;
+	m_levelData.resize(m_numMipmaps + 1);
+	for (uint level = 0; level <= m_numMipmaps; ++level)
+		m_levelData[level].resize(getLevelByteSize(level));
+}
+
+void GLTextureArray::createTexture(uint a_baseLevel)
+{
 	glGenTextures(1, &m_textureID);
-	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
 
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, (GLenum) a_minFilter);
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, (GLenum) a_magFilter);
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, (GLenum) a_textureWrapS);
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, (GLenum) a_textureWrapT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, (GLenum) m_minFilter);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, (GLenum) m_magFilter);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, (GLenum) m_textureWrapS);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, (GLenum) m_textureWrapT);
 	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint) m_numMipmaps);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint) (m_numMipmaps - a_baseLevel));
 
+	// The level that is resident is level 0 of the GL texture, the shaders only work with normalized coordinates
 	const GLint internalFormat = TextureFormatUtils::getInternalFormatForNumComponents(m_numComponents, m_isFloatTexture);
-	glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_numMipmaps + 1, internalFormat, m_width, m_height, m_depth);
+	const uint width = eastl::max(m_width >> a_baseLevel, 1u);
+	const uint height = eastl::max(m_height >> a_baseLevel, 1u);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_numMipmaps - a_baseLevel + 1, internalFormat, width, height, m_depth);
 }
 
 uint GLTextureArray::addTexture(const DBTexture& a_tex)
@@ -63,10 +110,18 @@ uint GLTextureArray::addTexture(const DBTexture& a_tex)
 	// Cannot add more textures than depth
 	assert(m_numTexturesAdded < m_depth);
 
+	if (m_isStreamed)
+	{
+		const uint64 layerByteSize = getLevelByteSize(0) / m_depth;
+		assert(a_tex.getData().size() == layerByteSize);
+		memcpy(m_levelData[0].data() + layerByteSize * m_numTexturesAdded, a_tex.getData().data(), layerByteSize);
+		return m_numTexturesAdded++;
+	}
+
 	const GLenum format = TextureFormatUtils::getFormatForNumComponents(m_numComponents);
 	const GLenum type = m_isFloatTexture ? GL_FLOAT : GL_UNSIGNED_BYTE;
 
-	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
 	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, m_numTexturesAdded, m_width, m_height, 1, format, type, (const GLvoid*) &a_tex.getData()[0]);
 
 	return m_numTexturesAdded++;
@@ -78,24 +133,130 @@ void GLTextureArray::finishInit()
 	assert(m_width != 0 && m_height != 0 && "Use startInit and addTexture before finishInit");
 	assert(m_numTexturesAdded == m_depth && "Texture array is not filled");
 
-	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
-	if (m_numMipmaps)
-		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
-	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	if (m_isStreamed)
+	{
+		generateMipMapsOnCPU();
+		m_residentLevel = m_numMipmaps;
+		createTexture(m_residentLevel);
+		uploadLevels(m_residentLevel, m_numMipmaps + 1);
+	}
+	else
+	{
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+		if (m_numMipmaps)
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
 	m_initialized = true;
 }
 
+void GLTextureArray::setResidentLevel(uint a_level)
+{
+	assert(m_initialized && m_isStreamed);
+	assert(a_level <= m_numMipmaps);
+	if (a_level == m_residentLevel)
+		return;
+
+	// Texture storage is immutable, so changing the finest level means a new texture.
+	// The levels both textures have are copied on the GPU, only the levels that were not resident are uploaded
+	uint prevTextureID = m_textureID;
+	const uint prevResidentLevel = m_residentLevel;
+	m_residentLevel = a_level;
+	createTexture(m_residentLevel);
+	for (uint level = eastl::max(a_level, prevResidentLevel); level <= m_numMipmaps; ++level)
+	{
+		const uint width = eastl::max(m_width >> level, 1u);
+		const uint height = eastl::max(m_height >> level, 1u);
+		glCopyImageSubData(prevTextureID, GL_TEXTURE_2D_ARRAY, level - prevResidentLevel, 0, 0, 0,
+			m_textureID, GL_TEXTURE_2D_ARRAY, level - a_level, 0, 0, 0, width, height, m_depth);
+	}
+	uploadLevels(a_level, eastl::max(a_level, prevResidentLevel));
+	GLStateCache::onTextureDeleted(prevTextureID);
+	glDeleteTextures(1, &prevTextureID);
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+uint64 GLTextureArray::getLevelByteSize(uint a_level) const
+{
+	const uint64 pixelSize = m_numComponents * (m_isFloatTexture ? sizeof(float) : sizeof(byte));
+	const uint64 width = eastl::max(m_width >> a_level, 1u);
+	const uint64 height = eastl::max(m_height >> a_level, 1u);
+	return width * height * m_depth * pixelSize;
+}
+
+void GLTextureArray::uploadLevels(uint a_beginLevel, uint a_endLevel)
+{
+	const GLenum format = TextureFormatUtils::getFormatForNumComponents(m_numComponents);
+	const GLenum type = m_isFloatTexture ? GL_FLOAT : GL_UNSIGNED_BYTE;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (uint level = a_beginLevel; level < a_endLevel; ++level)
+	{
+		const uint width = eastl::max(m_width >> level, 1u);
+		const uint height = eastl::max(m_height >> level, 1u);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level - m_residentLevel, 0, 0, 0, width, height, m_depth, format, type, (const GLvoid*) m_levelData[level].data());
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+/** 2x2 box filter per level, the same as what glGenerateMipmap does for the non streamed textures on most drivers */
+void GLTextureArray::generateMipMapsOnCPU()
+{
+	for (uint level = 1; level <= m_numMipmaps; ++level)
+	{
+		const uint srcWidth = eastl::max(m_width >> (level - 1), 1u);
+		const uint srcHeight = eastl::max(m_height >> (level - 1), 1u);
+		const uint width = eastl::max(m_width >> level, 1u);
+		const uint height = eastl::max(m_height >> level, 1u);
+		ParallelUtils::forRanges(height * m_depth, [&](uint a_begin, uint a_end, uint)
+		{
+			for (uint row = a_begin; row < a_end; ++row)
+			{
+				const uint layer = row / height;
+				const uint y = row % height;
+				const uint y0 = eastl::min(y * 2, srcHeight - 1);
+				const uint y1 = eastl::min(y * 2 + 1, srcHeight - 1);
+				for (uint x = 0; x < width; ++x)
+				{
+					const uint x0 = eastl::min(x * 2, srcWidth - 1);
+					const uint x1 = eastl::min(x * 2 + 1, srcWidth - 1);
+					const uint64 srcLayerOffset = uint64(layer) * srcWidth * srcHeight;
+					const uint64 srcIdx[4] = {
+						(srcLayerOffset + uint64(y0) * srcWidth + x0) * m_numComponents,
+						(srcLayerOffset + uint64(y0) * srcWidth + x1) * m_numComponents,
+						(srcLayerOffset + uint64(y1) * srcWidth + x0) * m_numComponents,
+						(srcLayerOffset + uint64(y1) * srcWidth + x1) * m_numComponents };
+					const uint64 dstIdx = (uint64(layer) * width * height + uint64(y) * width + x) * m_numComponents;
+					for (uint c = 0; c < m_numComponents; ++c)
+					{
+						if (m_isFloatTexture)
+						{
+							const float* src = rcast<const float*>(m_levelData[level - 1].data());
+							float* dst = rcast<float*>(m_levelData[level].data());
+							dst[dstIdx + c] = (src[srcIdx[0] + c] + src[srcIdx[1] + c] + src[srcIdx[2] + c] + src[srcIdx[3] + c]) * 0.25f;
+						}
+						else
+						{
+							const byte* src = m_levelData[level - 1].data();
+							byte* dst = m_levelData[level].data();
+							dst[dstIdx + c] = byte((uint(src[srcIdx[0] + c]) + src[srcIdx[1] + c] + src[srcIdx[2] + c] + src[srcIdx[3] + c] + 2) / 4);
+						}
+					}
+				}
+			}
+		}, MIN_MIPMAP_ROWS_PER_RANGE);
+	}
+}
+
 void GLTextureArray::bind(uint a_index)
 {
 	assert(m_initialized);
-	glActiveTexture(GL_TEXTURE0 + a_index);
-	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+	GLStateCache::bindTexture(a_index, GL_TEXTURE_2D_ARRAY, m_textureID);
 }
 
 void GLTextureArray::unbind(uint a_index)
 {
-	glActiveTexture(GL_TEXTURE0 + a_index);
-	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	GLStateCache::bindTexture(a_index, GL_TEXTURE_2D_ARRAY, 0);
 }
 
 
@@ -0,0 +1,74 @@
+#include "Graphics/GL/Wrappers/GLTimerQuery.h"
+
+#include "Graphics/GL/GL.h"
+#include "Graphics/Utils/CheckGLError.h"
+
+#include <assert.h>
+
+GLTimerQuery::~GLTimerQuery()
+{
+	if (m_initialized)
+		glDeleteQueries(GLsizei(m_queries.size()), m_queries.data());
+}
+
+void GLTimerQuery::initialize(uint a_maxMeasurementsInFlight)
+{
+	assert(a_maxMeasurementsInFlight);
+	if (m_initialized)
+		glDeleteQueries(GLsizei(m_queries.size()), m_queries.data());
+
+	m_queries.resize(a_maxMeasurementsInFlight * 2);
+	glGenQueries(GLsizei(m_queries.size()), m_queries.data());
+	CHECK_GL_ERROR();
+	m_oldestPending = 0;
+	m_numPending = 0;
+	m_isMeasuring = false;
+	m_initialized = true;
+}
+
+void GLTimerQuery::begin()
+{
+	assert(m_initialized && !m_isMeasuring);
+	const uint numMeasurements = uint(m_queries.size()) / 2;
+	if (m_numPending == numMeasurements)
+		return;
+	const uint idx = (m_oldestPending + m_numPending) % numMeasurements;
+	glQueryCounter(m_queries[idx * 2], GL_TIMESTAMP);
+	m_isMeasuring = true;
+}
+
+void GLTimerQuery::end()
+{
+	assert(m_initialized);
+	if (!m_isMeasuring)
+		return;
+	const uint numMeasurements = uint(m_queries.size()) / 2;
+	const uint idx = (m_oldestPending + m_numPending) % numMeasurements;
+	glQueryCounter(m_queries[idx * 2 + 1], GL_TIMESTAMP);
+	++m_numPending;
+	m_isMeasuring = false;
+}
+
+float GLTimerQuery::readLatestMs()
+{
+	assert(m_initialized);
+	// The GPU finishes the measurements in order, so the first one without a result ends the search
+	float latestMs = -1.0f;
+	const uint numMeasurements = uint(m_queries.size()) / 2;
+	while (m_numPending)
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(m_queries[m_oldestPending * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		GLuint64 beginNs = 0;
+		GLuint64 endNs = 0;
+		glGetQueryObjectui64v(m_queries[m_oldestPending * 2], GL_QUERY_RESULT, &beginNs);
+		glGetQueryObjectui64v(m_queries[m_oldestPending * 2 + 1], GL_QUERY_RESULT, &endNs);
+		latestMs = float(double(endNs - beginNs) / 1000000.0);
+		m_oldestPending = (m_oldestPending + 1) % numMeasurements;
+		--m_numPending;
+	}
+	return latestMs;
+}
@@ -1,6 +1,7 @@
 #include "Graphics/GL/Wrappers/GLVertexBuffer.h"
 
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/GL/Wrappers/GLStateBuffer.h"
 
 #include <assert.h>
@@ -8,7 +9,10 @@
 GLVertexBuffer::~GLVertexBuffer()
 {
 	if (m_initialized)
+	{
+		GLStateCache::onBufferDeleted(m_id);
 		glDeleteBuffers(1, &m_id);
+	}
 }
 
 GLVertexBuffer::GLVertexBuffer(const GLVertexBuffer& copy)
@@ -27,7 +31,10 @@ void GLVertexBuffer::initialize(const Config& a_config)
 void GLVertexBuffer::initialize(EBufferType a_bufferType, EDrawUsage a_drawUsage)
 {
 	if (m_initialized)
+	{
+		GLStateCache::onBufferDeleted(m_id);
 		glDeleteBuffers(1, &m_id);
+	}
 
 	glGenBuffers(1, &m_id);
 	m_bufferType = a_bufferType;
@@ -41,7 +48,7 @@ void GLVertexBuffer::upload(span<const byte> a_data)
 	assert(m_initialized);
 	if (!a_data.empty())
 	{
-		glBindBuffer(GLenum(m_bufferType), m_id);
+		GLStateCache::bindBuffer(GLenum(m_bufferType), m_id);
 		glBufferData(GLenum(m_bufferType), a_data.length_bytes(), a_data.data(), GLenum(m_drawUsage));
 	}
 }
@@ -50,7 +57,7 @@ void GLVertexBuffer::bind()
 {
 	assert(GLStateBuffer::isBegun());
 	assert(m_initialized);
-	glBindBuffer(GLenum(m_bufferType), m_id);
+	GLStateCache::bindBuffer(GLenum(m_bufferType), m_id);
 }
 
 void GLVertexBuffer::setVertexAttributes(span<const VertexAttribute> a_attributes)
@@ -79,7 +86,7 @@ void GLVertexBuffer::setVertexAttributes(span<const VertexAttribute> a_attribute
 		const bool isFloatType = (attribute.format == VertexAttribute::EFormat::FLOAT) || attribute.normalize;
 		const uint dataSize = ((attribute.format == VertexAttribute::EFormat::UNSIGNED_BYTE) ? 1 : 4) * attribute.numElements;
 
-		glBindBuffer(GLenum(m_bufferType), m_id);
+		GLStateCache::bindBuffer(GLenum(m_bufferType), m_id);
 
 		if (isFloatType)
 			glVertexAttribPointer(attribute.attributeIndex, attribute.numElements, GLenum(attribute.format), attribute.normalize, stride, rcast<GLvoid*>(offset));
@@ -87,6 +94,8 @@ void GLVertexBuffer::setVertexAttributes(span<const VertexAttribute> a_attribute
 			glVertexAttribIPointer(attribute.attributeIndex, attribute.numElements, GLenum(attribute.format), stride, rcast<GLvoid*>(offset));
 
 		glEnableVertexAttribArray(attribute.attributeIndex);
+		if (attribute.divisor)
+			glVertexAttribDivisor(attribute.attributeIndex, attribute.divisor);
 		offset += dataSize;
 	}
 }
\ No newline at end of file
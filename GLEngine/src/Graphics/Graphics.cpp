@@ -3,6 +3,7 @@
 #include "Graphics/EWindowMode.h"
 #include "Graphics/GL/GL.h"
 #include "Graphics/GL/GLContext.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/Utils/ARBDebugOutput.h"
 #include "Graphics/Utils/CheckGLError.h"
 #include "Graphics/GL/Scene/GLConfig.h"
@@ -79,6 +80,7 @@ void Graphics::createGLContext()
 	SDL_GL_DeleteContext(context);
 
 	m_context = new GLContext(m_hdc);
+	GLStateCache::invalidate();
 
 	for (GLenum glErr = glGetError(); glErr != GL_NO_ERROR; glErr = glGetError()) 
 	{
@@ -93,7 +95,6 @@ void Graphics::createGLContext()
 	{
 		int screenWidth, screenHeight;
 		SDL_GetWindowSize(m_window, &screenWidth, &screenHeight);
-		glViewport(0, 0, screenWidth, screenHeight);
 		setViewportSize(screenWidth, screenHeight);
 	}
 
@@ -125,6 +126,7 @@ void Graphics::clear(const glm::vec4& a_color, bool a_clearColor, bool a_clearDe
 
 void Graphics::swap()
 {
+	GLStateCache::endFrame();
 	SwapBuffers(scast<HDC>(m_hdc));
 }
 
@@ -136,53 +138,40 @@ void Graphics::setVsync(bool a_enabled)
 
 void Graphics::setDepthTest(bool a_enabled)
 {
-	if (a_enabled)
-		glEnable(GL_DEPTH_TEST);
-	else
-		glDisable(GL_DEPTH_TEST);
+	GLStateCache::setCapability(GL_DEPTH_TEST, a_enabled);
 }
 
 void Graphics::setDepthWrite(bool a_enabled)
 {
-	glDepthMask(a_enabled);
+	GLStateCache::setDepthMask(a_enabled);
 }
 
 void Graphics::setColorWrite(bool a_enabled)
 {
-	glColorMask(a_enabled, a_enabled, a_enabled, a_enabled);
+	GLStateCache::setColorMask(a_enabled);
 }
 
 void Graphics::setFaceCulling(EFaceCulling a_face)
 {
 	if (a_face != EFaceCulling::NONE)
 	{
-		glEnable(GL_CULL_FACE);
-		if (a_face == EFaceCulling::FRONT)
-			glCullFace(GL_FRONT);
-		else
-			glCullFace(GL_BACK);
+		GLStateCache::setCapability(GL_CULL_FACE, true);
+		GLStateCache::setCullFace(a_face == EFaceCulling::FRONT ? GL_FRONT : GL_BACK);
 	}
 	else
-		glDisable(GL_CULL_FACE);
+		GLStateCache::setCapability(GL_CULL_FACE, false);
 }
 
 void Graphics::setBlending(bool a_enabled)
 {
+	GLStateCache::setCapability(GL_BLEND, a_enabled);
 	if (a_enabled)
-	{
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	}
-	else
-		glDisable(GL_BLEND);
+		GLStateCache::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void Graphics::setMultisample(bool a_enabled)
 {
-	if (a_enabled)
-		glEnable(GL_MULTISAMPLE);
-	else
-		glDisable(GL_MULTISAMPLE);
+	GLStateCache::setCapability(GL_MULTISAMPLE, a_enabled);
 }
 
 void Graphics::setWindowTitle(const char* a_title)
@@ -194,14 +183,14 @@ void Graphics::setViewportPosition(uint a_viewportXPos, uint a_viewportYPos)
 {
 	m_viewportXPos = a_viewportXPos;
 	m_viewportYPos = a_viewportYPos;
-	glViewport(m_viewportXPos, m_viewportYPos, m_viewportWidth, m_viewportHeight);
+	GLStateCache::setViewport(m_viewportXPos, m_viewportYPos, m_viewportWidth, m_viewportHeight);
 }
 
 void Graphics::setViewportSize(uint a_viewportWidth, uint a_viewportHeight)
 {
 	m_viewportWidth = a_viewportWidth;
 	m_viewportHeight = a_viewportHeight;
-	glViewport(m_viewportXPos, m_viewportYPos, m_viewportWidth, m_viewportHeight);
+	GLStateCache::setViewport(m_viewportXPos, m_viewportYPos, m_viewportWidth, m_viewportHeight);
 }
 
 void Graphics::clearDepthOnly()
@@ -209,6 +198,14 @@ void Graphics::clearDepthOnly()
 	glClear(GL_DEPTH_BUFFER_BIT);
 }
 
+void Graphics::clearDepthOnly(int a_x, int a_y, uint a_width, uint a_height)
+{
+	GLStateCache::setCapability(GL_SCISSOR_TEST, true);
+	glScissor(a_x, a_y, a_width, a_height);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	GLStateCache::setCapability(GL_SCISSOR_TEST, false);
+}
+
 void Graphics::setDepthFunc(EDepthFunc a_depthFunc)
 {
 	GLenum func;
@@ -220,5 +217,5 @@ void Graphics::setDepthFunc(EDepthFunc a_depthFunc)
 	case EDepthFunc::GREATER: func = GL_GREATER; break;
 	default: assert(false);
 	}
-	glDepthFunc(func);
+	GLStateCache::setDepthFunc(func);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Graphics/UI/CEGUIManager.h"
 
 #include "Graphics/GL/GL.h"
+#include "Graphics/GL/GLStateCache.h"
 #include "Graphics/Utils/ARBDebugOutput.h"
 
 // #define NOMINMAX
@@ -231,21 +232,24 @@ void CEGUIManager::initialize()
 
 	initializeInput();
 
+	// Creating the renderer and loading the scheme textures binds GL objects behind the cache
+	GLStateCache::invalidate();
 	m_initialized = true;
 }
 
 void CEGUIManager::render(float a_deltaSec)
 {
-	glDisable(GL_DEPTH_TEST);
-	glDepthMask(false);
+	GLStateCache::setCapability(GL_DEPTH_TEST, false);
+	GLStateCache::setDepthMask(false);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glUseProgram(0);
+	GLStateCache::bindTexture(0, GL_TEXTURE_2D, 0);
+	GLStateCache::useProgram(0);
 
 	m_isFocused = (m_guiContext->getWindowContainingMouse() != m_rootWindow);
 	CEGUI::System::getSingleton().injectTimePulse(a_deltaSec);
 	CEGUI::System::getSingleton().renderAllGUIContexts();
+	// The CEGUI renderer changes and restores GL state without going through the cache
+	GLStateCache::invalidate();
 }
 
 void CEGUIManager::initializeInput()
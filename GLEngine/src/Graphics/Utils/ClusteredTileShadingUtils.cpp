@@ -121,16 +121,23 @@ IBounds3D ClusteredTiledShadingUtils::sphereToScreenSpaceBounds3D(
 	uint a_pixelsPerTileW, uint a_pixelsPerTileH, float a_recLogSD1)
 {
 	const IBounds2D bounds2D = sphereToScreenSpaceBounds2D(a_camera, a_lightPosViewSpace, a_lightRadius, a_screenWidth, a_screenHeight);
-	const float recNear = 1.0f / a_camera.getNear();
-
-	const int minZ = glm::max(int(calcClusterZ(a_lightPosViewSpace.z + a_lightRadius, recNear, a_recLogSD1)), 0);
-	const int maxZ = glm::max(int(ceilf(calcClusterZ(a_lightPosViewSpace.z - a_lightRadius, recNear, a_recLogSD1)) + 0.5f), 0);
+	const glm::ivec2 boundsZ = sphereToDepthSliceBounds(a_camera, a_lightPosViewSpace.z, a_lightRadius, a_recLogSD1);
 
 	const glm::ivec2 tileSizePx = glm::ivec2(a_pixelsPerTileW, a_pixelsPerTileH);
 
 	IBounds3D bounds3D;
-	bounds3D.min = glm::ivec3(bounds2D.min / tileSizePx, minZ);
-	bounds3D.max = glm::ivec3(bounds2D.max / tileSizePx + 1, maxZ);
+	bounds3D.min = glm::ivec3(bounds2D.min / tileSizePx, boundsZ.x);
+	bounds3D.max = glm::ivec3(bounds2D.max / tileSizePx + 1, boundsZ.y);
 
 	return bounds3D;
+}
+
+glm::ivec2 ClusteredTiledShadingUtils::sphereToDepthSliceBounds(const PerspectiveCamera& a_camera, float a_lightPosViewSpaceZ, float a_lightRadius, float a_recLogSD1)
+{
+	const float recNear = 1.0f / a_camera.getNear();
+
+	const int minZ = glm::max(int(calcClusterZ(a_lightPosViewSpaceZ + a_lightRadius, recNear, a_recLogSD1)), 0);
+	const int maxZ = glm::max(int(ceilf(calcClusterZ(a_lightPosViewSpaceZ - a_lightRadius, recNear, a_recLogSD1)) + 0.5f), 0);
+
+	return glm::ivec2(minZ, maxZ);
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "Graphics/Utils/DrawCommandBuffer.h"
+
+#include <assert.h>
+
+void DrawCommandBuffer::clear()
+{
+	m_commands.clear();
+	m_queue.clear();
+	m_transforms.clear();
+	m_buckets.clear();
+	m_finished = false;
+}
+
+uint DrawCommandBuffer::addTransform(const glm::mat4& a_modelMatrix, const glm::mat4& a_normalMatrix)
+{
+	assert(!m_finished);
+	const DrawTransform transform = { a_modelMatrix, a_normalMatrix };
+	m_transforms.push_back(transform);
+	return uint(m_transforms.size()) - 1;
+}
+
+void DrawCommandBuffer::addDraw(uint64 a_sortKey, uint a_numIndices, uint a_firstIndex, int a_baseVertex, uint a_transformIdx)
+{
+	assert(!m_finished);
+	assert(a_transformIdx < m_transforms.size());
+	const DrawCommand command = { a_numIndices, 1, a_firstIndex, a_baseVertex, a_transformIdx };
+	m_queue.add(a_sortKey, uint(m_commands.size()));
+	m_commands.push_back(command);
+}
+
+void DrawCommandBuffer::finish()
+{
+	assert(!m_finished);
+	m_finished = true;
+
+	m_queue.sort();
+	const eastl::vector<RenderQueue::Item>& items = m_queue.getItems();
+	m_sortedCommands.resize(m_commands.size());
+	for (uint i = 0; i < items.size(); ++i)
+	{
+		m_sortedCommands[i] = m_commands[items[i].index];
+		const uint64 bucketKey = RenderQueue::getBucketKey(items[i].key);
+		if (m_buckets.empty() || m_buckets.back().key != bucketKey)
+		{
+			const Bucket bucket = { bucketKey, i, 0 };
+			m_buckets.push_back(bucket);
+		}
+		m_buckets.back().numCommands++;
+	}
+	m_commands.swap(m_sortedCommands);
+}
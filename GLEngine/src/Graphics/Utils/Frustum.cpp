@@ -1,10 +1,116 @@
 #include "Graphics/Utils/Frustum.h"
 
+#include "Graphics/Utils/AABBList.h"
 #include "Graphics/Utils/PerspectiveCamera.h"
 #include "Graphics/Utils/Plane.h"
+#include "Utils/ParallelUtils.h"
+#include "EASTL/algorithm.h"
 
 #include <glm/gtx/fast_square_root.hpp>
 
+// x64 always has SSE2, AVX is only used when the compiler is allowed to (/arch:AVX)
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_SIMD_WIDTH 4
+#endif
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint BOXES_PER_WORD = 32;
+const uint MIN_WORDS_PER_RANGE = 512; // 16k boxes, starting threads for less takes longer than culling them
+
+#if FRUSTUM_SIMD_WIDTH == 8
+typedef __m256 SimdFloat;
+inline SimdFloat simdLoad(const float* a_values)           { return _mm256_loadu_ps(a_values); }
+inline SimdFloat simdSet(float a_value)                    { return _mm256_set1_ps(a_value); }
+inline SimdFloat simdAdd(SimdFloat a_a, SimdFloat a_b)     { return _mm256_add_ps(a_a, a_b); }
+inline SimdFloat simdMul(SimdFloat a_a, SimdFloat a_b)     { return _mm256_mul_ps(a_a, a_b); }
+inline SimdFloat simdAnd(SimdFloat a_a, SimdFloat a_b)     { return _mm256_and_ps(a_a, a_b); }
+inline SimdFloat simdOr(SimdFloat a_a, SimdFloat a_b)      { return _mm256_or_ps(a_a, a_b); }
+inline SimdFloat simdXor(SimdFloat a_a, SimdFloat a_b)     { return _mm256_xor_ps(a_a, a_b); }
+inline SimdFloat simdLess(SimdFloat a_a, SimdFloat a_b)    { return _mm256_cmp_ps(a_a, a_b, _CMP_LT_OQ); }
+inline SimdFloat simdBits(int a_bits)                      { return _mm256_castsi256_ps(_mm256_set1_epi32(a_bits)); }
+inline uint simdMoveMask(SimdFloat a_a)                    { return uint(_mm256_movemask_ps(a_a)); }
+#elif FRUSTUM_SIMD_WIDTH == 4
+typedef __m128 SimdFloat;
+inline SimdFloat simdLoad(const float* a_values)           { return _mm_loadu_ps(a_values); }
+inline SimdFloat simdSet(float a_value)                    { return _mm_set1_ps(a_value); }
+inline SimdFloat simdAdd(SimdFloat a_a, SimdFloat a_b)     { return _mm_add_ps(a_a, a_b); }
+inline SimdFloat simdMul(SimdFloat a_a, SimdFloat a_b)     { return _mm_mul_ps(a_a, a_b); }
+inline SimdFloat simdAnd(SimdFloat a_a, SimdFloat a_b)     { return _mm_and_ps(a_a, a_b); }
+inline SimdFloat simdOr(SimdFloat a_a, SimdFloat a_b)      { return _mm_or_ps(a_a, a_b); }
+inline SimdFloat simdXor(SimdFloat a_a, SimdFloat a_b)     { return _mm_xor_ps(a_a, a_b); }
+inline SimdFloat simdLess(SimdFloat a_a, SimdFloat a_b)    { return _mm_cmplt_ps(a_a, a_b); }
+inline SimdFloat simdBits(int a_bits)                      { return _mm_castsi128_ps(_mm_set1_epi32(a_bits)); }
+inline uint simdMoveMask(SimdFloat a_a)                    { return uint(_mm_movemask_ps(a_a)); }
+#endif
+
+/** Begin has to be the first box of a word, every word is cleared when its first box is reached */
+void cullRangeScalar(const Frustum& a_frustum, const AABBList& a_boxes, uint a_begin, uint a_end, uint* a_mask)
+{
+	for (uint i = a_begin; i < a_end; ++i)
+	{
+		if (i % BOXES_PER_WORD == 0)
+			a_mask[i / BOXES_PER_WORD] = 0;
+		if (a_frustum.aabbInFrustum(a_boxes.getCenter(i), a_boxes.getHalfSize(i)))
+			a_mask[i / BOXES_PER_WORD] |= 1u << (i % BOXES_PER_WORD);
+	}
+}
+
+void cullRange(const Frustum& a_frustum, const AABBList& a_boxes, uint a_begin, uint a_end, uint* a_mask)
+{
+#ifdef FRUSTUM_SIMD_WIDTH
+	SimdFloat normals[6][3];
+	SimdFloat distances[6];
+	for (uint plane = 0; plane < 6; ++plane)
+	{
+		for (uint axis = 0; axis < 3; ++axis)
+			normals[plane][axis] = simdSet(a_frustum.m_planes[plane].normal[axis]);
+		distances[plane] = simdSet(a_frustum.m_planes[plane].d);
+	}
+	const SimdFloat absMask = simdBits(0x7FFFFFFF);
+	const SimdFloat signMask = simdBits(int(0x80000000));
+	const float* centers[3] = { a_boxes.getCenters(0), a_boxes.getCenters(1), a_boxes.getCenters(2) };
+	const float* halfSizes[3] = { a_boxes.getHalfSizes(0), a_boxes.getHalfSizes(1), a_boxes.getHalfSizes(2) };
+
+	// Groups of FRUSTUM_SIMD_WIDTH never straddle a word since the range starts at a word, the scalar tail continues where they stop
+	const uint simdEnd = a_begin + (a_end - a_begin) / FRUSTUM_SIMD_WIDTH * FRUSTUM_SIMD_WIDTH;
+	for (uint i = a_begin; i < simdEnd; i += FRUSTUM_SIMD_WIDTH)
+	{
+		const SimdFloat centerX = simdLoad(centers[0] + i);
+		const SimdFloat centerY = simdLoad(centers[1] + i);
+		const SimdFloat centerZ = simdLoad(centers[2] + i);
+		const SimdFloat halfSizeX = simdLoad(halfSizes[0] + i);
+		const SimdFloat halfSizeY = simdLoad(halfSizes[1] + i);
+		const SimdFloat halfSizeZ = simdLoad(halfSizes[2] + i);
+		SimdFloat outside = simdSet(0.0f);
+		for (uint plane = 0; plane < 6; ++plane)
+		{	// Same operations in the same order as Plane::getSide, so the results match aabbInFrustum exactly
+			const SimdFloat* normal = normals[plane];
+			const SimdFloat dot = simdAdd(simdAdd(simdMul(normal[0], centerX), simdMul(normal[1], centerY)), simdMul(normal[2], centerZ));
+			const SimdFloat dist = simdAdd(dot, distances[plane]);
+			const SimdFloat maxAbsDist = simdAdd(simdAdd(
+				simdAnd(simdMul(normal[0], halfSizeX), absMask),
+				simdAnd(simdMul(normal[1], halfSizeY), absMask)),
+				simdAnd(simdMul(normal[2], halfSizeZ), absMask));
+			outside = simdOr(outside, simdLess(dist, simdXor(maxAbsDist, signMask)));
+		}
+		const uint visible = ~simdMoveMask(outside) & ((1u << FRUSTUM_SIMD_WIDTH) - 1);
+		if (i % BOXES_PER_WORD == 0)
+			a_mask[i / BOXES_PER_WORD] = 0;
+		a_mask[i / BOXES_PER_WORD] |= visible << (i % BOXES_PER_WORD);
+	}
+	cullRangeScalar(a_frustum, a_boxes, simdEnd, a_end, a_mask);
+#else
+	cullRangeScalar(a_frustum, a_boxes, a_begin, a_end, a_mask);
+#endif
+}
+
+END_UNNAMED_NAMESPACE()
+
 void Frustum::calculateFrustum(const glm::mat4& a_vpMatrix)
 {
 	glm::mat4 mat = glm::transpose(a_vpMatrix);
@@ -69,4 +175,28 @@ bool Frustum::aabbInFrustum(const glm::vec3& a_center, const glm::vec3& a_halfSi
 		if (m_planes[plane].getSide(a_center, a_halfSize) == Plane::NEGATIVE)
 			return false;
 	return true;
-}
\ No newline at end of file
+}
+
+void Frustum::aabbsInFrustum(const AABBList& a_boxes, eastl::vector<uint>& a_visibilityMask, bool a_multithreaded) const
+{
+	const uint numBoxes = a_boxes.getNumBoxes();
+	const uint numWords = (numBoxes + BOXES_PER_WORD - 1) / BOXES_PER_WORD;
+	a_visibilityMask.resize(numWords);
+	uint* mask = a_visibilityMask.data();
+	// Ranges are split on words so no two threads write the same word
+	auto cullWords = [&](uint a_beginWord, uint a_endWord, uint)
+	{
+		cullRange(*this, a_boxes, a_beginWord * BOXES_PER_WORD, eastl::min(a_endWord * BOXES_PER_WORD, numBoxes), mask);
+	};
+	if (a_multithreaded)
+		ParallelUtils::forRanges(numWords, cullWords, MIN_WORDS_PER_RANGE);
+	else if (numWords)
+		cullWords(0, numWords, 0);
+}
+
+void Frustum::aabbsInFrustumScalar(const AABBList& a_boxes, eastl::vector<uint>& a_visibilityMask) const
+{
+	const uint numBoxes = a_boxes.getNumBoxes();
+	a_visibilityMask.resize((numBoxes + BOXES_PER_WORD - 1) / BOXES_PER_WORD);
+	cullRangeScalar(*this, a_boxes, 0, numBoxes, a_visibilityMask.data());
+}
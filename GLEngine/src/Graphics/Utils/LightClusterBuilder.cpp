@@ -0,0 +1,551 @@
+#include "Graphics/Utils/LightClusterBuilder.h"
+
+#include "Graphics/Utils/ClusteredTiledShadingUtils.h"
+#include "Graphics/Utils/PerspectiveCamera.h"
+#include "Utils/ParallelUtils.h"
+
+#include <assert.h>
+#include <string.h>
+
+// x64 always has SSE2, the screen bounds of the lights are computed 4 at a time
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIGHT_CLUSTER_SSE
+#endif
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint MIN_LIGHTS_PER_RANGE = 256;
+const uint MIN_CLUSTERS_PER_CHUNK = 4096;
+const float MAX_UPDATED_LIGHT_FRACTION = 0.25f; // When more of the lights changed, update builds everything again
+const glm::vec4 POINT_LIGHT_DIRECTION_ANGLE(0.0f, 0.0f, -1.0f, -1.0f);
+const float COS_45_DEGREES = 0.70710678f;
+
+inline const glm::vec4& getDirectionAngle(const glm::vec4* a_lightDirectionAngles, uint a_lightIdx)
+{
+	return a_lightDirectionAngles ? a_lightDirectionAngles[a_lightIdx] : POINT_LIGHT_DIRECTION_ANGLE;
+}
+
+#ifdef LIGHT_CLUSTER_SSE
+
+inline __m128 select(__m128 a_mask, __m128 a_true, __m128 a_false)
+{
+	return _mm_or_ps(_mm_and_ps(a_mask, a_true), _mm_andnot_ps(a_mask, a_false));
+}
+
+/** updateClipRegionRoot of ClusteredTiledShadingUtils for 4 lights, with the same operations in the same order so the results are identical */
+inline void updateClipRegionRoot4(__m128 a_nc, __m128 a_lc, __m128 a_lz, __m128 a_lightRadius, __m128 a_cameraScale, __m128 a_hasRoots, __m128& a_clipMin, __m128& a_clipMax)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 nz = _mm_div_ps(_mm_sub_ps(a_lightRadius, _mm_mul_ps(a_nc, a_lc)), a_lz);
+	const __m128 pz = _mm_div_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(a_lc, a_lc), _mm_mul_ps(a_lz, a_lz)), _mm_mul_ps(a_lightRadius, a_lightRadius)),
+		_mm_sub_ps(a_lz, _mm_mul_ps(_mm_div_ps(nz, a_nc), a_lc)));
+	const __m128 c = _mm_div_ps(_mm_mul_ps(_mm_sub_ps(zero, nz), a_cameraScale), a_nc);
+
+	const __m128 update = _mm_and_ps(a_hasRoots, _mm_cmplt_ps(pz, zero));
+	const __m128 isNegative = _mm_cmplt_ps(a_nc, zero);
+	a_clipMin = select(_mm_and_ps(update, isNegative), _mm_max_ps(c, a_clipMin), a_clipMin);
+	a_clipMax = select(_mm_andnot_ps(isNegative, update), _mm_min_ps(c, a_clipMax), a_clipMax);
+}
+
+inline void updateClipRegion4(__m128 a_lc, __m128 a_lz, __m128 a_lightRadius, __m128 a_cameraScale, __m128& a_clipMin, __m128& a_clipMax)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 rSq = _mm_mul_ps(a_lightRadius, a_lightRadius);
+	const __m128 lcSqPluslzSq = _mm_add_ps(_mm_mul_ps(a_lc, a_lc), _mm_mul_ps(a_lz, a_lz));
+	const __m128 d = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(rSq, a_lc), a_lc), _mm_mul_ps(lcSqPluslzSq, _mm_sub_ps(rSq, _mm_mul_ps(a_lz, a_lz))));
+	const __m128 hasRoots = _mm_cmpge_ps(d, zero);
+
+	const __m128 a = _mm_mul_ps(a_lightRadius, a_lc);
+	const __m128 b = _mm_sqrt_ps(_mm_max_ps(d, zero));
+	updateClipRegionRoot4(_mm_div_ps(_mm_add_ps(a, b), lcSqPluslzSq), a_lc, a_lz, a_lightRadius, a_cameraScale, hasRoots, a_clipMin, a_clipMax);
+	updateClipRegionRoot4(_mm_div_ps(_mm_sub_ps(a, b), lcSqPluslzSq), a_lc, a_lz, a_lightRadius, a_cameraScale, hasRoots, a_clipMin, a_clipMax);
+}
+
+/** ClusteredTiledShadingUtils::sphereToScreenSpaceBounds2D for 4 view space lights, writes the min x, min y, max x and max y pixels of every light */
+void sphereToScreenSpaceBounds4(const glm::vec4* a_lights, float a_near, const glm::mat4& a_projection, uint a_screenWidth, uint a_screenHeight, glm::ivec4* a_bounds)
+{
+	__m128 x = _mm_loadu_ps(&a_lights[0].x);
+	__m128 y = _mm_loadu_ps(&a_lights[1].x);
+	__m128 z = _mm_loadu_ps(&a_lights[2].x);
+	__m128 radius = _mm_loadu_ps(&a_lights[3].x);
+	_MM_TRANSPOSE4_PS(x, y, z, radius);
+
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	__m128 clipMinX = minusOne;
+	__m128 clipMinY = minusOne;
+	__m128 clipMaxX = one;
+	__m128 clipMaxY = one;
+	updateClipRegion4(x, z, radius, _mm_set1_ps(a_projection[0][0]), clipMinX, clipMaxX);
+	updateClipRegion4(y, z, radius, _mm_set1_ps(a_projection[1][1]), clipMinY, clipMaxY);
+
+	// Lights behind the near plane get an empty region
+	const __m128 inFront = _mm_cmple_ps(_mm_sub_ps(z, radius), _mm_set1_ps(-a_near));
+	clipMinX = select(inFront, clipMinX, one);
+	clipMinY = select(inFront, clipMinY, one);
+	clipMaxX = select(inFront, clipMaxX, minusOne);
+	clipMaxY = select(inFront, clipMaxY, minusOne);
+
+	// Negated and swapped to screen space, from -1 to 1 to pixels
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 width = _mm_set1_ps(float(a_screenWidth));
+	const __m128 height = _mm_set1_ps(float(a_screenHeight));
+	auto toPixels = [&](__m128 a_clip, __m128 a_size)
+	{
+		const __m128 screen = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(zero, a_clip), half), half);
+		return _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(screen, zero), one), a_size));
+	};
+	__m128 minX = _mm_castsi128_ps(toPixels(clipMaxX, width));
+	__m128 minY = _mm_castsi128_ps(toPixels(clipMaxY, height));
+	__m128 maxX = _mm_castsi128_ps(toPixels(clipMinX, width));
+	__m128 maxY = _mm_castsi128_ps(toPixels(clipMinY, height));
+	_MM_TRANSPOSE4_PS(minX, minY, maxX, maxY);
+	_mm_storeu_si128(rcast<__m128i*>(&a_bounds[0]), _mm_castps_si128(minX));
+	_mm_storeu_si128(rcast<__m128i*>(&a_bounds[1]), _mm_castps_si128(minY));
+	_mm_storeu_si128(rcast<__m128i*>(&a_bounds[2]), _mm_castps_si128(maxX));
+	_mm_storeu_si128(rcast<__m128i*>(&a_bounds[3]), _mm_castps_si128(maxY));
+}
+
+#endif // LIGHT_CLUSTER_SSE
+
+END_UNNAMED_NAMESPACE()
+
+void LightClusterBuilder::initialize(const PerspectiveCamera& a_camera, uint a_screenWidth, uint a_screenHeight, uint a_tileWidth, uint a_tileHeight)
+{
+	m_screenWidth  = a_screenWidth;
+	m_screenHeight = a_screenHeight;
+	m_tileWidth    = a_tileWidth;
+	m_tileHeight   = a_tileHeight;
+	m_gridWidth    = a_screenWidth / a_tileWidth + 1;
+	m_gridHeight   = a_screenHeight / a_tileHeight + 1;
+	m_recNear      = 1.0f / a_camera.getNear();
+
+	const uint grid2dDimY = (a_screenHeight + a_tileHeight - 1) / a_tileHeight;
+	const float sD        = 2.0f * glm::tan(glm::radians(a_camera.getVFov()) * 0.5f) / float(grid2dDimY);
+	m_recLogSD1           = 1.0f / logf(sD + 1.0f);
+
+	const float zGridLocFar = logf(a_camera.getFar() / a_camera.getNear()) / logf(1.0f + sD);
+	m_gridDepth             = uint(ceilf(zGridLocFar) + 0.5f);
+
+	// The inverse of the depth slice of the shaders, log(depth / near) / log(1 + sD)
+	m_sliceDepths.resize(m_gridDepth + 1);
+	for (uint z = 0; z <= m_gridDepth; ++z)
+		m_sliceDepths[z] = a_camera.getNear() * expf(float(z) / m_recLogSD1);
+
+	m_clusterRanges.clear();
+	m_clusterRanges.resize(getGridSize(), glm::uvec2(0));
+	m_lightIndices.clear();
+	m_canUpdate = false;
+}
+
+template <typename Func>
+void LightClusterBuilder::forEachCluster(uint a_lightIdx, const Func& a_func) const
+{
+	const ClusterBounds& bounds = m_lightBounds[a_lightIdx];
+	const glm::vec4& light = m_lightPositionRangesViewSpace[a_lightIdx];
+	const glm::vec4& directionAngle = m_lightDirectionAnglesViewSpace[a_lightIdx];
+	const glm::vec4& boundingSphere = m_lightBoundingSpheres[a_lightIdx];
+	const bool testCone = directionAngle.w > 0.0f;
+	for (int x = bounds.min.x; x < bounds.max.x; ++x)
+		for (int y = bounds.min.y; y < bounds.max.y; ++y)
+			for (int z = bounds.min.z; z < bounds.max.z; ++z)
+				if (!m_refinementEnabled || (sphereIntersectsCluster(boundingSphere, x, y, z) && (!testCone || coneIntersectsCluster(light, directionAngle, x, y, z))))
+					a_func(getClusterIdx(x, y, z));
+}
+
+void LightClusterBuilder::build(const PerspectiveCamera& a_camera, const glm::vec4* a_lightPositionRanges, const glm::vec4* a_lightDirectionAngles, uint a_numLights,
+	bool a_multithreaded)
+{
+	assert(m_gridDepth);
+	m_viewMatrix = a_camera.getViewMatrix();
+	m_projectionMatrix = a_camera.getProjectionMatrix();
+	m_lightPositionRanges.assign(a_lightPositionRanges, a_lightPositionRanges + a_numLights);
+	if (a_lightDirectionAngles)
+		m_lightDirectionAngles.assign(a_lightDirectionAngles, a_lightDirectionAngles + a_numLights);
+	else
+		m_lightDirectionAngles.assign(a_numLights, POINT_LIGHT_DIRECTION_ANGLE);
+	m_canUpdate = true;
+
+	const uint gridSize = getGridSize();
+	if (!a_numLights)
+	{
+		m_clusterRanges.assign(gridSize, glm::uvec2(0));
+		m_lightIndices.clear();
+		return;
+	}
+	const uint numRanges = a_multithreaded ? ParallelUtils::getNumRanges(a_numLights, MIN_LIGHTS_PER_RANGE) : 1;
+	auto forLightRanges = [&](const auto& a_func)
+	{
+		if (a_multithreaded)
+			ParallelUtils::forRanges(a_numLights, a_func, MIN_LIGHTS_PER_RANGE);
+		else
+			a_func(0u, a_numLights, 0u);
+	};
+
+	m_lightPositionRangesViewSpace.resize(a_numLights);
+	m_lightDirectionAnglesViewSpace.resize(a_numLights);
+	m_lightBoundingSpheres.resize(a_numLights);
+	m_lightBounds.resize(a_numLights);
+	m_rangeCounts.resize(numRanges * gridSize);
+	calculateTileSlopes(a_camera);
+
+	// Every range of lights computes their bounds and counts them per cluster
+	const glm::mat4& viewMatrix = a_camera.getViewMatrix();
+	forLightRanges([&](uint a_begin, uint a_end, uint a_rangeIdx)
+	{
+		for (uint i = a_begin; i < a_end; ++i)
+			transformLight(viewMatrix, a_lightPositionRanges, a_lightDirectionAngles, i);
+		calculateBounds(a_camera, a_begin, a_end);
+
+		uint* counts = &m_rangeCounts[a_rangeIdx * gridSize];
+		memset(counts, 0, gridSize * sizeof(uint));
+		for (uint i = a_begin; i < a_end; ++i)
+			forEachCluster(i, [counts](uint a_clusterIdx) { counts[a_clusterIdx]++; });
+	});
+
+	// The lights of a cluster start after all clusters before it and within a cluster the lights of a range after the ranges before it,
+	// so every range writes its lights to its own part and the lights stay in increasing order. Chunks of clusters are summed in parallel first
+	const uint numChunks = a_multithreaded ? ParallelUtils::getNumRanges(gridSize, MIN_CLUSTERS_PER_CHUNK) : 1;
+	auto forClusterChunks = [&](const auto& a_func)
+	{
+		if (a_multithreaded)
+			ParallelUtils::forRanges(gridSize, a_func, MIN_CLUSTERS_PER_CHUNK);
+		else
+			a_func(0u, gridSize, 0u);
+	};
+	m_chunkOffsets.resize(numChunks + 1);
+	forClusterChunks([&](uint a_begin, uint a_end, uint a_chunkIdx)
+	{
+		uint numIndices = 0;
+		for (uint range = 0; range < numRanges; ++range)
+		{
+			const uint* counts = &m_rangeCounts[range * gridSize];
+			for (uint cluster = a_begin; cluster < a_end; ++cluster)
+				numIndices += counts[cluster];
+		}
+		m_chunkOffsets[a_chunkIdx + 1] = numIndices;
+	});
+	m_chunkOffsets[0] = 0;
+	for (uint i = 0; i < numChunks; ++i)
+		m_chunkOffsets[i + 1] += m_chunkOffsets[i];
+	forClusterChunks([&](uint a_begin, uint a_end, uint a_chunkIdx)
+	{
+		uint offset = m_chunkOffsets[a_chunkIdx];
+		for (uint cluster = a_begin; cluster < a_end; ++cluster)
+		{
+			m_clusterRanges[cluster].x = offset;
+			for (uint range = 0; range < numRanges; ++range)
+			{
+				uint& count = m_rangeCounts[range * gridSize + cluster];
+				const uint rangeCount = count;
+				count = offset;
+				offset += rangeCount;
+			}
+			m_clusterRanges[cluster].y = offset;
+		}
+	});
+
+	// Every range of lights fills its part of the clusters
+	m_lightIndices.resize(m_chunkOffsets[numChunks]);
+	forLightRanges([&](uint a_begin, uint a_end, uint a_rangeIdx)
+	{
+		uint* offsets = &m_rangeCounts[a_rangeIdx * gridSize];
+		uint* lightIndices = m_lightIndices.data();
+		for (uint i = a_begin; i < a_end; ++i)
+			forEachCluster(i, [offsets, lightIndices, i](uint a_clusterIdx) { lightIndices[offsets[a_clusterIdx]++] = i; });
+	});
+}
+
+bool LightClusterBuilder::update(const PerspectiveCamera& a_camera, const glm::vec4* a_lightPositionRanges, const glm::vec4* a_lightDirectionAngles, uint a_numLights,
+	bool a_multithreaded)
+{
+	// The clusters are in view space, when the camera moves every light moves relative to them
+	if (!m_canUpdate || a_camera.getViewMatrix() != m_viewMatrix || a_camera.getProjectionMatrix() != m_projectionMatrix)
+	{
+		build(a_camera, a_lightPositionRanges, a_lightDirectionAngles, a_numLights, a_multithreaded);
+		m_numUpdatedLights = a_numLights;
+		return true;
+	}
+
+	// Lights past the end of the shorter list were added or removed
+	const uint numOldLights = uint(m_lightPositionRanges.size());
+	const uint numCommonLights = glm::min(numOldLights, a_numLights);
+	const uint numAllLights = glm::max(numOldLights, a_numLights);
+	m_changedLights.clear();
+	for (uint i = 0; i < numCommonLights; ++i)
+		if (a_lightPositionRanges[i] != m_lightPositionRanges[i] || getDirectionAngle(a_lightDirectionAngles, i) != m_lightDirectionAngles[i])
+			m_changedLights.push_back(i);
+	for (uint i = numCommonLights; i < numAllLights; ++i)
+		m_changedLights.push_back(i);
+	const uint numChanged = uint(m_changedLights.size());
+	m_numUpdatedLights = numChanged;
+	if (!numChanged)
+		return false;
+	if (float(numChanged) > float(numAllLights) * MAX_UPDATED_LIGHT_FRACTION)
+	{
+		build(a_camera, a_lightPositionRanges, a_lightDirectionAngles, a_numLights, a_multithreaded);
+		m_numUpdatedLights = a_numLights;
+		return true;
+	}
+
+	// Count the changed lights leaving every cluster with their old bounds, then bin them again
+	const uint gridSize = getGridSize();
+	m_removedCounts.assign(gridSize, 0);
+	m_lightChanged.assign(numAllLights, 0);
+	for (uint i : m_changedLights)
+	{
+		m_lightChanged[i] = 1;
+		if (i < numOldLights)
+			forEachCluster(i, [this](uint a_clusterIdx) { m_removedCounts[a_clusterIdx]++; });
+	}
+
+	const glm::mat4& viewMatrix = a_camera.getViewMatrix();
+	m_lightPositionRanges.resize(a_numLights);
+	m_lightDirectionAngles.resize(a_numLights);
+	m_lightPositionRangesViewSpace.resize(a_numLights);
+	m_lightDirectionAnglesViewSpace.resize(a_numLights);
+	m_lightBoundingSpheres.resize(a_numLights);
+	m_lightBounds.resize(a_numLights);
+	m_addedOffsets.assign(gridSize + 1, 0);
+	for (uint i : m_changedLights)
+	{
+		if (i >= a_numLights)
+			break;
+		m_lightPositionRanges[i] = a_lightPositionRanges[i];
+		m_lightDirectionAngles[i] = getDirectionAngle(a_lightDirectionAngles, i);
+		transformLight(viewMatrix, a_lightPositionRanges, a_lightDirectionAngles, i);
+		calculateBounds(a_camera, i, i + 1);
+		forEachCluster(i, [this](uint a_clusterIdx) { m_addedOffsets[a_clusterIdx]++; });
+	}
+
+	// Summed to the end of every cluster, filled from the back in decreasing light order so they end at the begin in increasing order
+	for (uint cluster = 1; cluster <= gridSize; ++cluster)
+		m_addedOffsets[cluster] += m_addedOffsets[cluster - 1];
+	m_addedIndices.resize(m_addedOffsets[gridSize]);
+	for (uint i = numChanged; i-- > 0;)
+	{
+		const uint lightIdx = m_changedLights[i];
+		if (lightIdx < a_numLights)
+			forEachCluster(lightIdx, [this, lightIdx](uint a_clusterIdx) { m_addedIndices[--m_addedOffsets[a_clusterIdx]] = lightIdx; });
+	}
+
+	// Runs of clusters no changed light enters or leaves are copied at once, the others merge the lights that stayed with the ones entering
+	uint numRemoved = 0;
+	for (uint count : m_removedCounts)
+		numRemoved += count;
+	m_updatedLightIndices.resize(uint(m_lightIndices.size()) - numRemoved + uint(m_addedIndices.size()));
+	const uint* oldIndices = m_lightIndices.data();
+	const uint* addedIndices = m_addedIndices.data();
+	uint* newIndices = m_updatedLightIndices.data();
+	uint offset = 0;
+	uint runBegin = 0;    // In the new list, of the clusters not copied yet
+	uint runOldBegin = 0;
+	for (uint cluster = 0; cluster < gridSize; ++cluster)
+	{
+		glm::uvec2& range = m_clusterRanges[cluster];
+		const uint* added = addedIndices + m_addedOffsets[cluster];
+		const uint* addedEnd = addedIndices + m_addedOffsets[cluster + 1];
+		const uint begin = offset;
+		if (!m_removedCounts[cluster] && added == addedEnd)
+		{
+			offset += range.y - range.x;
+		}
+		else
+		{
+			memcpy(newIndices + runBegin, oldIndices + runOldBegin, (offset - runBegin) * sizeof(uint));
+			for (uint j = range.x; j < range.y; ++j)
+			{
+				const uint lightIdx = oldIndices[j];
+				if (m_lightChanged[lightIdx])
+					continue;
+				while (added != addedEnd && *added < lightIdx)
+					newIndices[offset++] = *added++;
+				newIndices[offset++] = lightIdx;
+			}
+			while (added != addedEnd)
+				newIndices[offset++] = *added++;
+			runBegin = offset;
+			runOldBegin = range.y;
+		}
+		range = glm::uvec2(begin, offset);
+	}
+	memcpy(newIndices + runBegin, oldIndices + runOldBegin, (offset - runBegin) * sizeof(uint));
+	assert(offset == m_updatedLightIndices.size());
+	m_lightIndices.swap(m_updatedLightIndices);
+	return true;
+}
+
+void LightClusterBuilder::buildReference(const PerspectiveCamera& a_camera, const glm::vec4* a_lightPositionRanges, const glm::vec4* a_lightDirectionAngles, uint a_numLights)
+{
+	assert(m_gridDepth);
+	m_canUpdate = false;
+	const glm::ivec3 gridMax(m_gridWidth, m_gridHeight, m_gridDepth);
+	const glm::mat4& viewMatrix = a_camera.getViewMatrix();
+	calculateTileSlopes(a_camera);
+	m_lightPositionRangesViewSpace.resize(a_numLights);
+	m_lightDirectionAnglesViewSpace.resize(a_numLights);
+	m_lightBoundingSpheres.resize(a_numLights);
+	eastl::vector<IBounds3D> lightBounds(a_numLights);
+	for (uint i = 0; i < a_numLights; ++i)
+	{
+		transformLight(viewMatrix, a_lightPositionRanges, a_lightDirectionAngles, i);
+		const glm::vec4& sphere = m_lightBoundingSpheres[i];
+		lightBounds[i] = ClusteredTiledShadingUtils::sphereToScreenSpaceBounds3D(a_camera, glm::vec3(sphere), sphere.w,
+			m_screenWidth, m_screenHeight, m_tileWidth, m_tileHeight, m_recLogSD1);
+		lightBounds[i].clamp(glm::ivec3(0), gridMax);
+	}
+
+	m_lightIndices.clear();
+	for (int x = 0; x < gridMax.x; ++x)
+	{
+		for (int y = 0; y < gridMax.y; ++y)
+		{
+			for (int z = 0; z < gridMax.z; ++z)
+			{
+				const glm::ivec3 cluster(x, y, z);
+				glm::uvec2& range = m_clusterRanges[getClusterIdx(x, y, z)];
+				range.x = uint(m_lightIndices.size());
+				for (uint i = 0; i < a_numLights; ++i)
+					if (glm::all(glm::greaterThanEqual(cluster, lightBounds[i].min)) && glm::all(glm::lessThan(cluster, lightBounds[i].max))
+						&& (!m_refinementEnabled || (sphereIntersectsCluster(m_lightBoundingSpheres[i], x, y, z)
+							&& (m_lightDirectionAnglesViewSpace[i].w <= 0.0f || coneIntersectsCluster(m_lightPositionRangesViewSpace[i], m_lightDirectionAnglesViewSpace[i], x, y, z)))))
+						m_lightIndices.push_back(i);
+				range.y = uint(m_lightIndices.size());
+			}
+		}
+	}
+}
+
+void LightClusterBuilder::transformLight(const glm::mat4& a_viewMatrix, const glm::vec4* a_lightPositionRanges, const glm::vec4* a_lightDirectionAngles, uint a_lightIdx)
+{
+	glm::vec4 light = a_viewMatrix * glm::vec4(glm::vec3(a_lightPositionRanges[a_lightIdx]), 1.0);
+	light.w = a_lightPositionRanges[a_lightIdx].w;
+	m_lightPositionRangesViewSpace[a_lightIdx] = light;
+
+	const glm::vec4& directionAngle = getDirectionAngle(a_lightDirectionAngles, a_lightIdx);
+	if (directionAngle.w <= -1.0f)
+	{
+		m_lightDirectionAnglesViewSpace[a_lightIdx] = POINT_LIGHT_DIRECTION_ANGLE;
+		m_lightBoundingSpheres[a_lightIdx] = light;
+		return;
+	}
+	const glm::vec3 direction = glm::normalize(glm::mat3(a_viewMatrix) * glm::vec3(directionAngle));
+	m_lightDirectionAnglesViewSpace[a_lightIdx] = glm::vec4(direction, directionAngle.w);
+
+	// The smallest sphere around the cone and its cap, through the apex and the rim for cones narrower than 45 degrees,
+	// around the rim for wider ones. Cones wider than a half space keep the sphere of the light
+	const float cosAngle = directionAngle.w;
+	const float sinAngle = glm::sqrt(glm::max(1.0f - cosAngle * cosAngle, 0.0f));
+	glm::vec4& boundingSphere = m_lightBoundingSpheres[a_lightIdx];
+	if (cosAngle <= 0.0f)
+	{
+		boundingSphere = light;
+	}
+	else if (cosAngle > COS_45_DEGREES)
+	{
+		const float radius = light.w / (2.0f * cosAngle);
+		boundingSphere = glm::vec4(glm::vec3(light) + direction * radius, radius);
+	}
+	else
+	{
+		boundingSphere = glm::vec4(glm::vec3(light) + direction * (light.w * cosAngle), light.w * sinAngle);
+	}
+}
+
+void LightClusterBuilder::calculateBounds(const PerspectiveCamera& a_camera, uint a_begin, uint a_end)
+{
+	const glm::ivec3 gridMax(m_gridWidth, m_gridHeight, m_gridDepth);
+	uint i = a_begin;
+#ifdef LIGHT_CLUSTER_SSE
+	for (; i + 4 <= a_end; i += 4)
+	{
+		glm::ivec4 screenBounds[4];
+		sphereToScreenSpaceBounds4(&m_lightBoundingSpheres[i], a_camera.getNear(), a_camera.getProjectionMatrix(), m_screenWidth, m_screenHeight, screenBounds);
+		for (uint j = 0; j < 4; ++j)
+		{
+			const glm::vec4& light = m_lightBoundingSpheres[i + j];
+			const glm::ivec2 boundsZ = ClusteredTiledShadingUtils::sphereToDepthSliceBounds(a_camera, light.z, light.w, m_recLogSD1);
+			const glm::ivec2 tileSize(m_tileWidth, m_tileHeight);
+			ClusterBounds& bounds = m_lightBounds[i + j];
+			bounds.min = glm::clamp(glm::ivec3(glm::ivec2(screenBounds[j].x, screenBounds[j].y) / tileSize, boundsZ.x), glm::ivec3(0), gridMax);
+			bounds.max = glm::clamp(glm::ivec3(glm::ivec2(screenBounds[j].z, screenBounds[j].w) / tileSize + 1, boundsZ.y), glm::ivec3(0), gridMax);
+		}
+	}
+#endif
+	for (; i < a_end; ++i)
+	{
+		const glm::vec4& light = m_lightBoundingSpheres[i];
+		IBounds3D bounds3D = ClusteredTiledShadingUtils::sphereToScreenSpaceBounds3D(a_camera, glm::vec3(light), light.w,
+			m_screenWidth, m_screenHeight, m_tileWidth, m_tileHeight, m_recLogSD1);
+		bounds3D.clamp(glm::ivec3(0), gridMax);
+		m_lightBounds[i].min = bounds3D.min;
+		m_lightBounds[i].max = bounds3D.max;
+	}
+}
+
+void LightClusterBuilder::calculateTileSlopes(const PerspectiveCamera& a_camera)
+{
+	// A view space point at depth d projects to x * projection[0][0] / d in normalized device coordinates
+	const glm::mat4& projection = a_camera.getProjectionMatrix();
+	m_tileSlopesX.resize(m_gridWidth + 1);
+	m_tileSlopesY.resize(m_gridHeight + 1);
+	for (uint x = 0; x <= m_gridWidth; ++x)
+		m_tileSlopesX[x] = (2.0f * float(x * m_tileWidth) / float(m_screenWidth) - 1.0f) / projection[0][0];
+	for (uint y = 0; y <= m_gridHeight; ++y)
+		m_tileSlopesY[y] = (2.0f * float(y * m_tileHeight) / float(m_screenHeight) - 1.0f) / projection[1][1];
+}
+
+void LightClusterBuilder::getClusterBox(int a_x, int a_y, int a_z, glm::vec3& a_min, glm::vec3& a_max) const
+{
+	// The box around the part of the tile frustum between the near and far depth of the slice
+	const float nearDepth = m_sliceDepths[a_z];
+	const float farDepth = m_sliceDepths[a_z + 1];
+	a_min.x = glm::min(m_tileSlopesX[a_x] * nearDepth, m_tileSlopesX[a_x] * farDepth);
+	a_max.x = glm::max(m_tileSlopesX[a_x + 1] * nearDepth, m_tileSlopesX[a_x + 1] * farDepth);
+	a_min.y = glm::min(m_tileSlopesY[a_y] * nearDepth, m_tileSlopesY[a_y] * farDepth);
+	a_max.y = glm::max(m_tileSlopesY[a_y + 1] * nearDepth, m_tileSlopesY[a_y + 1] * farDepth);
+	a_min.z = -farDepth;
+	a_max.z = -nearDepth;
+}
+
+bool LightClusterBuilder::sphereIntersectsCluster(const glm::vec4& a_sphere, int a_x, int a_y, int a_z) const
+{
+	glm::vec3 boxMin, boxMax;
+	getClusterBox(a_x, a_y, a_z, boxMin, boxMax);
+	const glm::vec3 distance = glm::max(glm::max(boxMin - glm::vec3(a_sphere), glm::vec3(a_sphere) - boxMax), glm::vec3(0.0f));
+	return glm::dot(distance, distance) <= a_sphere.w * a_sphere.w;
+}
+
+bool LightClusterBuilder::coneIntersectsCluster(const glm::vec4& a_light, const glm::vec4& a_directionAngle, int a_x, int a_y, int a_z) const
+{
+	glm::vec3 boxMin, boxMax;
+	getClusterBox(a_x, a_y, a_z, boxMin, boxMax);
+	const glm::vec3 center = (boxMin + boxMax) * 0.5f;
+	const float radius = glm::length(boxMax - center);
+
+	// Distance from the center of the cluster to the side of the cone, and along the axis to the apex and the end of the range
+	const glm::vec3 toCenter = center - glm::vec3(a_light);
+	const float distanceAlongAxis = glm::dot(toCenter, glm::vec3(a_directionAngle));
+	const float distanceFromAxis = glm::sqrt(glm::max(glm::dot(toCenter, toCenter) - distanceAlongAxis * distanceAlongAxis, 0.0f));
+	const float cosAngle = a_directionAngle.w;
+	const float sinAngle = glm::sqrt(glm::max(1.0f - cosAngle * cosAngle, 0.0f));
+	const float distanceFromSide = cosAngle * distanceFromAxis - sinAngle * distanceAlongAxis;
+	return distanceFromSide <= radius && distanceAlongAxis <= a_light.w + radius && distanceAlongAxis >= -radius;
+}
+
+LightClusterBuilder::Stats LightClusterBuilder::getStats() const
+{
+	Stats stats;
+	stats.numIndices = uint(m_lightIndices.size());
+	for (const glm::uvec2& range : m_clusterRanges)
+	{
+		const uint numLights = range.y - range.x;
+		stats.numOccupiedClusters += numLights > 0;
+		stats.maxLightsPerCluster = glm::max(stats.maxLightsPerCluster, numLights);
+	}
+	if (stats.numOccupiedClusters)
+		stats.avgLightsPerOccupiedCluster = float(stats.numIndices) / float(stats.numOccupiedClusters);
+	return stats;
+}
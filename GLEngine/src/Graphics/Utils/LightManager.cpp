@@ -3,20 +3,41 @@
 #include "Graphics/Utils/PerspectiveCamera.h"
 #include "EASTL/algorithm.h"
 
-LightHandle LightManager::INVALID_HANDLE = 0xFFFF;
+#include <assert.h>
 
-LightManager::LightManager(uint a_maxLights) : m_maxLights(a_maxLights)
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint SLOT_BITS = 20; // Up to a million lights, the remaining 12 bits count the reuses of a slot
+const uint SLOT_MASK = (1u << SLOT_BITS) - 1;
+const uint GENERATION_MASK = (1u << (32 - SLOT_BITS)) - 1;
+const float POINT_LIGHT_ANGLE = 180.0f;
+
+/** The cone angle is stored as its cosine, -1 exactly for point lights */
+inline float getConeCos(float a_angle)
+{
+	return a_angle >= POINT_LIGHT_ANGLE ? -1.0f : glm::cos(glm::radians(a_angle));
+}
+
+inline LightHandle makeHandle(uint a_slotIdx, uint a_generation)
+{
+	return a_slotIdx | (a_generation << SLOT_BITS);
+}
+
+END_UNNAMED_NAMESPACE()
+
+const LightHandle LightManager::INVALID_HANDLE = 0xFFFFFFFF;
+
+LightManager::LightManager(uint a_initialCapacity)
 {
-	m_lightPositionRanges = new glm::vec4[m_maxLights];
-	m_lightColorIntensities = new glm::vec4[m_maxLights];
-	m_lightHandles = new ushort[m_maxLights];
+	m_lightPositionRanges.reserve(a_initialCapacity);
+	m_lightColorIntensities.reserve(a_initialCapacity);
+	m_lightDirectionAngles.reserve(a_initialCapacity);
+	m_lightSlots.reserve(a_initialCapacity);
+	m_slots.reserve(a_initialCapacity);
 }
 
 LightManager::~LightManager()
 {
-	SAFE_DELETE_ARRAY(m_lightPositionRanges);
-	SAFE_DELETE_ARRAY(m_lightColorIntensities);
-	SAFE_DELETE_ARRAY(m_lightHandles);
 }
 
 LightHandle LightManager::createLight()
@@ -26,94 +47,196 @@ LightHandle LightManager::createLight()
 
 LightHandle LightManager::createLight(const glm::vec3& a_pos, float a_radius, const glm::vec3& a_color, float a_intensity)
 {
-	if (m_numUsedLights < m_maxLights)
+	return createSpotLight(a_pos, a_radius, glm::vec3(0.0f, -1.0f, 0.0f), POINT_LIGHT_ANGLE, a_color, a_intensity);
+}
+
+LightHandle LightManager::createSpotLight(const glm::vec3& a_pos, float a_radius, const glm::vec3& a_direction, float a_angle, const glm::vec3& a_color, float a_intensity)
+{
+	uint slotIdx;
+	if (!m_freeSlots.empty())
+	{
+		slotIdx = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
 	{
-		m_lightHandles[m_numUsedLights] = m_numUsedLights;
-		m_lightPositionRanges[m_numUsedLights] = glm::vec4(a_pos, a_radius);
-		m_lightColorIntensities[m_numUsedLights] = glm::vec4(glm::normalize(a_color), a_intensity);
-		return m_numUsedLights++;
+		// The last slot index would make INVALID_HANDLE a valid handle
+		if (m_slots.size() >= SLOT_MASK)
+		{
+			print("LightManager: more than %u lights\n", SLOT_MASK - 1);
+			return INVALID_HANDLE;
+		}
+		slotIdx = uint(m_slots.size());
+		m_slots.push_back({0, 0});
 	}
-	return INVALID_HANDLE;
+
+	const uint lightIdx = getNumLights();
+	m_slots[slotIdx].lightIdx = lightIdx;
+	m_lightSlots.push_back(slotIdx);
+	m_lightPositionRanges.push_back(glm::vec4(a_pos, a_radius));
+	m_lightColorIntensities.push_back(glm::vec4(glm::normalize(a_color), a_intensity));
+	m_lightDirectionAngles.push_back(glm::vec4(glm::normalize(a_direction), getConeCos(a_angle)));
+	markDirty(m_dirtyPositionRanges, lightIdx);
+	markDirty(m_dirtyColorIntensities, lightIdx);
+	return makeHandle(slotIdx, m_slots[slotIdx].generation);
 }
 
-void LightManager::deleteLight(LightHandle a_handle)
+void LightManager::deleteLight(LightHandle a_light)
 {
-	assert(m_numUsedLights > 0);
-	if (a_handle == INVALID_HANDLE)
+	// Stale handles are ignored instead of deleting the light that took over their place
+	if (!isValid(a_light))
 		return;
-	--m_numUsedLights;
-	if (a_handle != m_numUsedLights)
+	const uint lightIdx = getLightIdx(a_light);
+	const uint lastIdx = getNumLights() - 1;
+	if (lightIdx != lastIdx)
 	{
-		const ushort last = m_lightHandles[m_numUsedLights];
-		const ushort idx = m_lightHandles[a_handle];
-		eastl::swap(m_lightPositionRanges[last], m_lightPositionRanges[idx]);
-		eastl::swap(m_lightColorIntensities[last], m_lightColorIntensities[idx]);
+		m_lightPositionRanges[lightIdx] = m_lightPositionRanges[lastIdx];
+		m_lightColorIntensities[lightIdx] = m_lightColorIntensities[lastIdx];
+		m_lightDirectionAngles[lightIdx] = m_lightDirectionAngles[lastIdx];
+		m_lightSlots[lightIdx] = m_lightSlots[lastIdx];
+		m_slots[m_lightSlots[lightIdx]].lightIdx = lightIdx;
+		markDirty(m_dirtyPositionRanges, lightIdx);
+		markDirty(m_dirtyColorIntensities, lightIdx);
 	}
+	m_lightPositionRanges.pop_back();
+	m_lightColorIntensities.pop_back();
+	m_lightDirectionAngles.pop_back();
+	m_lightSlots.pop_back();
+
+	const uint slotIdx = a_light & SLOT_MASK;
+	m_slots[slotIdx].generation = (m_slots[slotIdx].generation + 1) & GENERATION_MASK;
+	m_freeSlots.push_back(slotIdx);
 }
 
 void LightManager::deleteLights()
 {
-	m_numUsedLights = 0;
+	for (uint slotIdx : m_lightSlots)
+	{
+		m_slots[slotIdx].generation = (m_slots[slotIdx].generation + 1) & GENERATION_MASK;
+		m_freeSlots.push_back(slotIdx);
+	}
+	m_lightPositionRanges.clear();
+	m_lightColorIntensities.clear();
+	m_lightDirectionAngles.clear();
+	m_lightSlots.clear();
+}
+
+bool LightManager::isValid(LightHandle a_light) const
+{
+	const uint slotIdx = a_light & SLOT_MASK;
+	if (slotIdx >= m_slots.size())
+		return false;
+	const Slot& slot = m_slots[slotIdx];
+	return slot.generation == (a_light >> SLOT_BITS) && slot.lightIdx < getNumLights() && m_lightSlots[slot.lightIdx] == slotIdx;
 }
 
 void LightManager::setLight(LightHandle a_light, const glm::vec3& a_pos, float a_radius, const glm::vec3& a_color, float a_intensity)
 {
-	assert(a_light < m_numUsedLights);
-	const ushort idx = m_lightHandles[a_light];
+	const uint idx = getLightIdx(a_light);
 	m_lightPositionRanges[idx] = glm::vec4(a_pos, a_radius);
 	m_lightColorIntensities[idx] = glm::vec4(a_color, a_intensity);
+	markDirty(m_dirtyPositionRanges, idx);
+	markDirty(m_dirtyColorIntensities, idx);
 }
 
 void LightManager::setLightPosition(LightHandle a_light, const glm::vec3& a_position)
 {
-	assert(a_light < m_numUsedLights);
-	glm::vec4& posRange = m_lightPositionRanges[m_lightHandles[a_light]];
+	const uint idx = getLightIdx(a_light);
+	glm::vec4& posRange = m_lightPositionRanges[idx];
 	posRange.x = a_position.x;
 	posRange.y = a_position.y;
 	posRange.z = a_position.z;
+	markDirty(m_dirtyPositionRanges, idx);
 }
 
 void LightManager::setLightRange(LightHandle a_light, float a_range)
 {
-	assert(a_light < m_numUsedLights);
-	m_lightPositionRanges[m_lightHandles[a_light]].w = a_range;
+	const uint idx = getLightIdx(a_light);
+	m_lightPositionRanges[idx].w = a_range;
+	markDirty(m_dirtyPositionRanges, idx);
 }
 
 void LightManager::setLightColor(LightHandle a_light, const glm::vec3& a_color)
 {
-	assert(a_light < m_numUsedLights);
-	glm::vec4& col = m_lightColorIntensities[m_lightHandles[a_light]];
+	const uint idx = getLightIdx(a_light);
+	glm::vec4& col = m_lightColorIntensities[idx];
 	col.r = a_color.r;
 	col.g = a_color.g;
 	col.b = a_color.b;
+	markDirty(m_dirtyColorIntensities, idx);
 }
 
 void LightManager::setLightIntensity(LightHandle a_light, float a_intensity)
 {
-	assert(a_light < m_numUsedLights);
-	m_lightColorIntensities[m_lightHandles[a_light]].a = a_intensity;
+	const uint idx = getLightIdx(a_light);
+	m_lightColorIntensities[idx].a = a_intensity;
+	markDirty(m_dirtyColorIntensities, idx);
+}
+
+void LightManager::setLightSpot(LightHandle a_light, const glm::vec3& a_direction, float a_angle)
+{
+	const uint idx = getLightIdx(a_light);
+	m_lightDirectionAngles[idx] = glm::vec4(glm::normalize(a_direction), getConeCos(a_angle));
+	markDirty(m_dirtyPositionRanges, idx);
 }
 
 const glm::vec3& LightManager::getLightPosition(LightHandle a_light) const
 {
-	assert(a_light < m_numUsedLights);
-	return rcast<glm::vec3&>(m_lightPositionRanges[m_lightHandles[a_light]]);
+	return rcast<const glm::vec3&>(m_lightPositionRanges[getLightIdx(a_light)]);
 }
 
 float LightManager::getLightRange(LightHandle a_light) const
 {
-	assert(a_light < m_numUsedLights);
-	return m_lightPositionRanges[m_lightHandles[a_light]].w;
+	return m_lightPositionRanges[getLightIdx(a_light)].w;
 }
 
 const glm::vec3& LightManager::getLightColor(LightHandle a_light) const
 {
-	assert(a_light < m_numUsedLights);
-	return rcast<glm::vec3&>(m_lightColorIntensities[m_lightHandles[a_light]]);
+	return rcast<const glm::vec3&>(m_lightColorIntensities[getLightIdx(a_light)]);
 }
 
 float LightManager::getLightIntensity(LightHandle a_light) const
 {
-	assert(a_light < m_numUsedLights);
-	return m_lightColorIntensities[m_lightHandles[a_light]].a;
-}
\ No newline at end of file
+	return m_lightColorIntensities[getLightIdx(a_light)].a;
+}
+
+const glm::vec3& LightManager::getLightDirection(LightHandle a_light) const
+{
+	return rcast<const glm::vec3&>(m_lightDirectionAngles[getLightIdx(a_light)]);
+}
+
+float LightManager::getLightSpotAngle(LightHandle a_light) const
+{
+	return glm::degrees(glm::acos(glm::clamp(m_lightDirectionAngles[getLightIdx(a_light)].w, -1.0f, 1.0f)));
+}
+
+bool LightManager::isSpotLight(LightHandle a_light) const
+{
+	return m_lightDirectionAngles[getLightIdx(a_light)].w > -1.0f;
+}
+
+void LightManager::clearDirtyRanges()
+{
+	m_dirtyPositionRanges = DirtyRange();
+	m_dirtyColorIntensities = DirtyRange();
+}
+
+uint LightManager::getLightIdx(LightHandle a_light) const
+{
+	assert(isValid(a_light));
+	return m_slots[a_light & SLOT_MASK].lightIdx;
+}
+
+void LightManager::markDirty(DirtyRange& a_range, uint a_lightIdx)
+{
+	if (a_range.isEmpty())
+	{
+		a_range.begin = a_lightIdx;
+		a_range.end = a_lightIdx + 1;
+	}
+	else
+	{
+		a_range.begin = glm::min(a_range.begin, a_lightIdx);
+		a_range.end = glm::max(a_range.end, a_lightIdx + 1);
+	}
+}
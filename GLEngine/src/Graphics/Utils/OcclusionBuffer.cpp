@@ -0,0 +1,297 @@
+#include "Graphics/Utils/OcclusionBuffer.h"
+
+#include "Graphics/Utils/AABBList.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/sort.h"
+
+#include <float.h>
+#include <math.h>
+
+// x64 always has SSE2, rows are rasterized 4 pixels at a time
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_SSE
+#endif
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint BOXES_PER_WORD = 32;
+const uint MAX_TEST_TEXELS = 4;  // Boxes are tested at the level where they cover at most this many texels per axis
+const float FAR_DEPTH = 1.0f;
+
+/** GL clip space near plane is z = -w, returns the distance to it scaled by w */
+inline float nearDistance(const glm::vec4& a_clip) { return a_clip.z + a_clip.w; }
+
+END_UNNAMED_NAMESPACE()
+
+void OcclusionBuffer::initialize(const Settings& a_settings)
+{
+	assert(a_settings.width % 4 == 0 && a_settings.width > 0 && a_settings.height > 0);
+	m_settings = a_settings;
+	m_levels.clear();
+	m_levelSizes.clear();
+
+	glm::uvec2 size(m_settings.width, m_settings.height);
+	while (true)
+	{
+		m_levelSizes.push_back(size);
+		m_levels.push_back(eastl::vector<float>(size.x * size.y, FAR_DEPTH));
+		if (size.x == 1 && size.y == 1)
+			break;
+		size = glm::uvec2((size.x + 1) / 2, (size.y + 1) / 2);
+	}
+	m_ready = false;
+}
+
+void OcclusionBuffer::beginFrame(const glm::mat4& a_viewProjection)
+{
+	assert(!m_levels.empty() && "OcclusionBuffer is not initialized");
+	m_viewProjection = a_viewProjection;
+	m_occluders.clear();
+	for (eastl::vector<float>& level : m_levels)
+		eastl::fill(level.begin(), level.end(), FAR_DEPTH);
+	m_stats = Stats();
+	m_ready = false;
+}
+
+void OcclusionBuffer::addOccluder(const OccluderMesh& a_mesh, const glm::mat4& a_modelMatrix, float a_priority)
+{
+	Occluder occluder;
+	occluder.mesh = &a_mesh;
+	occluder.modelMatrix = a_modelMatrix;
+	occluder.priority = a_priority;
+	m_occluders.push_back(occluder);
+}
+
+void OcclusionBuffer::rasterizeOccluders()
+{
+	eastl::sort(m_occluders.begin(), m_occluders.end(), [](const Occluder& a_left, const Occluder& a_right) { return a_left.priority > a_right.priority; });
+
+	for (const Occluder& occluder : m_occluders)
+	{
+		const uint numTriangles = uint(occluder.mesh->indices.size()) / 3;
+		if (m_stats.numTriangles + numTriangles > m_settings.maxTrianglesPerFrame)
+			continue; // A smaller occluder further down might still fit
+		rasterizeOccluder(occluder);
+		m_stats.numTriangles += numTriangles;
+		m_stats.numOccluders++;
+	}
+	buildHierarchy();
+	m_ready = true;
+}
+
+void OcclusionBuffer::rasterizeOccluder(const Occluder& a_occluder)
+{
+	const glm::mat4 mvp = m_viewProjection * a_occluder.modelMatrix;
+	const eastl::vector<glm::vec3>& positions = a_occluder.mesh->positions;
+	m_clipPositions.resize(positions.size());
+	for (uint i = 0; i < positions.size(); ++i)
+		m_clipPositions[i] = mvp * glm::vec4(positions[i], 1.0f);
+
+	const eastl::vector<uint>& indices = a_occluder.mesh->indices;
+	for (uint i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const glm::vec4* triangle[3] = { &m_clipPositions[indices[i]], &m_clipPositions[indices[i + 1]], &m_clipPositions[indices[i + 2]] };
+		uint numBehind = 0;
+		for (uint j = 0; j < 3; ++j)
+			numBehind += nearDistance(*triangle[j]) < 0.0f;
+
+		if (numBehind == 0)
+		{
+			rasterizeTriangle(*triangle[0], *triangle[1], *triangle[2]);
+			continue;
+		}
+		if (numBehind == 3)
+			continue;
+
+		// Clip against the near plane, what remains of the triangle is a triangle or a quad
+		glm::vec4 clipped[4];
+		uint numClipped = 0;
+		for (uint j = 0; j < 3; ++j)
+		{
+			const glm::vec4& from = *triangle[j];
+			const glm::vec4& to = *triangle[(j + 1) % 3];
+			const float fromDistance = nearDistance(from);
+			const float toDistance = nearDistance(to);
+			if (fromDistance >= 0.0f)
+				clipped[numClipped++] = from;
+			if ((fromDistance >= 0.0f) != (toDistance >= 0.0f))
+				clipped[numClipped++] = glm::mix(from, to, fromDistance / (fromDistance - toDistance));
+		}
+		rasterizeTriangle(clipped[0], clipped[1], clipped[2]);
+		if (numClipped == 4)
+			rasterizeTriangle(clipped[0], clipped[2], clipped[3]);
+	}
+}
+
+void OcclusionBuffer::rasterizeTriangle(const glm::vec4& a_v0, const glm::vec4& a_v1, const glm::vec4& a_v2)
+{
+	const float width = float(m_settings.width);
+	const float height = float(m_settings.height);
+
+	// To pixels, y up like normalized device coordinates so front faces stay counter clockwise
+	glm::vec3 v[3];
+	const glm::vec4* clip[3] = { &a_v0, &a_v1, &a_v2 };
+	for (uint i = 0; i < 3; ++i)
+	{
+		const float invW = 1.0f / clip[i]->w;
+		v[i] = glm::vec3((clip[i]->x * invW * 0.5f + 0.5f) * width, (clip[i]->y * invW * 0.5f + 0.5f) * height, clip[i]->z * invW);
+	}
+
+	const float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+	if (area <= 0.0f)
+		return; // Back facing or degenerate
+
+	const int minX = glm::max(int(floorf(glm::min(v[0].x, glm::min(v[1].x, v[2].x)))), 0);
+	const int maxX = glm::min(int(ceilf(glm::max(v[0].x, glm::max(v[1].x, v[2].x)))), int(m_settings.width) - 1);
+	const int minY = glm::max(int(floorf(glm::min(v[0].y, glm::min(v[1].y, v[2].y)))), 0);
+	const int maxY = glm::min(int(ceilf(glm::max(v[0].y, glm::max(v[1].y, v[2].y)))), int(m_settings.height) - 1);
+	if (minX > maxX || minY > maxY)
+		return;
+
+	// Edge functions a * x + b * y + c, positive inside. Edge i is opposite of vertex i so it also gives the barycentric weight of vertex i
+	float a[3], b[3], c[3];
+	for (uint i = 0; i < 3; ++i)
+	{
+		const glm::vec3& from = v[(i + 1) % 3];
+		const glm::vec3& to = v[(i + 2) % 3];
+		a[i] = from.y - to.y;
+		b[i] = to.x - from.x;
+		c[i] = -a[i] * from.x - b[i] * from.y;
+	}
+
+	// Depth is linear in screen space. The farthest depth within the pixel is stored so occluders never end up nearer than they are
+	const float invArea = 1.0f / area;
+	const float dzdx = (a[0] * v[0].z + a[1] * v[1].z + a[2] * v[2].z) * invArea;
+	const float dzdy = (b[0] * v[0].z + b[1] * v[1].z + b[2] * v[2].z) * invArea;
+	const float z0 = (c[0] * v[0].z + c[1] * v[1].z + c[2] * v[2].z) * invArea + 0.5f * (fabsf(dzdx) + fabsf(dzdy));
+	const float maxZ = glm::min(glm::max(v[0].z, glm::max(v[1].z, v[2].z)), FAR_DEPTH);
+
+	float* depth = m_levels[0].data();
+	const int startX = minX & ~3;
+	for (int y = minY; y <= maxY; ++y)
+	{
+		const float py = float(y) + 0.5f;
+		float* row = depth + y * m_settings.width;
+#ifdef OCCLUSION_SSE
+		const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 px = _mm_add_ps(_mm_set1_ps(float(startX)), offsets);
+		__m128 edges[3], edgeSteps[3];
+		for (uint i = 0; i < 3; ++i)
+		{
+			edges[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[i]), px), _mm_set1_ps(b[i] * py + c[i]));
+			edgeSteps[i] = _mm_set1_ps(a[i] * 4.0f);
+		}
+		__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), px), _mm_set1_ps(dzdy * py + z0));
+		const __m128 zStep = _mm_set1_ps(dzdx * 4.0f);
+		const __m128 zMax = _mm_set1_ps(maxZ);
+		const __m128 zero = _mm_setzero_ps();
+
+		// Pixels left of minX are only written when they are inside the triangle, rows are a multiple of 4 wide
+		for (int x = startX; x <= maxX; x += 4)
+		{
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edges[0], zero), _mm_cmpge_ps(edges[1], zero)), _mm_cmpge_ps(edges[2], zero));
+			if (_mm_movemask_ps(inside))
+			{
+				const __m128 old = _mm_loadu_ps(row + x);
+				const __m128 nearest = _mm_min_ps(old, _mm_min_ps(z, zMax));
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+			}
+			for (uint i = 0; i < 3; ++i)
+				edges[i] = _mm_add_ps(edges[i], edgeSteps[i]);
+			z = _mm_add_ps(z, zStep);
+		}
+#else
+		for (int x = minX; x <= maxX; ++x)
+		{
+			const float px = float(x) + 0.5f;
+			if (a[0] * px + b[0] * py + c[0] >= 0.0f && a[1] * px + b[1] * py + c[1] >= 0.0f && a[2] * px + b[2] * py + c[2] >= 0.0f)
+				row[x] = glm::min(row[x], glm::min(z0 + dzdx * px + dzdy * py, maxZ));
+		}
+#endif
+	}
+}
+
+void OcclusionBuffer::buildHierarchy()
+{
+	for (uint level = 1; level < m_levels.size(); ++level)
+	{
+		const glm::uvec2 srcSize = m_levelSizes[level - 1];
+		const glm::uvec2 size = m_levelSizes[level];
+		const float* src = m_levels[level - 1].data();
+		float* dst = m_levels[level].data();
+		for (uint y = 0; y < size.y; ++y)
+		{
+			const uint y0 = y * 2;
+			const uint y1 = glm::min(y0 + 1, srcSize.y - 1);
+			for (uint x = 0; x < size.x; ++x)
+			{
+				const uint x0 = x * 2;
+				const uint x1 = glm::min(x0 + 1, srcSize.x - 1);
+				dst[y * size.x + x] = glm::max(glm::max(src[y0 * srcSize.x + x0], src[y0 * srcSize.x + x1]), glm::max(src[y1 * srcSize.x + x0], src[y1 * srcSize.x + x1]));
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::isVisible(const glm::vec3& a_center, const glm::vec3& a_halfSize)
+{
+	assert(m_ready);
+	m_stats.numTested++;
+
+	glm::vec2 screenMin(FLT_MAX);
+	glm::vec2 screenMax(-FLT_MAX);
+	float nearestZ = FLT_MAX;
+	for (uint i = 0; i < 8; ++i)
+	{
+		const glm::vec3 corner = a_center + a_halfSize * glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+		const glm::vec4 clip = m_viewProjection * glm::vec4(corner, 1.0f);
+		if (nearDistance(clip) <= 0.0f)
+			return true; // Crosses the near plane, the camera might be inside
+		const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		screenMin = glm::min(screenMin, glm::vec2(ndc));
+		screenMax = glm::max(screenMax, glm::vec2(ndc));
+		nearestZ = glm::min(nearestZ, ndc.z);
+	}
+
+	// To pixels, grown by one for pixels the occluders only partially cover
+	const glm::vec2 size(m_settings.width, m_settings.height);
+	const glm::ivec2 pixelMin = glm::ivec2(glm::floor((screenMin * 0.5f + 0.5f) * size)) - 1;
+	const glm::ivec2 pixelMax = glm::ivec2(glm::floor((screenMax * 0.5f + 0.5f) * size)) + 1;
+	const glm::ivec2 clampedMin = glm::max(pixelMin, glm::ivec2(0));
+	const glm::ivec2 clampedMax = glm::min(pixelMax, glm::ivec2(size) - 1);
+	if (clampedMin.x > clampedMax.x || clampedMin.y > clampedMax.y)
+		return true; // Off screen, left to the frustum
+
+	uint level = 0;
+	while (level + 1 < m_levels.size() && uint(glm::max(clampedMax.x - clampedMin.x, clampedMax.y - clampedMin.y) >> level) >= MAX_TEST_TEXELS)
+		level++;
+
+	const float* depth = m_levels[level].data();
+	const uint levelWidth = m_levelSizes[level].x;
+	for (int y = clampedMin.y >> level; y <= clampedMax.y >> level; ++y)
+	{
+		for (int x = clampedMin.x >> level; x <= clampedMax.x >> level; ++x)
+		{
+			if (nearestZ <= depth[y * levelWidth + x])
+				return true;
+		}
+	}
+	m_stats.numOccluded++;
+	return false;
+}
+
+void OcclusionBuffer::cullOccluded(const AABBList& a_boxes, eastl::vector<uint>& a_visibilityMask)
+{
+	for (uint word = 0; word < a_visibilityMask.size(); ++word)
+	{
+		if (!a_visibilityMask[word])
+			continue;
+		for (uint bit = 0; bit < BOXES_PER_WORD; ++bit)
+		{
+			const uint boxIdx = word * BOXES_PER_WORD + bit;
+			if ((a_visibilityMask[word] & (1u << bit)) && !isVisible(a_boxes.getCenter(boxIdx), a_boxes.getHalfSize(boxIdx)))
+				a_visibilityMask[word] &= ~(1u << bit);
+		}
+	}
+}
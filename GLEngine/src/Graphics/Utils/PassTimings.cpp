@@ -0,0 +1,132 @@
+#include "Graphics/Utils/PassTimings.h"
+
+#include "EASTL/sort.h"
+#include "json/json.h"
+
+#include <assert.h>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <string.h>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+/** Of samples sorted ascending, the smallest sample with at least the fraction of samples at or below it */
+float getNearestRankPercentile(const eastl::vector<float>& a_sorted, float a_fraction)
+{
+	const uint rank = uint(glm::ceil(a_fraction * float(a_sorted.size())));
+	return a_sorted[glm::clamp(rank, 1u, uint(a_sorted.size())) - 1];
+}
+
+END_UNNAMED_NAMESPACE()
+
+void PassTimings::initialize(uint a_numSamples)
+{
+	assert(a_numSamples);
+	m_maxNumSamples = a_numSamples;
+	m_passes.clear();
+}
+
+uint PassTimings::getPassIndex(const char* a_name)
+{
+	// Frames have a few dozen passes at most
+	for (uint i = 0; i < m_passes.size(); ++i)
+		if (strcmp(m_passes[i].name.c_str(), a_name) == 0)
+			return i;
+
+	m_passes.push_back();
+	Pass& pass = m_passes.back();
+	pass.name = a_name;
+	pass.samples.resize(m_maxNumSamples);
+	pass.nextSample = 0;
+	pass.numSamples = 0;
+	return uint(m_passes.size() - 1);
+}
+
+void PassTimings::addSample(uint a_passIdx, float a_ms)
+{
+	assert(a_passIdx < m_passes.size());
+	Pass& pass = m_passes[a_passIdx];
+	pass.samples[pass.nextSample] = a_ms;
+	pass.nextSample = (pass.nextSample + 1) % m_maxNumSamples;
+	pass.numSamples = glm::min(pass.numSamples + 1, m_maxNumSamples);
+}
+
+void PassTimings::clearSamples()
+{
+	for (Pass& pass : m_passes)
+	{
+		pass.nextSample = 0;
+		pass.numSamples = 0;
+	}
+}
+
+void PassTimings::getStats(eastl::vector<PassStats>& a_stats) const
+{
+	a_stats.clear();
+	for (const Pass& pass : m_passes)
+	{
+		PassStats stats = {};
+		stats.name = pass.name.c_str();
+		stats.numSamples = pass.numSamples;
+		if (pass.numSamples)
+		{
+			// The ring is full or filled from the start
+			m_sorted.assign(pass.samples.begin(), pass.samples.begin() + pass.numSamples);
+			float totalMs = 0.0f;
+			for (float ms : m_sorted)
+				totalMs += ms;
+			eastl::sort(m_sorted.begin(), m_sorted.end());
+
+			stats.lastMs = pass.samples[(pass.nextSample + m_maxNumSamples - 1) % m_maxNumSamples];
+			stats.averageMs = totalMs / float(pass.numSamples);
+			stats.minMs = m_sorted.front();
+			stats.maxMs = m_sorted.back();
+			stats.p50Ms = getNearestRankPercentile(m_sorted, 0.5f);
+			stats.p95Ms = getNearestRankPercentile(m_sorted, 0.95f);
+			stats.p99Ms = getNearestRankPercentile(m_sorted, 0.99f);
+		}
+		a_stats.push_back(stats);
+	}
+}
+
+bool PassTimings::writeReport(const eastl::string& a_filePath) const
+{
+	eastl::vector<PassStats> passStats;
+	getStats(passStats);
+
+	Json::Value root(Json::objectValue);
+	root["maxNumSamples"] = m_maxNumSamples;
+	Json::Value& passes = root["passes"] = Json::Value(Json::arrayValue);
+	for (const PassStats& stats : passStats)
+	{
+		Json::Value& p = passes.append(Json::Value(Json::objectValue));
+		p["name"] = stats.name;
+		p["numSamples"] = stats.numSamples;
+		p["lastMs"] = stats.lastMs;
+		p["averageMs"] = stats.averageMs;
+		p["minMs"] = stats.minMs;
+		p["maxMs"] = stats.maxMs;
+		p["p50Ms"] = stats.p50Ms;
+		p["p95Ms"] = stats.p95Ms;
+		p["p99Ms"] = stats.p99Ms;
+	}
+
+	std::ofstream file(a_filePath.c_str());
+	if (!file.is_open())
+	{
+		print("Could not write pass timings: %s\n", a_filePath.c_str());
+		return false;
+	}
+	file << Json::StyledWriter().write(root);
+	return true;
+}
+
+void PassTimings::printSummary() const
+{
+	eastl::vector<PassStats> passStats;
+	getStats(passStats);
+
+	print("%-28s %8s %8s %8s %8s %8s\n", "Pass", "avg ms", "p50", "p95", "p99", "max");
+	for (const PassStats& stats : passStats)
+		print("%-28s %8.3f %8.3f %8.3f %8.3f %8.3f\n", stats.name, stats.averageMs, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs);
+}
@@ -0,0 +1,97 @@
+#include "Graphics/Utils/QualityGovernor.h"
+
+#include <assert.h>
+#include <glm/glm.hpp>
+
+void QualityGovernor::initialize(const Settings& a_settings, const eastl::vector<QualityLevel>& a_levels, uint a_startLevel)
+{
+	assert(!a_levels.empty());
+	m_settings = a_settings;
+	m_settings.upgradeFrames = glm::max(m_settings.upgradeFrames, 1u);
+	m_settings.maxUpgradeFrames = glm::max(m_settings.maxUpgradeFrames, m_settings.upgradeFrames);
+	m_levels = a_levels;
+	m_upgradeFrames = m_settings.upgradeFrames;
+	m_lastChangeUpgraded = false;
+	m_stats = Stats();
+	setLevel(glm::min(a_startLevel, getNumLevels() - 1));
+}
+
+bool QualityGovernor::update(float a_gpuMs, float a_cpuMs)
+{
+	if (a_gpuMs < 0.0f)
+		return false;
+	// The measurements right after a change still show the old level
+	if (m_settleFramesLeft)
+	{
+		--m_settleFramesLeft;
+		return false;
+	}
+
+	if (m_numAveraged++ == 0)
+	{
+		m_averageGPUMs = a_gpuMs;
+		m_averageCPUMs = a_cpuMs;
+	}
+	else
+	{
+		m_averageGPUMs += (a_gpuMs - m_averageGPUMs) * m_settings.smoothing;
+		m_averageCPUMs += (a_cpuMs - m_averageCPUMs) * m_settings.smoothing;
+	}
+	++m_framesAtLevel;
+	// An upgrade that held long enough was right, the next one does not have to wait longer
+	if (m_lastChangeUpgraded && m_framesAtLevel > m_upgradeFrames)
+		m_upgradeFrames = m_settings.upgradeFrames;
+
+	const float targetMs = m_settings.targetFrameMs;
+	if (m_averageCPUMs > targetMs && m_averageCPUMs > m_averageGPUMs)
+	{
+		++m_stats.numCPUBoundFrames;
+		m_framesOver = 0;
+		m_framesUnder = 0;
+		return false;
+	}
+
+	if (m_averageGPUMs > targetMs * (1.0f + m_settings.downgradeMargin))
+	{
+		m_framesUnder = 0;
+		if (++m_framesOver < m_settings.downgradeFrames || m_level + 1 >= getNumLevels())
+			return false;
+
+		if (m_lastChangeUpgraded && m_framesAtLevel <= m_upgradeFrames)
+		{
+			m_upgradeFrames = glm::min(m_upgradeFrames * 2, m_settings.maxUpgradeFrames);
+			++m_stats.numUndoneUpgrades;
+		}
+		m_lastChangeUpgraded = false;
+		++m_stats.numDowngrades;
+		setLevel(m_level + 1);
+		return true;
+	}
+
+	m_framesOver = 0;
+	if (m_level == 0)
+		return false;
+	const float predictedMs = m_averageGPUMs * m_levels[m_level - 1].relativeCost / m_levels[m_level].relativeCost;
+	if (predictedMs >= targetMs * (1.0f - m_settings.upgradeMargin))
+	{
+		m_framesUnder = 0;
+		return false;
+	}
+	if (++m_framesUnder < m_upgradeFrames)
+		return false;
+
+	m_lastChangeUpgraded = true;
+	++m_stats.numUpgrades;
+	setLevel(m_level - 1);
+	return true;
+}
+
+void QualityGovernor::setLevel(uint a_level)
+{
+	m_level = a_level;
+	m_settleFramesLeft = m_settings.settleFrames;
+	m_numAveraged = 0;
+	m_framesOver = 0;
+	m_framesUnder = 0;
+	m_framesAtLevel = 0;
+}
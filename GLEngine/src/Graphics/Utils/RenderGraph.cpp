@@ -0,0 +1,208 @@
+#include "Graphics/Utils/RenderGraph.h"
+
+#include "EASTL/sort.h"
+
+#include <assert.h>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint TRANSIENT_KEY_BIT = 0x80000000;
+
+inline uint countBits(uint a_mask)
+{
+	uint count = 0;
+	for (; a_mask; a_mask &= a_mask - 1)
+		++count;
+	return count;
+}
+
+END_UNNAMED_NAMESPACE()
+
+void RenderGraph::reset()
+{
+	m_resources.clear();
+	m_passes.clear();
+	m_compiledPasses.clear();
+	m_physicalDescs.clear();
+	m_stats = Stats();
+}
+
+RenderGraph::ResourceHandle RenderGraph::createTransient(const char* a_name, const ResourceDesc& a_desc)
+{
+	const Resource resource = { a_name, a_desc, false, false, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX };
+	m_resources.push_back(resource);
+	return ResourceHandle(m_resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::importResource(const char* a_name, const ResourceDesc& a_desc, bool a_isOutput)
+{
+	const Resource resource = { a_name, a_desc, true, a_isOutput, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX };
+	m_resources.push_back(resource);
+	return ResourceHandle(m_resources.size() - 1);
+}
+
+RenderGraph::PassHandle RenderGraph::addPass(const char* a_name, std::function<void()> a_execute)
+{
+	m_passes.push_back();
+	Pass& pass = m_passes.back();
+	pass.name = a_name;
+	pass.execute = a_execute;
+	pass.sideEffect = false;
+	pass.culled = false;
+	return PassHandle(m_passes.size() - 1);
+}
+
+void RenderGraph::read(PassHandle a_pass, ResourceHandle a_resource)
+{
+	assert(a_pass < m_passes.size() && a_resource < m_resources.size());
+	m_passes[a_pass].reads.push_back(a_resource);
+}
+
+void RenderGraph::write(PassHandle a_pass, ResourceHandle a_resource, ELoad a_load)
+{
+	assert(a_pass < m_passes.size() && a_resource < m_resources.size());
+	Pass& pass = m_passes[a_pass];
+	assert(pass.attachments.size() < MAX_ATTACHMENTS);
+	pass.attachments.push_back(a_resource);
+	pass.loads.push_back(a_load);
+}
+
+void RenderGraph::setSideEffect(PassHandle a_pass)
+{
+	m_passes[a_pass].sideEffect = true;
+}
+
+bool RenderGraph::compile()
+{
+	const uint numResources = getNumResources();
+	const uint numPasses = getNumPasses();
+	m_compiledPasses.clear();
+	m_physicalDescs.clear();
+	m_physicalLastUse.clear();
+	m_stats = Stats();
+	m_stats.numPasses = numPasses;
+
+	// Walking backwards, a pass is needed when it writes a resource a later needed pass reads or an output.
+	// A write that does not load overwrites what the passes before wrote, so they are not needed for it anymore
+	m_needed.assign(numResources, 0);
+	for (uint i = 0; i < numResources; ++i)
+		m_needed[i] = m_resources[i].output;
+	for (uint i = numPasses; i-- > 0;)
+	{
+		Pass& pass = m_passes[i];
+		bool needed = pass.sideEffect;
+		for (ResourceHandle resource : pass.attachments)
+			needed = needed || m_needed[resource];
+		pass.culled = !needed;
+		if (!needed)
+		{
+			++m_stats.numCulledPasses;
+			continue;
+		}
+		for (uint j = 0; j < pass.attachments.size(); ++j)
+			m_needed[pass.attachments[j]] = m_resources[pass.attachments[j]].output || pass.loads[j] == ELoad::LOAD;
+		for (ResourceHandle resource : pass.reads)
+			m_needed[resource] = 1;
+	}
+
+	// Lifetimes in the order the passes run in, and the clears of attachments that would otherwise hold what another transient left behind
+	for (Resource& resource : m_resources)
+	{
+		resource.physicalIdx = INVALID_INDEX;
+		resource.firstUse = INVALID_INDEX;
+		resource.lastUse = INVALID_INDEX;
+	}
+	auto use = [this](ResourceHandle a_resource, uint a_compiledIdx)
+	{
+		Resource& resource = m_resources[a_resource];
+		if (resource.firstUse == INVALID_INDEX)
+			resource.firstUse = a_compiledIdx;
+		resource.lastUse = a_compiledIdx;
+	};
+	m_written.assign(numResources, 0);
+	for (uint i = 0; i < numPasses; ++i)
+	{
+		const Pass& pass = m_passes[i];
+		if (pass.culled)
+			continue;
+
+		const uint compiledIdx = uint(m_compiledPasses.size());
+		for (ResourceHandle resource : pass.reads)
+		{
+			if (!m_resources[resource].imported && !m_written[resource])
+			{
+				print("RenderGraph: pass %s reads %s before anything wrote it\n", pass.name, m_resources[resource].name);
+				m_compiledPasses.clear();
+				return false;
+			}
+			use(resource, compiledIdx);
+		}
+		CompiledPass compiled = { PassHandle(i), false, 0 };
+		for (uint j = 0; j < pass.attachments.size(); ++j)
+		{
+			const ResourceHandle resource = pass.attachments[j];
+			if (pass.loads[j] == ELoad::CLEAR || (pass.loads[j] == ELoad::LOAD && !m_resources[resource].imported && !m_written[resource]))
+				compiled.clearMask |= 1u << j;
+			m_written[resource] = 1;
+			use(resource, compiledIdx);
+		}
+		m_compiledPasses.push_back(compiled);
+	}
+
+	// Transients in the order they start living take the first physical target of the same description that is free again
+	m_transientsByFirstUse.clear();
+	for (uint i = 0; i < numResources; ++i)
+		if (!m_resources[i].imported && m_resources[i].firstUse != INVALID_INDEX)
+			m_transientsByFirstUse.push_back(i);
+	eastl::sort(m_transientsByFirstUse.begin(), m_transientsByFirstUse.end(), [this](ResourceHandle a_left, ResourceHandle a_right)
+	{
+		const uint leftFirstUse = m_resources[a_left].firstUse;
+		const uint rightFirstUse = m_resources[a_right].firstUse;
+		return leftFirstUse < rightFirstUse || (leftFirstUse == rightFirstUse && a_left < a_right);
+	});
+	for (ResourceHandle handle : m_transientsByFirstUse)
+	{
+		Resource& resource = m_resources[handle];
+		uint physicalIdx = INVALID_INDEX;
+		for (uint i = 0; i < m_physicalDescs.size() && physicalIdx == INVALID_INDEX; ++i)
+			if (m_physicalDescs[i] == resource.desc && m_physicalLastUse[i] < resource.firstUse)
+				physicalIdx = i;
+		if (physicalIdx == INVALID_INDEX)
+		{
+			physicalIdx = uint(m_physicalDescs.size());
+			m_physicalDescs.push_back(resource.desc);
+			m_physicalLastUse.push_back(0);
+			m_stats.physicalBytes += resource.desc.getNumBytes();
+		}
+		m_physicalLastUse[physicalIdx] = resource.lastUse;
+		resource.physicalIdx = physicalIdx;
+		++m_stats.numTransients;
+		m_stats.transientBytes += resource.desc.getNumBytes();
+	}
+	m_stats.numPhysical = getNumPhysical();
+
+	// Passes keep the framebuffer of the pass before when they attach the same targets in the same order
+	for (uint i = 0; i < m_compiledPasses.size(); ++i)
+	{
+		CompiledPass& compiled = m_compiledPasses[i];
+		const Pass& pass = m_passes[compiled.pass];
+		bool sameAttachments = false;
+		if (i > 0)
+		{
+			const Pass& previousPass = m_passes[m_compiledPasses[i - 1].pass];
+			sameAttachments = previousPass.attachments.size() == pass.attachments.size();
+			for (uint j = 0; j < pass.attachments.size() && sameAttachments; ++j)
+				sameAttachments = getAttachmentKey(pass.attachments[j]) == getAttachmentKey(previousPass.attachments[j]);
+		}
+		compiled.bindFramebuffer = !pass.attachments.empty() && !sameAttachments;
+		m_stats.numFramebufferBinds += compiled.bindFramebuffer;
+		m_stats.numClears += countBits(compiled.clearMask);
+	}
+	return true;
+}
+
+uint RenderGraph::getAttachmentKey(ResourceHandle a_resource) const
+{
+	const Resource& resource = m_resources[a_resource];
+	return resource.imported ? a_resource : (resource.physicalIdx | TRANSIENT_KEY_BIT);
+}
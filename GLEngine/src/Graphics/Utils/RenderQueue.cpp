@@ -0,0 +1,74 @@
+#include "Graphics/Utils/RenderQueue.h"
+
+#include <assert.h>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint RADIX_BITS = 8;
+const uint RADIX_SIZE = 1 << RADIX_BITS;
+const uint NUM_RADIX_PASSES = 64 / RADIX_BITS;
+
+uint64 getMask(uint a_numBits)
+{
+	return (1ull << a_numBits) - 1;
+}
+
+END_UNNAMED_NAMESPACE()
+
+uint64 RenderQueue::makeKey(EPass a_pass, uint a_shaderID, uint a_materialID, float a_normalizedDepth)
+{
+	assert(a_pass < EPass::COUNT);
+	assert(a_shaderID <= getMask(SHADER_BITS));
+	const float clampedDepth = a_normalizedDepth < 0.0f ? 0.0f : (a_normalizedDepth > 1.0f ? 1.0f : a_normalizedDepth);
+	const uint64 depth = uint64(clampedDepth * float(getMask(DEPTH_BITS)));
+	const uint64 material = uint64(a_materialID) & getMask(MATERIAL_BITS);
+
+	uint64 key = uint64(a_pass) << (64 - PASS_BITS);
+	key |= (uint64(a_shaderID) & getMask(SHADER_BITS)) << BUCKET_SHIFT;
+	if (a_pass == EPass::BLENDED)
+	{	// Back to front has to win over material changes for blending to be correct
+		const uint64 invDepth = getMask(DEPTH_BITS) - depth;
+		key |= invDepth << (BUCKET_SHIFT - DEPTH_BITS);
+		key |= material << (BUCKET_SHIFT - DEPTH_BITS - MATERIAL_BITS);
+	}
+	else
+	{
+		key |= material << (BUCKET_SHIFT - MATERIAL_BITS);
+		key |= depth << (BUCKET_SHIFT - MATERIAL_BITS - DEPTH_BITS);
+	}
+	return key;
+}
+
+void RenderQueue::sort()
+{
+	const uint numItems = uint(m_items.size());
+	if (numItems < 2)
+		return;
+
+	// Least significant digit first, all histograms are gathered in one pass over the keys
+	uint histograms[NUM_RADIX_PASSES][RADIX_SIZE] = {};
+	for (const Item& item : m_items)
+		for (uint pass = 0; pass < NUM_RADIX_PASSES; ++pass)
+			histograms[pass][(item.key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+
+	m_scratch.resize(numItems);
+	for (uint pass = 0; pass < NUM_RADIX_PASSES; ++pass)
+	{
+		uint* histogram = histograms[pass];
+		const uint shift = pass * RADIX_BITS;
+		// Every key has the same digit, which is common for the unused and the pass bits
+		if (histogram[(m_items[0].key >> shift) & (RADIX_SIZE - 1)] == numItems)
+			continue;
+
+		uint offset = 0;
+		for (uint i = 0; i < RADIX_SIZE; ++i)
+		{
+			const uint count = histogram[i];
+			histogram[i] = offset;
+			offset += count;
+		}
+		for (const Item& item : m_items)
+			m_scratch[histogram[(item.key >> shift) & (RADIX_SIZE - 1)]++] = item;
+		m_items.swap(m_scratch);
+	}
+}
@@ -0,0 +1,43 @@
+#include "Graphics/Utils/RingBufferAllocator.h"
+
+#include <assert.h>
+
+const uint64 RingBufferAllocator::INVALID_OFFSET = 0xFFFFFFFFFFFFFFFFull;
+
+void RingBufferAllocator::initialize(uint64 a_sizeBytes)
+{
+	assert(a_sizeBytes);
+	m_sizeBytes = a_sizeBytes;
+	m_head = 0;
+	m_tail = 0;
+	m_frameEnds.clear();
+}
+
+uint64 RingBufferAllocator::allocate(uint64 a_numBytes, uint64 a_alignment)
+{
+	assert(m_sizeBytes);
+	assert(a_alignment && m_sizeBytes % a_alignment == 0);
+	if (a_numBytes > m_sizeBytes)
+		return INVALID_OFFSET;
+
+	uint64 start = (m_head + a_alignment - 1) / a_alignment * a_alignment;
+	if (start % m_sizeBytes + a_numBytes > m_sizeBytes)
+		start = (start / m_sizeBytes + 1) * m_sizeBytes; // Skip the rest of the ring, the size is aligned so the start is too
+	if (start + a_numBytes - m_tail > m_sizeBytes)
+		return INVALID_OFFSET;
+
+	m_head = start + a_numBytes;
+	return start % m_sizeBytes;
+}
+
+void RingBufferAllocator::endFrame()
+{
+	m_frameEnds.push_back(m_head);
+}
+
+void RingBufferAllocator::releaseOldestFrame()
+{
+	assert(!m_frameEnds.empty());
+	m_tail = m_frameEnds.front();
+	m_frameEnds.erase(m_frameEnds.begin());
+}
@@ -0,0 +1,156 @@
+#include "Graphics/Utils/ShadowCascades.h"
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const float RADIUS_ROUNDING = 16.0f; // Radii are rounded up to 1 / 16th so float noise does not change the texel size
+const float EARLY_REFIT_FRACTION = 0.5f; // A cascade whose part of the view used up this much of the margin may be refitted before it has to
+
+END_UNNAMED_NAMESPACE()
+
+void ShadowCascades::setSettings(const Settings& a_settings)
+{
+	assert(a_settings.numCascades > 0 && a_settings.numCascades <= MAX_CASCADES);
+	m_settings = a_settings;
+	m_settings.numCascades = glm::clamp(m_settings.numCascades, 1u, uint(MAX_CASCADES));
+	m_settings.cacheMargin = glm::max(m_settings.cacheMargin, 1.0f);
+	m_settings.farUpdateInterval = glm::max(m_settings.farUpdateInterval, 1u);
+	for (Cascade& cascade : m_cascades)
+		cascade.radius = 0.0f;
+}
+
+void ShadowCascades::calculateSplits(float a_near, float a_far, uint a_numCascades, float a_lambda, float* a_splits)
+{
+	a_splits[0] = a_near;
+	for (uint i = 1; i < a_numCascades; ++i)
+	{
+		const float fraction = float(i) / float(a_numCascades);
+		const float logarithmic = a_near * glm::pow(a_far / a_near, fraction);
+		const float uniform = a_near + (a_far - a_near) * fraction;
+		a_splits[i] = glm::mix(uniform, logarithmic, a_lambda);
+	}
+	a_splits[a_numCascades] = a_far;
+}
+
+glm::ivec2 ShadowCascades::getAtlasGrid(uint a_numCascades)
+{
+	if (a_numCascades <= 1)
+		return glm::ivec2(1, 1);
+	if (a_numCascades == 2)
+		return glm::ivec2(2, 1);
+	return glm::ivec2(2, 2);
+}
+
+void ShadowCascades::update(const PerspectiveCamera& a_camera, const glm::vec3& a_sunDirection)
+{
+	const uint numCascades = m_settings.numCascades;
+	float splits[MAX_CASCADES + 1];
+	calculateSplits(a_camera.getNear(), glm::min(a_camera.getFar(), m_settings.shadowDistance), numCascades, m_settings.splitLambda, splits);
+
+	// The extent of the view at a distance of 1, like the projection of the camera
+	const glm::vec3 direction = glm::normalize(a_camera.getDirection());
+	const glm::vec3 right = glm::normalize(glm::cross(direction, a_camera.getUp()));
+	const glm::vec3 up = glm::cross(right, direction);
+	const float tanHalfVFov = glm::tan(glm::radians(a_camera.getVFov()) * 0.5f);
+	const float tanHalfHFov = tanHalfVFov * a_camera.getWidth() / a_camera.getHeight();
+
+	// The light space axes only depend on the sun, snapping along them moves the shadow map by whole texels. A new sun moves every cascade
+	const glm::vec3 lightDirection = -glm::normalize(a_sunDirection);
+	const bool sunChanged = lightDirection != m_lightDirection;
+	if (sunChanged)
+	{
+		m_lightDirection = lightDirection;
+		m_worldUp = glm::abs(lightDirection.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+		m_lightRight = glm::normalize(glm::cross(lightDirection, m_worldUp));
+		m_lightUp = glm::cross(m_lightRight, lightDirection);
+	}
+
+	glm::vec3 centers[MAX_CASCADES];
+	float radii[MAX_CASCADES];
+	bool anyRefitted = false;
+	uint earlyRefitIdx = numCascades;
+	float earlyRefitUrgency = EARLY_REFIT_FRACTION;
+	for (uint i = 0; i < numCascades; ++i)
+	{
+		Cascade& cascade = m_cascades[i];
+		cascade.splitNear = splits[i];
+		cascade.splitFar = splits[i + 1];
+
+		glm::vec3 corners[8];
+		glm::vec3 center(0.0f);
+		for (uint j = 0; j < 8; ++j)
+		{
+			const float distance = (j & 4) ? cascade.splitFar : cascade.splitNear;
+			const float x = (j & 1) ? tanHalfHFov : -tanHalfHFov;
+			const float y = (j & 2) ? tanHalfVFov : -tanHalfVFov;
+			corners[j] = a_camera.getPosition() + (direction + right * x + up * y) * distance;
+			center += corners[j] / 8.0f;
+		}
+		float sliceRadius = 0.0f;
+		for (const glm::vec3& corner : corners)
+			sliceRadius = glm::max(sliceRadius, glm::length(corner - center));
+		// The margin, and two texels of padding for snapping to move the center by up to one texel diagonally
+		const float radius = glm::ceil(sliceRadius * m_settings.cacheMargin * (1.0f + 4.0f / float(m_settings.resolution)) * RADIUS_ROUNDING) / RADIUS_ROUNDING;
+		centers[i] = center;
+		radii[i] = radius;
+
+		// The cascade stays in place while the sphere of its part of the view is inside its sphere
+		const float margin = cascade.radius - sliceRadius;
+		const float offset = glm::length(center - cascade.center);
+		if (sunChanged || cascade.radius != radius || offset > margin)
+		{
+			fitCascade(i, center, radius);
+			anyRefitted = true;
+		}
+		else
+		{
+			cascade.renderStatic = m_staticInvalid;
+			if (offset > earlyRefitUrgency * margin)
+			{
+				earlyRefitUrgency = offset / margin;
+				earlyRefitIdx = i;
+			}
+		}
+	}
+	// Refitting a cascade before it has to spreads the static renders of a moving camera over frames
+	if (!anyRefitted && earlyRefitIdx < numCascades)
+		fitCascade(earlyRefitIdx, centers[earlyRefitIdx], radii[earlyRefitIdx]);
+	m_staticInvalid = false;
+
+	// Far cascades update their dynamic casters at a lower rate, staggered so they do not all update in the same frame
+	for (uint i = 0; i < numCascades; ++i)
+	{
+		Cascade& cascade = m_cascades[i];
+		const uint interval = (i < m_settings.numFullRateCascades) ? 1 : m_settings.farUpdateInterval;
+		cascade.renderDynamic = cascade.renderStatic || (m_frame + i) % interval == 0;
+	}
+	m_frame++;
+}
+
+void ShadowCascades::fitCascade(uint a_idx, glm::vec3 a_center, float a_radius)
+{
+	Cascade& cascade = m_cascades[a_idx];
+	const float texelSize = 2.0f * a_radius / float(m_settings.resolution);
+	const float x = glm::dot(a_center, m_lightRight);
+	const float y = glm::dot(a_center, m_lightUp);
+	a_center += m_lightRight * (glm::floor(x / texelSize) * texelSize - x) + m_lightUp * (glm::floor(y / texelSize) * texelSize - y);
+	cascade.center = a_center;
+	cascade.radius = a_radius;
+	cascade.renderStatic = true;
+
+	cascade.camera.initialize(2.0f * a_radius, 2.0f * a_radius, 90.0f, 0.0f, 2.0f * a_radius + m_settings.casterDistance, PerspectiveCamera::EProjection::ORTHOGRAPHIC);
+	cascade.camera.setPosition(a_center - m_lightDirection * (a_radius + m_settings.casterDistance));
+	cascade.camera.lookAtDir(m_lightDirection);
+	cascade.camera.updateMatrices(m_worldUp);
+
+	// From normalized device coordinates to the tile of the cascade and depth from 0 to 1
+	const glm::ivec2 grid = getAtlasGrid(m_settings.numCascades);
+	const glm::vec2 tileScale = 1.0f / glm::vec2(grid);
+	const glm::ivec2 tile(a_idx % grid.x, a_idx / grid.x);
+	glm::mat4 tileMatrix(1.0f);
+	tileMatrix[0][0] = 0.5f * tileScale.x;
+	tileMatrix[1][1] = 0.5f * tileScale.y;
+	tileMatrix[2][2] = 0.5f;
+	tileMatrix[3] = glm::vec4((glm::vec2(tile) + 0.5f) * tileScale, 0.5f, 1.0f);
+	cascade.shadowMatrix = tileMatrix * cascade.camera.getCombinedMatrix();
+	cascade.viewport = glm::ivec4(tile * int(m_settings.resolution), m_settings.resolution, m_settings.resolution);
+}
@@ -0,0 +1,176 @@
+#include "Graphics/Utils/TextureStreamingPolicy.h"
+
+#include "EASTL/algorithm.h"
+
+#include <assert.h>
+
+const TextureStreamingHandle TextureStreamingPolicy::INVALID_HANDLE = 0xFFFFFFFF;
+
+TextureStreamingHandle TextureStreamingPolicy::addTexture(const eastl::vector<uint64>& a_levelByteSizes)
+{
+	assert(!a_levelByteSizes.empty());
+
+	TextureStreamingHandle handle;
+	if (!m_freeHandles.empty())
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+	else
+	{
+		handle = TextureStreamingHandle(m_textures.size());
+		m_textures.push_back();
+	}
+
+	StreamedTexture& texture = m_textures[handle];
+	texture.levelByteSizes = a_levelByteSizes;
+	texture.residentLevel = texture.getCoarsestLevel();
+	texture.wantedLevel = texture.getCoarsestLevel();
+	texture.requestedLevel = uint(a_levelByteSizes.size());
+	texture.lastNeededFrame = m_frameIdx;
+	texture.inUse = true;
+	m_stats.residentBytes += a_levelByteSizes.back();
+	if (m_stats.residentBytes > m_settings.budgetBytes)
+		print("Coarsest texture mip levels exceed the streaming budget of %llu MB\n", m_settings.budgetBytes / 1024 / 1024);
+	return handle;
+}
+
+void TextureStreamingPolicy::removeTexture(TextureStreamingHandle a_handle)
+{
+	StreamedTexture& texture = m_textures[a_handle];
+	assert(texture.inUse);
+	for (uint level = texture.residentLevel; level < texture.levelByteSizes.size(); ++level)
+		m_stats.residentBytes -= texture.levelByteSizes[level];
+	texture = StreamedTexture();
+	m_freeHandles.push_back(a_handle);
+}
+
+void TextureStreamingPolicy::requestLevel(TextureStreamingHandle a_handle, uint a_level)
+{
+	StreamedTexture& texture = m_textures[a_handle];
+	assert(texture.inUse);
+	texture.requestedLevel = eastl::min(texture.requestedLevel, eastl::min(a_level, texture.getCoarsestLevel()));
+}
+
+void TextureStreamingPolicy::update()
+{
+	++m_frameIdx;
+	m_stats.uploadedBytes = 0;
+	m_stats.numMissingLevels = 0;
+
+	// Requests are sticky for a while so textures that go briefly out of view are not evicted and reloaded right away
+	for (StreamedTexture& texture : m_textures)
+	{
+		if (!texture.inUse)
+			continue;
+		if (texture.requestedLevel < texture.levelByteSizes.size())
+		{
+			texture.wantedLevel = texture.requestedLevel;
+			texture.lastNeededFrame = m_frameIdx;
+		}
+		else if (m_frameIdx - texture.lastNeededFrame > m_settings.numKeepFrames)
+		{
+			texture.wantedLevel = texture.getCoarsestLevel();
+		}
+		texture.requestedLevel = uint(texture.levelByteSizes.size());
+	}
+
+	// The budget may have been lowered, give up unneeded levels first and then the needed ones of the least recently needed textures
+	if (m_stats.residentBytes > m_settings.budgetBytes)
+		evictUnneeded(m_stats.residentBytes - m_settings.budgetBytes);
+	while (m_stats.residentBytes > m_settings.budgetBytes)
+	{
+		StreamedTexture* victim = NULL;
+		for (StreamedTexture& texture : m_textures)
+		{
+			if (texture.inUse && texture.residentLevel < texture.getCoarsestLevel() &&
+				(!victim || texture.lastNeededFrame < victim->lastNeededFrame ||
+				(texture.lastNeededFrame == victim->lastNeededFrame && texture.residentLevel < victim->residentLevel)))
+				victim = &texture;
+		}
+		if (!victim)
+			break;
+		m_stats.residentBytes -= victim->levelByteSizes[victim->residentLevel++];
+		m_stats.numEvictions++;
+	}
+
+	// Load one level at a time for the texture missing the most levels, so every texture gets sharper at a similar pace
+	eastl::vector<bool> blocked(m_textures.size(), false);
+	while (true)
+	{
+		StreamedTexture* best = NULL;
+		uint bestIdx = 0;
+		for (uint i = 0; i < m_textures.size(); ++i)
+		{
+			StreamedTexture& texture = m_textures[i];
+			if (!texture.inUse || blocked[i] || texture.wantedLevel >= texture.residentLevel)
+				continue;
+			if (!best)
+			{
+				best = &texture;
+				bestIdx = i;
+				continue;
+			}
+			const uint deficit = texture.residentLevel - texture.wantedLevel;
+			const uint bestDeficit = best->residentLevel - best->wantedLevel;
+			const uint64 cost = texture.levelByteSizes[texture.residentLevel - 1];
+			const uint64 bestCost = best->levelByteSizes[best->residentLevel - 1];
+			if (deficit > bestDeficit || (deficit == bestDeficit && cost < bestCost))
+			{
+				best = &texture;
+				bestIdx = i;
+			}
+		}
+		if (!best)
+			break;
+
+		// Only the newly resident level is uploaded, the levels that already were resident are kept on the GPU
+		const uint64 cost = best->levelByteSizes[best->residentLevel - 1];
+		if (m_stats.uploadedBytes && m_stats.uploadedBytes + cost > m_settings.maxUploadBytesPerFrame)
+			break;
+		if (m_stats.residentBytes + cost > m_settings.budgetBytes && !evictUnneeded(m_stats.residentBytes + cost - m_settings.budgetBytes))
+		{	// Does not fit, a cheaper texture might
+			blocked[bestIdx] = true;
+			continue;
+		}
+
+		best->residentLevel--;
+		m_stats.residentBytes += cost;
+		m_stats.uploadedBytes += cost;
+		m_stats.numLoads++;
+	}
+
+	for (const StreamedTexture& texture : m_textures)
+		if (texture.inUse && texture.wantedLevel < texture.residentLevel)
+			m_stats.numMissingLevels += texture.residentLevel - texture.wantedLevel;
+}
+
+bool TextureStreamingPolicy::evictUnneeded(uint64 a_numBytesNeeded)
+{
+	uint64 numBytesAvailable = 0;
+	for (const StreamedTexture& texture : m_textures)
+		if (texture.inUse)
+			for (uint level = texture.residentLevel; level < texture.wantedLevel; ++level)
+				numBytesAvailable += texture.levelByteSizes[level];
+	if (numBytesAvailable < a_numBytesNeeded)
+		return false;
+
+	uint64 numBytesFreed = 0;
+	while (numBytesFreed < a_numBytesNeeded)
+	{
+		StreamedTexture* victim = NULL;
+		for (StreamedTexture& texture : m_textures)
+		{
+			if (texture.inUse && texture.residentLevel < texture.wantedLevel &&
+				(!victim || texture.lastNeededFrame < victim->lastNeededFrame ||
+				(texture.lastNeededFrame == victim->lastNeededFrame && texture.residentLevel < victim->residentLevel)))
+				victim = &texture;
+		}
+		assert(victim);
+		const uint64 size = victim->levelByteSizes[victim->residentLevel++];
+		numBytesFreed += size;
+		m_stats.residentBytes -= size;
+		m_stats.numEvictions++;
+	}
+	return true;
+}
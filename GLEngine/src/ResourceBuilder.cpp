@@ -1,12 +1,19 @@
 #include "Database/ResourceBuilder.h"
 
+#include "Database/AssetDatabase.h"
+#include "Database/BuildStats.h"
+#include "Utils/DirectoryWatcher.h"
 #include "Utils/FileUtils.h"
+#include "Utils/Stopwatch.h"
 #include "EASTL/algorithm.h"
 
 #include <windows.h>
 
 BEGIN_UNNAMED_NAMESPACE()
 
+const uint WATCH_IDLE_WAIT_MS = 1000;
+const uint WATCH_SETTLE_WAIT_MS = 200;
+
 ResourceProcessor* getResourceProcessorForFile(const eastl::string& a_filePath, const ResourceBuilder::ResourceProcessorMap& a_processors)
 {
 	const eastl::string extension = FileUtils::getExtensionForFilePath(a_filePath);
@@ -17,6 +24,16 @@ ResourceProcessor* getResourceProcessorForFile(const eastl::string& a_filePath,
 		return NULL;
 }
 
+/** A resource depends on the files in its own folder and below it, like the materials and textures of a scene */
+bool isAffectedByChange(const eastl::string& a_resourcePath, const eastl::string& a_changedFilePath)
+{
+	if (a_resourcePath == a_changedFilePath)
+		return true;
+	const eastl::string resourceFolder = FileUtils::getFolderPathForFile(a_resourcePath);
+	const eastl::string changedFolder = FileUtils::getFolderPathForFile(a_changedFilePath);
+	return changedFolder.compare(0, resourceFolder.size(), resourceFolder) == 0;
+}
+
 END_UNNAMED_NAMESPACE()
 
 void ResourceBuilder::buildResourcesDB(const ResourceProcessorMap& a_processors, const eastl::string& a_inDirectoryPath, AssetDatabase& a_assetDatabase)
@@ -25,14 +42,69 @@ void ResourceBuilder::buildResourcesDB(const ResourceProcessorMap& a_processors,
 	{
 		ResourceProcessor* processor = getResourceProcessorForFile(filePath, a_processors);
 		if (processor)
+			buildResource(*processor, filePath, a_assetDatabase);
+	}
+}
+
+void ResourceBuilder::watchResourcesDB(const ResourceProcessorMap& a_processors, const eastl::string& a_inDirectoryPath, AssetDatabase& a_assetDatabase)
+{
+	DirectoryWatcher watcher;
+	if (!watcher.initialize(a_inDirectoryPath))
+		return;
+	print("Watching %s for changes\n", a_inDirectoryPath.c_str());
+
+	eastl::vector<eastl::string> changedFiles;
+	while (true)
+	{
+		bool lostChanges = false;
+		while (changedFiles.empty() && !lostChanges)
+			lostChanges = !watcher.waitForChanges(WATCH_IDLE_WAIT_MS, changedFiles);
+
+		// Editors and exporters touch files several times while saving, wait until it settles
+		uint numChangedFiles;
+		do
+		{
+			numChangedFiles = uint(changedFiles.size());
+			lostChanges |= !watcher.waitForChanges(WATCH_SETTLE_WAIT_MS, changedFiles);
+		} while (numChangedFiles != changedFiles.size());
+
+		for (eastl::string& changedFile : changedFiles)
+			changedFile = a_inDirectoryPath + "\\" + changedFile;
+
+		Stopwatch stopwatch;
+		stopwatch.start();
+		uint numBuilt = 0;
+		for (const eastl::string& filePath : FileUtils::listFiles(a_inDirectoryPath, "*"))
 		{
-			print("Processing: %s\n", filePath.c_str());
-			processor->process(filePath, a_assetDatabase);
-			print("Finished processing %s\n", filePath.c_str());
+			ResourceProcessor* processor = getResourceProcessorForFile(filePath, a_processors);
+			if (!processor)
+				continue;
+			const bool affected = lostChanges || eastl::any_of(changedFiles.begin(), changedFiles.end(),
+				[&](const eastl::string& a_changedFile) { return isAffectedByChange(filePath, a_changedFile); });
+			if (!affected)
+				continue;
+			if (buildResource(*processor, filePath, a_assetDatabase))
+				++numBuilt;
+			else
+				print("Keeping the previous build of %s\n", filePath.c_str());
 		}
+		if (numBuilt)
+			a_assetDatabase.commitUpdate();
+		stopwatch.stop();
+		print("%u changed files, rebuilt %u resources in %.1f ms\n", uint(changedFiles.size()), numBuilt, double(stopwatch.avgMicroSec().count()) / 1000.0);
+		changedFiles.clear();
 	}
 }
 
+bool ResourceBuilder::buildResource(ResourceProcessor& a_processor, const eastl::string& a_filePath, AssetDatabase& a_assetDatabase)
+{
+	print("Processing: %s\n", a_filePath.c_str());
+	BuildStats::ScopedAsset statsAsset(FileUtils::getFileNameFromPath(a_filePath));
+	const bool succeeded = a_processor.process(a_filePath, a_assetDatabase);
+	print("Finished processing %s\n", a_filePath.c_str());
+	return succeeded;
+}
+
 void ResourceBuilder::copyFiles(const eastl::vector<eastl::string>& a_extensions, const eastl::string& a_inDirectoryPath, const eastl::string& a_outDirectoryPath)
 {
 	print("Copying files from %s to %s\n", a_inDirectoryPath.c_str(), a_outDirectoryPath.c_str());
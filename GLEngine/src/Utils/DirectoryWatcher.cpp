@@ -0,0 +1,91 @@
+#include "Utils/DirectoryWatcher.h"
+
+#include "EASTL/algorithm.h"
+
+#include <assert.h>
+#include <Windows.h>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint NOTIFY_BUFFER_SIZE = 64 * 1024;
+const DWORD NOTIFY_FILTER = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+END_UNNAMED_NAMESPACE()
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+	if (m_directory)
+	{
+		// The pending read writes into m_buffer, wait for the cancellation before freeing anything
+		CancelIo(m_directory);
+		DWORD numBytes;
+		GetOverlappedResult(m_directory, m_overlapped, &numBytes, TRUE);
+		CloseHandle(m_directory);
+	}
+	if (m_overlapped)
+	{
+		CloseHandle(m_overlapped->hEvent);
+		SAFE_DELETE(m_overlapped);
+	}
+}
+
+bool DirectoryWatcher::initialize(const eastl::string& a_directoryPath)
+{
+	assert(!m_directory);
+
+	HANDLE directory = CreateFileA(a_directoryPath.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (directory == INVALID_HANDLE_VALUE)
+	{
+		print("Could not watch directory: %s\n", a_directoryPath.c_str());
+		return false;
+	}
+
+	m_directory = directory;
+	m_overlapped = new OVERLAPPED();
+	m_overlapped->hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	m_buffer.resize(NOTIFY_BUFFER_SIZE / sizeof(uint));
+	return startRead();
+}
+
+bool DirectoryWatcher::startRead()
+{
+	ResetEvent(m_overlapped->hEvent);
+	const DWORD bufferSize = DWORD(m_buffer.size() * sizeof(uint));
+	return ReadDirectoryChangesW(m_directory, m_buffer.data(), bufferSize, TRUE, NOTIFY_FILTER, NULL, m_overlapped, NULL) != 0;
+}
+
+bool DirectoryWatcher::waitForChanges(uint a_timeoutMs, eastl::vector<eastl::string>& a_changedFilePaths)
+{
+	assert(m_directory);
+	if (WaitForSingleObject(m_overlapped->hEvent, a_timeoutMs) != WAIT_OBJECT_0)
+		return true;
+
+	DWORD numBytes = 0;
+	// Zero bytes transferred means the notification buffer overflowed
+	const bool complete = GetOverlappedResult(m_directory, m_overlapped, &numBytes, FALSE) && numBytes != 0;
+	if (complete)
+	{
+		const byte* data = rcast<const byte*>(m_buffer.data());
+		while (true)
+		{
+			const FILE_NOTIFY_INFORMATION* info = rcast<const FILE_NOTIFY_INFORMATION*>(data);
+			if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME)
+			{
+				const int numChars = int(info->FileNameLength / sizeof(WCHAR));
+				const int size = WideCharToMultiByte(CP_UTF8, 0, info->FileName, numChars, NULL, 0, NULL, NULL);
+				eastl::string filePath(size, '\0');
+				WideCharToMultiByte(CP_UTF8, 0, info->FileName, numChars, &filePath[0], size, NULL, NULL);
+				if (eastl::find(a_changedFilePaths.begin(), a_changedFilePaths.end(), filePath) == a_changedFilePaths.end())
+					a_changedFilePaths.push_back(filePath);
+			}
+			if (!info->NextEntryOffset)
+				break;
+			data += info->NextEntryOffset;
+		}
+	}
+
+	if (!startRead())
+		print("Failed to continue watching directory\n");
+	return complete;
+}
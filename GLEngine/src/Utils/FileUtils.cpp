@@ -137,6 +137,22 @@ bool FileUtils::fileExists(const eastl::string& a_filePath)
 	return exists;
 }
 
+bool FileUtils::flushFileToDisk(const eastl::string& a_filePath)
+{
+	// Shares writing so the file can be flushed while it is still open elsewhere, the flush covers the writes of every handle
+	HANDLE file = CreateFileA(a_filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	const bool flushed = FlushFileBuffers(file) != 0;
+	CloseHandle(file);
+	return flushed;
+}
+
+bool FileUtils::replaceFile(const eastl::string& a_srcFilePath, const eastl::string& a_dstFilePath)
+{
+	return MoveFileExA(a_srcFilePath.c_str(), a_dstFilePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
 FileTime FileUtils::getCurrentFileTime()
 {
 	SYSTEMTIME st;
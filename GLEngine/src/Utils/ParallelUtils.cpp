@@ -0,0 +1,129 @@
+#include "Utils/ParallelUtils.h"
+
+#include "EASTL/vector.h"
+
+#include <condition_variable>
+#include <mutex>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+typedef void(*TaskFunc)(const void* task, uint taskIdx);
+
+// Set on the workers and on a calling thread while it runs tasks, nested calls run on the thread itself
+thread_local bool t_isRunningTasks = false;
+
+// Of yields a worker looks for a new job before it sleeps, so the jobs of a frame that follow each other do not wait for a wake up
+const uint NUM_SPINS_BEFORE_SLEEP = 2000;
+
+class WorkerPool
+{
+public:
+
+	WorkerPool(uint a_numThreads)
+	{
+		m_threads.reserve(a_numThreads);
+		for (uint i = 0; i < a_numThreads; ++i)
+			m_threads.push_back(std::thread([this]() { workerLoop(); }));
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_shutdown = true;
+		}
+		m_wakeCondition.notify_all();
+		for (std::thread& thread : m_threads)
+			thread.join();
+	}
+
+	void run(uint a_numTasks, TaskFunc a_func, const void* a_task)
+	{
+		// One job at a time, callers on other threads wait for the pool
+		std::lock_guard<std::mutex> runLock(m_runMutex);
+		Job job(a_numTasks, a_func, a_task);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = &job;
+			++m_generation;
+		}
+		m_wakeCondition.notify_all();
+		runJob(job);
+
+		// The job lives on this stack, workers only take it while counted as busy
+		m_job = NULL;
+		while (m_numBusyWorkers)
+			std::this_thread::yield();
+	}
+
+private:
+
+	struct Job
+	{
+		Job(uint a_numTasks, TaskFunc a_func, const void* a_task) : numTasks(a_numTasks), func(a_func), task(a_task), nextTask(0) {}
+		const uint numTasks;
+		const TaskFunc func;
+		const void* const task;
+		std::atomic<uint> nextTask;
+	};
+
+private:
+
+	static void runJob(Job& a_job)
+	{
+		t_isRunningTasks = true;
+		for (uint i = a_job.nextTask++; i < a_job.numTasks; i = a_job.nextTask++)
+			a_job.func(a_job.task, i);
+		t_isRunningTasks = false;
+	}
+
+	void workerLoop()
+	{
+		uint64 seenGeneration = 0;
+		for (;;)
+		{
+			for (uint spin = 0; spin < NUM_SPINS_BEFORE_SLEEP && m_generation == seenGeneration; ++spin)
+				std::this_thread::yield();
+			if (m_generation == seenGeneration)
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wakeCondition.wait(lock, [this, seenGeneration]() { return m_shutdown || m_generation != seenGeneration; });
+				if (m_shutdown)
+					return;
+			}
+
+			++m_numBusyWorkers;
+			seenGeneration = m_generation;
+			if (Job* job = m_job)
+				runJob(*job);
+			--m_numBusyWorkers;
+		}
+	}
+
+private:
+
+	eastl::vector<std::thread> m_threads;
+	std::mutex m_runMutex;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCondition;
+	std::atomic<Job*> m_job{ NULL };
+	std::atomic<uint64> m_generation{ 0 };
+	std::atomic<uint> m_numBusyWorkers{ 0 };
+	bool m_shutdown = false;
+};
+
+END_UNNAMED_NAMESPACE()
+
+void ParallelUtils::runTasks(uint a_numTasks, TaskFunc a_func, const void* a_task)
+{
+	if (t_isRunningTasks || a_numTasks <= 1)
+	{
+		for (uint i = 0; i < a_numTasks; ++i)
+			a_func(a_task, i);
+		return;
+	}
+
+	// The calling thread is the first worker
+	static WorkerPool s_pool(getNumWorkers() - 1);
+	s_pool.run(a_numTasks, a_func, a_task);
+}
@@ -0,0 +1,271 @@
+#include "Tests.h"
+
+#include "TestUtils.h"
+#include "Graphics/Utils/AABBList.h"
+#include "Graphics/Utils/Frustum.h"
+#include "Graphics/Utils/OcclusionBuffer.h"
+#include "Utils/ParallelUtils.h"
+#include "Utils/Stopwatch.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint CULLING_NUM_BOXES = 1000000;
+const uint CULLING_NUM_FRAMES = 20;
+const float CULLING_WORLD_SIZE = 1000.0f;
+const float CULLING_MAX_HALF_SIZE = 5.0f;
+
+const uint OCCLUSION_NUM_BOXES = 20000;
+const uint OCCLUSION_NUM_FRAMES = 60;
+const float OCCLUSION_ROOM_HALF_SIZE = 10.0f;
+const uint OCCLUSION_WALL_SUBDIVISIONS = 16;
+const float OCCLUSION_WALL_DISTANCE = 10.0f;
+const float OCCLUSION_WALL_HALF_SIZE = 8.0f;
+const float OCCLUSION_MAX_HALF_SIZE = 1.0f;
+
+/** Adds a grid of subdivisions x subdivisions quads to the mesh, front facing on the side u x v points to */
+void addOccluderGrid(OcclusionBuffer::OccluderMesh& a_mesh, const glm::vec3& a_corner, const glm::vec3& a_u, const glm::vec3& a_v, uint a_subdivisions)
+{
+	const uint firstVertex = uint(a_mesh.positions.size());
+	for (uint y = 0; y <= a_subdivisions; ++y)
+		for (uint x = 0; x <= a_subdivisions; ++x)
+			a_mesh.positions.push_back(a_corner + a_u * (float(x) / float(a_subdivisions)) + a_v * (float(y) / float(a_subdivisions)));
+
+	for (uint y = 0; y < a_subdivisions; ++y)
+	{
+		for (uint x = 0; x < a_subdivisions; ++x)
+		{
+			const uint corner = firstVertex + y * (a_subdivisions + 1) + x;
+			const uint quad[6] = { corner, corner + 1, corner + a_subdivisions + 2, corner, corner + a_subdivisions + 2, corner + a_subdivisions + 1 };
+			a_mesh.indices.insert(a_mesh.indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+END_UNNAMED_NAMESPACE()
+
+/** Frustum culls CULLING_NUM_BOXES random boxes every frame for CULLING_NUM_FRAMES frames with a camera turning around the origin,
+    one box at a time, with SIMD and with SIMD on all workers. Returns if the SIMD results are the same as the scalar ones */
+bool benchmarkCulling()
+{
+	TestRandom random(12345);
+
+	AABBList boxes;
+	boxes.reserve(CULLING_NUM_BOXES);
+	for (uint i = 0; i < CULLING_NUM_BOXES; ++i)
+	{
+		const glm::vec3 center = (glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) - 0.5f) * CULLING_WORLD_SIZE;
+		const glm::vec3 halfSize = glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) * CULLING_MAX_HALF_SIZE;
+		boxes.add(center, halfSize);
+	}
+
+	Frustum frustum;
+	eastl::vector<uint> scalarMask;
+	eastl::vector<uint> simdMask;
+	eastl::vector<uint> parallelMask;
+	Stopwatch scalarStopwatch(CULLING_NUM_FRAMES);
+	Stopwatch simdStopwatch(CULLING_NUM_FRAMES);
+	Stopwatch parallelStopwatch(CULLING_NUM_FRAMES);
+	bool passed = true;
+	uint numVisible = 0;
+	for (uint frame = 0; frame < CULLING_NUM_FRAMES; ++frame)
+	{
+		const float angle = glm::radians(360.0f * float(frame) / float(CULLING_NUM_FRAMES));
+		const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f), glm::vec3(glm::cos(angle), 0.0f, glm::sin(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+		frustum.calculateFrustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, CULLING_WORLD_SIZE * 0.5f) * viewMatrix);
+
+		scalarStopwatch.start();
+		frustum.aabbsInFrustumScalar(boxes, scalarMask);
+		scalarStopwatch.stop();
+
+		simdStopwatch.start();
+		frustum.aabbsInFrustum(boxes, simdMask);
+		simdStopwatch.stop();
+
+		parallelStopwatch.start();
+		frustum.aabbsInFrustum(boxes, parallelMask, true);
+		parallelStopwatch.stop();
+
+		for (uint i = 0; i < CULLING_NUM_BOXES && passed; ++i)
+		{
+			const bool visible = frustum.aabbInFrustum(boxes.getCenter(i), boxes.getHalfSize(i));
+			if (Frustum::isVisible(scalarMask, i) != visible || Frustum::isVisible(simdMask, i) != visible || Frustum::isVisible(parallelMask, i) != visible)
+			{
+				print("Frame %u: box %u culled differently than by aabbInFrustum\n", frame, i);
+				passed = false;
+			}
+			numVisible += visible;
+		}
+	}
+
+	print("Culling: %u boxes, %.1f%% visible, scalar %.3f ms, SIMD %.3f ms, SIMD on %u workers %.3f ms per frame\n", CULLING_NUM_BOXES,
+		100.0 * double(numVisible) / double(uint64(CULLING_NUM_BOXES) * CULLING_NUM_FRAMES), double(scalarStopwatch.avgMicroSec().count()) / 1000.0,
+		double(simdStopwatch.avgMicroSec().count()) / 1000.0, ParallelUtils::getNumWorkers(), double(parallelStopwatch.avgMicroSec().count()) / 1000.0);
+	return reportTest("Culling test", passed);
+}
+
+/** Occlusion culls boxes in two scenes for OCCLUSION_NUM_FRAMES frames. Inside a closed room turning around, every box outside the room should be culled
+    and none inside. In front of a wall with the camera moving sideways, boxes that are hidden are known exactly from where the rays to their corners hit the wall plane.
+    Returns if no box that can be seen was culled */
+bool testOcclusionCulling()
+{
+	TestRandom random(12345);
+	const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 200.0f);
+
+	OcclusionBuffer occlusionBuffer;
+	occlusionBuffer.initialize(OcclusionBuffer::Settings());
+	Frustum frustum;
+	eastl::vector<uint> visibilityMask;
+	Stopwatch rasterizeStopwatch(OCCLUSION_NUM_FRAMES * 2);
+	Stopwatch testStopwatch(OCCLUSION_NUM_FRAMES * 2);
+	bool passed = true;
+
+	// Room with its walls facing inwards, boxes are either completely inside or completely outside with some space to the walls
+	const float roomSize = OCCLUSION_ROOM_HALF_SIZE;
+	OcclusionBuffer::OccluderMesh room;
+	for (uint axis = 0; axis < 3; ++axis)
+	{
+		glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+		normal[axis] = 1.0f;
+		u[(axis + 1) % 3] = 2.0f * roomSize;
+		v[(axis + 2) % 3] = 2.0f * roomSize;
+		const glm::vec3 corner = -(u + v) * 0.5f;
+		addOccluderGrid(room, corner - normal * roomSize, u, v, OCCLUSION_WALL_SUBDIVISIONS);
+		addOccluderGrid(room, corner + normal * roomSize, v, u, OCCLUSION_WALL_SUBDIVISIONS);
+	}
+
+	AABBList roomBoxes;
+	eastl::vector<bool> insideRoom;
+	for (uint i = 0; i < OCCLUSION_NUM_BOXES; ++i)
+	{
+		const glm::vec3 halfSize = glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) * OCCLUSION_MAX_HALF_SIZE + 0.01f;
+		const bool inside = i % 2 == 0;
+		glm::vec3 center;
+		do
+			center = (glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) - 0.5f) * roomSize * (inside ? 2.0f : 6.0f);
+		while (inside ? glm::any(glm::greaterThan(glm::abs(center) + halfSize, glm::vec3(roomSize - 0.5f)))
+			: !glm::any(glm::greaterThan(glm::abs(center) - halfSize, glm::vec3(roomSize + 0.5f))));
+		roomBoxes.add(center, halfSize);
+		insideRoom.push_back(inside);
+	}
+
+	uint numOutsideInFrustum = 0;
+	uint numOutsideCulled = 0;
+	for (uint frame = 0; frame < OCCLUSION_NUM_FRAMES && passed; ++frame)
+	{
+		const float angle = glm::radians(360.0f * float(frame) / float(OCCLUSION_NUM_FRAMES));
+		const glm::vec3 position(glm::sin(angle) * roomSize * 0.5f, 0.0f, 0.0f);
+		const glm::vec3 direction(glm::cos(angle), glm::sin(angle * 3.0f) * 0.5f, glm::sin(angle));
+		const glm::mat4 viewProjection = projection * glm::lookAt(position, position + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+		frustum.calculateFrustum(viewProjection);
+		frustum.aabbsInFrustum(roomBoxes, visibilityMask);
+		const eastl::vector<uint> frustumMask = visibilityMask;
+
+		rasterizeStopwatch.start();
+		occlusionBuffer.beginFrame(viewProjection);
+		occlusionBuffer.addOccluder(room, glm::mat4(1.0f), 1.0f);
+		occlusionBuffer.rasterizeOccluders();
+		rasterizeStopwatch.stop();
+
+		testStopwatch.start();
+		occlusionBuffer.cullOccluded(roomBoxes, visibilityMask);
+		testStopwatch.stop();
+
+		for (uint i = 0; i < OCCLUSION_NUM_BOXES; ++i)
+		{
+			if (!Frustum::isVisible(frustumMask, i))
+				continue;
+			if (!insideRoom[i])
+			{
+				numOutsideInFrustum++;
+				numOutsideCulled += !Frustum::isVisible(visibilityMask, i);
+			}
+			else if (!Frustum::isVisible(visibilityMask, i))
+			{
+				print("Room frame %u: box %u inside the room was culled\n", frame, i);
+				passed = false;
+				break;
+			}
+		}
+	}
+
+	// Wall facing the camera, which looks down -z from z = 0
+	const float wallDistance = OCCLUSION_WALL_DISTANCE;
+	const float wallSize = OCCLUSION_WALL_HALF_SIZE;
+	OcclusionBuffer::OccluderMesh wall;
+	addOccluderGrid(wall, glm::vec3(-wallSize, -wallSize, -wallDistance), glm::vec3(2.0f * wallSize, 0.0f, 0.0f), glm::vec3(0.0f, 2.0f * wallSize, 0.0f), OCCLUSION_WALL_SUBDIVISIONS);
+
+	AABBList wallBoxes;
+	for (uint i = 0; i < OCCLUSION_NUM_BOXES; ++i)
+	{
+		const glm::vec3 halfSize = glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) * OCCLUSION_MAX_HALF_SIZE + 0.01f;
+		const float depth = i % 4 == 0 ? 1.0f + random.nextFloat() * (wallDistance - 2.0f) : wallDistance + 1.0f + random.nextFloat() * 30.0f;
+		const glm::vec2 side = (glm::vec2(random.nextFloat(), random.nextFloat()) - 0.5f) * wallSize * 4.0f * depth / wallDistance;
+		wallBoxes.add(glm::vec3(side, -depth - OCCLUSION_MAX_HALF_SIZE), halfSize);
+	}
+
+	uint numWallOnScreen = 0;
+	uint numWallHidden = 0;
+	uint numWallCulled = 0;
+	for (uint frame = 0; frame < OCCLUSION_NUM_FRAMES && passed; ++frame)
+	{
+		const float angle = glm::radians(360.0f * float(frame) / float(OCCLUSION_NUM_FRAMES));
+		const glm::vec3 position(glm::cos(angle) * wallSize * 0.5f, glm::sin(angle) * wallSize * 0.5f, 0.0f);
+		const glm::mat4 viewProjection = projection * glm::lookAt(position, position - glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		frustum.calculateFrustum(viewProjection);
+		frustum.aabbsInFrustum(wallBoxes, visibilityMask);
+
+		rasterizeStopwatch.start();
+		occlusionBuffer.beginFrame(viewProjection);
+		occlusionBuffer.addOccluder(wall, glm::mat4(1.0f), 1.0f);
+		occlusionBuffer.rasterizeOccluders();
+		rasterizeStopwatch.stop();
+
+		const eastl::vector<uint> frustumMask = visibilityMask;
+		testStopwatch.start();
+		occlusionBuffer.cullOccluded(wallBoxes, visibilityMask);
+		testStopwatch.stop();
+
+		for (uint i = 0; i < OCCLUSION_NUM_BOXES; ++i)
+		{
+			if (!Frustum::isVisible(frustumMask, i))
+				continue;
+
+			// Hidden when it is behind the wall and the ray from the camera to every corner hits the wall.
+			// Only checked for boxes completely on screen, what peeks out behind the wall might be off screen
+			bool onScreen = true;
+			bool hidden = true;
+			for (uint corner = 0; corner < 8; ++corner)
+			{
+				const glm::vec3 offset((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+				const glm::vec3 point = wallBoxes.getCenter(i) + wallBoxes.getHalfSize(i) * offset;
+				const glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+				onScreen = onScreen && glm::abs(clip.x) <= clip.w && glm::abs(clip.y) <= clip.w;
+				const float depth = -point.z;
+				const glm::vec2 hit = glm::vec2(position) + (glm::vec2(point) - glm::vec2(position)) * (wallDistance / depth);
+				hidden = hidden && depth > wallDistance && glm::abs(hit.x) <= wallSize && glm::abs(hit.y) <= wallSize;
+			}
+			if (!onScreen)
+				continue;
+			numWallOnScreen++;
+			numWallHidden += hidden;
+			numWallCulled += !Frustum::isVisible(visibilityMask, i);
+			if (!hidden && !Frustum::isVisible(visibilityMask, i))
+			{
+				print("Wall frame %u: box %u that can be seen was culled\n", frame, i);
+				passed = false;
+				break;
+			}
+		}
+	}
+
+	print("Occlusion room: %.1f%% of %u boxes outside the room in the frustum culled\n", 100.0 * double(numOutsideCulled) / double(glm::max(numOutsideInFrustum, 1u)), numOutsideInFrustum);
+	print("Occlusion wall: %.1f%% of %u boxes on screen culled, %.1f%% are hidden\n", 100.0 * double(numWallCulled) / double(glm::max(numWallOnScreen, 1u)),
+		numWallOnScreen, 100.0 * double(numWallHidden) / double(glm::max(numWallOnScreen, 1u)));
+	print("Occlusion: %ux%u buffer, rasterize %.3f ms, test %.3f ms per frame\n", occlusionBuffer.getWidth(0), occlusionBuffer.getHeight(0),
+		double(rasterizeStopwatch.avgMicroSec().count()) / 1000.0, double(testStopwatch.avgMicroSec().count()) / 1000.0);
+	return reportTest("Occlusion test", passed);
+}
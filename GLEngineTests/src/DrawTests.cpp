@@ -0,0 +1,239 @@
+#include "Tests.h"
+
+#include "TestUtils.h"
+#include "Graphics/Utils/DrawCommandBuffer.h"
+#include "Graphics/Utils/RenderQueue.h"
+#include "Graphics/Utils/RingBufferAllocator.h"
+#include "Utils/Stopwatch.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/sort.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint DRAW_COMMANDS_NUM_TRANSFORMS = 25000;
+const uint DRAW_COMMANDS_MESHES_PER_TRANSFORM = 4;
+const uint DRAW_COMMANDS_NUM_BUCKETS = 7;
+const uint DRAW_COMMANDS_INDICES_PER_MESH = 300;
+
+const uint RENDER_QUEUE_NUM_ITEMS = 100000;
+const uint RENDER_QUEUE_NUM_FRAMES = 100;
+const uint RENDER_QUEUE_NUM_SHADERS = 16;
+const uint RENDER_QUEUE_NUM_MATERIALS = 1000;
+
+const uint64 RING_BUFFER_SIZE = 64 * 1024;
+const uint RING_BUFFER_GPU_LATENCY_FRAMES = 2;
+const uint RING_BUFFER_NUM_FRAMES = 1000;
+const uint RING_BUFFER_MAX_ALLOCATIONS_PER_FRAME = 40;
+const uint RING_BUFFER_MAX_ALLOCATION_SIZE = 2048;
+
+END_UNNAMED_NAMESPACE()
+
+/** Fills a draw command buffer the way GLScene does, with the buckets interleaved, and checks the commands that would be uploaded.
+    Returns if all checks passed */
+bool testDrawCommands()
+{
+	DrawCommandBuffer drawCommands;
+	Stopwatch stopwatch;
+	stopwatch.start();
+	for (uint i = 0; i < DRAW_COMMANDS_NUM_TRANSFORMS; ++i)
+	{
+		const glm::mat4 modelMatrix = glm::mat4(float(i));
+		const uint transformIdx = drawCommands.addTransform(modelMatrix, modelMatrix);
+		for (uint j = 0; j < DRAW_COMMANDS_MESHES_PER_TRANSFORM; ++j)
+		{
+			const uint meshIdx = i * DRAW_COMMANDS_MESHES_PER_TRANSFORM + j;
+			const uint64 key = RenderQueue::makeKey(RenderQueue::EPass::SOLID, meshIdx % DRAW_COMMANDS_NUM_BUCKETS, 0, 0.0f);
+			drawCommands.addDraw(key, DRAW_COMMANDS_INDICES_PER_MESH, meshIdx * DRAW_COMMANDS_INDICES_PER_MESH, int(meshIdx), transformIdx);
+		}
+	}
+	drawCommands.finish();
+	stopwatch.stop();
+
+	bool passed = true;
+	const uint numDraws = DRAW_COMMANDS_NUM_TRANSFORMS * DRAW_COMMANDS_MESHES_PER_TRANSFORM;
+	const eastl::vector<DrawCommand>& commands = drawCommands.getCommands();
+	const eastl::vector<DrawCommandBuffer::Bucket>& buckets = drawCommands.getBuckets();
+	if (commands.size() != numDraws || drawCommands.getTransforms().size() != DRAW_COMMANDS_NUM_TRANSFORMS || buckets.size() != DRAW_COMMANDS_NUM_BUCKETS)
+	{
+		print("%u commands, %u transforms and %u buckets, expected %u, %u and %u\n", uint(commands.size()), uint(drawCommands.getTransforms().size()),
+			uint(buckets.size()), numDraws, DRAW_COMMANDS_NUM_TRANSFORMS, DRAW_COMMANDS_NUM_BUCKETS);
+		return false;
+	}
+
+	uint nextCommand = 0;
+	for (uint i = 0; i < buckets.size(); ++i)
+	{
+		const DrawCommandBuffer::Bucket& bucket = buckets[i];
+		if (bucket.key != i || bucket.firstCommand != nextCommand)
+		{
+			print("Bucket %u has key %llu and starts at %u, expected key %u at %u\n", i, bucket.key, bucket.firstCommand, i, nextCommand);
+			passed = false;
+		}
+		nextCommand = bucket.firstCommand + bucket.numCommands;
+
+		// Every command has to belong to the bucket, keep its order and point at the transform of its mesh
+		uint prevMeshIdx = 0;
+		for (uint j = bucket.firstCommand; j < nextCommand && j < commands.size(); ++j)
+		{
+			const DrawCommand& command = commands[j];
+			const uint meshIdx = uint(command.baseVertex);
+			const bool valid = meshIdx % DRAW_COMMANDS_NUM_BUCKETS == bucket.key && (j == bucket.firstCommand || meshIdx > prevMeshIdx) &&
+				command.count == DRAW_COMMANDS_INDICES_PER_MESH && command.firstIndex == meshIdx * DRAW_COMMANDS_INDICES_PER_MESH &&
+				command.instanceCount == 1 && command.baseInstance == meshIdx / DRAW_COMMANDS_MESHES_PER_TRANSFORM &&
+				drawCommands.getTransforms()[command.baseInstance].modelMatrix[0][0] == float(command.baseInstance);
+			if (!valid)
+			{
+				print("Command %u of bucket %u is wrong\n", j, i);
+				passed = false;
+				break;
+			}
+			prevMeshIdx = meshIdx;
+		}
+	}
+	if (nextCommand != numDraws)
+	{
+		print("Buckets cover %u of %u commands\n", nextCommand, numDraws);
+		passed = false;
+	}
+
+	print("Draw commands: %u draws in %u buckets built in %.2f ms\n", numDraws, uint(buckets.size()), double(stopwatch.avgMicroSec().count()) / 1000.0);
+	return reportTest("Draw command test", passed);
+}
+
+/** Sorts RENDER_QUEUE_NUM_ITEMS random draws every frame for RENDER_QUEUE_NUM_FRAMES frames with the radix sort of the render queue
+    and with a comparison sort, and checks the radix sort result is ordered and stable. Returns if the check passed */
+bool benchmarkRenderQueue()
+{
+	TestRandom random(12345);
+
+	RenderQueue queue;
+	eastl::vector<RenderQueue::Item> items;
+	Stopwatch radixStopwatch(RENDER_QUEUE_NUM_FRAMES);
+	Stopwatch comparisonStopwatch(RENDER_QUEUE_NUM_FRAMES);
+	bool passed = true;
+	for (uint frame = 0; frame < RENDER_QUEUE_NUM_FRAMES; ++frame)
+	{
+		items.clear();
+		for (uint i = 0; i < RENDER_QUEUE_NUM_ITEMS; ++i)
+		{
+			const RenderQueue::EPass pass = RenderQueue::EPass(random.next() % uint(RenderQueue::EPass::COUNT));
+			const float depth = float(random.next() % 10000) / 10000.0f;
+			const RenderQueue::Item item = { RenderQueue::makeKey(pass, random.next() % RENDER_QUEUE_NUM_SHADERS, random.next() % RENDER_QUEUE_NUM_MATERIALS, depth), i };
+			items.push_back(item);
+		}
+
+		queue.clear();
+		radixStopwatch.start();
+		for (const RenderQueue::Item& item : items)
+			queue.add(item.key, item.index);
+		queue.sort();
+		radixStopwatch.stop();
+
+		comparisonStopwatch.start();
+		eastl::sort(items.begin(), items.end(), [](const RenderQueue::Item& a, const RenderQueue::Item& b) { return a.key < b.key; });
+		comparisonStopwatch.stop();
+
+		const eastl::vector<RenderQueue::Item>& sorted = queue.getItems();
+		for (uint i = 1; i < sorted.size() && passed; ++i)
+		{
+			const RenderQueue::Item& prev = sorted[i - 1];
+			if (prev.key > sorted[i].key || (prev.key == sorted[i].key && prev.index > sorted[i].index))
+			{
+				print("Frame %u: item %u is out of order\n", frame, i);
+				passed = false;
+			}
+		}
+	}
+
+	print("Render queue: %u items, radix sort %.3f ms, comparison sort %.3f ms per frame\n", RENDER_QUEUE_NUM_ITEMS,
+		double(radixStopwatch.avgMicroSec().count()) / 1000.0, double(comparisonStopwatch.avgMicroSec().count()) / 1000.0);
+	return reportTest("Render queue test", passed);
+}
+
+/** Runs the ring buffer allocator with a simulated GPU that finishes frames a few frames late, the way GLRingBuffer uses it.
+    Checks that ranges are aligned, never wrap and never overlap ranges of frames the GPU may still read. Returns if all checks passed */
+bool testRingBufferAllocator()
+{
+	struct Range
+	{
+		uint64 offset;
+		uint64 numBytes;
+		uint frameIdx;
+	};
+
+	RingBufferAllocator allocator;
+	allocator.initialize(RING_BUFFER_SIZE);
+	const uint64 alignments[] = { 16, 64, 256 };
+	eastl::vector<Range> liveRanges;
+	uint firstLiveFrame = 0;
+	TestRandom random(12345);
+
+	bool passed = true;
+	uint numAllocations = 0;
+	uint numWaits = 0;
+	uint64 peakUsedBytes = 0;
+	for (uint frame = 0; frame < RING_BUFFER_NUM_FRAMES && passed; ++frame)
+	{
+		const uint numFrameAllocations = random.next() % RING_BUFFER_MAX_ALLOCATIONS_PER_FRAME;
+		for (uint i = 0; i < numFrameAllocations && passed; ++i)
+		{
+			const uint64 numBytes = 1 + random.next() % RING_BUFFER_MAX_ALLOCATION_SIZE;
+			const uint64 alignment = alignments[random.next() % ARRAY_SIZE(alignments)];
+			uint64 offset = allocator.allocate(numBytes, alignment);
+			while (offset == RingBufferAllocator::INVALID_OFFSET && allocator.getNumFramesInFlight())
+			{	// Wait for the GPU like GLRingBuffer does
+				allocator.releaseOldestFrame();
+				firstLiveFrame++;
+				numWaits++;
+				offset = allocator.allocate(numBytes, alignment);
+			}
+			if (offset == RingBufferAllocator::INVALID_OFFSET)
+			{
+				print("Frame %u: %llu bytes did not fit with only the current frame in use\n", frame, numBytes);
+				passed = false;
+				break;
+			}
+
+			while (!liveRanges.empty() && liveRanges.front().frameIdx < firstLiveFrame)
+				liveRanges.erase(liveRanges.begin());
+			if (offset % alignment != 0 || offset + numBytes > RING_BUFFER_SIZE)
+			{
+				print("Frame %u: range %llu + %llu is not aligned to %llu or wraps\n", frame, offset, numBytes, alignment);
+				passed = false;
+			}
+			for (const Range& range : liveRanges)
+			{
+				if (offset < range.offset + range.numBytes && range.offset < offset + numBytes)
+				{
+					print("Frame %u: range %llu + %llu overlaps range %llu + %llu of frame %u\n", frame, offset, numBytes, range.offset, range.numBytes, range.frameIdx);
+					passed = false;
+					break;
+				}
+			}
+			const Range range = { offset, numBytes, frame };
+			liveRanges.push_back(range);
+			peakUsedBytes = eastl::max(peakUsedBytes, allocator.getUsedBytes());
+			numAllocations++;
+		}
+
+		allocator.endFrame();
+		while (allocator.getNumFramesInFlight() > RING_BUFFER_GPU_LATENCY_FRAMES)
+		{
+			allocator.releaseOldestFrame();
+			firstLiveFrame++;
+		}
+	}
+
+	if (peakUsedBytes > RING_BUFFER_SIZE)
+	{
+		print("%llu bytes in use, more than the ring holds\n", peakUsedBytes);
+		passed = false;
+	}
+
+	print("Ring buffer: %u allocations over %u frames, %u waits for the GPU, peak %llu of %llu bytes\n", numAllocations, RING_BUFFER_NUM_FRAMES,
+		numWaits, peakUsedBytes, RING_BUFFER_SIZE);
+	return reportTest("Ring buffer test", passed);
+}
@@ -0,0 +1,219 @@
+#include "Tests.h"
+
+#include "TestUtils.h"
+#include "Graphics/Utils/PassTimings.h"
+#include "Graphics/Utils/QualityGovernor.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/vector.h"
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <glm/glm.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const float QUALITY_GOVERNOR_LEVEL_COSTS[] = { 1.0f, 0.85f, 0.7f, 0.56f, 0.44f, 0.33f, 0.25f };
+const uint QUALITY_GOVERNOR_START_LEVEL = 1;
+const uint QUALITY_GOVERNOR_GPU_LATENCY_FRAMES = 3; // Frames until the timer queries of a frame are read back
+const uint QUALITY_GOVERNOR_WARMUP_FRAMES = 1000;   // Before the level has to be settled
+
+const uint PASS_TIMINGS_NUM_SAMPLES = 100;
+const char* const PASS_TIMINGS_REPORT_PATH = "pass-timings-test.json";
+
+END_UNNAMED_NAMESPACE()
+
+/** Runs the quality governor on synthetic frame times: constant heavy and light loads, load steps, noise with spikes, a CPU bound
+    load and a level that costs more than estimated. Checks that it settles on a level that fits, reacts to steps quickly, does not
+    flip between levels on noise or wrong estimates and leaves CPU bound frames alone. Returns if all checks passed */
+bool testQualityGovernor()
+{
+	struct Result
+	{
+		uint finalLevel;
+		uint numChangesAfterWarmup;
+		uint numFramesOver; // After the warmup
+		float averageGPUMs; // After the warmup
+		QualityGovernor::Stats stats;
+		eastl::vector<uint> levels; // Of every frame
+	};
+
+	eastl::vector<QualityGovernor::QualityLevel> levels;
+	for (float cost : QUALITY_GOVERNOR_LEVEL_COSTS)
+		levels.push_back({ 1.0f, 2, 2048, 5, cost });
+	const QualityGovernor::Settings settings;
+	const float targetMs = settings.targetFrameMs;
+
+	TestRandom random(12345);
+	// The GPU time of a frame is the load at the best level times the cost of the level, the GPU times arrive a few frames late
+	auto simulate = [&](uint a_numFrames, std::function<float(uint)> a_gpuLoadMs, float a_cpuMs, float a_noise, float a_spikeChance, const float* a_actualCosts)
+	{
+		QualityGovernor governor;
+		governor.initialize(settings, levels, QUALITY_GOVERNOR_START_LEVEL);
+		Result result = {};
+		eastl::vector<float> gpuTimes;
+		double totalGPUMs = 0.0;
+		for (uint frame = 0; frame < a_numFrames; ++frame)
+		{
+			float gpuMs = a_gpuLoadMs(frame) * a_actualCosts[governor.getLevel()] * (1.0f + a_noise * (random.nextFloat() * 2.0f - 1.0f));
+			if (random.nextFloat() < a_spikeChance)
+				gpuMs *= 3.0f;
+			gpuTimes.push_back(gpuMs);
+			result.levels.push_back(governor.getLevel());
+			if (frame >= QUALITY_GOVERNOR_WARMUP_FRAMES)
+			{
+				result.numFramesOver += gpuMs > targetMs * (1.0f + settings.downgradeMargin) ? 1 : 0;
+				totalGPUMs += gpuMs;
+			}
+
+			const float measuredMs = frame >= QUALITY_GOVERNOR_GPU_LATENCY_FRAMES ? gpuTimes[frame - QUALITY_GOVERNOR_GPU_LATENCY_FRAMES] : -1.0f;
+			if (governor.update(measuredMs, a_cpuMs) && frame >= QUALITY_GOVERNOR_WARMUP_FRAMES)
+				result.numChangesAfterWarmup++;
+		}
+		result.finalLevel = governor.getLevel();
+		result.averageGPUMs = float(totalGPUMs / double(a_numFrames - QUALITY_GOVERNOR_WARMUP_FRAMES));
+		result.stats = governor.getStats();
+		return result;
+	};
+	auto printResult = [](const char* a_name, const Result& a_result, uint a_numFrames)
+	{
+		print("%-12s level %u, %3u down %3u up (%u undone), %u changes after warmup, %5.1f%% of frames over the target, average %5.2f ms\n",
+			a_name, a_result.finalLevel, a_result.stats.numDowngrades, a_result.stats.numUpgrades, a_result.stats.numUndoneUpgrades,
+			a_result.numChangesAfterWarmup, 100.0f * float(a_result.numFramesOver) / float(a_numFrames - QUALITY_GOVERNOR_WARMUP_FRAMES), a_result.averageGPUMs);
+	};
+	// The best level that fits under the target
+	auto getFittingLevel = [&](float a_loadMs)
+	{
+		uint level = 0;
+		while (level + 1 < levels.size() && a_loadMs * QUALITY_GOVERNOR_LEVEL_COSTS[level] > targetMs)
+			++level;
+		return level;
+	};
+
+	bool passed = true;
+
+	const float heavyLoadMs = 28.0f;
+	const Result heavy = simulate(5000, [heavyLoadMs](uint) { return heavyLoadMs; }, 5.0f, 0.1f, 0.0f, QUALITY_GOVERNOR_LEVEL_COSTS);
+	printResult("Heavy", heavy, 5000);
+	check(passed, heavy.finalLevel == getFittingLevel(heavyLoadMs), "Heavy load: did not settle on the best level that fits");
+	check(passed, heavy.numChangesAfterWarmup == 0, "Heavy load: the level changed after settling");
+	check(passed, heavy.averageGPUMs < targetMs, "Heavy load: frames take longer than the target");
+
+	const Result light = simulate(5000, [](uint) { return 8.0f; }, 5.0f, 0.1f, 0.0f, QUALITY_GOVERNOR_LEVEL_COSTS);
+	printResult("Light", light, 5000);
+	check(passed, light.finalLevel == 0 && light.numChangesAfterWarmup == 0, "Light load: did not settle on the best level");
+
+	// The load steps up and back down, the quality has to drop quickly and rise again afterwards
+	const uint stepFrames = 2000;
+	const Result step = simulate(3 * stepFrames, [stepFrames, heavyLoadMs](uint a_frame) { return a_frame >= stepFrames && a_frame < 2 * stepFrames ? heavyLoadMs : 12.0f; },
+		5.0f, 0.1f, 0.0f, QUALITY_GOVERNOR_LEVEL_COSTS);
+	printResult("Step", step, 3 * stepFrames);
+	uint framesToDowngrade = 0;
+	while (framesToDowngrade < stepFrames && step.levels[stepFrames + framesToDowngrade] == step.levels[stepFrames - 1])
+		++framesToDowngrade;
+	uint framesToFit = 0;
+	while (framesToFit < stepFrames && step.levels[stepFrames + framesToFit] < getFittingLevel(heavyLoadMs))
+		++framesToFit;
+	print("Step: first downgrade after %u frames, fitting level after %u frames\n", framesToDowngrade, framesToFit);
+	check(passed, framesToDowngrade <= QUALITY_GOVERNOR_GPU_LATENCY_FRAMES + 2 * settings.downgradeFrames, "Step: reacted too slowly to the load step");
+	check(passed, framesToFit <= 200, "Step: took too long to reach a level that fits");
+	check(passed, step.finalLevel == getFittingLevel(12.0f), "Step: did not return to the best level after the load dropped");
+
+	// Noise and single frame spikes must not make the level flip
+	const Result noisy = simulate(10000, [](uint) { return 25.0f; }, 5.0f, 0.3f, 0.02f, QUALITY_GOVERNOR_LEVEL_COSTS);
+	printResult("Noisy", noisy, 10000);
+	check(passed, noisy.numChangesAfterWarmup <= 4, "Noisy load: the level changed too often");
+
+	// Frames the CPU holds up do not get faster at a lower quality
+	const Result cpuBound = simulate(5000, [](uint) { return 18.0f; }, 25.0f, 0.1f, 0.0f, QUALITY_GOVERNOR_LEVEL_COSTS);
+	printResult("CPU bound", cpuBound, 5000);
+	check(passed, cpuBound.stats.numDowngrades == 0 && cpuBound.finalLevel == QUALITY_GOVERNOR_START_LEVEL, "CPU bound: changed the level of CPU bound frames");
+
+	// The level above the fitting one costs more than estimated, so every upgrade to it is undone
+	float wrongCosts[ARRAY_SIZE(QUALITY_GOVERNOR_LEVEL_COSTS)];
+	for (uint i = 0; i < ARRAY_SIZE(QUALITY_GOVERNOR_LEVEL_COSTS); ++i)
+		wrongCosts[i] = QUALITY_GOVERNOR_LEVEL_COSTS[i];
+	wrongCosts[2] = 0.85f;
+	const uint wrongCostFrames = 20000;
+	const Result wrongCost = simulate(wrongCostFrames, [](uint) { return 21.0f; }, 5.0f, 0.05f, 0.0f, wrongCosts);
+	printResult("Wrong cost", wrongCost, wrongCostFrames);
+	const uint maxUpgrades = uint(glm::log2(float(settings.maxUpgradeFrames) / float(settings.upgradeFrames))) + 2 + wrongCostFrames / settings.maxUpgradeFrames;
+	check(passed, wrongCost.stats.numUndoneUpgrades > 0 && wrongCost.stats.numUpgrades <= maxUpgrades, "Wrong cost: upgrades that had to be undone were repeated too often");
+
+	return reportTest("Quality governor test", passed);
+}
+
+/** Feeds synthetic pass times to the pass timings. Checks the statistics and percentiles of a known distribution, that only the
+    last frames count, that passes are found by name and the report holds every pass. Returns if all checks passed */
+bool testPassTimings()
+{
+	bool passed = true;
+	PassTimings timings;
+	timings.initialize(PASS_TIMINGS_NUM_SAMPLES);
+	const uint shadowsIdx = timings.getPassIndex("Shadows");
+	const uint modelsIdx = timings.getPassIndex("Models");
+	const uint emptyIdx = timings.getPassIndex("Empty");
+	// Passes are found by the contents of their name, not by the pointer
+	char shadowsName[] = "Shadows";
+	check(passed, timings.getPassIndex(shadowsName) == shadowsIdx && timings.getNumPasses() == 3, "A pass was added twice");
+	check(passed, modelsIdx != shadowsIdx && emptyIdx != modelsIdx, "Two passes share an index");
+
+	// A shuffled 1 to 100 ms, so every percentile is the sample with its rank
+	TestRandom random(12345);
+	eastl::vector<float> samples;
+	for (uint i = 1; i <= PASS_TIMINGS_NUM_SAMPLES; ++i)
+		samples.push_back(float(i));
+	for (uint i = uint(samples.size()) - 1; i > 0; --i)
+		eastl::swap(samples[i], samples[random.next() % (i + 1)]);
+	for (float ms : samples)
+		timings.addSample(shadowsIdx, ms);
+	// Few samples, the percentiles round up to the next sample
+	const float modelsSamples[] = { 5.0f, 2.0f, 7.0f, 1.0f, 4.0f, 3.0f, 6.0f };
+	for (float ms : modelsSamples)
+		timings.addSample(modelsIdx, ms);
+
+	eastl::vector<PassTimings::PassStats> stats;
+	timings.getStats(stats);
+	const PassTimings::PassStats& shadows = stats[shadowsIdx];
+	print("Shadows: avg %.2f p50 %.2f p95 %.2f p99 %.2f min %.2f max %.2f\n", shadows.averageMs, shadows.p50Ms, shadows.p95Ms, shadows.p99Ms, shadows.minMs, shadows.maxMs);
+	check(passed, shadows.numSamples == PASS_TIMINGS_NUM_SAMPLES && shadows.lastMs == samples.back(), "Shadows: wrong number of samples or last sample");
+	check(passed, glm::abs(shadows.averageMs - 50.5f) < 0.001f, "Shadows: wrong average");
+	check(passed, shadows.minMs == 1.0f && shadows.maxMs == 100.0f, "Shadows: wrong min or max");
+	check(passed, shadows.p50Ms == 50.0f && shadows.p95Ms == 95.0f && shadows.p99Ms == 99.0f, "Shadows: wrong percentiles");
+	const PassTimings::PassStats& models = stats[modelsIdx];
+	check(passed, models.numSamples == ARRAY_SIZE(modelsSamples) && models.averageMs == 4.0f && models.lastMs == 6.0f, "Models: wrong average or last sample");
+	check(passed, models.p50Ms == 4.0f && models.p95Ms == 7.0f && models.p99Ms == 7.0f, "Models: wrong percentiles of few samples");
+	const PassTimings::PassStats& empty = stats[emptyIdx];
+	check(passed, empty.numSamples == 0 && empty.averageMs == 0.0f && empty.maxMs == 0.0f, "Empty: a pass without samples has statistics");
+
+	// Only the last frames count, the old samples leave the window one by one
+	const uint numNewSamples = PASS_TIMINGS_NUM_SAMPLES / 2;
+	for (uint i = 0; i < numNewSamples; ++i)
+		timings.addSample(shadowsIdx, 200.0f);
+	float expectedTotalMs = 200.0f * numNewSamples;
+	for (uint i = numNewSamples; i < samples.size(); ++i)
+		expectedTotalMs += samples[i];
+	timings.getStats(stats);
+	const PassTimings::PassStats& halfReplaced = stats[shadowsIdx];
+	check(passed, halfReplaced.numSamples == PASS_TIMINGS_NUM_SAMPLES && halfReplaced.lastMs == 200.0f, "Rolling: wrong number of samples or last sample");
+	check(passed, glm::abs(halfReplaced.averageMs - expectedTotalMs / PASS_TIMINGS_NUM_SAMPLES) < 0.001f, "Rolling: the average is not of the last samples");
+	check(passed, halfReplaced.maxMs == 200.0f && halfReplaced.p50Ms < 200.0f && halfReplaced.p99Ms == 200.0f, "Rolling: wrong percentiles of the last samples");
+	for (uint i = 0; i < PASS_TIMINGS_NUM_SAMPLES + 7; ++i)
+		timings.addSample(shadowsIdx, 200.0f);
+	timings.getStats(stats);
+	const PassTimings::PassStats& replaced = stats[shadowsIdx];
+	check(passed, replaced.minMs == 200.0f && replaced.averageMs == 200.0f, "Rolling: old samples are still in the window");
+
+	check(passed, timings.writeReport(PASS_TIMINGS_REPORT_PATH), "The report could not be written");
+	std::ifstream report(PASS_TIMINGS_REPORT_PATH);
+	const std::string reportText((std::istreambuf_iterator<char>(report)), std::istreambuf_iterator<char>());
+	check(passed, reportText.find("\"Shadows\"") != std::string::npos && reportText.find("\"p95Ms\"") != std::string::npos, "The report misses a pass or a statistic");
+	report.close();
+	remove(PASS_TIMINGS_REPORT_PATH);
+
+	timings.clearSamples();
+	timings.getStats(stats);
+	check(passed, timings.getNumPasses() == 3 && stats[shadowsIdx].numSamples == 0, "Clearing the samples did not keep the passes or kept samples");
+
+	return reportTest("Pass timings test", passed);
+}
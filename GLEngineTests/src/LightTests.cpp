@@ -0,0 +1,454 @@
+#include "Tests.h"
+
+#include "TestUtils.h"
+#include "Graphics/Utils/LightClusterBuilder.h"
+#include "Graphics/Utils/LightManager.h"
+#include "Graphics/Utils/PerspectiveCamera.h"
+#include "Utils/ParallelUtils.h"
+#include "Utils/Stopwatch.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint LIGHT_CLUSTERS_NUM_LIGHTS[] = { 1000, 10000, 50000 };
+const uint LIGHT_CLUSTERS_NUM_REFERENCE_LIGHTS = 1000; // Checking against the reference is slow, it tests every light for every cluster
+const uint LIGHT_CLUSTERS_NUM_FRAMES = 20;
+const float LIGHT_CLUSTERS_WORLD_SIZE = 200.0f;
+const float LIGHT_CLUSTERS_MIN_RANGE = 0.5f;
+const float LIGHT_CLUSTERS_MAX_RANGE = 8.0f;
+const uint LIGHT_CLUSTERS_SAMPLED_LIGHT_STRIDE = 7;
+const uint LIGHT_CLUSTERS_SAMPLES_PER_LIGHT = 16;
+const float LIGHT_CLUSTERS_CHANGED_FRACTIONS[] = { 0.001f, 0.01f, 0.1f }; // Of the lights that move or change range every frame of the update benchmark
+const float LIGHT_CLUSTERS_MAX_MOVE = 2.0f;
+const float LIGHT_CLUSTERS_MOVING_CAMERA_CHANGED_FRACTION = 0.01f;
+const float LIGHT_CLUSTERS_CAMERA_TURN_PER_FRAME = 0.5f; // Degrees, 30 per second at 60 fps
+const float LIGHT_CLUSTERS_CAMERA_MOVE_PER_FRAME = 0.1f; // 6 units per second at 60 fps
+const float LIGHT_CLUSTERS_SPOT_FRACTION = 0.5f; // Of the lights that are spot lights
+const float LIGHT_CLUSTERS_MIN_SPOT_ANGLE = 15.0f;
+const float LIGHT_CLUSTERS_MAX_SPOT_ANGLE = 60.0f;
+
+const uint LIGHT_MANAGER_MAX_LIGHTS = 5000;
+const uint LIGHT_MANAGER_NUM_OPERATIONS = 200000;
+const uint LIGHT_MANAGER_CHECK_INTERVAL = 1000; // Operations between checking every light and stale handle
+
+END_UNNAMED_NAMESPACE()
+
+/** Bins random lights into the clusters of a 1080p camera that turns around, LIGHT_CLUSTERS_NUM_FRAMES frames for every count in LIGHT_CLUSTERS_NUM_LIGHTS.
+    Every frame the parallel and the single threaded build have to match the one light and one cluster at a time reference exactly, and points sampled
+    inside the lights, and inside the cone of spot lights, have to find the light in the cluster the shaders look up for them. Prints the lights
+    per cluster without the refinement, with the spot lights treated as point lights and with the cone test. Returns if all checks passed */
+bool benchmarkLightClusters()
+{
+	TestRandom random(12345);
+	auto randomDirection = [&random]()
+	{
+		glm::vec3 direction;
+		do
+			direction = glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) * 2.0f - 1.0f;
+		while (glm::length(direction) > 1.0f || glm::length(direction) < 0.1f);
+		return glm::normalize(direction);
+	};
+
+	PerspectiveCamera camera;
+	camera.initialize(1920.0f, 1080.0f, 90.0f, 0.1f, 1000.0f);
+	camera.setPosition(glm::vec3(0.0f, 0.0f, 0.0f));
+	camera.updateMatrices();
+
+	LightClusterBuilder builder;
+	LightClusterBuilder referenceBuilder;
+	builder.initialize(camera, 1920, 1080, 64, 64);
+	referenceBuilder.initialize(camera, 1920, 1080, 64, 64);
+
+	bool passed = true;
+	for (uint numLights : LIGHT_CLUSTERS_NUM_LIGHTS)
+	{
+		eastl::vector<glm::vec4> lights(numLights);
+		eastl::vector<glm::vec4> directionAngles(numLights);
+		for (uint i = 0; i < numLights; ++i)
+		{
+			const glm::vec3 position = (glm::vec3(random.nextFloat(), random.nextFloat() * 0.1f, random.nextFloat()) - glm::vec3(0.5f, 0.05f, 0.5f)) * LIGHT_CLUSTERS_WORLD_SIZE;
+			lights[i] = glm::vec4(position, glm::mix(LIGHT_CLUSTERS_MIN_RANGE, LIGHT_CLUSTERS_MAX_RANGE, random.nextFloat()));
+			const bool spot = random.nextFloat() < LIGHT_CLUSTERS_SPOT_FRACTION;
+			const float spotAngle = glm::mix(LIGHT_CLUSTERS_MIN_SPOT_ANGLE, LIGHT_CLUSTERS_MAX_SPOT_ANGLE, random.nextFloat());
+			directionAngles[i] = glm::vec4(randomDirection(), spot ? glm::cos(glm::radians(spotAngle)) : -1.0f);
+		}
+
+		Stopwatch singleStopwatch(LIGHT_CLUSTERS_NUM_FRAMES);
+		Stopwatch parallelStopwatch(LIGHT_CLUSTERS_NUM_FRAMES);
+		Stopwatch unrefinedStopwatch(LIGHT_CLUSTERS_NUM_FRAMES);
+		uint64 numIndices = 0;
+		uint64 numUnrefinedIndices = 0;
+		uint64 numPointIndices = 0;
+		double sumAvgLights = 0.0;
+		double sumUnrefinedAvgLights = 0.0;
+		uint maxLights = 0;
+		uint maxUnrefinedLights = 0;
+		for (uint frame = 0; frame < LIGHT_CLUSTERS_NUM_FRAMES && passed; ++frame)
+		{
+			const float angle = glm::radians(360.0f * float(frame) / float(LIGHT_CLUSTERS_NUM_FRAMES));
+			camera.lookAtDir(glm::normalize(glm::vec3(glm::cos(angle), -0.1f, glm::sin(angle))));
+			camera.updateMatrices();
+
+			builder.setRefinementEnabled(false);
+			unrefinedStopwatch.start();
+			builder.build(camera, lights.data(), directionAngles.data(), numLights, true);
+			unrefinedStopwatch.stop();
+			const LightClusterBuilder::Stats unrefinedStats = builder.getStats();
+			numUnrefinedIndices += unrefinedStats.numIndices;
+			sumUnrefinedAvgLights += unrefinedStats.avgLightsPerOccupiedCluster;
+			maxUnrefinedLights = glm::max(maxUnrefinedLights, unrefinedStats.maxLightsPerCluster);
+
+			builder.setRefinementEnabled(true);
+			builder.build(camera, lights.data(), NULL, numLights, true);
+			numPointIndices += builder.getStats().numIndices;
+
+			singleStopwatch.start();
+			builder.build(camera, lights.data(), directionAngles.data(), numLights, false);
+			singleStopwatch.stop();
+			const eastl::vector<glm::uvec2> singleRanges = builder.getClusterRanges();
+			const eastl::vector<uint> singleIndices = builder.getLightIndices();
+
+			parallelStopwatch.start();
+			builder.build(camera, lights.data(), directionAngles.data(), numLights, true);
+			parallelStopwatch.stop();
+			const LightClusterBuilder::Stats stats = builder.getStats();
+			numIndices += stats.numIndices;
+			sumAvgLights += stats.avgLightsPerOccupiedCluster;
+			maxLights = glm::max(maxLights, stats.maxLightsPerCluster);
+
+			if (singleRanges != builder.getClusterRanges() || singleIndices != builder.getLightIndices())
+			{
+				print("%u lights, frame %u: the single threaded and the parallel build differ\n", numLights, frame);
+				passed = false;
+			}
+			if (numLights <= LIGHT_CLUSTERS_NUM_REFERENCE_LIGHTS)
+			{
+				referenceBuilder.buildReference(camera, lights.data(), directionAngles.data(), numLights);
+				if (referenceBuilder.getClusterRanges() != builder.getClusterRanges() || referenceBuilder.getLightIndices() != builder.getLightIndices())
+				{
+					print("%u lights, frame %u: the build differs from the reference, %u instead of %u indices\n", numLights, frame,
+						uint(builder.getLightIndices().size()), uint(referenceBuilder.getLightIndices().size()));
+					passed = false;
+				}
+			}
+
+			// Look up points lit by the lights like the shaders do, every one that lands in a cluster has to find its light there
+			const glm::mat4& projection = camera.getProjectionMatrix();
+			for (uint i = 0; i < numLights && passed; i += LIGHT_CLUSTERS_SAMPLED_LIGHT_STRIDE)
+			{
+				const glm::vec4& light = builder.getLightPositionRangesViewSpace()[i];
+				const glm::vec4& directionAngle = builder.getLightDirectionAnglesViewSpace()[i];
+				for (uint sample = 0; sample < LIGHT_CLUSTERS_SAMPLES_PER_LIGHT; ++sample)
+				{
+					const glm::vec3 offset = glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) * 2.0f - 1.0f;
+					if (glm::length(offset) > 0.99f || glm::length(offset) < 0.01f)
+						continue;
+					if (glm::dot(glm::normalize(offset), glm::vec3(directionAngle)) < directionAngle.w)
+						continue;
+					const glm::vec3 point = glm::vec3(light) + offset * light.w;
+					const glm::vec4 clip = projection * glm::vec4(point, 1.0f);
+					const glm::vec2 pixel = (glm::vec2(clip) / clip.w * 0.5f + 0.5f) * glm::vec2(1920.0f, 1080.0f);
+					if (point.z > -camera.getNear() || pixel.x < 0.0f || pixel.y < 0.0f || pixel.x >= 1920.0f || pixel.y >= 1080.0f)
+						continue;
+					const int slice = int(glm::log(-point.z * builder.getRecNear()) * builder.getRecLogSD1());
+					if (slice >= int(builder.getGridDepth()))
+						continue;
+					const uint clusterIdx = (uint(pixel.x) / 64 * builder.getGridHeight() + uint(pixel.y) / 64) * builder.getGridDepth() + uint(slice);
+					const glm::uvec2 range = builder.getClusterRanges()[clusterIdx];
+					const uint* indices = builder.getLightIndices().data();
+					if (eastl::find(indices + range.x, indices + range.y, i) == indices + range.y)
+					{
+						print("%u lights, frame %u: light %u is missing in cluster %u of a point inside it\n", numLights, frame, i, clusterIdx);
+						passed = false;
+						break;
+					}
+				}
+			}
+		}
+
+		print("Light clusters: %u lights in %u clusters, unrefined %.0f indices, %.1f average %u max lights per occupied cluster, %.3f ms per frame\n",
+			numLights, builder.getGridSize(), double(numUnrefinedIndices) / double(LIGHT_CLUSTERS_NUM_FRAMES), sumUnrefinedAvgLights / double(LIGHT_CLUSTERS_NUM_FRAMES),
+			maxUnrefinedLights, double(unrefinedStopwatch.avgMicroSec().count()) / 1000.0);
+		print("Light clusters: %u lights, %.0f%% spot lights, %.0f indices with the spot lights as point lights\n", numLights, 100.0f * LIGHT_CLUSTERS_SPOT_FRACTION,
+			double(numPointIndices) / double(LIGHT_CLUSTERS_NUM_FRAMES));
+		print("Light clusters: %u lights refined %.0f indices, %.1f average %u max lights per occupied cluster, single thread %.3f ms, %u workers %.3f ms per frame\n",
+			numLights, double(numIndices) / double(LIGHT_CLUSTERS_NUM_FRAMES), sumAvgLights / double(LIGHT_CLUSTERS_NUM_FRAMES), maxLights,
+			double(singleStopwatch.avgMicroSec().count()) / 1000.0, ParallelUtils::getNumWorkers(), double(parallelStopwatch.avgMicroSec().count()) / 1000.0);
+	}
+	return reportTest("Light clusters test", passed);
+}
+
+/** Moves, or turns the spot light of, LIGHT_CLUSTERS_CHANGED_FRACTIONS of random lights every frame in front of a camera that stands still and compares updating the clusters
+    with building them again, for every count in LIGHT_CLUSTERS_NUM_LIGHTS. Then the camera moves and turns every frame while LIGHT_CLUSTERS_MOVING_CAMERA_CHANGED_FRACTION
+    of the lights change, which has to build everything again like changing the projection. Lights are also added and removed like the LightManager does.
+    The updated lists have to match the built ones exactly. Returns if all checks passed */
+bool benchmarkLightClusterUpdates()
+{
+	TestRandom random(54321);
+	auto randomLight = [&]()
+	{
+		const glm::vec3 position = (glm::vec3(random.nextFloat(), random.nextFloat() * 0.1f, random.nextFloat()) - glm::vec3(0.5f, 0.05f, 0.5f)) * LIGHT_CLUSTERS_WORLD_SIZE;
+		return glm::vec4(position, glm::mix(LIGHT_CLUSTERS_MIN_RANGE, LIGHT_CLUSTERS_MAX_RANGE, random.nextFloat()));
+	};
+	auto randomDirectionAngle = [&]()
+	{
+		const glm::vec3 direction = glm::normalize(glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) - 0.5f + glm::vec3(0.0f, 0.0f, 0.01f));
+		const float spotAngle = glm::mix(LIGHT_CLUSTERS_MIN_SPOT_ANGLE, LIGHT_CLUSTERS_MAX_SPOT_ANGLE, random.nextFloat());
+		return glm::vec4(direction, random.nextFloat() < LIGHT_CLUSTERS_SPOT_FRACTION ? glm::cos(glm::radians(spotAngle)) : -1.0f);
+	};
+
+	PerspectiveCamera camera;
+	camera.initialize(1920.0f, 1080.0f, 90.0f, 0.1f, 1000.0f);
+	camera.setPosition(glm::vec3(0.0f, 0.0f, 0.0f));
+	float angle = 0.0f;
+	camera.lookAtDir(glm::normalize(glm::vec3(glm::cos(angle), -0.1f, glm::sin(angle))));
+	camera.updateMatrices();
+
+	LightClusterBuilder updater;
+	LightClusterBuilder builder;
+	updater.initialize(camera, 1920, 1080, 64, 64);
+	builder.initialize(camera, 1920, 1080, 64, 64);
+
+	bool passed = true;
+	auto checkLists = [&](const char* a_what, uint a_numLights)
+	{
+		if (updater.getClusterRanges() != builder.getClusterRanges() || updater.getLightIndices() != builder.getLightIndices()
+			|| updater.getLightPositionRangesViewSpace() != builder.getLightPositionRangesViewSpace())
+		{
+			print("%u lights, %s: the updated clusters differ from the built ones\n", a_numLights, a_what);
+			passed = false;
+		}
+	};
+	auto check = [&](const char* a_what, uint a_numLights, uint a_expectedUpdated)
+	{
+		checkLists(a_what, a_numLights);
+		if (updater.getNumUpdatedLights() != a_expectedUpdated)
+		{
+			print("%u lights, %s: %u lights updated instead of %u\n", a_numLights, a_what, updater.getNumUpdatedLights(), a_expectedUpdated);
+			passed = false;
+		}
+	};
+
+	for (uint numLights : LIGHT_CLUSTERS_NUM_LIGHTS)
+	{
+		eastl::vector<glm::vec4> lights(numLights);
+		eastl::vector<glm::vec4> directionAngles(numLights);
+		for (uint i = 0; i < numLights; ++i)
+		{
+			lights[i] = randomLight();
+			directionAngles[i] = randomDirectionAngle();
+		}
+		updater.update(camera, lights.data(), directionAngles.data(), numLights);
+		builder.build(camera, lights.data(), directionAngles.data(), numLights);
+		check("new lights", numLights, numLights);
+
+		// Strided so no light changes twice and the update sees exactly numChanged lights
+		auto changeLights = [&](uint a_numChanged)
+		{
+			const uint first = uint(random.nextFloat() * float(numLights));
+			const uint stride = numLights / a_numChanged;
+			for (uint i = 0; i < a_numChanged; ++i)
+			{
+				const uint lightIdx = (first + i * stride) % numLights;
+				glm::vec4& light = lights[lightIdx];
+				if (i % 4 == 0)
+					light.w = glm::mix(LIGHT_CLUSTERS_MIN_RANGE, LIGHT_CLUSTERS_MAX_RANGE, random.nextFloat());
+				else if (i % 4 == 1)
+					directionAngles[lightIdx] = randomDirectionAngle();
+				else
+					light += glm::vec4((glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) - 0.5f) * 2.0f * LIGHT_CLUSTERS_MAX_MOVE, 0.0f);
+			}
+		};
+
+		for (float fraction : LIGHT_CLUSTERS_CHANGED_FRACTIONS)
+		{
+			const uint numChanged = glm::max(uint(float(numLights) * fraction), 1u);
+			Stopwatch updateStopwatch(LIGHT_CLUSTERS_NUM_FRAMES);
+			Stopwatch buildStopwatch(LIGHT_CLUSTERS_NUM_FRAMES);
+			uint numUpdated = 0;
+			for (uint frame = 0; frame < LIGHT_CLUSTERS_NUM_FRAMES && passed; ++frame)
+			{
+				changeLights(numChanged);
+				updateStopwatch.start();
+				updater.update(camera, lights.data(), directionAngles.data(), numLights);
+				updateStopwatch.stop();
+				buildStopwatch.start();
+				builder.build(camera, lights.data(), directionAngles.data(), numLights);
+				buildStopwatch.stop();
+				numUpdated += updater.getNumUpdatedLights();
+				check("moving lights", numLights, numChanged);
+			}
+			print("Light cluster updates: %u of %u lights changed, %u updated per frame, update %.3f ms, build %.3f ms per frame\n", numChanged, numLights,
+				numUpdated / LIGHT_CLUSTERS_NUM_FRAMES, double(updateStopwatch.avgMicroSec().count()) / 1000.0, double(buildStopwatch.avgMicroSec().count()) / 1000.0);
+		}
+
+		// Nothing changed, then a light is added and one removed by moving the last into its place
+		updater.update(camera, lights.data(), directionAngles.data(), numLights);
+		builder.build(camera, lights.data(), directionAngles.data(), numLights);
+		check("nothing changed", numLights, 0);
+		lights.push_back(randomLight());
+		directionAngles.push_back(randomDirectionAngle());
+		updater.update(camera, lights.data(), directionAngles.data(), numLights + 1);
+		builder.build(camera, lights.data(), directionAngles.data(), numLights + 1);
+		check("added light", numLights, 1);
+		lights[numLights / 2] = lights.back();
+		lights.pop_back();
+		directionAngles[numLights / 2] = directionAngles.back();
+		directionAngles.pop_back();
+		updater.update(camera, lights.data(), directionAngles.data(), numLights);
+		builder.build(camera, lights.data(), directionAngles.data(), numLights);
+		check("removed light", numLights, 2);
+
+		// Every light moves relative to the clusters of a moving camera, so every frame builds everything and the update costs what a build does
+		{
+			const uint numChanged = glm::max(uint(float(numLights) * LIGHT_CLUSTERS_MOVING_CAMERA_CHANGED_FRACTION), 1u);
+			Stopwatch updateStopwatch(LIGHT_CLUSTERS_NUM_FRAMES);
+			Stopwatch buildStopwatch(LIGHT_CLUSTERS_NUM_FRAMES);
+			for (uint frame = 0; frame < LIGHT_CLUSTERS_NUM_FRAMES && passed; ++frame)
+			{
+				angle += glm::radians(LIGHT_CLUSTERS_CAMERA_TURN_PER_FRAME);
+				camera.setPosition(camera.getPosition() + camera.getDirection() * LIGHT_CLUSTERS_CAMERA_MOVE_PER_FRAME);
+				camera.lookAtDir(glm::normalize(glm::vec3(glm::cos(angle), -0.1f, glm::sin(angle))));
+				camera.updateMatrices();
+				changeLights(numChanged);
+				updateStopwatch.start();
+				updater.update(camera, lights.data(), directionAngles.data(), numLights);
+				updateStopwatch.stop();
+				buildStopwatch.start();
+				builder.build(camera, lights.data(), directionAngles.data(), numLights);
+				buildStopwatch.stop();
+				check("moving camera", numLights, numLights);
+			}
+			print("Light cluster updates: moving camera, %u of %u lights changed, update %.3f ms, build %.3f ms per frame\n", numChanged, numLights,
+				double(updateStopwatch.avgMicroSec().count()) / 1000.0, double(buildStopwatch.avgMicroSec().count()) / 1000.0);
+		}
+
+		// Changing the projection changes the clusters themselves
+		camera.setHorizontalFieldOfView(80.0f);
+		camera.updateMatrices();
+		updater.update(camera, lights.data(), directionAngles.data(), numLights);
+		builder.build(camera, lights.data(), directionAngles.data(), numLights);
+		check("changed projection", numLights, numLights);
+		camera.setHorizontalFieldOfView(90.0f);
+		camera.updateMatrices();
+	}
+	return reportTest("Light cluster update test", passed);
+}
+
+/** Creates, changes and deletes random lights through their handles, up to LIGHT_MANAGER_MAX_LIGHTS at a time.
+    Every handle has to keep finding its own light while deletes move others around, handles of deleted lights have to be invalid
+    and deleting them again must not change anything. Changed lights have to be inside the dirty ranges. Returns if all checks passed */
+bool testLightManager()
+{
+	struct Light
+	{
+		LightHandle handle;
+		glm::vec4 positionRange;
+		glm::vec4 colorIntensity;
+	};
+
+	TestRandom random(12345);
+	auto randomVec3 = [&random]() { return glm::vec3(random.nextFloat(), random.nextFloat(), random.nextFloat()) * 100.0f + 0.01f; };
+
+	LightManager lightManager;
+	eastl::vector<Light> lights;
+	eastl::vector<LightHandle> deletedHandles;
+	bool passed = true;
+	auto checkDirty = [&](const LightManager::DirtyRange& a_range, const glm::vec4* a_values, const glm::vec4& a_value, uint a_operation)
+	{
+		for (uint i = a_range.begin; i < glm::min(a_range.end, lightManager.getNumLights()); ++i)
+			if (a_values[i] == a_value)
+				return;
+		print("Operation %u: a changed light is outside the dirty range %u to %u\n", a_operation, a_range.begin, a_range.end);
+		passed = false;
+	};
+
+	uint numCreated = 0;
+	uint numDeleted = 0;
+	for (uint operation = 0; operation < LIGHT_MANAGER_NUM_OPERATIONS && passed; ++operation)
+	{
+		const float choice = random.nextFloat();
+		if (lights.empty() || (choice < 0.35f && lights.size() < LIGHT_MANAGER_MAX_LIGHTS))
+		{
+			Light light;
+			light.positionRange = glm::vec4(randomVec3(), random.nextFloat() * 8.0f);
+			const glm::vec3 color = randomVec3();
+			light.colorIntensity = glm::vec4(glm::normalize(color), random.nextFloat());
+			light.handle = lightManager.createLight(glm::vec3(light.positionRange), light.positionRange.w, color, light.colorIntensity.w);
+			lights.push_back(light);
+			numCreated++;
+		}
+		else if (choice < 0.6f)
+		{
+			const uint idx = uint(random.nextFloat() * float(lights.size())) % uint(lights.size());
+			lightManager.deleteLight(lights[idx].handle);
+			deletedHandles.push_back(lights[idx].handle);
+			lights[idx] = lights.back();
+			lights.pop_back();
+			numDeleted++;
+		}
+		else if (choice < 0.7f)
+		{
+			// Deleting a stale handle again must not delete the light that took over its slot
+			const uint numLights = lightManager.getNumLights();
+			if (!deletedHandles.empty())
+				lightManager.deleteLight(deletedHandles[uint(random.nextFloat() * float(deletedHandles.size())) % uint(deletedHandles.size())]);
+			if (lightManager.getNumLights() != numLights)
+			{
+				print("Operation %u: deleting a stale handle deleted a light\n", operation);
+				passed = false;
+			}
+		}
+		else if (choice < 0.85f)
+		{
+			Light& light = lights[uint(random.nextFloat() * float(lights.size())) % uint(lights.size())];
+			light.positionRange = glm::vec4(randomVec3(), light.positionRange.w);
+			lightManager.setLightPosition(light.handle, glm::vec3(light.positionRange));
+			checkDirty(lightManager.getDirtyPositionRanges(), lightManager.getLightPositionRanges(), light.positionRange, operation);
+		}
+		else
+		{
+			Light& light = lights[uint(random.nextFloat() * float(lights.size())) % uint(lights.size())];
+			light.colorIntensity.w = random.nextFloat() * 2.0f;
+			lightManager.setLightIntensity(light.handle, light.colorIntensity.w);
+			checkDirty(lightManager.getDirtyColorIntensities(), lightManager.getLightColorIntensities(), light.colorIntensity, operation);
+		}
+
+		if (operation % LIGHT_MANAGER_CHECK_INTERVAL == 0)
+		{
+			if (lightManager.getNumLights() != lights.size())
+			{
+				print("Operation %u: %u lights instead of %u\n", operation, lightManager.getNumLights(), uint(lights.size()));
+				passed = false;
+			}
+			for (const Light& light : lights)
+			{
+				if (!lightManager.isValid(light.handle) || lightManager.getLightPosition(light.handle) != glm::vec3(light.positionRange)
+					|| lightManager.getLightRange(light.handle) != light.positionRange.w || lightManager.getLightColor(light.handle) != glm::vec3(light.colorIntensity)
+					|| lightManager.getLightIntensity(light.handle) != light.colorIntensity.w)
+				{
+					print("Operation %u: handle %x does not find its light\n", operation, light.handle);
+					passed = false;
+					break;
+				}
+			}
+			for (LightHandle handle : deletedHandles)
+			{
+				if (lightManager.isValid(handle))
+				{
+					print("Operation %u: deleted handle %x is still valid\n", operation, handle);
+					passed = false;
+					break;
+				}
+			}
+			lightManager.clearDirtyRanges();
+		}
+	}
+
+	print("Light manager: %u lights created, %u deleted, %u left\n", numCreated, numDeleted, lightManager.getNumLights());
+	return reportTest("Light manager test", passed);
+}
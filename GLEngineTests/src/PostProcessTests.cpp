@@ -0,0 +1,370 @@
+#include "Tests.h"
+
+#include "TestUtils.h"
+#include "Graphics/Utils/PerspectiveCamera.h"
+#include "EASTL/vector.h"
+
+#include <functional>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint BLOOM_IMAGE_SIZE = 1024;                  // Of the simulated scene, wide enough that the widest glow fits
+const uint BLOOM_DEFAULT_NUM_LEVELS = 5;             // Bloom::DEFAULT_NUM_LEVELS
+const uint BLOOM_NUM_LEVELS[] = { 3, 4, 5, 6, 7 };
+const uint BLOOM_RESOLUTIONS[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+const float BLOOM_ENERGY_FRACTIONS[] = { 0.9f, 0.99f }; // Of the glow inside the radius that is compared
+// Of Blur/gaussianblur.frag, bilinear taps on both sides of the center
+const float BLOOM_GAUSSIAN_WEIGHTS[] = { 0.10855f, 0.13135f, 0.10406f, 0.07216f, 0.04380f, 0.02328f, 0.01083f, 0.00441f, 0.00157f };
+const float BLOOM_GAUSSIAN_OFFSETS[] = { 0.66293f, 2.47904f, 4.46232f, 6.44568f, 8.42917f, 10.41281f, 12.39664f, 14.38070f, 16.36501f };
+
+const uint HBAO_REPROJECTION_WIDTH = 320; // Of the ambient occlusion, half of 640x360
+const uint HBAO_REPROJECTION_HEIGHT = 180;
+const uint HBAO_REPROJECTION_NUM_FRAMES = 120;
+const float HBAO_REPROJECTION_DEPTH_TOLERANCE = 0.05f;   // TEMPORAL_DEPTH_TOLERANCE of HBAO
+const float HBAO_REPROJECTION_MAX_WRONG_HISTORY = 0.01f; // Of the pixels that keep their history, kept although hidden the frame before
+const float HBAO_REPROJECTION_MAX_DROPPED = 0.03f;       // Of the pixels visible the frame before, dropped at edges by the unfiltered depth
+
+END_UNNAMED_NAMESPACE()
+
+/** Runs both bloom methods on the CPU like their shaders on the glow of a single bright pixel and compares the radius that holds most of
+    the glow, then estimates the bytes every pass reads and writes for BLOOM_RESOLUTIONS. The pyramid with BLOOM_DEFAULT_NUM_LEVELS has to
+    glow at least as wide as the gaussian blur and move fewer bytes. Returns if all checks passed */
+bool benchmarkBloom()
+{
+	struct Image
+	{
+		uint width;
+		uint height;
+		eastl::vector<float> texels;
+	};
+	auto makeImage = [](uint a_width, uint a_height)
+	{
+		Image image;
+		image.width = a_width;
+		image.height = a_height;
+		image.texels.resize(a_width * a_height, 0.0f);
+		return image;
+	};
+	// Bilinear with the edges clamped, like the samplers of the render targets
+	auto sample = [](const Image& a_image, float a_u, float a_v)
+	{
+		const float x = a_u * float(a_image.width) - 0.5f;
+		const float y = a_v * float(a_image.height) - 0.5f;
+		const float fx = glm::floor(x);
+		const float fy = glm::floor(y);
+		auto texel = [&a_image](int a_x, int a_y)
+		{
+			a_x = glm::clamp(a_x, 0, int(a_image.width) - 1);
+			a_y = glm::clamp(a_y, 0, int(a_image.height) - 1);
+			return a_image.texels[a_y * a_image.width + a_x];
+		};
+		const float tx = x - fx;
+		const float ty = y - fy;
+		const int ix = int(fx);
+		const int iy = int(fy);
+		return glm::mix(glm::mix(texel(ix, iy), texel(ix + 1, iy), tx), glm::mix(texel(ix, iy + 1), texel(ix + 1, iy + 1), tx), ty);
+	};
+	// Runs a full screen pass, the function gets the texture coordinate and the texel size of the target
+	auto runPass = [](Image& a_target, std::function<float(float, float)> a_shade)
+	{
+		for (uint y = 0; y < a_target.height; ++y)
+			for (uint x = 0; x < a_target.width; ++x)
+				a_target.texels[y * a_target.width + x] = a_shade((float(x) + 0.5f) / float(a_target.width), (float(y) + 0.5f) / float(a_target.height));
+	};
+
+	// Of Bloom/bloomdownsample.frag and Bloom/bloomupsample.frag
+	auto downsample = [&](const Image& a_source)
+	{
+		Image target = makeImage(glm::max(a_source.width / 2, 1u), glm::max(a_source.height / 2, 1u));
+		const float sx = 1.0f / float(a_source.width);
+		const float sy = 1.0f / float(a_source.height);
+		runPass(target, [&](float a_u, float a_v)
+		{
+			auto tap = [&](float a_x, float a_y) { return sample(a_source, a_u + a_x * sx, a_v + a_y * sy); };
+			return tap(0.0f, 0.0f) * 0.125f
+				+ (tap(-2.0f, 2.0f) + tap(2.0f, 2.0f) + tap(-2.0f, -2.0f) + tap(2.0f, -2.0f)) * 0.03125f
+				+ (tap(0.0f, 2.0f) + tap(-2.0f, 0.0f) + tap(2.0f, 0.0f) + tap(0.0f, -2.0f)) * 0.0625f
+				+ (tap(-1.0f, 1.0f) + tap(1.0f, 1.0f) + tap(-1.0f, -1.0f) + tap(1.0f, -1.0f)) * 0.125f;
+		});
+		return target;
+	};
+	auto upsample = [&](const Image& a_source, const Image& a_level, float a_scale)
+	{
+		Image target = makeImage(a_level.width, a_level.height);
+		const float sx = 1.0f / float(a_source.width);
+		const float sy = 1.0f / float(a_source.height);
+		runPass(target, [&](float a_u, float a_v)
+		{
+			auto tap = [&](float a_x, float a_y) { return sample(a_source, a_u + a_x * sx, a_v + a_y * sy); };
+			const float upsampled = tap(0.0f, 0.0f) * 4.0f + (tap(-1.0f, 0.0f) + tap(1.0f, 0.0f) + tap(0.0f, -1.0f) + tap(0.0f, 1.0f)) * 2.0f
+				+ tap(-1.0f, -1.0f) + tap(1.0f, -1.0f) + tap(-1.0f, 1.0f) + tap(1.0f, 1.0f);
+			return (sample(a_level, a_u, a_v) + upsampled / 16.0f) * a_scale;
+		});
+		return target;
+	};
+	// Of Blur/gaussianblur.frag, a horizontal or vertical pass at the resolution of the input
+	auto gaussianBlur = [&](const Image& a_source, bool a_horizontal)
+	{
+		Image target = makeImage(a_source.width, a_source.height);
+		const float sx = a_horizontal ? 1.0f / float(a_source.width) : 0.0f;
+		const float sy = a_horizontal ? 0.0f : 1.0f / float(a_source.height);
+		runPass(target, [&](float a_u, float a_v)
+		{
+			float blurred = 0.0f;
+			for (uint i = 0; i < ARRAY_SIZE(BLOOM_GAUSSIAN_WEIGHTS); ++i)
+			{
+				const float offset = BLOOM_GAUSSIAN_OFFSETS[i];
+				blurred += BLOOM_GAUSSIAN_WEIGHTS[i] * (sample(a_source, a_u + offset * sx, a_v + offset * sy) + sample(a_source, a_u - offset * sx, a_v - offset * sy));
+			}
+			return blurred;
+		});
+		return target;
+	};
+	// Of the glow as the combine pass samples it at the resolution of the scene, the smallest radius in pixels around the bright pixel
+	// that holds every fraction of BLOOM_ENERGY_FRACTIONS
+	auto getRadii = [&](const Image& a_glow, float* a_radii)
+	{
+		const float center = float(BLOOM_IMAGE_SIZE / 2) + 0.5f;
+		const uint maxRadius = BLOOM_IMAGE_SIZE / 2;
+		eastl::vector<double> energyAtRadius(maxRadius + 1, 0.0);
+		double totalEnergy = 0.0;
+		for (uint y = 0; y < BLOOM_IMAGE_SIZE; ++y)
+		{
+			for (uint x = 0; x < BLOOM_IMAGE_SIZE; ++x)
+			{
+				const float u = (float(x) + 0.5f) / float(BLOOM_IMAGE_SIZE);
+				const float v = (float(y) + 0.5f) / float(BLOOM_IMAGE_SIZE);
+				const float energy = sample(a_glow, u, v);
+				const float distance = glm::length(glm::vec2(float(x) + 0.5f, float(y) + 0.5f) - center);
+				energyAtRadius[glm::min(uint(glm::ceil(distance)), maxRadius)] += energy;
+				totalEnergy += energy;
+			}
+		}
+		for (uint i = 0; i < ARRAY_SIZE(BLOOM_ENERGY_FRACTIONS); ++i)
+		{
+			double energy = 0.0;
+			uint radius = 0;
+			while (radius < maxRadius && (energy += energyAtRadius[radius]) < BLOOM_ENERGY_FRACTIONS[i] * totalEnergy)
+				++radius;
+			a_radii[i] = float(radius);
+		}
+		return float(totalEnergy);
+	};
+
+	// A single bright pixel in the middle, the bright pass keeps it as it is
+	Image scene = makeImage(BLOOM_IMAGE_SIZE, BLOOM_IMAGE_SIZE);
+	scene.texels[(BLOOM_IMAGE_SIZE / 2) * BLOOM_IMAGE_SIZE + BLOOM_IMAGE_SIZE / 2] = 1.0f;
+
+	float gaussianRadii[ARRAY_SIZE(BLOOM_ENERGY_FRACTIONS)];
+	const float gaussianEnergy = getRadii(gaussianBlur(gaussianBlur(scene, true), false), gaussianRadii);
+	print("Bloom gaussian blur: energy %.3f, %.0f%% within %.0f pixels, %.0f%% within %.0f pixels\n", double(gaussianEnergy),
+		100.0 * double(BLOOM_ENERGY_FRACTIONS[0]), double(gaussianRadii[0]), 100.0 * double(BLOOM_ENERGY_FRACTIONS[1]), double(gaussianRadii[1]));
+
+	bool passed = true;
+	float defaultRadii[ARRAY_SIZE(BLOOM_ENERGY_FRACTIONS)] = {};
+	for (uint numLevels : BLOOM_NUM_LEVELS)
+	{
+		// The bright pass writes the first level at half the resolution, bilinear between the 4 pixels of the scene under every texel
+		eastl::vector<Image> levels;
+		levels.push_back(makeImage(BLOOM_IMAGE_SIZE / 2, BLOOM_IMAGE_SIZE / 2));
+		runPass(levels.back(), [&](float a_u, float a_v) { return sample(scene, a_u, a_v); });
+		while (levels.size() < numLevels)
+			levels.push_back(downsample(levels.back()));
+		Image summed = levels.back();
+		for (uint level = uint(levels.size()) - 1; level-- > 0;)
+			summed = upsample(summed, levels[level], level == 0 ? 1.0f / float(levels.size()) : 1.0f);
+
+		float radii[ARRAY_SIZE(BLOOM_ENERGY_FRACTIONS)];
+		const float energy = getRadii(summed, radii);
+		print("Bloom pyramid %u levels: energy %.3f, %.0f%% within %.0f pixels, %.0f%% within %.0f pixels\n", numLevels, double(energy),
+			100.0 * double(BLOOM_ENERGY_FRACTIONS[0]), double(radii[0]), 100.0 * double(BLOOM_ENERGY_FRACTIONS[1]), double(radii[1]));
+		if (glm::abs(energy - gaussianEnergy) > 0.05f)
+		{
+			print("Bloom pyramid %u levels: not as bright as the gaussian blur\n", numLevels);
+			passed = false;
+		}
+		if (numLevels == BLOOM_DEFAULT_NUM_LEVELS)
+			for (uint i = 0; i < ARRAY_SIZE(BLOOM_ENERGY_FRACTIONS); ++i)
+				defaultRadii[i] = radii[i];
+	}
+	for (uint i = 0; i < ARRAY_SIZE(BLOOM_ENERGY_FRACTIONS); ++i)
+	{
+		if (defaultRadii[i] < gaussianRadii[i])
+		{
+			print("Bloom pyramid %u levels: narrower than the gaussian blur\n", BLOOM_DEFAULT_NUM_LEVELS);
+			passed = false;
+		}
+	}
+
+	// Every pass reads its inputs and writes its target once, the caches keep the overlapping taps. The gaussian blur works on RGB8 targets
+	// at the resolution of the scene, the pyramid on RGB16F levels from half the resolution. The combine pass reads the result
+	for (const uint* resolution : BLOOM_RESOLUTIONS)
+	{
+		const uint64 numPixels = uint64(resolution[0]) * resolution[1];
+		const uint64 gaussianBytes = numPixels * 4 + numPixels * 4 + 2 * (numPixels * 4 + numPixels * 4) + numPixels * 4;
+		print("Bloom %ux%u: gaussian blur 3 passes %.1f MB\n", resolution[0], resolution[1], double(gaussianBytes) / (1024.0 * 1024.0));
+		for (uint numLevels : BLOOM_NUM_LEVELS)
+		{
+			eastl::vector<uint64> levelPixels;
+			uint width = resolution[0] / 2;
+			uint height = resolution[1] / 2;
+			for (uint level = 0; level < numLevels; ++level)
+			{
+				levelPixels.push_back(uint64(width) * height);
+				width = glm::max(width / 2, 1u);
+				height = glm::max(height / 2, 1u);
+			}
+			uint64 pyramidBytes = numPixels * 4 + levelPixels[0] * 8;
+			for (uint level = 1; level < numLevels; ++level)
+				pyramidBytes += levelPixels[level - 1] * 8 + levelPixels[level] * 8;
+			for (uint level = 0; level + 1 < numLevels; ++level)
+				pyramidBytes += levelPixels[level + 1] * 8 + 2 * levelPixels[level] * 8;
+			pyramidBytes += levelPixels[0] * 8;
+			print("Bloom %ux%u: pyramid %u levels %2u passes %.1f MB, %.0f%% of the gaussian blur\n", resolution[0], resolution[1], numLevels, 2 * numLevels - 1,
+				double(pyramidBytes) / (1024.0 * 1024.0), 100.0 * double(pyramidBytes) / double(gaussianBytes));
+			if (numLevels == BLOOM_DEFAULT_NUM_LEVELS && pyramidBytes >= gaussianBytes)
+			{
+				print("Bloom %ux%u: pyramid %u levels moves more bytes than the gaussian blur\n", resolution[0], resolution[1], numLevels);
+				passed = false;
+			}
+		}
+	}
+	return reportTest("Bloom test", passed);
+}
+
+/** Moves a camera around a sphere on a ground plane and reprojects every pixel of a frame into the depth of the frame before like the
+    temporal resolve of HBAO, with the depths ray cast at the ambient occlusion resolution. The history has to be kept where the point was
+    visible the frame before and dropped where it was hidden or off screen, but at edges where the unfiltered depth of the frame before
+    belongs to the other side. Returns if all checks passed */
+bool testHBAOReprojection()
+{
+	const glm::vec3 sphereCenters[] = { glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(3.0f, 0.5f, -2.0f) };
+	const float sphereRadii[] = { 1.5f, 0.75f };
+	// Distance along the ray to the closest surface, 0 for none
+	auto raycast = [&](const glm::vec3& a_origin, const glm::vec3& a_dir)
+	{
+		float closest = a_dir.y < 0.0f ? -a_origin.y / a_dir.y : 0.0f;
+		for (uint i = 0; i < ARRAY_SIZE(sphereCenters); ++i)
+		{
+			const glm::vec3 toOrigin = a_origin - sphereCenters[i];
+			const float b = glm::dot(toOrigin, a_dir);
+			const float discriminant = b * b - (glm::dot(toOrigin, toOrigin) - sphereRadii[i] * sphereRadii[i]);
+			const float t = discriminant >= 0.0f ? -b - glm::sqrt(discriminant) : 0.0f;
+			if (t > 0.0f && (closest == 0.0f || t < closest))
+				closest = t;
+		}
+		return closest;
+	};
+
+	PerspectiveCamera camera;
+	camera.initialize(float(HBAO_REPROJECTION_WIDTH), float(HBAO_REPROJECTION_HEIGHT), 90.0f, 0.1f, 100.0f);
+	// The window depth of every pixel, 1 where nothing is hit
+	auto renderDepth = [&](eastl::vector<float>& a_depth, eastl::vector<glm::vec3>& a_points)
+	{
+		const glm::mat4 invViewProjection = glm::inverse(camera.getCombinedMatrix());
+		a_depth.resize(HBAO_REPROJECTION_WIDTH * HBAO_REPROJECTION_HEIGHT);
+		a_points.resize(HBAO_REPROJECTION_WIDTH * HBAO_REPROJECTION_HEIGHT);
+		for (uint y = 0; y < HBAO_REPROJECTION_HEIGHT; ++y)
+		{
+			for (uint x = 0; x < HBAO_REPROJECTION_WIDTH; ++x)
+			{
+				const glm::vec2 ndc = glm::vec2((float(x) + 0.5f) / float(HBAO_REPROJECTION_WIDTH), (float(y) + 0.5f) / float(HBAO_REPROJECTION_HEIGHT)) * 2.0f - 1.0f;
+				const glm::vec4 farPoint = invViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+				const glm::vec3 dir = glm::normalize(glm::vec3(farPoint) / farPoint.w - camera.getPosition());
+				const float t = raycast(camera.getPosition(), dir);
+				const uint idx = y * HBAO_REPROJECTION_WIDTH + x;
+				a_points[idx] = camera.getPosition() + dir * t;
+				const glm::vec4 clip = camera.getCombinedMatrix() * glm::vec4(a_points[idx], 1.0f);
+				a_depth[idx] = (t > 0.0f && t < camera.getFar()) ? clip.z / clip.w * 0.5f + 0.5f : 1.0f;
+			}
+		}
+	};
+	// Of the shaders, from the window depth
+	const float near = camera.getNear();
+	const float far = camera.getFar();
+	auto viewDepth = [near, far](float a_depth)
+	{
+		return 1.0f / ((near - far) / (2.0f * near * far) * (a_depth * 2.0f - 1.0f) + (near + far) / (2.0f * near * far));
+	};
+
+	eastl::vector<float> prevDepth;
+	eastl::vector<float> depth;
+	eastl::vector<glm::vec3> prevPoints;
+	eastl::vector<glm::vec3> points;
+	glm::mat4 prevViewProjection;
+	glm::vec3 prevPosition;
+	uint numKept = 0;
+	uint numWrongHistory = 0;
+	uint numVisibleBefore = 0;
+	uint numDropped = 0;
+	for (uint frame = 0; frame < HBAO_REPROJECTION_NUM_FRAMES; ++frame)
+	{
+		// Circles the spheres while it moves up and down and looks a bit past them
+		const float angle = float(frame) * 0.03f;
+		camera.setPosition(glm::vec3(glm::sin(angle) * 7.0f, 1.5f + glm::sin(angle * 3.0f), glm::cos(angle) * 7.0f));
+		camera.lookAtPoint(glm::vec3(glm::sin(angle * 2.0f), 0.5f, 0.0f));
+		camera.updateMatrices();
+		renderDepth(depth, points);
+		if (frame > 0)
+		{
+			const glm::mat4 reprojection = prevViewProjection * glm::inverse(camera.getCombinedMatrix());
+			for (uint y = 0; y < HBAO_REPROJECTION_HEIGHT; ++y)
+			{
+				for (uint x = 0; x < HBAO_REPROJECTION_WIDTH; ++x)
+				{
+					const uint idx = y * HBAO_REPROJECTION_WIDTH + x;
+					if (depth[idx] >= 1.0f)
+						continue;
+
+					// The temporal resolve
+					const glm::vec2 texcoord((float(x) + 0.5f) / float(HBAO_REPROJECTION_WIDTH), (float(y) + 0.5f) / float(HBAO_REPROJECTION_HEIGHT));
+					const glm::vec4 prevClip = reprojection * glm::vec4(glm::vec3(texcoord, depth[idx]) * 2.0f - 1.0f, 1.0f);
+					const glm::vec3 prevPos = glm::vec3(prevClip) / prevClip.w * 0.5f + 0.5f;
+					bool keep = prevPos.x >= 0.0f && prevPos.y >= 0.0f && prevPos.x <= 1.0f && prevPos.y <= 1.0f;
+					if (keep)
+					{
+						const uint prevX = glm::min(uint(prevPos.x * float(HBAO_REPROJECTION_WIDTH)), HBAO_REPROJECTION_WIDTH - 1);
+						const uint prevY = glm::min(uint(prevPos.y * float(HBAO_REPROJECTION_HEIGHT)), HBAO_REPROJECTION_HEIGHT - 1);
+						const float expectedDepth = viewDepth(prevPos.z);
+						keep = glm::abs(viewDepth(prevDepth[prevY * HBAO_REPROJECTION_WIDTH + prevX]) - expectedDepth) <= HBAO_REPROJECTION_DEPTH_TOLERANCE * expectedDepth;
+					}
+
+					// Visible the frame before if on screen and nothing was in front of it
+					const glm::vec3 toPoint = points[idx] - prevPosition;
+					const float distance = glm::length(toPoint);
+					const float hit = raycast(prevPosition, toPoint / distance);
+					const bool onScreen = prevPos.x >= 0.0f && prevPos.y >= 0.0f && prevPos.x <= 1.0f && prevPos.y <= 1.0f && prevPos.z <= 1.0f;
+					const bool visibleBefore = onScreen && hit > distance * 0.99f;
+
+					numKept += keep ? 1 : 0;
+					numWrongHistory += (keep && !visibleBefore) ? 1 : 0;
+					numVisibleBefore += visibleBefore ? 1 : 0;
+					numDropped += (visibleBefore && !keep) ? 1 : 0;
+				}
+			}
+		}
+		prevDepth.swap(depth);
+		prevPoints.swap(points);
+		prevViewProjection = camera.getCombinedMatrix();
+		prevPosition = camera.getPosition();
+	}
+
+	const float wrongHistoryFraction = float(numWrongHistory) / float(glm::max(numKept, 1u));
+	const float droppedFraction = float(numDropped) / float(glm::max(numVisibleBefore, 1u));
+	print("HBAO reprojection: %u frames, %u pixels kept their history, %.2f%% of them hidden the frame before, %.2f%% of the visible ones dropped\n",
+		HBAO_REPROJECTION_NUM_FRAMES, numKept, 100.0 * double(wrongHistoryFraction), 100.0 * double(droppedFraction));
+	bool passed = true;
+	if (wrongHistoryFraction > HBAO_REPROJECTION_MAX_WRONG_HISTORY)
+	{
+		print("HBAO reprojection: kept the history of too many pixels that were hidden\n");
+		passed = false;
+	}
+	if (droppedFraction > HBAO_REPROJECTION_MAX_DROPPED)
+	{
+		print("HBAO reprojection: dropped the history of too many pixels that were visible\n");
+		passed = false;
+	}
+	return reportTest("HBAO reprojection test", passed);
+}
@@ -0,0 +1,326 @@
+#include "Tests.h"
+
+#include "TestUtils.h"
+#include "Graphics/Utils/RenderGraph.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint RENDER_GRAPH_WIDTH = 3840;
+const uint RENDER_GRAPH_HEIGHT = 2160;
+const uint RENDER_GRAPH_MSAA_SAMPLES[] = { 0, 4 };
+const uint RENDER_GRAPH_NUM_RANDOM_GRAPHS = 2000;
+const uint RENDER_GRAPH_MAX_RANDOM_PASSES = 24;
+const uint RENDER_GRAPH_MAX_RANDOM_RESOURCES = 16;
+const uint RENDER_GRAPH_NUM_RANDOM_DESCS = 3; // Few descriptions so many transients can share targets
+const uint RENDER_GRAPH_BLOOM_LEVELS = 5;
+
+/** Declares the passes GLRenderer declares every frame, with made up format ids since RenderGraph only compares them. Returns the number
+    of passes that should be culled */
+uint declareRendererFrame(RenderGraph& a_graph, bool a_hbaoEnabled, bool a_bloomEnabled, bool a_fxaaEnabled, uint a_numSamples)
+{
+	enum EFormat { RGB8, DEPTH24, R32F, R8, RGB16F, R16F };
+	auto makeDesc = [](uint a_format, uint a_bytesPerPixel, uint a_scale, uint a_numSamples)
+	{
+		RenderGraph::ResourceDesc desc;
+		desc.format = a_format;
+		desc.width = RENDER_GRAPH_WIDTH / a_scale;
+		desc.height = RENDER_GRAPH_HEIGHT / a_scale;
+		desc.numSamples = a_numSamples;
+		desc.bytesPerPixel = a_bytesPerPixel;
+		return desc;
+	};
+	auto addPass = [&a_graph](const char* a_name, std::initializer_list<RenderGraph::ResourceHandle> a_reads, RenderGraph::ResourceHandle a_output, RenderGraph::ELoad a_load)
+	{
+		const RenderGraph::PassHandle pass = a_graph.addPass(a_name, NULL);
+		for (RenderGraph::ResourceHandle read : a_reads)
+			a_graph.read(pass, read);
+		a_graph.write(pass, a_output, a_load);
+		return pass;
+	};
+
+	const RenderGraph::ResourceHandle backbuffer = a_graph.importResource("Backbuffer", makeDesc(RGB8, 4, 1, 0), true);
+	const RenderGraph::ResourceHandle sceneColor = a_graph.createTransient("Scene color", makeDesc(RGB8, 4, 1, a_numSamples));
+	const RenderGraph::ResourceHandle sceneDepth = a_graph.createTransient("Scene depth", makeDesc(DEPTH24, 4, 1, a_numSamples));
+	const char* const scenePassNames[] = { "Depth prepass", "Skybox", "Models" };
+	for (uint i = 0; i < ARRAY_SIZE(scenePassNames); ++i)
+	{
+		const RenderGraph::PassHandle pass = a_graph.addPass(scenePassNames[i], NULL);
+		a_graph.write(pass, sceneColor);
+		a_graph.write(pass, sceneDepth, i == 0 ? RenderGraph::ELoad::CLEAR : RenderGraph::ELoad::LOAD);
+	}
+
+	const RenderGraph::ResourceHandle hbaoDepth = a_graph.createTransient("HBAO depth", makeDesc(R32F, 4, 2, 0));
+	addPass("HBAO downsample depth", { sceneDepth }, hbaoDepth, RenderGraph::ELoad::DONT_CARE);
+	const RenderGraph::ResourceHandle hbao = a_graph.createTransient("HBAO", makeDesc(R8, 1, 2, 0));
+	addPass("HBAO", { hbaoDepth }, hbao, RenderGraph::ELoad::DONT_CARE);
+	// The temporal resolve reads the history the frame before wrote and writes the other one, the history is kept across frames
+	const RenderGraph::ResourceHandle prevHistory = a_graph.importResource("HBAO history before", makeDesc(R16F, 2, 2, 0), false);
+	const RenderGraph::ResourceHandle prevHistoryDepth = a_graph.importResource("HBAO history depth before", makeDesc(R32F, 4, 2, 0), false);
+	const RenderGraph::ResourceHandle history = a_graph.importResource("HBAO history", makeDesc(R16F, 2, 2, 0), false);
+	const RenderGraph::ResourceHandle historyDepth = a_graph.importResource("HBAO history depth", makeDesc(R32F, 4, 2, 0), false);
+	const RenderGraph::PassHandle resolvePass = addPass("HBAO temporal resolve", { hbao, sceneDepth, prevHistory, prevHistoryDepth }, history,
+		RenderGraph::ELoad::DONT_CARE);
+	a_graph.write(resolvePass, historyDepth, RenderGraph::ELoad::DONT_CARE);
+	const RenderGraph::ResourceHandle blurredX = a_graph.createTransient("Bilateral blur X", makeDesc(R8, 1, 1, 0));
+	addPass("Bilateral blur X", { history, sceneDepth }, blurredX, RenderGraph::ELoad::DONT_CARE);
+	const RenderGraph::ResourceHandle hbaoResult = a_graph.createTransient("Bilateral blur", makeDesc(R8, 1, 1, 0));
+	addPass("Bilateral blur Y", { blurredX, sceneDepth }, hbaoResult, RenderGraph::ELoad::DONT_CARE);
+
+	// The bloom pyramid, every level halves the one before and the levels add up again from the smallest
+	const char* const bloomDownsampleNames[] = { "Bloom downsample 1", "Bloom downsample 2", "Bloom downsample 3", "Bloom downsample 4" };
+	const char* const bloomUpsampleNames[] = { "Bloom upsample 0", "Bloom upsample 1", "Bloom upsample 2", "Bloom upsample 3" };
+	static_assert(ARRAY_SIZE(bloomDownsampleNames) == RENDER_GRAPH_BLOOM_LEVELS - 1, "A name for every level");
+	eastl::vector<RenderGraph::ResourceHandle> bloomLevels;
+	bloomLevels.push_back(a_graph.createTransient("Bloom bright", makeDesc(RGB16F, 8, 2, 0)));
+	addPass("Bloom bright", { sceneColor }, bloomLevels.back(), RenderGraph::ELoad::DONT_CARE);
+	for (uint i = 1; i < RENDER_GRAPH_BLOOM_LEVELS; ++i)
+	{
+		bloomLevels.push_back(a_graph.createTransient(bloomDownsampleNames[i - 1], makeDesc(RGB16F, 8, 2 << i, 0)));
+		addPass(bloomDownsampleNames[i - 1], { bloomLevels[i - 1] }, bloomLevels[i], RenderGraph::ELoad::DONT_CARE);
+	}
+	RenderGraph::ResourceHandle bloomResult = bloomLevels.back();
+	for (uint i = RENDER_GRAPH_BLOOM_LEVELS - 1; i-- > 0;)
+	{
+		const RenderGraph::ResourceHandle summed = a_graph.createTransient(bloomUpsampleNames[i], a_graph.getResourceDesc(bloomLevels[i]));
+		addPass(bloomUpsampleNames[i], { bloomResult, bloomLevels[i] }, summed, RenderGraph::ELoad::DONT_CARE);
+		bloomResult = summed;
+	}
+
+	const RenderGraph::ResourceHandle combined = a_fxaaEnabled ? a_graph.createTransient("Combined", makeDesc(RGB8, 4, 1, 0)) : backbuffer;
+	const RenderGraph::PassHandle combinePass = addPass("Combine", { sceneColor }, combined, RenderGraph::ELoad::DONT_CARE);
+	if (a_hbaoEnabled)
+		a_graph.read(combinePass, hbaoResult);
+	if (a_bloomEnabled)
+		a_graph.read(combinePass, bloomResult);
+	if (a_fxaaEnabled)
+		addPass("FXAA", { combined }, backbuffer, RenderGraph::ELoad::DONT_CARE);
+
+	return (a_hbaoEnabled ? 0 : 5) + (a_bloomEnabled ? 0 : 2 * RENDER_GRAPH_BLOOM_LEVELS - 1);
+}
+
+/** Checks a compiled graph against brute force versions of culling, lifetimes, clears and framebuffer binds, and runs the passes on
+    the physical targets to check no pass reads a transient another transient sharing its target overwrote. Returns if all checks passed */
+bool checkRenderGraph(const RenderGraph& a_graph, const char* a_label)
+{
+	const uint numPasses = a_graph.getNumPasses();
+	const uint numResources = a_graph.getNumResources();
+	auto fail = [a_label](const char* a_message, const char* a_name)
+	{
+		print("%s: %s %s\n", a_label, a_message, a_name);
+		return false;
+	};
+
+	// A pass is needed if it writes an output, has a side effect or a later needed pass reads or loads what it wrote
+	// before another needed pass overwrote it
+	eastl::vector<bool> needed(numPasses, false);
+	for (uint i = numPasses; i-- > 0;)
+	{
+		const eastl::vector<RenderGraph::ResourceHandle>& attachments = a_graph.getAttachments(i);
+		needed[i] = a_graph.hasSideEffect(i);
+		for (uint j = 0; j < attachments.size() && !needed[i]; ++j)
+		{
+			const RenderGraph::ResourceHandle resource = attachments[j];
+			needed[i] = a_graph.isOutput(resource);
+			for (uint k = i + 1; k < numPasses && !needed[i]; ++k)
+			{
+				if (!needed[k])
+					continue;
+				const eastl::vector<RenderGraph::ResourceHandle>& reads = a_graph.getReads(k);
+				const eastl::vector<RenderGraph::ResourceHandle>& laterAttachments = a_graph.getAttachments(k);
+				bool overwritten = false;
+				for (uint l = 0; l < laterAttachments.size(); ++l)
+				{
+					if (laterAttachments[l] != resource)
+						continue;
+					if (a_graph.getLoads(k)[l] == RenderGraph::ELoad::LOAD)
+						needed[i] = true;
+					else
+						overwritten = true;
+				}
+				needed[i] = needed[i] || eastl::find(reads.begin(), reads.end(), resource) != reads.end();
+				if (overwritten)
+					break;
+			}
+		}
+		if (needed[i] == a_graph.isCulled(i))
+			return fail(needed[i] ? "culled needed pass" : "kept unneeded pass", a_graph.getPassName(i));
+	}
+
+	// Lifetimes from the compiled passes using every transient
+	const eastl::vector<RenderGraph::CompiledPass>& compiledPasses = a_graph.getCompiledPasses();
+	eastl::vector<uint> firstUse(numResources, RenderGraph::INVALID_INDEX);
+	eastl::vector<uint> lastUse(numResources, RenderGraph::INVALID_INDEX);
+	for (uint i = 0; i < compiledPasses.size(); ++i)
+	{
+		eastl::vector<RenderGraph::ResourceHandle> used = a_graph.getReads(compiledPasses[i].pass);
+		used.insert(used.end(), a_graph.getAttachments(compiledPasses[i].pass).begin(), a_graph.getAttachments(compiledPasses[i].pass).end());
+		for (RenderGraph::ResourceHandle resource : used)
+		{
+			firstUse[resource] = glm::min(firstUse[resource], i);
+			lastUse[resource] = lastUse[resource] == RenderGraph::INVALID_INDEX ? i : glm::max(lastUse[resource], i);
+		}
+	}
+	for (uint i = 0; i < numResources; ++i)
+	{
+		if (a_graph.isImported(i))
+			continue;
+		if (a_graph.getFirstUse(i) != firstUse[i] || a_graph.getLastUse(i) != lastUse[i])
+			return fail("wrong lifetime of", a_graph.getResourceName(i));
+		const uint physicalIdx = a_graph.getPhysicalIdx(i);
+		if ((physicalIdx == RenderGraph::INVALID_INDEX) != (firstUse[i] == RenderGraph::INVALID_INDEX))
+			return fail("wrong physical target of", a_graph.getResourceName(i));
+		if (physicalIdx != RenderGraph::INVALID_INDEX && !(a_graph.getPhysicalDesc(physicalIdx) == a_graph.getResourceDesc(i)))
+			return fail("different description than its target", a_graph.getResourceName(i));
+		for (uint j = 0; j < i && physicalIdx != RenderGraph::INVALID_INDEX; ++j)
+			if (!a_graph.isImported(j) && a_graph.getPhysicalIdx(j) == physicalIdx && firstUse[i] <= lastUse[j] && firstUse[j] <= lastUse[i])
+				return fail("shares its target while alive with another transient", a_graph.getResourceName(i));
+	}
+
+	// Running the passes on the targets: what every physical target holds, clears and binds
+	eastl::vector<uint> contents(a_graph.getNumPhysical(), RenderGraph::INVALID_INDEX);
+	eastl::vector<bool> written(numResources, false);
+	auto getTarget = [&a_graph](RenderGraph::ResourceHandle a_resource)
+	{
+		return a_graph.isImported(a_resource) ? a_resource : a_graph.getNumResources() + a_graph.getPhysicalIdx(a_resource);
+	};
+	for (uint i = 0; i < compiledPasses.size(); ++i)
+	{
+		const RenderGraph::CompiledPass& compiled = compiledPasses[i];
+		const eastl::vector<RenderGraph::ResourceHandle>& attachments = a_graph.getAttachments(compiled.pass);
+		const eastl::vector<RenderGraph::ELoad>& loads = a_graph.getLoads(compiled.pass);
+		for (RenderGraph::ResourceHandle resource : a_graph.getReads(compiled.pass))
+			if (!a_graph.isImported(resource) && contents[a_graph.getPhysicalIdx(resource)] != resource)
+				return fail("reads an overwritten or unwritten transient", a_graph.getPassName(compiled.pass));
+
+		bool sameAttachments = i > 0 && attachments.size() == a_graph.getAttachments(compiledPasses[i - 1].pass).size();
+		for (uint j = 0; j < attachments.size() && sameAttachments; ++j)
+			sameAttachments = getTarget(attachments[j]) == getTarget(a_graph.getAttachments(compiledPasses[i - 1].pass)[j]);
+		if (compiled.bindFramebuffer != (!attachments.empty() && !sameAttachments))
+			return fail("wrong framebuffer bind of", a_graph.getPassName(compiled.pass));
+
+		for (uint j = 0; j < attachments.size(); ++j)
+		{
+			const RenderGraph::ResourceHandle resource = attachments[j];
+			const bool cleared = (compiled.clearMask & (1u << j)) != 0;
+			const bool clear = loads[j] == RenderGraph::ELoad::CLEAR || (loads[j] == RenderGraph::ELoad::LOAD && !a_graph.isImported(resource) && !written[resource]);
+			if (cleared != clear)
+				return fail("wrong clear of an attachment of", a_graph.getPassName(compiled.pass));
+			if (!a_graph.isImported(resource))
+			{
+				if (loads[j] == RenderGraph::ELoad::LOAD && !cleared && contents[a_graph.getPhysicalIdx(resource)] != resource)
+					return fail("loads an overwritten transient", a_graph.getPassName(compiled.pass));
+				contents[a_graph.getPhysicalIdx(resource)] = resource;
+			}
+			written[resource] = true;
+		}
+	}
+	return true;
+}
+
+END_UNNAMED_NAMESPACE()
+
+/** Compiles the frame GLRenderer declares at 4K for every combination of its effects and random graphs, and checks them with
+    checkRenderGraph. Prints how much memory sharing targets saves. Returns if all checks passed */
+bool testRenderGraph()
+{
+	bool passed = true;
+	RenderGraph graph;
+	for (uint numSamples : RENDER_GRAPH_MSAA_SAMPLES)
+	{
+		for (uint effects = 0; effects < 8 && passed; ++effects)
+		{
+			const bool hbaoEnabled = (effects & 1) != 0;
+			const bool bloomEnabled = (effects & 2) != 0;
+			const bool fxaaEnabled = (effects & 4) != 0;
+			graph.reset();
+			const uint numExpectedCulled = declareRendererFrame(graph, hbaoEnabled, bloomEnabled, fxaaEnabled, numSamples);
+			if (!graph.compile())
+			{
+				print("Renderer frame did not compile\n");
+				passed = false;
+				break;
+			}
+			const RenderGraph::Stats& stats = graph.getStats();
+			if (stats.numCulledPasses != numExpectedCulled)
+			{
+				print("Renderer frame: %u passes culled instead of %u\n", stats.numCulledPasses, numExpectedCulled);
+				passed = false;
+			}
+			passed = checkRenderGraph(graph, "Renderer frame") && passed;
+			print("msaa %u hbao %u bloom %u fxaa %u: %2u passes %u culled, %2u transients in %u targets, %6.1f MB instead of %6.1f MB, %u binds %u clears\n",
+				numSamples, uint(hbaoEnabled), uint(bloomEnabled), uint(fxaaEnabled), stats.numPasses, stats.numCulledPasses, stats.numTransients,
+				stats.numPhysical, double(stats.physicalBytes) / (1024.0 * 1024.0), double(stats.transientBytes) / (1024.0 * 1024.0),
+				stats.numFramebufferBinds, stats.numClears);
+		}
+	}
+
+	TestRandom random(12345);
+	uint64 transientBytes = 0;
+	uint64 physicalBytes = 0;
+	for (uint i = 0; i < RENDER_GRAPH_NUM_RANDOM_GRAPHS && passed; ++i)
+	{
+		graph.reset();
+		const uint numResources = 2 + random.next(RENDER_GRAPH_MAX_RANDOM_RESOURCES - 1);
+		eastl::vector<bool> written(numResources, false);
+		for (uint j = 0; j < numResources; ++j)
+		{
+			RenderGraph::ResourceDesc desc;
+			desc.format = random.next(RENDER_GRAPH_NUM_RANDOM_DESCS);
+			desc.width = RENDER_GRAPH_WIDTH;
+			desc.height = RENDER_GRAPH_HEIGHT;
+			desc.bytesPerPixel = 4;
+			// The first resource is the output, a few others are imported
+			if (j == 0 || random.next(8) == 0)
+			{
+				graph.importResource("Imported", desc, j == 0);
+				written[j] = true;
+			}
+			else
+				graph.createTransient("Transient", desc);
+		}
+		const uint numPasses = 1 + random.next(RENDER_GRAPH_MAX_RANDOM_PASSES);
+		for (uint j = 0; j < numPasses; ++j)
+		{
+			const RenderGraph::PassHandle pass = graph.addPass("Pass", NULL);
+			// Only resources written before are read so every graph compiles
+			const uint numReads = random.next(3);
+			for (uint k = 0; k < numReads; ++k)
+			{
+				const RenderGraph::ResourceHandle resource = random.next(numResources);
+				if (written[resource])
+					graph.read(pass, resource);
+			}
+			const uint numAttachments = (j == numPasses - 1 || random.next(10) == 0) ? 1 : random.next(3);
+			for (uint k = 0; k < numAttachments; ++k)
+			{
+				const RenderGraph::ResourceHandle resource = j == numPasses - 1 ? 0 : random.next(numResources);
+				const eastl::vector<RenderGraph::ResourceHandle>& attachments = graph.getAttachments(pass);
+				if (eastl::find(attachments.begin(), attachments.end(), resource) != attachments.end())
+					continue;
+				graph.write(pass, resource, RenderGraph::ELoad(random.next(3)));
+				written[resource] = true;
+			}
+			if (random.next(16) == 0)
+				graph.setSideEffect(pass);
+		}
+		if (!graph.compile())
+		{
+			print("Random graph %u did not compile\n", i);
+			passed = false;
+			break;
+		}
+		if (!checkRenderGraph(graph, "Random graph"))
+		{
+			print("Random graph %u of %u passes failed\n", i, numPasses);
+			passed = false;
+		}
+		transientBytes += graph.getStats().transientBytes;
+		physicalBytes += graph.getStats().physicalBytes;
+	}
+	print("Random graphs: %.1f MB of transients in %.1f MB of targets\n", double(transientBytes) / (1024.0 * 1024.0), double(physicalBytes) / (1024.0 * 1024.0));
+	return reportTest("Render graph test", passed);
+}
@@ -0,0 +1,196 @@
+#include "Tests.h"
+
+#include "TestUtils.h"
+#include "Graphics/Utils/PerspectiveCamera.h"
+#include "Graphics/Utils/ShadowCascades.h"
+#include "Utils/Stopwatch.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint CASCADES_NUM_FRAMES = 1000;
+const float CASCADES_OLD_SHADOW_RANGE = 200.0f; // Of the single shadow map the cascades replaced
+const uint CASCADES_OLD_SHADOW_RESOLUTION = 8192;
+const float CASCADES_TEXEL_TOLERANCE = 0.05f; // Float precision of texel positions in a 4096 wide atlas
+const float CASCADES_MAX_STATIC_RENDER_FRACTION = 0.1f; // Of the cascades that render their static casters per frame while the camera walks and turns
+
+END_UNNAMED_NAMESPACE()
+
+/** Checks the split distances, that every cascade covers its part of the view and casters towards the sun, and that the shadow maps
+    only move by whole texels and keep their size while the camera walks and turns for CASCADES_NUM_FRAMES frames.
+    Also checks that the cached static casters are rendered again rarely while the camera moves, never while it stands still, and for every cascade after invalidating or a new sun. Returns if all checks passed */
+bool testShadowCascades()
+{
+	bool passed = true;
+	float splits[ShadowCascades::MAX_CASCADES + 1];
+	ShadowCascades::calculateSplits(1.0f, 100.0f, 2, 0.0f, splits);
+	if (glm::abs(splits[1] - 50.5f) > 0.001f)
+	{
+		print("Uniform split is %f instead of 50.5\n", splits[1]);
+		passed = false;
+	}
+	ShadowCascades::calculateSplits(1.0f, 100.0f, 2, 1.0f, splits);
+	if (glm::abs(splits[1] - 10.0f) > 0.001f)
+	{
+		print("Logarithmic split is %f instead of 10\n", splits[1]);
+		passed = false;
+	}
+	for (uint numCascades = 1; numCascades <= ShadowCascades::MAX_CASCADES; ++numCascades)
+	{
+		ShadowCascades::calculateSplits(0.1f, 200.0f, numCascades, 0.75f, splits);
+		bool increasing = splits[0] == 0.1f && splits[numCascades] == 200.0f;
+		for (uint i = 0; i < numCascades; ++i)
+			increasing = increasing && splits[i] < splits[i + 1];
+		if (!increasing)
+		{
+			print("Splits of %u cascades do not go from near to far\n", numCascades);
+			passed = false;
+		}
+	}
+
+	ShadowCascades cascades;
+	ShadowCascades::Settings settings;
+	cascades.setSettings(settings);
+	const glm::vec3 sunDirection = glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f));
+	const glm::vec2 atlasSize = glm::vec2(cascades.getAtlasSize());
+	PerspectiveCamera camera;
+	camera.initialize(1280.0f, 720.0f, 90.0f, 0.1f, 1000.0f);
+	const glm::vec3 probe(12.3f, 4.5f, -6.7f); // Fixed point whose position in the shadow maps is followed
+
+	glm::vec2 probeTexels[ShadowCascades::MAX_CASCADES];
+	float radii[ShadowCascades::MAX_CASCADES];
+	uint numStaticRenders[ShadowCascades::MAX_CASCADES] = {};
+	uint numDynamicRenders[ShadowCascades::MAX_CASCADES] = {};
+	uint numFramesWithStaticRenders = 0;
+	Stopwatch updateStopwatch(CASCADES_NUM_FRAMES);
+	for (uint frame = 0; frame < CASCADES_NUM_FRAMES && passed; ++frame)
+	{
+		const float angle = glm::radians(float(frame) * 0.7f);
+		camera.setPosition(glm::vec3(glm::sin(angle * 0.3f) * 20.0f, 2.0f, float(frame) * 0.013f));
+		camera.lookAtDir(glm::normalize(glm::vec3(glm::cos(angle), glm::sin(angle * 2.0f) * 0.3f, glm::sin(angle))));
+		camera.updateMatrices();
+
+		updateStopwatch.start();
+		cascades.update(camera, sunDirection);
+		updateStopwatch.stop();
+
+		// A moving camera refits at most one cascade early per frame, more only when they all have to
+		uint numStaticThisFrame = 0;
+		for (uint i = 0; i < cascades.getNumCascades(); ++i)
+		{
+			numStaticRenders[i] += cascades.getCascade(i).renderStatic;
+			numDynamicRenders[i] += cascades.getCascade(i).renderDynamic;
+			numStaticThisFrame += cascades.getCascade(i).renderStatic;
+			if (cascades.getCascade(i).renderStatic && !cascades.getCascade(i).renderDynamic)
+			{
+				print("Frame %u: cascade %u renders its static casters but does not update its tile\n", frame, i);
+				passed = false;
+			}
+		}
+		if (frame > 0 && numStaticThisFrame > 0)
+			numFramesWithStaticRenders++;
+
+		for (uint i = 0; i < cascades.getNumCascades() && passed; ++i)
+		{
+			const ShadowCascades::Cascade& cascade = cascades.getCascade(i);
+			const glm::vec2 tileMin = glm::vec2(cascade.viewport.x, cascade.viewport.y) / atlasSize;
+			const glm::vec2 tileMax = glm::vec2(cascade.viewport.x + cascade.viewport.z, cascade.viewport.y + cascade.viewport.w) / atlasSize;
+
+			// The corners of the part of the view and a caster between them and the sun have to be in the tile
+			const float tanHalfVFov = glm::tan(glm::radians(camera.getVFov()) * 0.5f);
+			const glm::vec3 right = glm::normalize(glm::cross(camera.getDirection(), camera.getUp()));
+			const glm::vec3 up = glm::cross(right, camera.getDirection());
+			for (uint corner = 0; corner < 9; ++corner)
+			{
+				const float distance = (corner & 4) ? cascade.splitFar : cascade.splitNear;
+				const float x = (corner & 1) ? tanHalfVFov * camera.getWidth() / camera.getHeight() : -tanHalfVFov * camera.getWidth() / camera.getHeight();
+				const float y = (corner & 2) ? tanHalfVFov : -tanHalfVFov;
+				glm::vec3 point = camera.getPosition() + (camera.getDirection() + right * x + up * y) * distance;
+				if (corner == 8)
+					point = cascade.center + sunDirection * (cascade.radius + settings.casterDistance * 0.99f);
+				const glm::vec4 shadowCoord = cascade.shadowMatrix * glm::vec4(point, 1.0f);
+				if (glm::any(glm::lessThan(glm::vec2(shadowCoord), tileMin)) || glm::any(glm::greaterThan(glm::vec2(shadowCoord), tileMax))
+					|| shadowCoord.z < 0.0f || shadowCoord.z > 1.0f)
+				{
+					print("Frame %u: %s %u of cascade %u is outside its tile\n", frame, corner == 8 ? "caster" : "corner", corner, i);
+					passed = false;
+				}
+			}
+
+			// Turning keeps the size, and any fixed point moves by whole texels
+			const glm::vec2 probeTexel = glm::vec2(cascade.shadowMatrix * glm::vec4(probe, 1.0f)) * atlasSize;
+			if (frame > 0)
+			{
+				const glm::vec2 moved = probeTexel - probeTexels[i];
+				if (glm::any(glm::greaterThan(glm::abs(moved - glm::round(moved)), glm::vec2(CASCADES_TEXEL_TOLERANCE))))
+				{
+					print("Frame %u: cascade %u moved by %f %f texels\n", frame, i, moved.x, moved.y);
+					passed = false;
+				}
+				if (cascade.radius != radii[i])
+				{
+					print("Frame %u: cascade %u changed its radius from %f to %f\n", frame, i, radii[i], cascade.radius);
+					passed = false;
+				}
+			}
+			probeTexels[i] = probeTexel;
+			radii[i] = cascade.radius;
+		}
+	}
+
+	// A camera that stops lets the cascades settle, a new sun or invalidating renders the static casters of all cascades again
+	for (uint i = 0; i <= cascades.getNumCascades(); ++i)
+		cascades.update(camera, sunDirection);
+	for (uint i = 0; i < cascades.getNumCascades(); ++i)
+	{
+		if (cascades.getCascade(i).renderStatic)
+		{
+			print("Cascade %u renders its static casters while the camera stands still\n", i);
+			passed = false;
+		}
+	}
+	cascades.invalidateStatic();
+	cascades.update(camera, sunDirection);
+	bool allStatic = true;
+	for (uint i = 0; i < cascades.getNumCascades(); ++i)
+		allStatic = allStatic && cascades.getCascade(i).renderStatic;
+	cascades.update(camera, glm::normalize(sunDirection + glm::vec3(0.0f, 0.0f, 0.01f)));
+	for (uint i = 0; i < cascades.getNumCascades(); ++i)
+		allStatic = allStatic && cascades.getCascade(i).renderStatic;
+	if (!allStatic)
+	{
+		print("Invalidating or a new sun did not render the static casters of every cascade\n");
+		passed = false;
+	}
+
+	uint numStaticRendersTotal = 0;
+	uint numDynamicRendersTotal = 0;
+	for (uint i = 0; i < cascades.getNumCascades(); ++i)
+	{
+		numStaticRendersTotal += numStaticRenders[i];
+		numDynamicRendersTotal += numDynamicRenders[i];
+	}
+	const float staticRenderFraction = float(numStaticRendersTotal) / float(CASCADES_NUM_FRAMES * cascades.getNumCascades());
+	if (staticRenderFraction > CASCADES_MAX_STATIC_RENDER_FRACTION)
+	{
+		print("%.1f%% of the cascades rendered their static casters per frame\n", 100.0 * staticRenderFraction);
+		passed = false;
+	}
+
+	const float oldTexelSize = CASCADES_OLD_SHADOW_RANGE / float(CASCADES_OLD_SHADOW_RESOLUTION);
+	for (uint i = 0; i < cascades.getNumCascades(); ++i)
+	{
+		const ShadowCascades::Cascade& cascade = cascades.getCascade(i);
+		const float texelSize = 2.0f * cascade.radius / float(settings.resolution);
+		print("Cascade %u: %.2f to %.2f, %.4f units per texel, %.1fx the single shadow map, static casters in %u and dynamic casters in %u of %u frames\n", i,
+			cascade.splitNear, cascade.splitFar, texelSize, oldTexelSize / texelSize, numStaticRenders[i], numDynamicRenders[i], CASCADES_NUM_FRAMES);
+	}
+	print("Shadow cache: %.1f%% of the static cascade renders and %.1f%% of the dynamic ones of rendering every cascade every frame, static renders in %u frames\n",
+		100.0 * staticRenderFraction, 100.0 * double(numDynamicRendersTotal) / double(CASCADES_NUM_FRAMES * cascades.getNumCascades()), numFramesWithStaticRenders);
+	const double numAtlasTexels = double(atlasSize.x) * double(atlasSize.y);
+	print("Shadow cascades: %.0fx%.0f atlas, %.1f%% of the texels of the single shadow map, update %.3f us\n", atlasSize.x, atlasSize.y,
+		100.0 * numAtlasTexels / (double(CASCADES_OLD_SHADOW_RESOLUTION) * double(CASCADES_OLD_SHADOW_RESOLUTION)), double(updateStopwatch.avgMicroSec().count()));
+	return reportTest("Shadow cascades test", passed);
+}
@@ -0,0 +1,16 @@
+#include "TestUtils.h"
+
+void check(bool& a_passed, bool a_condition, const char* a_message)
+{
+	if (!a_condition)
+	{
+		print("%s\n", a_message);
+		a_passed = false;
+	}
+}
+
+bool reportTest(const char* a_name, bool a_passed)
+{
+	print("%s %s\n", a_name, a_passed ? "passed" : "FAILED");
+	return a_passed;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Core.h"
+
+/** Linear congruential generator, the tests only need the same numbers on every platform and run */
+struct TestRandom
+{
+	explicit TestRandom(uint a_seed) : seed(a_seed) {}
+
+	/** 24 bits, the low bits of the generator repeat too quickly */
+	uint next()           { seed = seed * 1664525u + 1013904223u; return seed >> 8; }
+	/** In [0, max) */
+	uint next(uint a_max) { return next() % a_max; }
+	/** In [0, 1) */
+	float nextFloat()     { return float(next()) / float(1 << 24); }
+
+	uint seed;
+};
+
+/** Prints the message and clears passed if the condition does not hold */
+void check(bool& passed, bool condition, const char* message);
+/** Prints the name of the test and if it passed, returns passed */
+bool reportTest(const char* name, bool passed);
@@ -0,0 +1,34 @@
+#pragma once
+
+/** Every test returns if all of its checks passed, main.cpp runs them by name */
+
+// TextureStreamingTests.cpp
+bool simulateTextureStreaming();
+
+// DrawTests.cpp
+bool testDrawCommands();
+bool benchmarkRenderQueue();
+bool testRingBufferAllocator();
+
+// CullingTests.cpp
+bool benchmarkCulling();
+bool testOcclusionCulling();
+
+// LightTests.cpp
+bool benchmarkLightClusters();
+bool benchmarkLightClusterUpdates();
+bool testLightManager();
+
+// ShadowTests.cpp
+bool testShadowCascades();
+
+// RenderGraphTests.cpp
+bool testRenderGraph();
+
+// FrameTimingTests.cpp
+bool testQualityGovernor();
+bool testPassTimings();
+
+// PostProcessTests.cpp
+bool benchmarkBloom();
+bool testHBAOReprojection();
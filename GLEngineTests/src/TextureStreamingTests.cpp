@@ -0,0 +1,108 @@
+#include "Tests.h"
+
+#include "TestUtils.h"
+#include "Graphics/Utils/TextureStreamingPolicy.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/vector.h"
+
+#include <glm/glm.hpp>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+const uint STREAMING_NUM_TEXTURES = 48;
+const uint STREAMING_NUM_LEVELS = 5;
+const uint STREAMING_TEXTURE_SIZE = 4096;
+const float STREAMING_TEXTURE_SPACING = 10.0f;
+const float STREAMING_VIEW_DISTANCE = 60.0f;
+const float STREAMING_FULL_DETAIL_DISTANCE = 4.0f;
+const uint STREAMING_NUM_WALK_FRAMES = 2000;
+const uint STREAMING_NUM_SETTLE_FRAMES = 300;
+
+END_UNNAMED_NAMESPACE()
+
+/** Walks a camera along a row of textures and checks the residency policy never exceeds its budget or upload rate,
+    and that everything the camera needs is resident once it stops. Returns if all checks passed */
+bool simulateTextureStreaming()
+{
+	TextureStreamingPolicy policy;
+	TextureStreamingPolicy::Settings settings;
+	settings.budgetBytes = 512ull * 1024 * 1024;
+	settings.maxUploadBytesPerFrame = 32ull * 1024 * 1024;
+	settings.numKeepFrames = 30;
+	policy.setSettings(settings);
+
+	eastl::vector<eastl::vector<uint64>> levelByteSizes(STREAMING_NUM_TEXTURES);
+	eastl::vector<TextureStreamingHandle> handles;
+	uint64 largestLevelSize = 0;
+	for (uint i = 0; i < STREAMING_NUM_TEXTURES; ++i)
+	{
+		const uint64 numLayers = 1 + i % 3;
+		for (uint level = 0; level < STREAMING_NUM_LEVELS; ++level)
+			levelByteSizes[i].push_back(uint64(STREAMING_TEXTURE_SIZE >> level) * (STREAMING_TEXTURE_SIZE >> level) * 4 * numLayers);
+		largestLevelSize = eastl::max(largestLevelSize, levelByteSizes[i][0]);
+		handles.push_back(policy.addTexture(levelByteSizes[i]));
+	}
+
+	auto getWantedLevel = [](float a_distance)
+	{
+		const float level = glm::log2(glm::max(a_distance / STREAMING_FULL_DETAIL_DISTANCE, 1.0f));
+		return glm::min(uint(level), STREAMING_NUM_LEVELS - 1);
+	};
+
+	bool passed = true;
+	uint64 peakResidentBytes = 0;
+	uint64 totalMissingLevels = 0;
+	const float walkLength = STREAMING_TEXTURE_SPACING * (STREAMING_NUM_TEXTURES - 1);
+	const uint numFrames = STREAMING_NUM_WALK_FRAMES + STREAMING_NUM_SETTLE_FRAMES;
+	for (uint frame = 0; frame < numFrames; ++frame)
+	{
+		const float cameraPos = walkLength * glm::min(float(frame) / STREAMING_NUM_WALK_FRAMES, 1.0f);
+		for (uint i = 0; i < STREAMING_NUM_TEXTURES; ++i)
+		{
+			const float distance = glm::abs(i * STREAMING_TEXTURE_SPACING - cameraPos);
+			if (distance < STREAMING_VIEW_DISTANCE)
+				policy.requestLevel(handles[i], getWantedLevel(distance));
+		}
+		policy.update();
+
+		const TextureStreamingPolicy::Stats& stats = policy.getStats();
+		uint64 residentBytes = 0;
+		for (uint i = 0; i < STREAMING_NUM_TEXTURES; ++i)
+			for (uint level = policy.getResidentLevel(handles[i]); level < STREAMING_NUM_LEVELS; ++level)
+				residentBytes += levelByteSizes[i][level];
+		if (residentBytes != stats.residentBytes || residentBytes > settings.budgetBytes)
+		{
+			print("Frame %u: resident %llu bytes, policy reports %llu, budget %llu\n", frame, residentBytes, stats.residentBytes, settings.budgetBytes);
+			passed = false;
+		}
+		if (stats.uploadedBytes > eastl::max(settings.maxUploadBytesPerFrame, largestLevelSize))
+		{
+			print("Frame %u: uploaded %llu bytes, more than allowed\n", frame, stats.uploadedBytes);
+			passed = false;
+		}
+		peakResidentBytes = eastl::max(peakResidentBytes, residentBytes);
+		totalMissingLevels += stats.numMissingLevels;
+	}
+
+	// The camera stopped at the end of the row where the needed levels fit the budget, so nothing may be missing
+	if (policy.getStats().numMissingLevels != 0)
+	{
+		print("%u levels still missing after settling\n", policy.getStats().numMissingLevels);
+		passed = false;
+	}
+
+	// Lowering the budget has to take effect in the next update
+	settings.budgetBytes /= 4;
+	policy.setSettings(settings);
+	policy.update();
+	if (policy.getStats().residentBytes > settings.budgetBytes)
+	{
+		print("Budget lowered to %llu bytes but %llu resident\n", settings.budgetBytes, policy.getStats().residentBytes);
+		passed = false;
+	}
+
+	const TextureStreamingPolicy::Stats& stats = policy.getStats();
+	print("Texture streaming: %u loads, %u evictions, peak %.1f MB, avg %.2f missing levels per frame\n", stats.numLoads, stats.numEvictions,
+		double(peakResidentBytes) / (1024.0 * 1024.0), double(totalMissingLevels) / numFrames);
+	return reportTest("Texture streaming simulation", passed);
+}
@@ -0,0 +1,71 @@
+#include "GLEngine.h"
+
+#include "Tests.h"
+
+#include <cstring>
+
+BEGIN_UNNAMED_NAMESPACE()
+
+struct Test
+{
+	const char* name;
+	bool(*func)();
+};
+
+const Test TESTS[] =
+{
+	{ "-test-streaming",                   simulateTextureStreaming },
+	{ "-test-draw-commands",               testDrawCommands },
+	{ "-benchmark-render-queue",           benchmarkRenderQueue },
+	{ "-benchmark-culling",                benchmarkCulling },
+	{ "-benchmark-light-clusters",         benchmarkLightClusters },
+	{ "-benchmark-light-cluster-updates",  benchmarkLightClusterUpdates },
+	{ "-test-occlusion",                   testOcclusionCulling },
+	{ "-test-shadow-cascades",             testShadowCascades },
+	{ "-test-ring-buffer",                 testRingBufferAllocator },
+	{ "-test-light-manager",               testLightManager },
+	{ "-test-render-graph",                testRenderGraph },
+	{ "-test-quality-governor",            testQualityGovernor },
+	{ "-test-pass-timings",                testPassTimings },
+	{ "-benchmark-bloom",                  benchmarkBloom },
+	{ "-test-hbao-reprojection",           testHBAOReprojection },
+};
+
+END_UNNAMED_NAMESPACE()
+
+/** Runs every test, or the ones named on the command line. Returns nonzero when a check failed or a name is unknown */
+int main(int argc, char* argv[])
+{
+	GLEngine::initialize("GLEngineTests", 0, 0, EWindowMode::NONE);
+
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		bool known = false;
+		for (uint i = 0; i < ARRAY_SIZE(TESTS) && !known; ++i)
+			known = strcmp(argv[arg], TESTS[i].name) == 0;
+		if (!known)
+		{
+			print("Unknown test: %s\n", argv[arg]);
+			GLEngine::finish();
+			return 1;
+		}
+	}
+
+	uint numRun = 0;
+	uint numFailed = 0;
+	for (uint i = 0; i < ARRAY_SIZE(TESTS); ++i)
+	{
+		bool selected = argc == 1;
+		for (int arg = 1; arg < argc && !selected; ++arg)
+			selected = strcmp(argv[arg], TESTS[i].name) == 0;
+		if (!selected)
+			continue;
+		++numRun;
+		if (!TESTS[i].func())
+			++numFailed;
+	}
+	print("%u of %u tests passed\n", numRun - numFailed, numRun);
+
+	GLEngine::finish();
+	return numFailed ? 1 : 0;
+}
@@ -1,22 +1,153 @@
 #include "GLEngine.h"
 
 #include "Database/AssetDatabase.h"
+#include "Database/Assets/DBScene.h"
+#include "Database/BuildStats.h"
 #include "Database/Processors/SceneProcessor.h"
 #include "Database/ResourceBuilder.h"
+#include "Utils/Stopwatch.h"
 
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
-int main()
+BEGIN_UNNAMED_NAMESPACE()
+
+const char* const OBJ_DB_PATH = "..\\GLApp\\assets\\OBJ-DB.da";
+const char* const MODELS_DIRECTORY_PATH = "..\\GLApp\\assets\\Models";
+const uint NUM_BENCHMARK_ITERATIONS = 3;
+const uint NUM_BENCHMARK_LOOKUPS = 1000000;
+
+/** Imports the file with both importers and prints the throughput. Returns if both imported it */
+bool benchmarkImporters(const eastl::string& a_filePath)
 {
-	GLEngine::initialize("GLResourceBuilder", 0, 0, EWindowMode::NONE);
+	std::ifstream file(a_filePath.c_str(), std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		print("Could not open: %s\n", a_filePath.c_str());
+		return false;
+	}
+	const double fileSizeMB = double(file.tellg()) / (1024.0 * 1024.0);
+	file.close();
 
-	SceneProcessor sceneProcessor;
-	AssetDatabase objDB;
+	const DBScene::EImporter importers[] = { DBScene::EImporter::OBJ, DBScene::EImporter::ASSIMP };
+	const char* const importerNames[] = { "obj", "assimp" };
+	bool allSucceeded = true;
+	for (uint i = 0; i < ARRAY_SIZE(importers); ++i)
+	{
+		Stopwatch stopwatch(NUM_BENCHMARK_ITERATIONS);
+		uint64 numTriangles = 0;
+		bool succeeded = true;
+		for (uint j = 0; j < NUM_BENCHMARK_ITERATIONS && succeeded; ++j)
+		{
+			DBScene scene;
+			stopwatch.start();
+			succeeded = scene.importScene(a_filePath, importers[i]);
+			stopwatch.stop();
+
+			numTriangles = 0;
+			for (const DBMesh& mesh : scene.getMeshes())
+				numTriangles += mesh.getIndices().size() / 3;
+		}
+		if (!succeeded)
+		{
+			print("%-8s failed to import %s\n", importerNames[i], a_filePath.c_str());
+			allSucceeded = false;
+			continue;
+		}
+
+		const double seconds = double(stopwatch.avgMicroSec().count()) / 1000000.0;
+		print("%-8s %8.1f ms  %8.1f MB/s  %8.2f Mtris/s  (%llu tris)\n", importerNames[i], seconds * 1000.0,
+			fileSizeMB / seconds, double(numTriangles) / seconds / 1000000.0, numTriangles);
+	}
+	return allSucceeded;
+}
+
+/** Times NUM_BENCHMARK_LOOKUPS asset lookups by name and by id. Returns if the database could be opened and has assets */
+bool benchmarkLookups(const eastl::string& a_databasePath)
+{
+	AssetDatabase database;
+	if (!database.openExisting(a_databasePath))
+		return false;
+
+	const eastl::vector<eastl::string> names = database.listAssets();
+	if (names.empty())
+	{
+		print("No assets in: %s\n", a_databasePath.c_str());
+		return false;
+	}
+	eastl::vector<AssetID> ids;
+	for (const eastl::string& name : names)
+		ids.push_back(AssetDatabase::getAssetID(name));
 
-	ResourceBuilder::ResourceProcessorMap processors = {{"obj", &sceneProcessor}};
-	objDB.createNew("..\\GLApp\\assets\\OBJ-DB.da");
-	ResourceBuilder::buildResourcesDB(processors, "..\\GLApp\\assets\\Models", objDB);
+	Stopwatch stopwatch;
+	uint numFound = 0;
+	stopwatch.start();
+	for (uint i = 0; i < NUM_BENCHMARK_LOOKUPS; ++i)
+		numFound += database.hasAsset(names[i % names.size()]) ? 1 : 0;
+	stopwatch.stop();
+	print("name lookups: %8.2f ms (%u found)\n", double(stopwatch.avgMicroSec().count()) / 1000.0, numFound);
+
+	stopwatch.reset();
+	numFound = 0;
+	stopwatch.start();
+	for (uint i = 0; i < NUM_BENCHMARK_LOOKUPS; ++i)
+		numFound += database.hasAsset(ids[i % ids.size()]) ? 1 : 0;
+	stopwatch.stop();
+	print("id lookups:   %8.2f ms (%u found)\n", double(stopwatch.avgMicroSec().count()) / 1000.0, numFound);
+	return true;
+}
+
+void buildObjDB(const ResourceBuilder::ResourceProcessorMap& a_processors)
+{
+	AssetDatabase objDB;
+	BuildStats::beginBuild();
+	objDB.createNew(OBJ_DB_PATH);
+	objDB.setWriteOrderFromTrace("..\\GLApp\\assets\\OBJ-DB.trace");
+	ResourceBuilder::buildResourcesDB(a_processors, MODELS_DIRECTORY_PATH, objDB);
 	objDB.writeAndClose();
+	BuildStats::endBuild("..\\GLApp\\assets\\OBJ-DB-report.json");
+}
+
+END_UNNAMED_NAMESPACE()
+
+int main(int argc, char* argv[])
+{
+	GLEngine::initialize("GLResourceBuilder", 0, 0, EWindowMode::NONE);
+
+	// The benchmarks return their result instead of waiting for enter, the tests and the other benchmarks are in GLEngineTests
+	if (argc == 3 && strcmp(argv[1], "-benchmark") == 0)
+	{
+		const bool succeeded = benchmarkImporters(argv[2]);
+		GLEngine::finish();
+		return succeeded ? 0 : 1;
+	}
+	else if (argc == 3 && strcmp(argv[1], "-benchmark-lookup") == 0)
+	{
+		const bool succeeded = benchmarkLookups(argv[2]);
+		GLEngine::finish();
+		return succeeded ? 0 : 1;
+	}
+	else if (argc == 2 && strcmp(argv[1], "-daemon") == 0)
+	{
+		// Keep the processors and database open and only rebuild what changes, a running GLApp reloads the affected scenes
+		SceneProcessor sceneProcessor;
+		ResourceBuilder::ResourceProcessorMap processors = {{"obj", &sceneProcessor}};
+		AssetDatabase objDB;
+		if (!objDB.openForUpdate(OBJ_DB_PATH))
+		{
+			buildObjDB(processors);
+			objDB.openForUpdate(OBJ_DB_PATH);
+		}
+		if (objDB.isOpen())
+			ResourceBuilder::watchResourcesDB(processors, MODELS_DIRECTORY_PATH, objDB);
+	}
+	else
+	{
+		SceneProcessor sceneProcessor;
+		ResourceBuilder::ResourceProcessorMap processors = {{"obj", &sceneProcessor}};
+		buildObjDB(processors);
+	}
 
 	print("Press enter to exit\n");
 	std::cin.ignore();